@@ -30,6 +30,7 @@
 #include "UBCFFAdaptor.h"
 #include "document/UBDocumentProxy.h"
 #include "core/UBDocumentManager.h"
+#include "core/UBPersistenceManager.h"
 #include "core/UBApplication.h"
 #include "core/memcheck.h"
 #include "document/UBDocumentController.h"
@@ -60,8 +61,6 @@ QString UBExportCFF::exportExtention()
 
 void UBExportCFF::persist(UBDocumentProxy* pDocument)
 {
-    QString src = pDocument->persistencePath();
-
     if (!pDocument)
         return;
 
@@ -74,8 +73,12 @@ void UBExportCFF::persist(UBDocumentProxy* pDocument)
         if (mIsVerbose)
             UBApplication::showMessage(tr("Exporting document..."));
 
+            // the IWB converter only understands the legacy page names and the points written in the page svg
+            QString exportPath = UBFileSystemUtils::createTempDir("exportDocument");
+
             UBCFFAdaptor toIWBExporter;
-            if (toIWBExporter.convertUBZToIWB(src, filename))
+            if (UBPersistenceManager::persistenceManager()->copyDocumentForExport(pDocument, exportPath)
+                    && toIWBExporter.convertUBZToIWB(exportPath, filename))
             {
                 if (mIsVerbose)
                     UBApplication::showMessage(tr("Export successful."));
@@ -84,6 +87,8 @@ void UBExportCFF::persist(UBDocumentProxy* pDocument)
                 if (mIsVerbose)
                     UBApplication::showMessage(tr("Export failed."));
 
+            UBFileSystemUtils::deleteDir(exportPath);
+
         showErrorsList(toIWBExporter.getConversionMessages());
 
         QApplication::restoreOverrideCursor();
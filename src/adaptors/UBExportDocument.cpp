@@ -32,6 +32,7 @@
 #include "frameworks/UBPlatformUtils.h"
 
 #include "core/UBDocumentManager.h"
+#include "core/UBPersistenceManager.h"
 #include "core/UBApplication.h"
 
 #include "document/UBDocumentProxy.h"
@@ -76,13 +77,28 @@ bool UBExportDocument::persistsDocument(UBDocumentProxy* pDocumentProxy, const Q
         return false;
     }
 
-    QDir documentDir = QDir(pDocumentProxy->persistencePath());
+    // readers older than the page manifest and the stroke sidecar expect the pages under names that follow their
+    // order and the points in the page svg, that is only written in a copy
+    QString exportPath = UBFileSystemUtils::createTempDir("exportDocument");
+
+    if (!UBPersistenceManager::persistenceManager()->copyDocumentForExport(pDocumentProxy, exportPath))
+    {
+        qWarning() << "Export failed. Cause: cannot copy the document to" << exportPath;
+        UBFileSystemUtils::deleteDir(exportPath);
+        zip.close();
+        QFile::remove(filename);
+        return false;
+    }
+
+    QDir documentDir = QDir(exportPath);
 
     QuaZipFile outFile(&zip);
     UBFileSystemUtils::compressDirInZip(documentDir, "", &outFile, true, this);
 
     zip.close();
 
+    UBFileSystemUtils::deleteDir(exportPath);
+
     if(zip.getZipError() != 0)
     {
         qWarning("Export failed. Cause: zip.close(): %d", zip.getZipError());
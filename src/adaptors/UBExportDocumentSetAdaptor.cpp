@@ -134,6 +134,7 @@ bool UBExportDocumentSetAdaptor::persistData(const QModelIndex &pRootIndex, QStr
 
     if (!addDocumentToZip(pRootIndex, treeModel, zip)) {
         zip.close();
+        QFile::remove(filename);
         return false;
     }
 
@@ -174,13 +175,26 @@ bool UBExportDocumentSetAdaptor::addDocumentToZip(const QModelIndex &pIndex, UBD
         QString documentPath(pDocumentProxy->persistencePath());
         //document.checkDocumentDirectory(documentPath);
 
-        QDir documentDir = QDir(pDocumentProxy->persistencePath());
+        // the set is imported back, possibly by an older version, as a list of folders
+        QString exportPath = UBFileSystemUtils::createTempDir("exportDocument");
+
+        if (!UBPersistenceManager::persistenceManager()->copyDocumentForExport(pDocumentProxy, exportPath))
+        {
+            qWarning() << "Export failed. Cause: cannot copy the document to" << exportPath;
+            UBFileSystemUtils::deleteDir(exportPath);
+            return false;
+        }
+
+        QDir documentDir = QDir(exportPath);
         QuaZipFile zipFile(&zip);
         UBFileSystemUtils::compressDirInZip(documentDir, QFileInfo(documentPath).fileName() + "/", &zipFile, false);
 
+        UBFileSystemUtils::deleteDir(exportPath);
+
         if(zip.getZipError() != 0)
         {
             qWarning("Export failed. Cause: zip.close(): %d", zip.getZipError());
+            return false;
         }
     }
 
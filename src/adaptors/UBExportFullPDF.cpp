@@ -31,7 +31,6 @@
 
 #include <QtCore>
 #include <QtSvg>
-#include <QPrinter>
 
 #include "core/UBApplication.h"
 #include "core/UBDisplayManager.h"
@@ -49,6 +48,7 @@
 #include "pdf/GraphicsPDFItem.h"
 
 #include "UBExportPDF.h"
+#include "UBExportPDFPipeline.h"
 
 #include <Merger.h>
 #include <Exception.h>
@@ -77,10 +77,10 @@ UBExportFullPDF::~UBExportFullPDF()
 }
 
 
-void UBExportFullPDF::saveOverlayPdf(UBDocumentProxy* pDocumentProxy, const QString& filename)
+bool UBExportFullPDF::saveOverlayPdf(UBDocumentProxy* pDocumentProxy, const QString& filename)
 {
     if (!pDocumentProxy || filename.length() == 0 || pDocumentProxy->pageCount() == 0)
-        return;
+        return false;
 
     /*
         PDFMerger is supposed to be working only for PDFs using 1.0 to 1.4 standard, but I encountered no issue using 1.7 documents.
@@ -96,69 +96,35 @@ void UBExportFullPDF::saveOverlayPdf(UBDocumentProxy* pDocumentProxy, const QStr
     {
         //PDF
         qDebug() << "exporting document to PDF Merger" << filename;
-        QPrinter pdfPrinter;
 
-        pdfPrinter.setOutputFormat(QPrinter::PdfFormat);
-        pdfPrinter.setResolution(UBSettings::settings()->pdfResolution->get().toInt());
-        pdfPrinter.setOutputFileName(filename);
-        pdfPrinter.setFullPage(true);
+        mPageDescriptions.fill(PageDescription(), pDocumentProxy->pageCount());
 
-        QPainter* pdfPainter = 0;
+        UBExportPDFPipeline pipeline(pDocumentProxy, UBGraphicsScene::PdfExport);
 
-        for(int pageIndex = 0 ; pageIndex < pDocumentProxy->pageCount(); pageIndex++)
-        {
-            UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(pDocumentProxy, pageIndex);
-            // set background to white, no grid for PDF output
-            bool isDark = scene->isDarkBackground();
-            UBPageBackground pageBackground = scene->pageBackground();
+        pipeline.setSceneInspector([this, pDocumentProxy](UBGraphicsScene* scene, int pageIndex) {
+            PageDescription& page = mPageDescriptions[pageIndex];
+            page.nominalSize = scene->nominalSize();
 
-            bool exportDark = isDark && UBSettings::settings()->exportBackgroundColor->get().toBool();
+            UBGraphicsPDFItem *pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*>(scene->backgroundObject());
 
-            if (UBSettings::settings()->exportBackgroundGrid->get().toBool())
-            {
-                scene->setBackground(exportDark, pageBackground);
-            }
-            else
+            if (pdfItem)
             {
-                scene->setBackground(exportDark, UBPageBackground::plain);
+                mHasPDFBackgrounds = true;
+
+                QString pdfName = UBPersistenceManager::objectDirectory + "/" + pdfItem->fileUuid().toString() + ".pdf";
+                page.backgroundPath = pDocumentProxy->persistencePath() + "/" + pdfName;
+                page.pdfPageNumber = pdfItem->pageNumber();
+                page.annotationsRect = scene->annotationsBoundingRect();
+                page.pdfRect = pdfItem->sceneBoundingRect();
+                page.pdfScale = pdfItem->scale();
             }
+        });
 
-            // set high res rendering
-            scene->setRenderingQuality(UBItem::RenderingQualityHigh, UBItem::CacheNotAllowed);
-            scene->setRenderingContext(UBGraphicsScene::PdfExport);
-
-            // pageSize is the output PDF page size; it is set to equal the scene's boundary size; if the contents
-            // of the scene overflow from the boundaries, they will be scaled down.
-            QSize pageSize = scene->sceneSize();
-
-            UBGraphicsPDFItem *pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*>(scene->backgroundObject());
-
-            if (pdfItem) mHasPDFBackgrounds = true;
-
-            pdfPrinter.setPaperSize(QSizeF(pageSize.width()*mScaleFactor, pageSize.height()*mScaleFactor), QPrinter::Point);
-
-            if (!pdfPainter) pdfPainter = new QPainter(&pdfPrinter);
-
-            if (pageIndex != 0) pdfPrinter.newPage();
-
-            //render to PDF
-            scene->setDrawingMode(true);
-            scene->render(pdfPainter, QRectF(), scene->normalizedSceneRect());
-
-            //restore screen rendering quality
-            scene->setRenderingContext(UBGraphicsScene::Screen);
-            scene->setRenderingQuality(UBItem::RenderingQualityNormal, UBItem::CacheAllowed);
-
-            //restore background state
-            scene->setDrawingMode(false);
-            scene->setBackground(isDark, pageBackground);
-        }
-
-        if (pdfPainter) delete pdfPainter;
+        return pipeline.exportTo(filename);
     }
     else
     {
-        mSimpleExporter->persistsDocument(pDocumentProxy, filename);
+        return mSimpleExporter->persistsDocument(pDocumentProxy, filename);
     }
 }
 
@@ -183,7 +149,11 @@ bool UBExportFullPDF::persistsDocument(UBDocumentProxy* pDocumentProxy, const QS
 
     mHasPDFBackgrounds = false;
 
-    saveOverlayPdf(pDocumentProxy, overlayName);
+    if (!saveOverlayPdf(pDocumentProxy, overlayName))
+    {
+        mPageDescriptions.clear();
+        return false;
+    }
 
     if (!mHasPDFBackgrounds)
     {
@@ -192,9 +162,10 @@ bool UBExportFullPDF::persistsDocument(UBDocumentProxy* pDocumentProxy, const QS
     }
     else
     {
-        Merger merger;
         try
         {
+            // the merger maps the source files, it is released before the overlay is removed
+            Merger merger;
             merger.addOverlayDocument(QFile::encodeName(overlayName).constData());
 
             MergeDescription mergeInfo;
@@ -203,23 +174,21 @@ bool UBExportFullPDF::persistsDocument(UBDocumentProxy* pDocumentProxy, const QS
 
             for(int pageIndex = 0 ; pageIndex < existingPageCount; pageIndex++)
             {
-                UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(pDocumentProxy, pageIndex);
-                UBGraphicsPDFItem *pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*>(scene->backgroundObject());
+                const PageDescription& page = mPageDescriptions.at(pageIndex);
 
-                QSize pageSize = scene->nominalSize();
-                
-                if (pdfItem)
+                QSize pageSize = page.nominalSize.isEmpty() ? pDocumentProxy->defaultDocumentSize() : page.nominalSize;
+
+                if (!page.backgroundPath.isEmpty())
                 {
-                    QString pdfName = UBPersistenceManager::objectDirectory + "/" + pdfItem->fileUuid().toString() + ".pdf";
-                    QString backgroundPath = pDocumentProxy->persistencePath() + "/" + pdfName;
-                    QRectF annotationsRect = scene->annotationsBoundingRect();
+                    QString backgroundPath = page.backgroundPath;
+                    QRectF annotationsRect = page.annotationsRect;
 
                     // Original datas
                     double xAnnotation = qRound(annotationsRect.x());
                     double yAnnotation = qRound(annotationsRect.y());
-                    double xPdf = qRound(pdfItem->sceneBoundingRect().x());
-                    double yPdf = qRound(pdfItem->sceneBoundingRect().y());
-                    double hPdf = qRound(pdfItem->sceneBoundingRect().height());
+                    double xPdf = qRound(page.pdfRect.x());
+                    double yPdf = qRound(page.pdfRect.y());
+                    double hPdf = qRound(page.pdfRect.height());
 
                     // Exportation-transformed datas
                     double hScaleFactor = pageSize.width()/annotationsRect.width();
@@ -240,14 +209,14 @@ bool UBExportFullPDF::persistsDocument(UBDocumentProxy* pDocumentProxy, const QS
 
                     // If the PDF was scaled when added to the scene (e.g if it was loaded from a document with a different DPI
                     // than the current one), it should also be scaled here.
-                    qreal pdfScale = pdfItem->scale();
+                    qreal pdfScale = page.pdfScale;
 
                     TransformationDescription pdfTransform(xPdfOffset, yPdfOffset, scaleFactor * pdfScale, 0);
                     TransformationDescription annotationTransform(xAnnotationsOffset, yAnnotationsOffset, 1, 0);
 
                     MergePageDescription pageDescription(pageSize.width() * mScaleFactor,
                                                          pageSize.height() * mScaleFactor,
-                                                         pdfItem->pageNumber(),
+                                                         page.pdfPageNumber,
                                                          QFile::encodeName(backgroundPath).constData(),
                                                          pdfTransform,
                                                          pageIndex + 1,
@@ -275,7 +244,10 @@ bool UBExportFullPDF::persistsDocument(UBDocumentProxy* pDocumentProxy, const QS
 
             merger.merge(QFile::encodeName(overlayName).constData(), mergeInfo);
 
-            merger.saveMergedDocumentsAs(QFile::encodeName(filename).constData());
+            if (UBSettings::settings()->pdfMergeAsIncrementalUpdate->get().toBool())
+                merger.saveMergedDocumentsAsUpdate(QFile::encodeName(filename).constData());
+            else
+                merger.saveMergedDocumentsAs(QFile::encodeName(filename).constData());
 
         }
         catch(Exception e)
@@ -292,6 +264,8 @@ bool UBExportFullPDF::persistsDocument(UBDocumentProxy* pDocumentProxy, const QS
         }
     }
 
+    mPageDescriptions.clear();
+
     return true;
 }
 
@@ -52,9 +52,23 @@ class UBExportFullPDF : public UBExportAdaptor
         virtual bool persistsDocument(UBDocumentProxy* pDocument, const QString& filename);
 
     protected:
-        void saveOverlayPdf(UBDocumentProxy* pDocumentProxy, const QString& filename);
+        bool saveOverlayPdf(UBDocumentProxy* pDocumentProxy, const QString& filename);
 
     private:
+        // what the merger needs to know about a page, collected while its overlay is rendered
+        struct PageDescription
+        {
+            PageDescription() : pdfPageNumber(0), pdfScale(1) {}
+
+            QSize nominalSize;
+            QString backgroundPath;
+            int pdfPageNumber;
+            QRectF annotationsRect;
+            QRectF pdfRect;
+            qreal pdfScale;
+        };
+
+        QVector<PageDescription> mPageDescriptions;
         float mScaleFactor;
         bool mHasPDFBackgrounds;
 
@@ -49,6 +49,8 @@
 
 #include "pdf/GraphicsPDFItem.h"
 
+#include "UBExportPDFPipeline.h"
+
 #include "core/memcheck.h"
 
 UBExportPDF::UBExportPDF(QObject *parent)
@@ -80,79 +82,9 @@ bool UBExportPDF::associatedActionactionAvailableFor(const QModelIndex &selected
 
 bool UBExportPDF::persistsDocument(UBDocumentProxy* pDocumentProxy, const QString& filename)
 {
-    QPdfWriter pdfWriter(filename);
-
-    qDebug() << "exporting document to PDF" << filename;
-
-    pdfWriter.setResolution(UBSettings::settings()->pdfResolution->get().toInt());
-    pdfWriter.setPageMargins(QMarginsF());
-    pdfWriter.setTitle(pDocumentProxy->name());
-    pdfWriter.setCreator("OpenBoard PDF export");
-    pdfWriter.setPdfVersion(QPagedPaintDevice::PdfVersion_1_4);
-
-    // need to calculate screen resolution
-    float dpiCommon = UBApplication::displayManager->logicalDpi(ScreenRole::Control);
-    float scaleFactor = dpiCommon ? 72.0f / dpiCommon : 1.f;
-
-    QPainter pdfPainter;
-    bool painterNeedsBegin = true;
-
-    int existingPageCount = pDocumentProxy->pageCount();
-
-    for(int pageIndex = 0 ; pageIndex < existingPageCount; pageIndex++) {
-
-        UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(pDocumentProxy, pageIndex);
-        UBApplication::showMessage(tr("Exporting page %1 of %2").arg(pageIndex + 1).arg(existingPageCount));
-
-        // set background to white, no crossing for PDF output
-        bool isDark = scene->isDarkBackground();
-        UBPageBackground pageBackground = scene->pageBackground();
-
-        bool exportDark = isDark && UBSettings::settings()->exportBackgroundColor->get().toBool();
-
-        if (UBSettings::settings()->exportBackgroundGrid->get().toBool())
-        {
-            scene->setBackground(exportDark, pageBackground);
-        }
-        else
-        {
-            scene->setBackground(exportDark, UBPageBackground::plain);
-        }
+    UBExportPDFPipeline pipeline(pDocumentProxy, UBGraphicsScene::NonScreen);
 
-        // pageSize is the output PDF page size; it is set to equal the scene's boundary size; if the contents
-        // of the scene overflow from the boundaries, they will be scaled down.
-        QSize pageSize = scene->sceneSize();
-
-        // set high res rendering
-        scene->setRenderingQuality(UBItem::RenderingQualityHigh, UBItem::CacheNotAllowed);
-        scene->setRenderingContext(UBGraphicsScene::NonScreen);
-
-        // Setting output page size
-        QPageSize outputPageSize = QPageSize(QSizeF(pageSize.width()*scaleFactor, pageSize.height()*scaleFactor), QPageSize::Point);
-        pdfWriter.setPageSize(outputPageSize);
-
-        // Call begin only once
-        if(painterNeedsBegin)
-            painterNeedsBegin = !pdfPainter.begin(&pdfWriter);
-
-        else if (pageIndex < existingPageCount)
-            pdfWriter.newPage();
-
-        // Render the scene
-        scene->render(&pdfPainter, QRectF(), scene->normalizedSceneRect());
-
-        // Restore screen rendering quality
-        scene->setRenderingContext(UBGraphicsScene::Screen);
-        scene->setRenderingQuality(UBItem::RenderingQualityNormal, UBItem::CacheAllowed);
-
-        // Restore background state
-        scene->setBackground(isDark, pageBackground);
-    }
-
-    if(!painterNeedsBegin)
-        pdfPainter.end();
-
-    return true;
+    return pipeline.exportTo(filename);
 }
 
 QString UBExportPDF::exportExtention()
@@ -0,0 +1,377 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#include "UBExportPDFPipeline.h"
+
+#include <QtConcurrent>
+#include <QPdfWriter>
+#include <QThread>
+
+#include "core/UBApplication.h"
+#include "core/UBDisplayManager.h"
+#include "core/UBPersistenceManager.h"
+#include "core/UBSettings.h"
+#include "core/UBSetting.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "gui/UBMainWindow.h"
+
+#include "core/memcheck.h"
+
+class UBExportPDFWriterThread : public QThread
+{
+    public:
+        UBExportPDFWriterThread(UBExportPDFPipeline* pipeline, const QString& filename)
+            : QThread(pipeline)
+            , mPipeline(pipeline)
+            , mFilename(filename)
+        {
+            // NOOP
+        }
+
+    protected:
+        virtual void run()
+        {
+            mPipeline->writePages(mFilename);
+        }
+
+    private:
+        UBExportPDFPipeline* mPipeline;
+        QString mFilename;
+};
+
+UBExportPDFPipeline::UBExportPDFPipeline(UBDocumentProxy* pDocumentProxy, UBGraphicsScene::RenderingContext pRenderingContext, QObject* parent)
+    : QObject(parent)
+    , mDocumentProxy(pDocumentProxy)
+    , mRenderingContext(pRenderingContext)
+    , mPageCount(0)
+    , mNextPageToParse(0)
+    , mNextPageToRecord(0)
+    , mWrittenPageCount(0)
+    , mRecordingScheduled(false)
+    , mProgress(0)
+{
+    mCancelled = false;
+    mWriteFailed = false;
+
+    // a parsed page is much larger than its file, a recorded one larger still
+    mMaxPagesInFlight = qMax(2, QThreadPool::globalInstance()->maxThreadCount()) + 2;
+
+    // need to calculate screen resolution
+    float dpiCommon = UBApplication::displayManager->logicalDpi(ScreenRole::Control);
+    mScaleFactor = dpiCommon ? 72.0f / dpiCommon : 1.f;
+
+    mResolution = UBSettings::settings()->pdfResolution->get().toInt();
+}
+
+UBExportPDFPipeline::~UBExportPDFPipeline()
+{
+    // NOOP
+}
+
+void UBExportPDFPipeline::setSceneInspector(std::function<void(UBGraphicsScene*, int)> inspector)
+{
+    mSceneInspector = inspector;
+}
+
+bool UBExportPDFPipeline::exportTo(const QString& filename)
+{
+    mPageCount = mDocumentProxy->pageCount();
+
+    if (mPageCount == 0)
+        return true;
+
+    QProgressDialog progress(tr("Exporting page %1 of %2").arg(1).arg(mPageCount), tr("Cancel"), 0, mPageCount, UBApplication::mainWindow);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    mProgress = &progress;
+
+    connect(&progress, SIGNAL(canceled()), this, SLOT(cancel()));
+
+    // the pages that are not cached are read from the disk, where the queued saves go first
+    UBPersistenceManager::persistenceManager()->waitForWrites(mDocumentProxy);
+
+    UBExportPDFWriterThread writer(this, filename);
+    writer.start();
+
+    dispatch();
+
+    // the pages are parsed, recorded and written while the dialog runs the event loop
+    progress.exec();
+
+    cancel();
+    writer.wait();
+
+    foreach(QFutureWatcher<UBSvgPreparedScene>* watcher, mParsing)
+        watcher->waitForFinished();
+
+    mProgress = 0;
+
+    bool completed = mWrittenPageCount == mPageCount && !mWriteFailed;
+
+    if (!completed)
+    {
+        qWarning() << "PDF export of" << mDocumentProxy->name() << "stopped after" << mWrittenPageCount << "pages";
+        QFile::remove(filename);
+    }
+
+    return completed;
+}
+
+void UBExportPDFPipeline::dispatch()
+{
+    // parsed, recorded and unwritten pages all count, this bounds the memory used
+    while (!mCancelled && mNextPageToParse < mPageCount && mNextPageToParse - mWrittenPageCount < mMaxPagesInFlight)
+    {
+        int pageIndex = mNextPageToParse++;
+
+        QFutureWatcher<UBSvgPreparedScene>* watcher = new QFutureWatcher<UBSvgPreparedScene>(this);
+        mParsing << watcher;
+
+        connect(watcher, &QFutureWatcher<UBSvgPreparedScene>::finished, this, [this, watcher, pageIndex]() {
+            mParsing.removeOne(watcher);
+            pageParsed(pageIndex, watcher->result());
+            watcher->deleteLater();
+        });
+
+        QString documentPath = mDocumentProxy->persistencePath();
+
+        watcher->setFuture(QtConcurrent::run([documentPath, pageIndex]() {
+            return UBSvgSubsetAdaptor::prepareScene(documentPath, pageIndex);
+        }));
+    }
+}
+
+void UBExportPDFPipeline::pageParsed(int pageIndex, const UBSvgPreparedScene& preparedScene)
+{
+    if (mCancelled)
+        return;
+
+    mParsedPages.insert(pageIndex, preparedScene);
+
+    if (pageIndex == mNextPageToRecord)
+        scheduleRecording();
+}
+
+void UBExportPDFPipeline::scheduleRecording()
+{
+    if (!mRecordingScheduled)
+    {
+        mRecordingScheduled = true;
+        QTimer::singleShot(0, this, SLOT(recordNextPage()));
+    }
+}
+
+void UBExportPDFPipeline::recordNextPage()
+{
+    mRecordingScheduled = false;
+
+    if (mCancelled || !mParsedPages.contains(mNextPageToRecord))
+        return;
+
+    int pageIndex = mNextPageToRecord++;
+    UBSvgPreparedScene preparedScene = mParsedPages.take(pageIndex);
+
+    // a cached scene may hold changes that are not on the disk yet, the other pages are built apart from the cache
+    UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->getDocumentScene(mDocumentProxy, pageIndex);
+    bool cachedScene = scene != 0;
+
+    if (!cachedScene)
+        scene = preparedScene.xmlData.isEmpty() ? 0 : UBSvgSubsetAdaptor::loadScene(mDocumentProxy, preparedScene);
+
+    RecordedPage page;
+
+    if (scene)
+    {
+        page = record(scene, pageIndex);
+
+        if (!cachedScene)
+            delete scene;
+    }
+    else
+    {
+        // an unreadable page stays blank, so that the following pages keep their number
+        QSize pageSize = mDocumentProxy->defaultDocumentSize();
+        page.pointSize = QSizeF(pageSize.width() * mScaleFactor, pageSize.height() * mScaleFactor);
+    }
+
+    {
+        QMutexLocker locker(&mMutex);
+        mRecordedPages.insert(pageIndex, page);
+        mPageRecorded.wakeAll();
+    }
+
+    if (mParsedPages.contains(mNextPageToRecord))
+        scheduleRecording();
+}
+
+UBExportPDFPipeline::RecordedPage UBExportPDFPipeline::record(UBGraphicsScene* scene, int pageIndex)
+{
+    RecordedPage page;
+
+    if (mSceneInspector)
+        mSceneInspector(scene, pageIndex);
+
+    // the changes below are undone afterwards, a cached scene does not need to be saved for them
+    bool isModified = scene->isModified();
+
+    // set background to white, no crossing for PDF output
+    bool isDark = scene->isDarkBackground();
+    UBPageBackground pageBackground = scene->pageBackground();
+
+    bool exportDark = isDark && UBSettings::settings()->exportBackgroundColor->get().toBool();
+
+    if (UBSettings::settings()->exportBackgroundGrid->get().toBool())
+    {
+        scene->setBackground(exportDark, pageBackground);
+    }
+    else
+    {
+        scene->setBackground(exportDark, UBPageBackground::plain);
+    }
+
+    // set high res rendering
+    scene->setRenderingQuality(UBItem::RenderingQualityHigh, UBItem::CacheNotAllowed);
+    scene->setRenderingContext(mRenderingContext);
+
+    // the PDF backgrounds are merged in afterwards, as in desktop mode they are not drawn
+    if (mRenderingContext == UBGraphicsScene::PdfExport)
+        scene->setDrawingMode(true);
+
+    // pageSize is the output PDF page size; it is set to equal the scene's boundary size; if the contents
+    // of the scene overflow from the boundaries, they will be scaled down.
+    QSize pageSize = scene->sceneSize();
+    page.pointSize = QSizeF(pageSize.width() * mScaleFactor, pageSize.height() * mScaleFactor);
+
+    // the recording is played back on a page of the same size in device pixels
+    QRectF targetRect(QPointF(), page.pointSize * mResolution / 72.0);
+
+    QPainter painter(&page.picture);
+    scene->render(&painter, targetRect, scene->normalizedSceneRect());
+    painter.end();
+
+    // Restore screen rendering quality
+    scene->setRenderingContext(UBGraphicsScene::Screen);
+    scene->setRenderingQuality(UBItem::RenderingQualityNormal, UBItem::CacheAllowed);
+    scene->setDrawingMode(false);
+
+    // Restore background state
+    scene->setBackground(isDark, pageBackground);
+    scene->setModified(isModified);
+
+    return page;
+}
+
+void UBExportPDFPipeline::writePages(const QString& filename)
+{
+    QPdfWriter pdfWriter(filename);
+
+    qDebug() << "exporting document to PDF" << filename;
+
+    pdfWriter.setResolution(mResolution);
+    pdfWriter.setPageMargins(QMarginsF());
+    pdfWriter.setTitle(mDocumentProxy->name());
+    pdfWriter.setCreator("OpenBoard PDF export");
+    pdfWriter.setPdfVersion(QPagedPaintDevice::PdfVersion_1_4);
+
+    QPainter pdfPainter;
+
+    for (int pageIndex = 0; pageIndex < mPageCount; pageIndex++)
+    {
+        RecordedPage page;
+
+        {
+            QMutexLocker locker(&mMutex);
+
+            while (!mCancelled && !mRecordedPages.contains(pageIndex))
+                mPageRecorded.wait(&mMutex);
+
+            if (mCancelled)
+                break;
+
+            page = mRecordedPages.take(pageIndex);
+        }
+
+        // Setting output page size
+        pdfWriter.setPageSize(QPageSize(page.pointSize, QPageSize::Point));
+
+        // Call begin only once
+        if (pageIndex == 0)
+        {
+            if (!pdfPainter.begin(&pdfWriter))
+            {
+                mWriteFailed = true;
+                QMetaObject::invokeMethod(this, "cancel", Qt::QueuedConnection);
+                break;
+            }
+        }
+        else
+        {
+            pdfWriter.newPage();
+        }
+
+        pdfPainter.drawPicture(0, 0, page.picture);
+
+        QMetaObject::invokeMethod(this, "pageWritten", Qt::QueuedConnection, Q_ARG(int, pageIndex + 1));
+    }
+
+    if (pdfPainter.isActive())
+        pdfPainter.end();
+}
+
+void UBExportPDFPipeline::pageWritten(int writtenPageCount)
+{
+    mWrittenPageCount = writtenPageCount;
+
+    if (mProgress && !mCancelled)
+    {
+        if (writtenPageCount < mPageCount)
+            mProgress->setLabelText(tr("Exporting page %1 of %2").arg(writtenPageCount + 1).arg(mPageCount));
+
+        // closes the dialog once the last page is written
+        mProgress->setValue(writtenPageCount);
+    }
+
+    dispatch();
+}
+
+void UBExportPDFPipeline::cancel()
+{
+    {
+        QMutexLocker locker(&mMutex);
+        mCancelled = true;
+        mPageRecorded.wakeAll();
+    }
+
+    if (mProgress && mProgress->isVisible())
+        mProgress->cancel();
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#ifndef UBEXPORTPDFPIPELINE_H_
+#define UBEXPORTPDFPIPELINE_H_
+
+#include <QtGui>
+#include <QProgressDialog>
+#include <atomic>
+#include <functional>
+
+#include "adaptors/UBSvgSubsetAdaptor.h"
+#include "domain/UBGraphicsScene.h"
+
+class UBDocumentProxy;
+
+/**
+ * @brief Exports the pages of a document to a PDF file without blocking the user interface
+ *
+ * The pages are parsed on the global thread pool. Their scenes can only be built on the GUI thread, where each
+ * one is recorded into a QPicture, one page per event loop iteration. A single writer thread plays the recordings
+ * back into the PDF in page order. Only a few pages are in flight at any time, and the export can be cancelled
+ * from its progress dialog.
+ *
+ * The scenes are built apart from the scene cache, which is left as it is; pages with unsaved changes are
+ * recorded from their cached scene.
+ */
+class UBExportPDFPipeline : public QObject
+{
+    Q_OBJECT
+
+    friend class UBExportPDFWriterThread;
+
+    public:
+        UBExportPDFPipeline(UBDocumentProxy* pDocumentProxy, UBGraphicsScene::RenderingContext pRenderingContext, QObject* parent = 0);
+        virtual ~UBExportPDFPipeline();
+
+        // called on the GUI thread with the scene of every page, before it is prepared for recording
+        void setSceneInspector(std::function<void(UBGraphicsScene*, int)> inspector);
+
+        // returns false when the export failed or was cancelled, the file is removed then
+        bool exportTo(const QString& filename);
+
+    private slots:
+        void recordNextPage();
+        void pageWritten(int writtenPageCount);
+        void cancel();
+
+    private:
+        struct RecordedPage
+        {
+            QSizeF pointSize;
+            QPicture picture;
+        };
+
+        void dispatch();
+        void pageParsed(int pageIndex, const UBSvgPreparedScene& preparedScene);
+        void scheduleRecording();
+        RecordedPage record(UBGraphicsScene* scene, int pageIndex);
+        void writePages(const QString& filename);
+
+        UBDocumentProxy* mDocumentProxy;
+        UBGraphicsScene::RenderingContext mRenderingContext;
+        std::function<void(UBGraphicsScene*, int)> mSceneInspector;
+
+        int mPageCount;
+        int mMaxPagesInFlight;
+        int mNextPageToParse;
+        int mNextPageToRecord;
+        int mWrittenPageCount;
+        bool mRecordingScheduled;
+
+        float mScaleFactor;
+        int mResolution;
+
+        QMap<int, UBSvgPreparedScene> mParsedPages;
+        QList<QFutureWatcher<UBSvgPreparedScene>*> mParsing;
+
+        QMutex mMutex;
+        QWaitCondition mPageRecorded;
+        QMap<int, RecordedPage> mRecordedPages;
+        std::atomic<bool> mCancelled;
+        std::atomic<bool> mWriteFailed;
+
+        QProgressDialog* mProgress;
+};
+
+#endif /* UBEXPORTPDFPIPELINE_H_ */
@@ -33,6 +33,7 @@
 #include "frameworks/UBFileSystemUtils.h"
 
 #include "core/UBDocumentManager.h"
+#include "core/UBPersistenceManager.h"
 #include "core/UBApplication.h"
 
 #include "document/UBDocumentProxy.h"
@@ -69,7 +70,8 @@ void UBExportWeb::persist(UBDocumentProxy* pDocumentProxy)
         QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
         UBApplication::showMessage(tr("Exporting document..."));
 
-        if(UBFileSystemUtils::copyDir(pDocumentProxy->persistencePath(), dirName))
+        // the web player reads the pages by their legacy names
+        if(UBPersistenceManager::persistenceManager()->copyDocumentForExport(pDocumentProxy, dirName))
         {
             QString htmlPath = dirName + "/index.html";
 
@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#include "UBPageManifest.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+
+#include "core/memcheck.h"
+
+const QString UBPageManifest::manifestFileName = "pages.xml";
+
+QMutex UBPageManifest::sMutex;
+QHash<QString, UBPageManifest::Manifest> UBPageManifest::sManifests;
+
+static const QString tPages = "pages";
+static const QString tPage = "page";
+static const QString aVersion = "version";
+static const QString aFile = "file";
+static const QString sManifestVersion = "1";
+
+int UBPageManifest::pageNumber(const QString& documentPath, int pageIndex)
+{
+    QMutexLocker locker(&sMutex);
+
+    const Manifest& pages = manifest(documentPath);
+
+    // a legacy document may be asked for the page about to be appended
+    if (!pages.stored)
+        return pageIndex;
+
+    if (pageIndex < 0 || pageIndex >= pages.numbers.size())
+    {
+        qWarning() << "no page" << pageIndex << "in" << documentPath;
+        return -1;
+    }
+
+    return pages.numbers.at(pageIndex);
+}
+
+
+int UBPageManifest::pageCount(const QString& documentPath)
+{
+    QMutexLocker locker(&sMutex);
+
+    QHash<QString, Manifest>::iterator it = sManifests.find(documentPath);
+
+    if (it != sManifests.end())
+    {
+        updateLegacyPageCount(documentPath, it.value());
+        return it.value().numbers.size();
+    }
+
+    // counted at startup for every document, only the documents in use are kept
+    QVector<int> numbers;
+
+    if (read(documentPath, numbers))
+        return numbers.size();
+
+    return legacyPageCount(documentPath);
+}
+
+
+QString UBPageManifest::pageSvgPath(const QString& documentPath, int pageIndex)
+{
+    return documentPath + "/" + svgFileName(pageNumber(documentPath, pageIndex));
+}
+
+
+QString UBPageManifest::pageThumbnailPath(const QString& documentPath, int pageIndex)
+{
+    return documentPath + "/" + thumbnailFileName(pageNumber(documentPath, pageIndex));
+}
+
+
+QString UBPageManifest::svgFileName(int pageNumber)
+{
+    return UBFileSystemUtils::digitFileFormat("page%1.svg", pageNumber);
+}
+
+
+QString UBPageManifest::thumbnailFileName(int pageNumber)
+{
+    return UBFileSystemUtils::digitFileFormat("page%1.thumbnail.jpg", pageNumber);
+}
+
+
+int UBPageManifest::insertPage(const QString& documentPath, int pageIndex)
+{
+    QMutexLocker locker(&sMutex);
+
+    Manifest& pages = manifest(documentPath);
+    updateLegacyPageCount(documentPath, pages);
+
+    int count = pages.numbers.size();
+
+    pageIndex = qBound(0, pageIndex, count);
+
+    // appending keeps the legacy layout
+    if (!pages.stored && pageIndex == count)
+    {
+        pages.numbers.append(count);
+        return count;
+    }
+
+    // the lowest free number, so that file names keep their three digits as long as they did before;
+    // a file left by a page removed while its save was still queued is not reused
+    QSet<int> usedNumbers;
+
+    foreach (int number, pages.numbers)
+        usedNumbers << number;
+
+    int number = 0;
+
+    while (usedNumbers.contains(number) || QFile::exists(documentPath + "/" + svgFileName(number)))
+        number++;
+
+    pages.numbers.insert(pageIndex, number);
+    pages.stored = true;
+
+    write(documentPath, pages);
+
+    return number;
+}
+
+
+int UBPageManifest::removePage(const QString& documentPath, int pageIndex)
+{
+    QMutexLocker locker(&sMutex);
+
+    Manifest& pages = manifest(documentPath);
+    updateLegacyPageCount(documentPath, pages);
+
+    int count = pages.numbers.size();
+
+    if (pageIndex < 0 || pageIndex >= count)
+        return -1;
+
+    int number = pages.numbers.takeAt(pageIndex);
+
+    if (pages.stored || pageIndex != count - 1)
+    {
+        pages.stored = true;
+        write(documentPath, pages);
+    }
+
+    return number;
+}
+
+
+void UBPageManifest::movePage(const QString& documentPath, int sourceIndex, int targetIndex)
+{
+    QMutexLocker locker(&sMutex);
+
+    Manifest& pages = manifest(documentPath);
+    updateLegacyPageCount(documentPath, pages);
+
+    int count = pages.numbers.size();
+
+    if (sourceIndex == targetIndex || sourceIndex < 0 || sourceIndex >= count || targetIndex < 0 || targetIndex >= count)
+        return;
+
+    pages.numbers.move(sourceIndex, targetIndex);
+    pages.stored = true;
+
+    write(documentPath, pages);
+}
+
+
+int UBPageManifest::fillNumber(const QString& documentPath, int pageNumber)
+{
+    QMutexLocker locker(&sMutex);
+
+    Manifest& pages = manifest(documentPath);
+
+    if (!pages.stored || pageNumber < 0)
+        return -1;
+
+    int lastIndex = -1;
+
+    for (int i = 0; i < pages.numbers.size(); i++)
+    {
+        if (pages.numbers.at(i) > pageNumber && (lastIndex < 0 || pages.numbers.at(i) > pages.numbers.at(lastIndex)))
+            lastIndex = i;
+    }
+
+    if (lastIndex < 0)
+        return -1;
+
+    int lastNumber = pages.numbers.at(lastIndex);
+
+    if (!QFile::rename(documentPath + "/" + svgFileName(lastNumber), documentPath + "/" + svgFileName(pageNumber)))
+    {
+        qWarning() << "cannot renumber page" << lastNumber << "of" << documentPath;
+        return -1;
+    }
+
+    // the pack entry of the number belongs to the removed page, its jpeg date and size no longer match
+    QFile::rename(documentPath + "/" + thumbnailFileName(lastNumber), documentPath + "/" + thumbnailFileName(pageNumber));
+
+    pages.numbers[lastIndex] = pageNumber;
+
+    write(documentPath, pages);
+
+    return lastNumber;
+}
+
+
+void UBPageManifest::forget(const QString& documentPath)
+{
+    QMutexLocker locker(&sMutex);
+
+    sManifests.remove(documentPath);
+}
+
+
+UBPageManifest::Manifest& UBPageManifest::manifest(const QString& documentPath)
+{
+    QHash<QString, Manifest>::iterator it = sManifests.find(documentPath);
+
+    if (it != sManifests.end())
+        return it.value();
+
+    Manifest pages;
+    pages.stored = read(documentPath, pages.numbers);
+
+    if (!pages.stored)
+    {
+        int count = legacyPageCount(documentPath);
+
+        for (int i = 0; i < count; i++)
+            pages.numbers << i;
+    }
+
+    return sManifests.insert(documentPath, pages).value();
+}
+
+
+bool UBPageManifest::read(const QString& documentPath, QVector<int>& numbers)
+{
+    QFile file(documentPath + "/" + manifestFileName);
+
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    QXmlStreamReader xmlReader(&file);
+    QSet<int> knownNumbers;
+
+    numbers.clear();
+
+    while (!xmlReader.atEnd())
+    {
+        xmlReader.readNext();
+
+        if (!xmlReader.isStartElement())
+            continue;
+
+        if (xmlReader.name() == tPages)
+        {
+            if (xmlReader.attributes().value(aVersion) != sManifestVersion)
+            {
+                xmlReader.raiseError("unknown version");
+                break;
+            }
+        }
+        else if (xmlReader.name() == tPage)
+        {
+            bool isNumber = false;
+            int number = xmlReader.attributes().value(aFile).toInt(&isNumber);
+
+            if (!isNumber || number < 0 || knownNumbers.contains(number))
+            {
+                xmlReader.raiseError("invalid page");
+                break;
+            }
+
+            knownNumbers << number;
+            numbers << number;
+        }
+    }
+
+    if (xmlReader.hasError())
+    {
+        qWarning() << "cannot make sense of page manifest" << file.fileName() << xmlReader.errorString();
+        numbers.clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+bool UBPageManifest::write(const QString& documentPath, const Manifest& manifest)
+{
+    QSaveFile file(documentPath + "/" + manifestFileName);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCritical() << "cannot open " << file.fileName() << " for writing ...";
+        return false;
+    }
+
+    QXmlStreamWriter xmlWriter(&file);
+    xmlWriter.setAutoFormatting(true);
+
+    xmlWriter.writeStartDocument();
+    xmlWriter.writeStartElement(tPages);
+    xmlWriter.writeAttribute(aVersion, sManifestVersion);
+
+    foreach (int number, manifest.numbers)
+    {
+        xmlWriter.writeEmptyElement(tPage);
+        xmlWriter.writeAttribute(aFile, QString::number(number));
+    }
+
+    xmlWriter.writeEndElement();
+    xmlWriter.writeEndDocument();
+
+    return file.commit();
+}
+
+
+void UBPageManifest::updateLegacyPageCount(const QString& documentPath, Manifest& manifest)
+{
+    if (manifest.stored)
+        return;
+
+    // pages may have been written after the last one by their index since; the files of appended pages
+    // may still be queued for writing, so the count never goes down here
+    int count = manifest.numbers.size();
+
+    while (QFile::exists(documentPath + "/" + svgFileName(count)))
+        manifest.numbers << count++;
+}
+
+
+int UBPageManifest::legacyPageCount(const QString& documentPath)
+{
+    int pageIndex = 0;
+
+    while (QFile::exists(documentPath + "/" + svgFileName(pageIndex)))
+        pageIndex++;
+
+    return pageIndex;
+}
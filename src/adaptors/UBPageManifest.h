@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+#ifndef UBPAGEMANIFEST_H
+#define UBPAGEMANIFEST_H
+
+#include <QtCore>
+
+/**
+ * The order of the pages of a document, kept in pages.xml as the list of the numbers of their files.
+ *
+ * Without that file a document has the legacy layout, the page at index i being stored in pageNNN.svg and
+ * pageNNN.thumbnail.jpg with NNN = i. A document gets a manifest the first time a page is inserted, removed or
+ * moved anywhere but at its end: those operations change the list instead of renaming every following page.
+ * The numbers are kept from 0 on without gap, older versions read the pages until the first missing number and
+ * so still see every page, in the order of their files; the exports write the pages under their legacy names.
+ */
+class UBPageManifest
+{
+public:
+    // safe to call from any thread, -1 when the document has no such page
+    static int pageNumber(const QString& documentPath, int pageIndex);
+    static int pageCount(const QString& documentPath);
+
+    static QString pageSvgPath(const QString& documentPath, int pageIndex);
+    static QString pageThumbnailPath(const QString& documentPath, int pageIndex);
+
+    static QString svgFileName(int pageNumber);
+    static QString thumbnailFileName(int pageNumber);
+
+    // the number of the files of the new page, that do not exist yet
+    static int insertPage(const QString& documentPath, int pageIndex);
+
+    // the number of the files of the removed page, that are left to the caller
+    static int removePage(const QString& documentPath, int pageIndex);
+
+    static void movePage(const QString& documentPath, int sourceIndex, int targetIndex);
+
+    // gives the files of the page with the highest number the number of a removed page, whose files are gone;
+    // returns the number the page had, -1 when no page was renumbered
+    static int fillNumber(const QString& documentPath, int pageNumber);
+
+    // drops what is known of a document whose folder is deleted
+    static void forget(const QString& documentPath);
+
+    static const QString manifestFileName;
+
+private:
+    struct Manifest
+    {
+        Manifest() : stored(false) {}
+
+        QVector<int> numbers;
+        bool stored;
+    };
+
+    // callers hold sMutex
+    static Manifest& manifest(const QString& documentPath);
+    static bool read(const QString& documentPath, QVector<int>& numbers);
+    static bool write(const QString& documentPath, const Manifest& manifest);
+    static void updateLegacyPageCount(const QString& documentPath, Manifest& manifest);
+    static int legacyPageCount(const QString& documentPath);
+
+    static QMutex sMutex;
+    static QHash<QString, Manifest> sManifests;
+};
+
+#endif // UBPAGEMANIFEST_H
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+#include "UBStrokeSidecar.h"
+
+#include <QtEndian>
+
+#include "core/UBPersistenceManager.h"
+
+#include "core/memcheck.h"
+
+const QString UBStrokeSidecar::fileSuffix = ".ubs";
+
+static const quint32 sMagic = 0x55425354; // "UBST"
+static const quint16 sVersion = 1;
+static const quint16 sQuantization = 100;
+static const int sHeaderSize = 12;
+
+static inline void appendVarint(QByteArray& data, quint32 value)
+{
+    while (value >= 0x80)
+    {
+        data.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    data.append(char(value));
+}
+
+static inline void appendSigned(QByteArray& data, qint32 value)
+{
+    appendVarint(data, (quint32(value) << 1) ^ quint32(value >> 31));
+}
+
+static inline bool readVarint(const uchar*& pos, const uchar* end, quint32& value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 32 && pos < end; shift += 7)
+    {
+        uchar byte = *pos++;
+        value |= quint32(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+static inline bool readSigned(const uchar*& pos, const uchar* end, qint32& value)
+{
+    quint32 zigzag;
+
+    if (!readVarint(pos, end, zigzag))
+        return false;
+
+    value = qint32(zigzag >> 1) ^ -qint32(zigzag & 1);
+
+    return true;
+}
+
+
+QString UBStrokeSidecar::relativePath(const QUuid& uuid)
+{
+    return UBPersistenceManager::strokeDirectory + "/" + uuid.toString() + fileSuffix;
+}
+
+
+QByteArray UBStrokeSidecar::encode(const QVector<QPolygonF>& strokes)
+{
+    QByteArray data;
+
+    int pointCount = 0;
+    foreach(const QPolygonF& stroke, strokes)
+        pointCount += stroke.size();
+
+    // deltas between successive points of a stroke mostly fit in one or two bytes
+    data.reserve(sHeaderSize + strokes.size() * 2 + pointCount * 3);
+
+    uchar header[sHeaderSize];
+    qToBigEndian<quint32>(sMagic, header);
+    qToBigEndian<quint16>(sVersion, header + 4);
+    qToBigEndian<quint16>(sQuantization, header + 6);
+    qToBigEndian<quint32>(strokes.size(), header + 8);
+    data.append(reinterpret_cast<const char*>(header), sHeaderSize);
+
+    foreach(const QPolygonF& stroke, strokes)
+    {
+        appendVarint(data, stroke.size());
+
+        qint32 previousX = 0;
+        qint32 previousY = 0;
+
+        foreach(const QPointF& point, stroke)
+        {
+            qint32 x = qRound(point.x() * sQuantization);
+            qint32 y = qRound(point.y() * sQuantization);
+
+            appendSigned(data, x - previousX);
+            appendSigned(data, y - previousY);
+
+            previousX = x;
+            previousY = y;
+        }
+    }
+
+    return data;
+}
+
+
+bool UBStrokeSidecar::decode(const QByteArray& data, QVector<QPolygonF>& strokes)
+{
+    strokes.clear();
+
+    if (data.size() < sHeaderSize)
+        return false;
+
+    const uchar* pos = reinterpret_cast<const uchar*>(data.constData());
+    const uchar* end = pos + data.size();
+
+    if (qFromBigEndian<quint32>(pos) != sMagic || qFromBigEndian<quint16>(pos + 4) != sVersion)
+        return false;
+
+    quint16 quantization = qFromBigEndian<quint16>(pos + 6);
+    quint32 strokeCount = qFromBigEndian<quint32>(pos + 8);
+    pos += sHeaderSize;
+
+    if (quantization == 0)
+        return false;
+
+    // every stroke needs at least its point count byte
+    if (strokeCount > quint32(end - pos))
+        return false;
+
+    strokes.reserve(strokeCount);
+
+    for (quint32 i = 0; i < strokeCount; i++)
+    {
+        quint32 pointCount;
+
+        // every point needs at least two bytes
+        if (!readVarint(pos, end, pointCount) || pointCount > quint32(end - pos) / 2)
+        {
+            strokes.clear();
+            return false;
+        }
+
+        QPolygonF stroke;
+        stroke.reserve(pointCount);
+
+        qint32 x = 0;
+        qint32 y = 0;
+
+        for (quint32 j = 0; j < pointCount; j++)
+        {
+            qint32 dx, dy;
+
+            if (!readSigned(pos, end, dx) || !readSigned(pos, end, dy))
+            {
+                strokes.clear();
+                return false;
+            }
+
+            x += dx;
+            y += dy;
+
+            stroke << QPointF(qreal(x) / quantization, qreal(y) / quantization);
+        }
+
+        strokes << stroke;
+    }
+
+    return true;
+}
+
+
+bool UBStrokeSidecar::write(const QString& fileName, const QVector<QPolygonF>& strokes)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCritical() << "cannot open " << fileName << " for writing ...";
+        return false;
+    }
+
+    file.write(encode(strokes));
+    file.close();
+
+    return true;
+}
+
+
+QVector<QPolygonF> UBStrokeSidecar::read(const QString& fileName)
+{
+    QVector<QPolygonF> strokes;
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Cannot open file " << fileName << " for reading ...";
+        return strokes;
+    }
+
+    if (!decode(file.readAll(), strokes))
+        qWarning() << "cannot make sense of stroke file" << fileName;
+
+    file.close();
+
+    return strokes;
+}
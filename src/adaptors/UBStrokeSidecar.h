@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+#ifndef UBSTROKESIDECAR_H
+#define UBSTROKESIDECAR_H
+
+#include <QtCore>
+#include <QPolygonF>
+
+/**
+ * Binary storage of the point lists of a page's strokes, written next to the page svg.
+ * Points are quantized to 1/100 of a scene unit and delta encoded as zigzag varints;
+ * the stroke elements of the svg refer to their point list by index.
+ */
+class UBStrokeSidecar //static class
+{
+public:
+    static QString relativePath(const QUuid& uuid);
+
+    static QByteArray encode(const QVector<QPolygonF>& strokes);
+    static bool decode(const QByteArray& data, QVector<QPolygonF>& strokes);
+
+    static bool write(const QString& fileName, const QVector<QPolygonF>& strokes);
+    static QVector<QPolygonF> read(const QString& fileName);
+
+    static const QString fileSuffix;
+
+private:
+    UBStrokeSidecar() {}
+};
+
+#endif // UBSTROKESIDECAR_H
@@ -77,6 +77,9 @@
 #include "core/UBDisplayManager.h"
 #include "core/UBTextTools.h"
 
+#include "adaptors/UBStrokeSidecar.h"
+#include "adaptors/UBPageManifest.h"
+
 #include "pdf/PDFRenderer.h"
 
 #include "core/memcheck.h"
@@ -99,6 +102,89 @@ const QString tStrokeGroup = "strokeGroup";
 const QString tGroups = "groups";
 const QString aId = "id";
 
+const QString tAudio = "audio";
+const QString tAxes = "axes";
+const QString tBr = "br";
+const QString tCache = "cache";
+const QString tCompass = "compass";
+const QString tCurtain = "curtain";
+const QString tDatastoreEntry = "datastoreEntry";
+const QString tFont = "font";
+const QString tForeignObject = "foreignObject";
+const QString tImage = "image";
+const QString tItemTextContent = "itemTextContent";
+const QString tLine = "line";
+const QString tPolygon = "polygon";
+const QString tPolyline = "polyline";
+const QString tPreference = "preference";
+const QString tProtractor = "protractor";
+const QString tRuler = "ruler";
+const QString tSvg = "svg";
+const QString tSvgGroup = "g";
+const QString tText = "text";
+const QString tTriangle = "triangle";
+const QString tVideo = "video";
+
+const QString aAngle = "angle";
+const QString aBackground = "background";
+const QString aColor = "color";
+const QString aColorA = "colorA";
+const QString aColorB = "colorB";
+const QString aColorG = "colorG";
+const QString aColorR = "colorR";
+const QString aCrossedBackground = "crossed-background";
+const QString aDarkBackground = "dark-background";
+const QString aEditable = "editable";
+const QString aFace = "face";
+const QString aFill = "fill";
+const QString aFillOnDarkBackground = "fill-on-dark-background";
+const QString aFillOnLightBackground = "fill-on-light-background";
+const QString aFillOpacity = "fill-opacity";
+const QString aFillRule = "fill-rule";
+const QString aFrozen = "frozen";
+const QString aGridSize = "grid-size";
+const QString aHeight = "height";
+const QString aHref = "href";
+const QString aIntermediateLines = "intermediate-lines";
+const QString aKey = "key";
+const QString aLayer = "layer";
+const QString aLeft = "left";
+const QString aLocked = "locked";
+const QString aMarkerAngle = "marker-angle";
+const QString aNominalSize = "nominal-size";
+const QString aNumbers = "numbers";
+const QString aOrientation = "orientation";
+const QString aPageDpi = "pageDpi";
+const QString aParent = "parent";
+const QString aPixelsPerPoint = "pixels-per-point";
+const QString aPoints = "points";
+const QString aPointsIndex = "points-index";
+const QString aPosition = "position";
+const QString aRuledBackground = "ruled-background";
+const QString aShape = "shape";
+const QString aShapeSize = "shapeSize";
+const QString aSource = "source";
+const QString aSrc = "src";
+const QString aStroke = "stroke";
+const QString aStrokeOpacity = "stroke-opacity";
+const QString aStrokeWidth = "stroke-width";
+const QString aStrokes = "strokes";
+const QString aStyle = "style";
+const QString aTop = "top";
+const QString aTransform = "transform";
+const QString aType = "type";
+const QString aUuid = "uuid";
+const QString aValue = "value";
+const QString aViewBox = "viewBox";
+const QString aWidth = "width";
+const QString aX = "x";
+const QString aX1 = "x1";
+const QString aX2 = "x2";
+const QString aY = "y";
+const QString aY1 = "y1";
+const QString aY2 = "y2";
+const QString aZValue = "z-value";
+
 QString UBSvgSubsetAdaptor::toSvgTransform(const QTransform& matrix)
 {
     return QString("matrix(%1, %2, %3, %4, %5, %6)")
@@ -111,32 +197,223 @@ QString UBSvgSubsetAdaptor::toSvgTransform(const QTransform& matrix)
 }
 
 
-QTransform UBSvgSubsetAdaptor::fromSvgTransform(const QString& transform)
+// Reads a C locale number straight from the reader's buffer, without building a QString.
+// On success pos is left right after the number.
+static bool readSvgNumber(const QChar*& pos, const QChar* end, qreal& value)
+{
+    const QChar* c = pos;
+    bool negative = false;
+
+    if (c < end && (*c == QLatin1Char('-') || *c == QLatin1Char('+')))
+    {
+        negative = *c == QLatin1Char('-');
+        ++c;
+    }
+
+    qreal number = 0;
+    bool hasDigits = false;
+
+    while (c < end && c->unicode() >= '0' && c->unicode() <= '9')
+    {
+        number = number * 10 + (c->unicode() - '0');
+        hasDigits = true;
+        ++c;
+    }
+
+    if (c < end && *c == QLatin1Char('.'))
+    {
+        qreal scale = 1;
+        ++c;
+
+        while (c < end && c->unicode() >= '0' && c->unicode() <= '9')
+        {
+            number = number * 10 + (c->unicode() - '0');
+            scale *= 10;
+            hasDigits = true;
+            ++c;
+        }
+
+        number /= scale;
+    }
+
+    if (!hasDigits)
+        return false;
+
+    if (c < end && (*c == QLatin1Char('e') || *c == QLatin1Char('E')))
+    {
+        const QChar* e = c + 1;
+        bool negativeExponent = false;
+
+        if (e < end && (*e == QLatin1Char('-') || *e == QLatin1Char('+')))
+        {
+            negativeExponent = *e == QLatin1Char('-');
+            ++e;
+        }
+
+        int exponent = 0;
+        bool hasExponent = false;
+
+        while (e < end && e->unicode() >= '0' && e->unicode() <= '9')
+        {
+            exponent = exponent * 10 + (e->unicode() - '0');
+            hasExponent = true;
+            ++e;
+        }
+
+        if (hasExponent)
+        {
+            number *= qPow(10., negativeExponent ? -exponent : exponent);
+            c = e;
+        }
+    }
+
+    value = negative ? -number : number;
+    pos = c;
+
+    return true;
+}
+
+
+// scans "matrix(a,b,c,d,e,f)" in place, so that the reader does not copy the attribute
+static QTransform transformFromSvgRef(const QStringRef& transform)
 {
     QTransform matrix;
-    QString ts = transform;
-    ts.replace("matrix(", "");
-    ts.replace(")", "");
-    QStringList sl = ts.split(",");
 
-    if (sl.size() >= 6)
+    const QChar* c = transform.unicode();
+    const QChar* end = c + transform.size();
+
+    const QChar* values = c;
+    while (values < end && *values != QLatin1Char('('))
+        ++values;
+
+    if (values < end)
+        c = values + 1;
+
+    qreal m[6];
+    int count = 0;
+
+    while (count < 6 && c < end)
     {
-        matrix.setMatrix(
-                    sl.at(0).toFloat(),
-                    sl.at(1).toFloat(),
-                    0,
-                    sl.at(2).toFloat(),
-                    sl.at(3).toFloat(),
-                    0,
-                    sl.at(4).toFloat(),
-                    sl.at(5).toFloat(),
-                    1);
+        while (c < end && (c->isSpace() || *c == QLatin1Char(',')))
+            ++c;
+
+        if (!readSvgNumber(c, end, m[count]))
+            break;
+
+        count++;
     }
 
+    if (count == 6)
+        matrix.setMatrix(m[0], m[1], 0, m[2], m[3], 0, m[4], m[5], 1);
+
     return matrix;
 }
 
 
+QPolygonF UBSvgSubsetAdaptor::fromSvgPoints(const QStringRef& svgPoints)
+{
+    QPolygonF polygon;
+
+    if (svgPoints.isNull())
+    {
+        qWarning() << "cannot make sense of 'points' value " << svgPoints.toString();
+        return polygon;
+    }
+
+    // a point is written as "x,y " so its size gives a good guess of the point count
+    polygon.reserve(svgPoints.size() / 8);
+
+    const QChar* start = svgPoints.unicode();
+    const QChar* end = start + svgPoints.size();
+    const QChar* c = start;
+
+    while (c < end)
+    {
+        while (c < end && c->isSpace())
+            ++c;
+
+        if (c == end)
+            break;
+
+        const QChar* pointEnd = c;
+        while (pointEnd < end && !pointEnd->isSpace())
+            ++pointEnd;
+
+        qreal x = 0, y = 0;
+        const QChar* p = c;
+
+        bool parsed = readSvgNumber(p, pointEnd, x) && p < pointEnd && *p == QLatin1Char(',');
+
+        if (parsed)
+        {
+            ++p;
+            parsed = readSvgNumber(p, pointEnd, y) && p == pointEnd;
+        }
+
+        if (parsed)
+        {
+            polygon << QPointF(x, y);
+        }
+        else
+        {
+            QStringRef sPoint = svgPoints.mid(c - start, pointEnd - c);
+            QVector<QStringRef> sCoord = sPoint.split(QLatin1Char(','), QString::SkipEmptyParts);
+
+            if (sCoord.size() == 2)
+            {
+                polygon << QPointF(sCoord.at(0).toFloat(), sCoord.at(1).toFloat());
+            }
+            else if (sCoord.size() == 4){
+                //This is the case on system were the "," is used to seperate decimal
+                QString sX = sCoord.at(0).toString() + "." + sCoord.at(1).toString();
+                QString sY = sCoord.at(2).toString() + "." + sCoord.at(3).toString();
+                polygon << QPointF(sX.toFloat(), sY.toFloat());
+            }
+            else
+            {
+                qWarning() << "cannot make sense of a 'point' value" << sPoint.toString();
+            }
+        }
+
+        c = pointEnd;
+    }
+
+    return polygon;
+}
+
+
+
+#ifndef QT_NO_DEBUG
+struct UBSvgParseStatistic
+{
+    UBSvgParseStatistic() : count(0), nsecs(0) {}
+
+    int count;
+    qint64 nsecs;
+};
+
+// time spent handling each element type, gathered by UBSvgSubsetReader::loadScene in debug builds.
+// Scenes are only built on the GUI thread, the worker threads stop at prepareScene.
+static QMap<QString, UBSvgParseStatistic> sParseStatistics;
+#endif
+
+
+void UBSvgSubsetAdaptor::dumpParseStatistics()
+{
+#ifndef QT_NO_DEBUG
+    QMapIterator<QString, UBSvgParseStatistic> it(sParseStatistics);
+
+    while (it.hasNext())
+    {
+        it.next();
+        qDebug() << "UBSvgSubsetAdaptor::dumpParseStatistics:" << it.key()
+                 << "count" << it.value().count
+                 << "total" << it.value().nsecs / 1000000 << "ms"
+                 << "average" << it.value().nsecs / it.value().count / 1000 << "us";
+    }
+#endif
+}
+
 
 static bool itemZIndexComp(const QGraphicsItem* item1,
                            const QGraphicsItem* item2)
@@ -164,7 +441,7 @@ void UBSvgSubsetAdaptor::upgradeScene(UBDocumentProxy* proxy, const int pageInde
 
 QDomDocument UBSvgSubsetAdaptor::loadSceneDocument(UBDocumentProxy* proxy, const int pPageIndex)
 {
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg",pPageIndex);
+    QString fileName = UBPageManifest::pageSvgPath(proxy->persistencePath(), pPageIndex);
 
     QFile file(fileName);
     QDomDocument doc("page");
@@ -185,49 +462,98 @@ QDomDocument UBSvgSubsetAdaptor::loadSceneDocument(UBDocumentProxy* proxy, const
 }
 
 
+// declared before the element they apply to, so that a rewritten element keeps its prefix
+static void writeNamespaceDeclarations(const QXmlStreamReader& xmlReader, QXmlStreamWriter& xmlWriter)
+{
+    foreach (const QXmlStreamNamespaceDeclaration& declaration, xmlReader.namespaceDeclarations())
+    {
+        if (declaration.prefix().isEmpty())
+            xmlWriter.writeDefaultNamespace(declaration.namespaceUri().toString());
+        else
+            xmlWriter.writeNamespace(declaration.namespaceUri().toString(), declaration.prefix().toString());
+    }
+}
+
+
 void UBSvgSubsetAdaptor::setSceneUuid(UBDocumentProxy* proxy, const int pageIndex, QUuid pUuid)
 {
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg",pageIndex);
+    QString documentPath = proxy->persistencePath();
+    QString fileName = UBPageManifest::pageSvgPath(documentPath, pageIndex);
 
     QFile file(fileName);
 
     if (!file.exists() || !file.open(QIODevice::ReadOnly))
         return;
 
-    QTextStream textReadStream(&file);
-    QString xmlContent = textReadStream.readAll();
-    int uuidIndex = xmlContent.indexOf("uuid");
-    if (-1 == uuidIndex)
+    QByteArray svgData = file.readAll();
+    file.close();
+
+    // the stroke file is named after the page uuid, the page gets a copy of its own
+    QString sidecarFileName = strokeSidecarFileName(fileName);
+    QString newSidecarFileName = UBStrokeSidecar::relativePath(pUuid);
+
+    if (!sidecarFileName.isEmpty())
     {
-        qWarning() << "Cannot read UUID from file" << fileName << "to set new UUID";
-        file.close();
-        return;
+        QFile::remove(documentPath + "/" + newSidecarFileName);
+
+        if (!QFile::copy(documentPath + "/" + sidecarFileName, documentPath + "/" + newSidecarFileName))
+        {
+            // the page must not keep pointing at the stroke file of the page it was copied from
+            qWarning() << "Cannot copy the stroke file" << sidecarFileName << "of" << fileName << ", its points are written in the page";
+            svgData = inlineStrokeSidecar(documentPath, svgData);
+        }
     }
-    int quoteStartIndex = xmlContent.indexOf('"', uuidIndex);
-    if (-1 == quoteStartIndex)
+
+    QXmlStreamReader xmlReader(svgData);
+
+    QByteArray newSvgData;
+    QXmlStreamWriter xmlWriter(&newSvgData);
+
+    bool uuidWritten = false;
+    bool rootWritten = false;
+
+    while (!xmlReader.atEnd())
     {
-        qWarning() << "Cannot read UUID from file" << fileName << "to set new UUID";
-        file.close();
-        return;
+        xmlReader.readNext();
+
+        if (rootWritten || !xmlReader.isStartElement())
+        {
+            xmlWriter.writeCurrentToken(xmlReader);
+            continue;
+        }
+
+        writeNamespaceDeclarations(xmlReader, xmlWriter);
+        xmlWriter.writeStartElement(xmlReader.namespaceUri().toString(), xmlReader.name().toString());
+
+        foreach (const QXmlStreamAttribute& attribute, xmlReader.attributes())
+        {
+            if (!uuidWritten && attribute.name() == aUuid)
+            {
+                xmlWriter.writeAttribute(QXmlStreamAttribute(attribute.namespaceUri().toString(), aUuid, UBStringUtils::toCanonicalUuid(pUuid)));
+                uuidWritten = true;
+            }
+            else if (attribute.namespaceUri() == UBSettings::uniboardDocumentNamespaceUri && attribute.name() == aStrokes)
+            {
+                xmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, aStrokes, newSidecarFileName);
+            }
+            else
+            {
+                xmlWriter.writeAttribute(attribute);
+            }
+        }
+
+        rootWritten = true;
     }
-    int quoteEndIndex = xmlContent.indexOf('"', quoteStartIndex + 1);
-    if (-1 == quoteEndIndex)
+
+    if (xmlReader.hasError() || !uuidWritten)
     {
         qWarning() << "Cannot read UUID from file" << fileName << "to set new UUID";
-        file.close();
         return;
     }
 
-    file.close();
-
-    QString newXmlContent = xmlContent.left(quoteStartIndex + 1);
-    newXmlContent.append(UBStringUtils::toCanonicalUuid(pUuid));
-    newXmlContent.append(xmlContent.right(xmlContent.length() - quoteEndIndex));
-
     if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
     {
-        QTextStream textWriteStream(&file);
-        textWriteStream << newXmlContent;
+        file.write(newSvgData);
         file.close();
     }
     else
@@ -245,7 +571,7 @@ QString UBSvgSubsetAdaptor::uniboardDocumentNamespaceUriFromVersion(int mFileVer
 UBGraphicsScene* UBSvgSubsetAdaptor::loadScene(UBDocumentProxy* proxy, const int pageIndex)
 {
     UBApplication::showMessage(QObject::tr("Loading scene (%1/%2)").arg(pageIndex+1).arg(proxy->pageCount()));
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex);
+    QString fileName = UBPageManifest::pageSvgPath(proxy->persistencePath(), pageIndex);
     qDebug() << fileName;
     QFile file(fileName);
 
@@ -270,7 +596,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::loadScene(UBDocumentProxy* proxy, const int
 
 QByteArray UBSvgSubsetAdaptor::loadSceneAsText(UBDocumentProxy* proxy, const int pageIndex)
 {
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex);
+    QString fileName = UBPageManifest::pageSvgPath(proxy->persistencePath(), pageIndex);
     qDebug() << fileName;
     QFile file(fileName);
 
@@ -293,7 +619,7 @@ QByteArray UBSvgSubsetAdaptor::loadSceneAsText(UBDocumentProxy* proxy, const int
 
 QUuid UBSvgSubsetAdaptor::sceneUuid(UBDocumentProxy* proxy, const int pageIndex)
 {
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex);
+    QString fileName = UBPageManifest::pageSvgPath(proxy->persistencePath(), pageIndex);
 
     QFile file(fileName);
 
@@ -317,7 +643,7 @@ QUuid UBSvgSubsetAdaptor::sceneUuid(UBDocumentProxy* proxy, const int pageIndex)
 
             if (xml.isStartElement())
             {
-                if (xml.name() == "svg")
+                if (xml.name() == tSvg)
                 {
                     QStringRef svgSceneUuid = xml.attributes().value(UBSettings::uniboardDocumentNamespaceUri, "uuid");
                     if (svgSceneUuid.isNull())
@@ -344,8 +670,82 @@ UBGraphicsScene* UBSvgSubsetAdaptor::loadScene(UBDocumentProxy* proxy, const QBy
     return reader.loadScene(proxy);
 }
 
-UBSvgSubsetAdaptor::UBSvgSubsetReader::UBSvgSubsetReader(UBDocumentProxy* pProxy, const QByteArray& pXmlData)
+UBSvgPreparedScene UBSvgSubsetAdaptor::prepareScene(UBDocumentProxy* proxy, const int pageIndex)
+{
+    return prepareScene(proxy->persistencePath(), pageIndex);
+}
+
+UBSvgPreparedScene UBSvgSubsetAdaptor::prepareScene(const QString& documentPath, const int pageIndex)
+{
+    UBSvgPreparedScene preparedScene;
+
+    QFile file(UBPageManifest::pageSvgPath(documentPath, pageIndex));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return preparedScene;
+
+    QByteArray text = file.readAll();
+    file.close();
+
+    if (text.isEmpty())
+        return preparedScene;
+
+    preparedScene.xmlData = UBTextTools::cleanHtmlCData(QString(text)).toUtf8();
+
+    // stroke point lists are by far the largest part of a page, parse them here so that
+    // only the items themselves are left to build on the GUI thread
+    QXmlStreamReader xmlReader(preparedScene.xmlData);
+    QVector<QPolygonF> sidecarStrokes;
+
+    while (!xmlReader.atEnd())
+    {
+        xmlReader.readNext();
+
+        if (!xmlReader.isStartElement())
+            continue;
+
+        if (xmlReader.name() == tSvg)
+        {
+            QStringRef ubStrokes = xmlReader.attributes().value(UBSettings::uniboardDocumentNamespaceUri, aStrokes);
+
+            if (!ubStrokes.isNull())
+                sidecarStrokes = UBStrokeSidecar::read(documentPath + "/" + UBFileSystemUtils::normalizeFilePath(ubStrokes.toString()));
+        }
+        else if (xmlReader.name() == tPolygon || xmlReader.name() == tPolyline)
+        {
+            QStringRef ubPointsIndex = xmlReader.attributes().value(UBSettings::uniboardDocumentNamespaceUri, aPointsIndex);
+            QStringRef svgPoints = xmlReader.attributes().value(aPoints);
+
+            int index = ubPointsIndex.isNull() ? -1 : ubPointsIndex.toInt();
+
+            if (index >= 0 && index < sidecarStrokes.size())
+            {
+                preparedScene.points.insert(xmlReader.characterOffset(), sidecarStrokes.at(index));
+            }
+            // without its stroke file, the page still holds the points at a lower precision
+            else if (!svgPoints.isNull())
+            {
+                preparedScene.points.insert(xmlReader.characterOffset(), fromSvgPoints(svgPoints));
+            }
+        }
+    }
+
+    if (xmlReader.hasError())
+        qWarning() << "error while preparing scene" << pageIndex << ":" << xmlReader.errorString();
+
+    return preparedScene;
+}
+
+
+UBGraphicsScene* UBSvgSubsetAdaptor::loadScene(UBDocumentProxy* proxy, const UBSvgPreparedScene& preparedScene)
+{
+    UBSvgSubsetReader reader(proxy, preparedScene.xmlData, &preparedScene.points);
+    return reader.loadScene(proxy);
+}
+
+UBSvgSubsetAdaptor::UBSvgSubsetReader::UBSvgSubsetReader(UBDocumentProxy* pProxy, const QByteArray& pXmlData, const QHash<qint64, QPolygonF>* pPreparedPoints)
     : mXmlReader(pXmlData)
+    , mPreparedPoints(pPreparedPoints)
     , mProxy(pProxy)
     , mDocumentPath(pProxy->persistencePath())
     , mGroupHasInfo(false)
@@ -369,12 +769,33 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
     UBGraphicsStrokesGroup* strokesGroup = 0;
     UBGraphicsStroke* currentStroke = 0;
 
+#ifndef QT_NO_DEBUG
+    QElapsedTimer elementTime;
+    QString profiledElement;
+    QMap<QString, UBSvgParseStatistic> parseStatistics;
+#endif
+
     while (!mXmlReader.atEnd())
     {
+#ifndef QT_NO_DEBUG
+        if (!profiledElement.isEmpty())
+        {
+            UBSvgParseStatistic& statistic = parseStatistics[profiledElement];
+            statistic.count++;
+            statistic.nsecs += elementTime.nsecsElapsed();
+            profiledElement.clear();
+        }
+#endif
+
         mXmlReader.readNext();
         if (mXmlReader.isStartElement())
         {
-            if (mXmlReader.name() == "svg")
+#ifndef QT_NO_DEBUG
+            profiledElement = mXmlReader.name().toString();
+            elementTime.start();
+#endif
+
+            if (mXmlReader.name() == tSvg)
             {
                 if (!mScene)
                 {
@@ -412,14 +833,16 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
 
                 mNamespaceUri = uniboardDocumentNamespaceUriFromVersion(mFileVersion);
 
-                QStringRef svgSceneUuid = mXmlReader.attributes().value(mNamespaceUri, "uuid");
+                QStringRef svgSceneUuid = mXmlReader.attributes().value(mNamespaceUri, aUuid);
 
                 if (!svgSceneUuid.isNull())
                     mScene->setUuid(QUuid(svgSceneUuid.toString()));
 
+                readStrokeSidecar();
+
                 // introduced in UB 4.0
 
-                QStringRef svgViewBox = mXmlReader.attributes().value("viewBox");
+                QStringRef svgViewBox = mXmlReader.attributes().value(aViewBox);
 
 
                 if (!svgViewBox.isNull())
@@ -442,7 +865,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     }
                 }
 
-                QStringRef pageDpi = mXmlReader.attributes().value("pageDpi");
+                QStringRef pageDpi = mXmlReader.attributes().value(aPageDpi);
 
                 if (!pageDpi.isNull())
                     proxy->setPageDpi(pageDpi.toInt());
@@ -456,17 +879,17 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                 bool crossedBackground = false;
                 bool ruledBackground = false;
 
-                QStringRef ubDarkBackground = mXmlReader.attributes().value(mNamespaceUri, "dark-background");
+                QStringRef ubDarkBackground = mXmlReader.attributes().value(mNamespaceUri, aDarkBackground);
 
                 if (!ubDarkBackground.isNull())
                     darkBackground = (ubDarkBackground.toString() == xmlTrue);
 
-                QStringRef ubCrossedBackground = mXmlReader.attributes().value(mNamespaceUri, "crossed-background");
+                QStringRef ubCrossedBackground = mXmlReader.attributes().value(mNamespaceUri, aCrossedBackground);
 
                 if (!ubCrossedBackground.isNull())
                     crossedBackground = (ubCrossedBackground.toString() == xmlTrue);
 
-                QStringRef ubGridSize = mXmlReader.attributes().value(mNamespaceUri, "grid-size");
+                QStringRef ubGridSize = mXmlReader.attributes().value(mNamespaceUri, aGridSize);
 
                 if (!ubGridSize.isNull()) {
                     int gridSize = ubGridSize.toInt();
@@ -476,7 +899,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
 
                 if (crossedBackground) {
 
-                    QStringRef ubIntermediateLines = mXmlReader.attributes().value(mNamespaceUri, "intermediate-lines");
+                    QStringRef ubIntermediateLines = mXmlReader.attributes().value(mNamespaceUri, aIntermediateLines);
 
                     if (!ubIntermediateLines.isNull()) {
                         bool intermediateLines = ubIntermediateLines.toInt();
@@ -485,14 +908,14 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     }
                 }
 
-                QStringRef ubRuledBackground = mXmlReader.attributes().value(mNamespaceUri, "ruled-background");
+                QStringRef ubRuledBackground = mXmlReader.attributes().value(mNamespaceUri, aRuledBackground);
 
                 if (!ubRuledBackground.isNull())
                     ruledBackground = (ubRuledBackground.toString() == xmlTrue);
 
                 if (ruledBackground && !crossedBackground) { // if for some reason both are true, the background will be a grid
 
-                    QStringRef ubIntermediateLines = mXmlReader.attributes().value(mNamespaceUri, "intermediate-lines");
+                    QStringRef ubIntermediateLines = mXmlReader.attributes().value(mNamespaceUri, aIntermediateLines);
 
                     if (!ubIntermediateLines.isNull()) {
                         bool intermediateLines = ubIntermediateLines.toInt();
@@ -511,7 +934,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
 
                 mScene->setBackground(darkBackground, bg);
 
-                QStringRef pageNominalSize = mXmlReader.attributes().value(mNamespaceUri, "nominal-size");
+                QStringRef pageNominalSize = mXmlReader.attributes().value(mNamespaceUri, aNominalSize);
                 if (!pageNominalSize.isNull())
                 {
                     QStringList ts = pageNominalSize.toString().split(QLatin1Char('x'), QString::SkipEmptyParts);
@@ -531,34 +954,34 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
 
                 }
             }
-            else if (mXmlReader.name() == "g")
+            else if (mXmlReader.name() == tSvgGroup)
             {
                 strokesGroup = new UBGraphicsStrokesGroup();
                 graphicsItemFromSvg(strokesGroup);
 
-                QStringRef ubZValue = mXmlReader.attributes().value(mNamespaceUri, "z-value");
+                QStringRef ubZValue = mXmlReader.attributes().value(mNamespaceUri, aZValue);
 
                 if (!ubZValue.isNull())
                 {
-                    mGroupZIndex = ubZValue.toString().toFloat();
+                    mGroupZIndex = ubZValue.toFloat();
                     mGroupHasInfo = true;
                 }
 
-                QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-dark-background");
+                QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnDarkBackground);
 
                 if (!ubFillOnDarkBackground.isNull())
                 {
                     mGroupDarkBackgroundColor.setNamedColor(ubFillOnDarkBackground.toString());
                 }
 
-                QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-light-background");
+                QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnLightBackground);
 
                 if (!ubFillOnLightBackground.isNull())
                 {
                     mGroupLightBackgroundColor.setNamedColor(ubFillOnLightBackground.toString());
                 }
 
-                QStringRef ubUuid = mXmlReader.attributes().value(mNamespaceUri, "uuid");
+                QStringRef ubUuid = mXmlReader.attributes().value(mNamespaceUri, aUuid);
 
                 if (!ubUuid.isNull())
                     strokesGroup->setUuid(ubUuid.toString());
@@ -570,15 +993,15 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                 if (!mStrokesList.contains(uuid_stripped))
                     mStrokesList.insert(uuid_stripped, strokesGroup);
             }
-            else if (mXmlReader.name() == "polygon" || mXmlReader.name() == "line")
+            else if (mXmlReader.name() == tPolygon || mXmlReader.name() == tLine)
             {
                 UBGraphicsPolygonItem* polygonItem = 0;
 
-                QString parentId = mXmlReader.attributes().value(mNamespaceUri, "parent").toString();
+                QString parentId = mXmlReader.attributes().value(mNamespaceUri, aParent).toString();
 
-                if (mXmlReader.name() == "polygon")
+                if (mXmlReader.name() == tPolygon)
                     polygonItem = polygonItemFromPolygonSvg(mScene->isDarkBackground() ? Qt::white : Qt::black);
-                else if (mXmlReader.name() == "line")
+                else if (mXmlReader.name() == tLine)
                     polygonItem = polygonItemFromLineSvg(mScene->isDarkBackground() ? Qt::white : Qt::black);
 
                 if(parentId.isEmpty() && strokesGroup)
@@ -615,11 +1038,11 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     group->addToGroup(polygonItem);
                 }
             }
-            else if (mXmlReader.name() == "polyline")
+            else if (mXmlReader.name() == tPolyline)
             {
                 QList<UBGraphicsPolygonItem*> polygonItems = polygonItemsFromPolylineSvg(mScene->isDarkBackground() ? Qt::white : Qt::black);
 
-                QString parentId = mXmlReader.attributes().value(mNamespaceUri, "parent").toString();
+                QString parentId = mXmlReader.attributes().value(mNamespaceUri, aParent).toString();
 
                 if(parentId.isEmpty() && strokesGroup)
                     parentId = strokesGroup->uuid().toString();
@@ -657,15 +1080,15 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                 }
 
             }
-            else if (mXmlReader.name() == "image")
+            else if (mXmlReader.name() == tImage)
             {
-                QStringRef imageHref = mXmlReader.attributes().value(nsXLink, "href");
+                QStringRef imageHref = mXmlReader.attributes().value(nsXLink, aHref);
 
                 if (!imageHref.isNull())
                 {
                     QString href = imageHref.toString();
 
-                    QStringRef ubBackground = mXmlReader.attributes().value(mNamespaceUri, "background");
+                    QStringRef ubBackground = mXmlReader.attributes().value(mNamespaceUri, aBackground);
 
                     bool isBackground = (!ubBackground.isNull() && ubBackground.toString() == xmlTrue);
 
@@ -708,7 +1131,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     }
                 }
             }
-            else if (mXmlReader.name() == "audio")
+            else if (mXmlReader.name() == tAudio)
             {
                 UBGraphicsMediaItem* audioItem = audioItemFromSvg();
                 if (audioItem)
@@ -724,7 +1147,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     audioItem->pause();
                 }
             }
-            else if (mXmlReader.name() == "video")
+            else if (mXmlReader.name() == tVideo)
             {
                 UBGraphicsMediaItem* videoItem = videoItemFromSvg();
                 if (videoItem)
@@ -738,7 +1161,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     videoItem->show();
                 }
             }
-            else if (mXmlReader.name() == "text")//This is for backward compatibility with proto text field prior to version 4.3
+            else if (mXmlReader.name() == tText)//This is for backward compatibility with proto text field prior to version 4.3
             {
                 UBGraphicsTextItem* textItem = textItemFromSvg();
                 if (textItem)
@@ -751,7 +1174,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     textItem->show();
                 }
             }
-            else if (mXmlReader.name() == "curtain")
+            else if (mXmlReader.name() == tCurtain)
             {
                 UBGraphicsCurtainItem* mask = curtainItemFromSvg();
                 if (mask)
@@ -760,7 +1183,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     mScene->registerTool(mask);
                 }
             }
-            else if (mXmlReader.name() == "ruler")
+            else if (mXmlReader.name() == tRuler)
             {
 
                 UBGraphicsRuler *ruler = rulerFromSvg();
@@ -771,7 +1194,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                 }
 
             }
-            else if (mXmlReader.name() == "axes")
+            else if (mXmlReader.name() == tAxes)
             {
 
                 UBGraphicsAxes *axes = axesFromSvg();
@@ -782,7 +1205,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                 }
 
             }
-            else if (mXmlReader.name() == "compass")
+            else if (mXmlReader.name() == tCompass)
             {
                 UBGraphicsCompass *compass = compassFromSvg();
                 if (compass)
@@ -791,7 +1214,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     mScene->registerTool(compass);
                 }
             }
-            else if (mXmlReader.name() == "protractor")
+            else if (mXmlReader.name() == tProtractor)
             {
                 UBGraphicsProtractor *protractor = protractorFromSvg();
                 if (protractor)
@@ -800,7 +1223,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     mScene->registerTool(protractor);
                 }
             }
-            else if (mXmlReader.name() == "triangle")
+            else if (mXmlReader.name() == tTriangle)
             {
                 UBGraphicsTriangle *triangle = triangleFromSvg();
                 if (triangle)
@@ -809,7 +1232,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     mScene->registerTool(triangle);
                 }
             }
-            else if (mXmlReader.name() == "cache")
+            else if (mXmlReader.name() == tCache)
             {
                 UBGraphicsCache* cache = cacheFromSvg();
                 if(cache)
@@ -819,15 +1242,15 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     UBApplication::boardController->notifyCache(true);
                 }
             }
-            else if (mXmlReader.name() == "foreignObject")
+            else if (mXmlReader.name() == tForeignObject)
             {
-                QString href = mXmlReader.attributes().value(nsXLink, "href").toString();
-                QString src = mXmlReader.attributes().value(mNamespaceUri, "src").toString();
-                QString type = mXmlReader.attributes().value(mNamespaceUri, "type").toString();
-                bool isBackground = mXmlReader.attributes().value(mNamespaceUri, "background").toString() == xmlTrue;
+                QString href = mXmlReader.attributes().value(nsXLink, aHref).toString();
+                QString src = mXmlReader.attributes().value(mNamespaceUri, aSrc).toString();
+                QString type = mXmlReader.attributes().value(mNamespaceUri, aType).toString();
+                bool isBackground = mXmlReader.attributes().value(mNamespaceUri, aBackground).toString() == xmlTrue;
 
-                qreal foreignObjectWidth = mXmlReader.attributes().value("width").toString().toFloat();
-                qreal foreignObjectHeight = mXmlReader.attributes().value("height").toString().toFloat();
+                qreal foreignObjectWidth = mXmlReader.attributes().value(aWidth).toFloat();
+                qreal foreignObjectHeight = mXmlReader.attributes().value(aHeight).toFloat();
 
                 if (href.contains(".pdf"))
                 {
@@ -928,17 +1351,17 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
                     qWarning() << "Ignoring unknown foreignObject:" << href;
                 }
             }
-            else if (currentWidget && (mXmlReader.name() == "preference"))
+            else if (currentWidget && (mXmlReader.name() == tPreference))
             {
-                QString key = mXmlReader.attributes().value("key").toString();
-                QString value = mXmlReader.attributes().value("value").toString();
+                QString key = mXmlReader.attributes().value(aKey).toString();
+                QString value = mXmlReader.attributes().value(aValue).toString();
 
                 currentWidget->setPreference(key, value);
             }
-            else if (currentWidget && (mXmlReader.name() == "datastoreEntry"))
+            else if (currentWidget && (mXmlReader.name() == tDatastoreEntry))
             {
-                QString key = mXmlReader.attributes().value("key").toString();
-                QString value = mXmlReader.attributes().value("value").toString();
+                QString key = mXmlReader.attributes().value(aKey).toString();
+                QString value = mXmlReader.attributes().value(aValue).toString();
 
                 currentWidget->setDatastoreEntry(key, value);
             } else if (mXmlReader.name() == tGroups) {
@@ -952,7 +1375,7 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
         }
         else if (mXmlReader.isEndElement())
         {
-            if (mXmlReader.name() == "g")
+            if (mXmlReader.name() == tSvgGroup)
             {
                 mGroupHasInfo = false;
                 mGroupDarkBackgroundColor = QColor();
@@ -963,6 +1386,18 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene(UBDocumentProx
         }
     }
 
+#ifndef QT_NO_DEBUG
+    {
+        QMapIterator<QString, UBSvgParseStatistic> it(parseStatistics);
+        while (it.hasNext())
+        {
+            it.next();
+            UBSvgParseStatistic& statistic = sParseStatistics[it.key()];
+            statistic.count += it.value().count;
+            statistic.nsecs += it.value().nsecs;
+        }
+    }
+#endif
 
     if (mXmlReader.hasError())
     {
@@ -998,14 +1433,14 @@ UBGraphicsGroupContainerItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::readGroup()
     if(mStrokesList.contains(id))
         shouldSkipSubElements = true;
 
-    QString ubLocked = mXmlReader.attributes().value(mNamespaceUri, "locked").toString();
+    QString ubLocked = mXmlReader.attributes().value(mNamespaceUri, aLocked).toString();
     if (!ubLocked.isEmpty())
     {
         bool isLocked = ubLocked.contains(xmlTrue);
         group->setData(UBGraphicsItemData::ItemLocked, QVariant(isLocked));
     }
 
-    QStringRef ubLayer = mXmlReader.attributes().value(mNamespaceUri, "layer");
+    QStringRef ubLayer = mXmlReader.attributes().value(mNamespaceUri, aLayer);
     if (!ubLayer.isNull())
     {
         bool ok;
@@ -1111,12 +1546,48 @@ void UBSvgSubsetAdaptor::persistScene(UBDocumentProxy* proxy, UBGraphicsScene* p
     writer.persistScene(proxy, pageIndex);
 }
 
+UBSvgSerializedScene UBSvgSubsetAdaptor::serializeScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex)
+{
+    UBSvgSubsetWriter writer(proxy, pScene, pageIndex);
+    return writer.serializeScene(proxy);
+}
+
+bool UBSvgSubsetAdaptor::writeScene(UBDocumentProxy* proxy, const int pageIndex, const UBSvgSerializedScene& serializedScene)
+{
+    return writeScene(proxy, UBPageManifest::pageSvgPath(proxy->persistencePath(), pageIndex), serializedScene);
+}
+
+bool UBSvgSubsetAdaptor::writeScene(UBDocumentProxy* proxy, const QString& fileName, const UBSvgSerializedScene& serializedScene)
+{
+    QString documentPath = proxy->persistencePath();
+
+    // the sidecar goes first so that the page never refers to points that are not on disk yet
+    if (!serializedScene.sidecarFileName.isEmpty()
+            && !UBStrokeSidecar::write(documentPath + "/" + serializedScene.sidecarFileName, serializedScene.sidecarStrokes))
+    {
+        return false;
+    }
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCritical() << "cannot open " << fileName << " for writing ...";
+        return false;
+    }
+    file.write(serializedScene.svgData);
+    file.flush();
+    file.close();
+
+    return true;
+}
+
 
 UBSvgSubsetAdaptor::UBSvgSubsetWriter::UBSvgSubsetWriter(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex)
     : mScene(pScene)
     , mDocumentPath(proxy->persistencePath())
     , mPageIndex(pageIndex)
-
+    , mUseStrokeSidecar(UBSettings::settings()->useStrokeSidecar->get().toBool())
 {
     // NOOP
 }
@@ -1130,6 +1601,9 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::writeSvgElement(UBDocumentProxy* pro
     mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "version", UBSettings::currentFileVersion);
     mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "uuid", UBStringUtils::toCanonicalUuid(mScene->uuid()));
 
+    if (mUseStrokeSidecar)
+        mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "strokes", UBStrokeSidecar::relativePath(mScene->uuid()));
+
     int margin = UBSettings::settings()->svgViewBoxMargin->get().toInt();
     QRect normalized = mScene->normalizedSceneRect().toRect();
     normalized.translate(margin * -1, margin * -1);
@@ -1178,8 +1652,11 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::writeSvgElement(UBDocumentProxy* pro
 
 bool UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistScene(UBDocumentProxy* proxy, int pageIndex)
 {
-    Q_UNUSED(pageIndex);
+    return writeScene(proxy, pageIndex, serializeScene(proxy));
+}
 
+UBSvgSerializedScene UBSvgSubsetAdaptor::UBSvgSubsetWriter::serializeScene(UBDocumentProxy* proxy)
+{
     //Creating dom structure to store information
     QDomDocument groupDomDocument;
     QDomElement groupRoot = groupDomDocument.createElement(tGroups);
@@ -1270,8 +1747,15 @@ bool UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistScene(UBDocumentProxy* proxy,
 
                 if (stroke && !stroke->hasPressure())
                 {
+                    // the polyline is made of all the polygons of the stroke
+                    int context = (stroke->polygons().size() << 1) | (groupHoldsInfo ? 1 : 0);
+                    qint64 fragmentStart;
 
-                    strokeToSvgPolyline(stroke, groupHoldsInfo);
+                    if (!writeCachedFragment(polygonItem, context, fragmentStart))
+                    {
+                        strokeToSvgPolyline(stroke, groupHoldsInfo);
+                        cacheFragment(polygonItem, context, fragmentStart);
+                    }
 
                     //we can dequeue all polygons belonging to that stroke
                     foreach(UBGraphicsPolygonItem* gi, stroke->polygons())
@@ -1284,12 +1768,25 @@ bool UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistScene(UBDocumentProxy* proxy,
 
             UBGraphicsStroke* stroke = dynamic_cast<UBGraphicsStroke* >(currentStroke);
 
-            if (stroke && stroke->hasPressure())
-                polygonItemToSvgPolygon(polygonItem, groupHoldsInfo);
+            int context = groupHoldsInfo ? 1 : 0;
+            qint64 fragmentStart;
 
+            if (stroke && stroke->hasPressure())
+            {
+                if (!writeCachedFragment(polygonItem, context, fragmentStart))
+                {
+                    polygonItemToSvgPolygon(polygonItem, groupHoldsInfo);
+                    cacheFragment(polygonItem, context, fragmentStart);
+                }
+            }
             else if (polygonItem->isNominalLine())
-                polygonItemToSvgLine(polygonItem, groupHoldsInfo);
-
+            {
+                if (!writeCachedFragment(polygonItem, context, fragmentStart))
+                {
+                    polygonItemToSvgLine(polygonItem, groupHoldsInfo);
+                    cacheFragment(polygonItem, context, fragmentStart);
+                }
+            }
 
             continue;
         }
@@ -1301,130 +1798,23 @@ bool UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistScene(UBDocumentProxy* proxy,
             openStroke = 0;
         }
 
-        // Is the item a picture?
-        UBGraphicsPixmapItem *pixmapItem = qgraphicsitem_cast<UBGraphicsPixmapItem*> (item);
-        if (pixmapItem && pixmapItem->isVisible())
-        {
-            pixmapItemToLinkedImage(pixmapItem);
-            continue;
-        }
-
-        // Is the item a shape?
-        UBGraphicsSvgItem *svgItem = qgraphicsitem_cast<UBGraphicsSvgItem*> (item);
-        if (svgItem && svgItem->isVisible())
-        {
-            svgItemToLinkedSvg(svgItem);
-            continue;
-        }
-
-        UBGraphicsVideoItem * videoItem = qgraphicsitem_cast<UBGraphicsVideoItem*> (item);
-
-        if (videoItem && videoItem->isVisible()) {
-            videoItemToLinkedVideo(videoItem);
-            continue;
-        }
-
-        UBGraphicsAudioItem * audioItem = qgraphicsitem_cast<UBGraphicsAudioItem*> (item);
-
-        if (audioItem && audioItem->isVisible()) {
-            audioItemToLinkedAudio(audioItem);
-            continue;
-        }
-
-        // Is the item an app? // NOTE @letsfindaway obsolete
-        UBGraphicsAppleWidgetItem *appleWidgetItem = qgraphicsitem_cast<UBGraphicsAppleWidgetItem*> (item);
-        if (appleWidgetItem && appleWidgetItem->isVisible())
-        {
-            graphicsAppleWidgetToSvg(appleWidgetItem);
-            continue;
-        }
-
-        // Is the item a W3C?
-        UBGraphicsW3CWidgetItem *w3cWidgetItem = qgraphicsitem_cast<UBGraphicsW3CWidgetItem*> (item);
-        if (w3cWidgetItem && w3cWidgetItem->isVisible())
-        {
-            graphicsW3CWidgetToSvg(w3cWidgetItem);
-            continue;
-        }
-
-        // Is the item a PDF?
-        UBGraphicsPDFItem *pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*> (item);
-        if (pdfItem && pdfItem->isVisible())
-        {
-            pdfItemToLinkedPDF(pdfItem);
-            continue;
-        }
-
-        // Is the item a text?
-        UBGraphicsTextItem *textItem = qgraphicsitem_cast<UBGraphicsTextItem*> (item);
-        if (textItem && textItem->isVisible())
-        {
-            textItemToSvg(textItem);
-            continue;
-        }
-
-        // Is the item a curtain?
-        UBGraphicsCurtainItem *curtainItem = qgraphicsitem_cast<UBGraphicsCurtainItem*> (item);
-        if (curtainItem && curtainItem->isVisible())
-        {
-            curtainItemToSvg(curtainItem);
-            continue;
-        }
-
-        // Is the item a ruler?
-        UBGraphicsRuler *ruler = qgraphicsitem_cast<UBGraphicsRuler*> (item);
-        if (ruler && ruler->isVisible())
-        {
-            rulerToSvg(ruler);
-            continue;
-        }
-
-        // Is the item a axes?
-        UBGraphicsAxes *axes = qgraphicsitem_cast<UBGraphicsAxes*> (item);
-        if (axes && axes->isVisible())
-        {
-            axesToSvg(axes);
-            continue;
-        }
-
-        // Is the item a cache?
-        UBGraphicsCache* cache = qgraphicsitem_cast<UBGraphicsCache*>(item);
-        if(cache && cache->isVisible())
+        // Is the item a group?
+        UBGraphicsGroupContainerItem *groupItem = qgraphicsitem_cast<UBGraphicsGroupContainerItem*>(item);
+        if (groupItem && groupItem->isVisible())
         {
-            cacheToSvg(cache);
+            persistGroupToDom(groupItem, &groupRoot, &groupDomDocument);
             continue;
         }
 
-        // Is the item a compass
-        UBGraphicsCompass *compass = qgraphicsitem_cast<UBGraphicsCompass*> (item);
-        if (compass && compass->isVisible())
-        {
-            compassToSvg(compass);
+        if (!item->isVisible())
             continue;
-        }
 
-        // Is the item a protractor?
-        UBGraphicsProtractor *protractor = qgraphicsitem_cast<UBGraphicsProtractor*> (item);
-        if (protractor && protractor->isVisible())
-        {
-            protractorToSvg(protractor);
-            continue;
-        }
+        qint64 fragmentStart;
 
-        // Is the item a triangle?
-        UBGraphicsTriangle *triangle = qgraphicsitem_cast<UBGraphicsTriangle*> (item);
-        if (triangle && triangle->isVisible())
+        if (!writeCachedFragment(item, 0, fragmentStart))
         {
-            triangleToSvg(triangle);
-            continue;
-        }
-
-        // Is the item a group?
-        UBGraphicsGroupContainerItem *groupItem = qgraphicsitem_cast<UBGraphicsGroupContainerItem*>(item);
-        if (groupItem && groupItem->isVisible())
-        {
-            persistGroupToDom(groupItem, &groupRoot, &groupDomDocument);
-            continue;
+            itemToSvg(item);
+            cacheFragment(item, 0, fragmentStart);
         }
     }
 
@@ -1467,21 +1857,180 @@ bool UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistScene(UBDocumentProxy* proxy,
     }
 
     mXmlWriter.writeEndDocument();
-    QString fileName = mDocumentPath + UBFileSystemUtils::digitFileFormat("/page%1.svg", mPageIndex);
-    QFile file(fileName);
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    UBSvgSerializedScene serializedScene;
+    serializedScene.svgData = buffer.data();
+
+    if (mUseStrokeSidecar)
     {
-        qCritical() << "cannot open " << fileName << " for writing ...";
-        return false;
+        serializedScene.sidecarFileName = UBStrokeSidecar::relativePath(mScene->uuid());
+        serializedScene.sidecarStrokes = mSidecarStrokes;
     }
-    file.write(buffer.data());
-    file.flush();
-    file.close();
+
+    return serializedScene;
+}
+
+bool UBSvgSubsetAdaptor::UBSvgSubsetWriter::writeCachedFragment(QGraphicsItem* item, int context, qint64& fragmentStart)
+{
+    fragmentStart = -1;
+
+    // widgets and pdfs store files next to the page while being written, media items
+    // write their playback position, that changes without the item being modified, and
+    // strokes in the sidecar refer to the point lists of the current save
+    bool cacheable = !UBGraphicsScene::getPersonalUuid(item).isNull()
+            && item->type() != UBGraphicsWidgetItem::Type
+            && item->type() != UBGraphicsPDFItem::Type
+            && item->type() != UBGraphicsMediaItem::Type
+            && item->type() != UBGraphicsAudioItem::Type
+            && item->type() != UBGraphicsVideoItem::Type
+            && !(mUseStrokeSidecar && item->type() == UBGraphicsPolygonItem::Type);
+
+    if (!cacheable)
+        return false;
+
+    // closes a pending start tag, so that the fragment does not depend on what was written before it
+    mXmlWriter.writeCharacters("\n");
+    fragmentStart = mXmlWriter.device()->pos();
+
+    QByteArray fragment = mScene->persistedFragment(item, context);
+
+    if (fragment.isEmpty())
+        return false;
+
+    mXmlWriter.device()->write(fragment);
 
     return true;
 }
 
+void UBSvgSubsetAdaptor::UBSvgSubsetWriter::cacheFragment(QGraphicsItem* item, int context, qint64 fragmentStart)
+{
+    QBuffer* buffer = qobject_cast<QBuffer*>(mXmlWriter.device());
+
+    if (fragmentStart >= 0 && buffer)
+        mScene->setPersistedFragment(item, context, buffer->data().mid(fragmentStart));
+}
+
+void UBSvgSubsetAdaptor::UBSvgSubsetWriter::itemToSvg(QGraphicsItem* item)
+{
+    // Is the item a picture?
+    UBGraphicsPixmapItem *pixmapItem = qgraphicsitem_cast<UBGraphicsPixmapItem*> (item);
+    if (pixmapItem)
+    {
+        pixmapItemToLinkedImage(pixmapItem);
+        return;
+    }
+
+    // Is the item a shape?
+    UBGraphicsSvgItem *svgItem = qgraphicsitem_cast<UBGraphicsSvgItem*> (item);
+    if (svgItem)
+    {
+        svgItemToLinkedSvg(svgItem);
+        return;
+    }
+
+    UBGraphicsVideoItem * videoItem = qgraphicsitem_cast<UBGraphicsVideoItem*> (item);
+
+    if (videoItem) {
+        videoItemToLinkedVideo(videoItem);
+        return;
+    }
+
+    UBGraphicsAudioItem * audioItem = qgraphicsitem_cast<UBGraphicsAudioItem*> (item);
+
+    if (audioItem) {
+        audioItemToLinkedAudio(audioItem);
+        return;
+    }
+
+    // Is the item an app? // NOTE @letsfindaway obsolete
+    UBGraphicsAppleWidgetItem *appleWidgetItem = qgraphicsitem_cast<UBGraphicsAppleWidgetItem*> (item);
+    if (appleWidgetItem)
+    {
+        graphicsAppleWidgetToSvg(appleWidgetItem);
+        return;
+    }
+
+    // Is the item a W3C?
+    UBGraphicsW3CWidgetItem *w3cWidgetItem = qgraphicsitem_cast<UBGraphicsW3CWidgetItem*> (item);
+    if (w3cWidgetItem)
+    {
+        graphicsW3CWidgetToSvg(w3cWidgetItem);
+        return;
+    }
+
+    // Is the item a PDF?
+    UBGraphicsPDFItem *pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*> (item);
+    if (pdfItem)
+    {
+        pdfItemToLinkedPDF(pdfItem);
+        return;
+    }
+
+    // Is the item a text?
+    UBGraphicsTextItem *textItem = qgraphicsitem_cast<UBGraphicsTextItem*> (item);
+    if (textItem)
+    {
+        textItemToSvg(textItem);
+        return;
+    }
+
+    // Is the item a curtain?
+    UBGraphicsCurtainItem *curtainItem = qgraphicsitem_cast<UBGraphicsCurtainItem*> (item);
+    if (curtainItem)
+    {
+        curtainItemToSvg(curtainItem);
+        return;
+    }
+
+    // Is the item a ruler?
+    UBGraphicsRuler *ruler = qgraphicsitem_cast<UBGraphicsRuler*> (item);
+    if (ruler)
+    {
+        rulerToSvg(ruler);
+        return;
+    }
+
+    // Is the item a axes?
+    UBGraphicsAxes *axes = qgraphicsitem_cast<UBGraphicsAxes*> (item);
+    if (axes)
+    {
+        axesToSvg(axes);
+        return;
+    }
+
+    // Is the item a cache?
+    UBGraphicsCache* cache = qgraphicsitem_cast<UBGraphicsCache*>(item);
+    if(cache)
+    {
+        cacheToSvg(cache);
+        return;
+    }
+
+    // Is the item a compass
+    UBGraphicsCompass *compass = qgraphicsitem_cast<UBGraphicsCompass*> (item);
+    if (compass)
+    {
+        compassToSvg(compass);
+        return;
+    }
+
+    // Is the item a protractor?
+    UBGraphicsProtractor *protractor = qgraphicsitem_cast<UBGraphicsProtractor*> (item);
+    if (protractor)
+    {
+        protractorToSvg(protractor);
+        return;
+    }
+
+    // Is the item a triangle?
+    UBGraphicsTriangle *triangle = qgraphicsitem_cast<UBGraphicsTriangle*> (item);
+    if (triangle)
+    {
+        triangleToSvg(triangle);
+        return;
+    }
+}
+
 void UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistGroupToDom(QGraphicsItem *groupItem, QDomElement *curParent, QDomDocument *groupDomDocument)
 {
     QUuid uuid = UBGraphicsScene::getPersonalUuid(groupItem);
@@ -1513,6 +2062,21 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistGroupToDom(QGraphicsItem *gro
     }
 }
 
+void UBSvgSubsetAdaptor::UBSvgSubsetWriter::writePointsAttribute(QVector<QPointF> points)
+{
+    if (mUseStrokeSidecar)
+    {
+        UBGeometryUtils::crashPointList(points);
+
+        mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "points-index", QString::number(mSidecarStrokes.size()));
+        mSidecarStrokes << QPolygonF(points);
+    }
+    else
+    {
+        mXmlWriter.writeAttribute("points", pointsToSvgPointsAttribute(points));
+    }
+}
+
 void UBSvgSubsetAdaptor::UBSvgSubsetWriter::polygonItemToSvgLine(UBGraphicsPolygonItem* polygonItem, bool groupHoldsInfo)
 {
     mXmlWriter.writeStartElement("line");
@@ -1572,8 +2136,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::strokeToSvgPolyline(UBGraphicsStroke
             points[1] = QPointF(points[1].x() + 0.01, points[1].y());
         }
 
-        QString svgPoints = pointsToSvgPointsAttribute(points);
-        mXmlWriter.writeAttribute("points", svgPoints);
+        writePointsAttribute(points);
 
         UBGraphicsPolygonItem* firstPolygonItem = pols.at(0);
 
@@ -1635,8 +2198,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::polygonItemToSvgPolygon(UBGraphicsPo
     {
         mXmlWriter.writeStartElement("polygon");
 
-        QString points = pointsToSvgPointsAttribute(polygon);
-        mXmlWriter.writeAttribute("points", points);
+        writePointsAttribute(polygon);
         mXmlWriter.writeAttribute("transform",toSvgTransform(polygonItem->transform()));
         mXmlWriter.writeAttribute("fill", polygonItem->brush().color().name());
 
@@ -1682,72 +2244,68 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::polygonItemToSvgPolygon(UBGraphicsPo
 }
 
 
-UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromPolygonSvg(const QColor& pDefaultColor)
+QPolygonF UBSvgSubsetAdaptor::UBSvgSubsetReader::pointsFromSvg()
 {
-    UBGraphicsPolygonItem* polygonItem = new UBGraphicsPolygonItem();
-
-    graphicsItemFromSvg(polygonItem);
+    if (mPreparedPoints)
+    {
+        QHash<qint64, QPolygonF>::const_iterator it = mPreparedPoints->constFind(mXmlReader.characterOffset());
 
-    QStringRef svgPoints = mXmlReader.attributes().value("points");
+        if (it != mPreparedPoints->constEnd())
+            return it.value();
+    }
 
-    QPolygonF polygon;
+    QStringRef ubPointsIndex = mXmlReader.attributes().value(mNamespaceUri, aPointsIndex);
 
-    if (!svgPoints.isNull())
+    if (!ubPointsIndex.isNull())
     {
-        QStringList ts = svgPoints.toString().split(QLatin1Char(' '), QString::SkipEmptyParts);
+        int index = ubPointsIndex.toInt();
 
-        foreach(const QString sPoint, ts)
-        {
-            QStringList sCoord = sPoint.split(QLatin1Char(','), QString::SkipEmptyParts);
+        if (index >= 0 && index < mSidecarStrokes.size())
+            return mSidecarStrokes.at(index);
 
-            if (sCoord.size() == 2)
-            {
-                QPointF point;
-                point.setX(sCoord.at(0).toFloat());
-                point.setY(sCoord.at(1).toFloat());
-                polygon << point;
-            }
-            else if (sCoord.size() == 4){
-                //This is the case on system were the "," is used to seperate decimal
-                QPointF point;
-                QString x = sCoord.at(0) + "." + sCoord.at(1);
-                QString y = sCoord.at(2) + "." + sCoord.at(3);
-                point.setX(x.toFloat());
-                point.setY(y.toFloat());
-                polygon << point;
-            }
-            else
-            {
-                qWarning() << "cannot make sense of a 'point' value" << sCoord;
-            }
-        }
-    }
-    else
-    {
-        qWarning() << "cannot make sense of 'points' value " << svgPoints.toString();
+        qWarning() << "cannot find stroke" << index << "in the stroke file, using the points of the page";
     }
 
-    polygonItem->setPolygon(polygon);
+    return fromSvgPoints(mXmlReader.attributes().value(aPoints));
+}
+
+void UBSvgSubsetAdaptor::UBSvgSubsetReader::readStrokeSidecar()
+{
+    QStringRef ubStrokes = mXmlReader.attributes().value(mNamespaceUri, aStrokes);
+
+    // the prepared points already hold the sidecar content
+    if (!ubStrokes.isNull() && !mPreparedPoints)
+        mSidecarStrokes = UBStrokeSidecar::read(mDocumentPath + "/" + UBFileSystemUtils::normalizeFilePath(ubStrokes.toString()));
+}
 
-    QStringRef svgFill = mXmlReader.attributes().value("fill");
+
+UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromPolygonSvg(const QColor& pDefaultColor)
+{
+    UBGraphicsPolygonItem* polygonItem = new UBGraphicsPolygonItem();
+
+    graphicsItemFromSvg(polygonItem);
+
+    polygonItem->setPolygon(pointsFromSvg());
+
+    QStringRef svgFill = mXmlReader.attributes().value(aFill);
 
     QColor brushColor = pDefaultColor;
 
     if (!svgFill.isNull())
         brushColor.setNamedColor(svgFill.toString());
 
-    QStringRef svgFillOpacity = mXmlReader.attributes().value("fill-opacity");
+    QStringRef svgFillOpacity = mXmlReader.attributes().value(aFillOpacity);
     qreal opacity = 1.0;
 
     if (!svgFillOpacity.isNull())
     {
-        opacity = svgFillOpacity.toString().toFloat();
+        opacity = svgFillOpacity.toFloat();
         brushColor.setAlphaF(opacity);
     }
 
     polygonItem->setColor(brushColor);
 
-    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-dark-background");
+    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnDarkBackground);
 
     if (!ubFillOnDarkBackground.isNull())
     {
@@ -1766,7 +2324,7 @@ UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromPol
         polygonItem->setColorOnDarkBackground(color);
     }
 
-    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-light-background");
+    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnLightBackground);
 
     if (!ubFillOnLightBackground.isNull())
     {
@@ -1787,7 +2345,7 @@ UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromPol
     // Before OpenBoard v1.4, fill rule was only saved if it was "Even-odd". Therefore if no fill rule
     // is specified, we assume that it should be Winding fill.
 
-    QStringRef fillRule = mXmlReader.attributes().value("fill-rule");
+    QStringRef fillRule = mXmlReader.attributes().value(aFillRule);
 
     if (!fillRule.isNull() && fillRule.toString() == "evenodd")
         polygonItem->setFillRule(Qt::OddEvenFill);
@@ -1800,19 +2358,19 @@ UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromPol
 
 UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromLineSvg(const QColor& pDefaultColor)
 {
-    QStringRef svgX1 = mXmlReader.attributes().value("x1");
-    QStringRef svgY1 = mXmlReader.attributes().value("y1");
-    QStringRef svgX2 = mXmlReader.attributes().value("x2");
-    QStringRef svgY2 = mXmlReader.attributes().value("y2");
+    QStringRef svgX1 = mXmlReader.attributes().value(aX1);
+    QStringRef svgY1 = mXmlReader.attributes().value(aY1);
+    QStringRef svgX2 = mXmlReader.attributes().value(aX2);
+    QStringRef svgY2 = mXmlReader.attributes().value(aY2);
 
     QLineF line;
 
     if (!svgX1.isNull() && !svgY1.isNull() && !svgX2.isNull() && !svgY2.isNull())
     {
-        qreal x1 = svgX1.toString().toFloat();
-        qreal y1 = svgY1.toString().toFloat();
-        qreal x2 = svgX2.toString().toFloat();
-        qreal y2 = svgY2.toString().toFloat();
+        qreal x1 = svgX1.toFloat();
+        qreal y1 = svgY1.toFloat();
+        qreal x2 = svgX2.toFloat();
+        qreal y2 = svgY2.toFloat();
 
         line.setLine(x1, y1, x2, y2);
     }
@@ -1822,19 +2380,19 @@ UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromLin
         return 0;
     }
 
-    QStringRef strokeWidth = mXmlReader.attributes().value("stroke-width");
+    QStringRef strokeWidth = mXmlReader.attributes().value(aStrokeWidth);
 
     qreal lineWidth = 1.;
 
     if (!strokeWidth.isNull())
     {
-        lineWidth = strokeWidth.toString().toFloat();
+        lineWidth = strokeWidth.toFloat();
     }
 
     UBGraphicsPolygonItem* polygonItem = new UBGraphicsPolygonItem(line, lineWidth);
     graphicsItemFromSvg(polygonItem);
 
-    QStringRef svgStroke = mXmlReader.attributes().value("stroke");
+    QStringRef svgStroke = mXmlReader.attributes().value(aStroke);
 
     QColor brushColor = pDefaultColor;
 
@@ -1844,18 +2402,18 @@ UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromLin
 
     }
 
-    QStringRef svgStrokeOpacity = mXmlReader.attributes().value("stroke-opacity");
+    QStringRef svgStrokeOpacity = mXmlReader.attributes().value(aStrokeOpacity);
     qreal opacity = 1.0;
 
     if (!svgStrokeOpacity.isNull())
     {
-        opacity = svgStrokeOpacity.toString().toFloat();
+        opacity = svgStrokeOpacity.toFloat();
         brushColor.setAlphaF(opacity);
     }
 
     polygonItem->setColor(brushColor);
 
-    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-dark-background");
+    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnDarkBackground);
 
     if (!ubFillOnDarkBackground.isNull())
     {
@@ -1874,7 +2432,7 @@ UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromLin
         polygonItem->setColorOnDarkBackground(color);
     }
 
-    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-light-background");
+    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnLightBackground);
 
     if (!ubFillOnLightBackground.isNull())
     {
@@ -1897,18 +2455,18 @@ UBGraphicsPolygonItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemFromLin
 
 QList<UBGraphicsPolygonItem*> UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItemsFromPolylineSvg(const QColor& pDefaultColor)
 {
-    QStringRef strokeWidth = mXmlReader.attributes().value("stroke-width");
+    QStringRef strokeWidth = mXmlReader.attributes().value(aStrokeWidth);
 
     qreal lineWidth = 1.;
 
     if (!strokeWidth.isNull())
     {
-        lineWidth = strokeWidth.toString().toFloat();
+        lineWidth = strokeWidth.toFloat();
     }
 
     QColor brushColor = pDefaultColor;
 
-    QStringRef svgStroke = mXmlReader.attributes().value("stroke");
+    QStringRef svgStroke = mXmlReader.attributes().value(aStroke);
     if (!svgStroke.isNull())
     {
         brushColor.setNamedColor(svgStroke.toString());
@@ -1916,24 +2474,24 @@ QList<UBGraphicsPolygonItem*> UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItem
 
     qreal opacity = 1.0;
 
-    QStringRef svgStrokeOpacity = mXmlReader.attributes().value("stroke-opacity");
+    QStringRef svgStrokeOpacity = mXmlReader.attributes().value(aStrokeOpacity);
     if (!svgStrokeOpacity.isNull())
     {
-        opacity = svgStrokeOpacity.toString().toFloat();
+        opacity = svgStrokeOpacity.toFloat();
         brushColor.setAlphaF(opacity);
     }
 
-    QStringRef ubZValue = mXmlReader.attributes().value(mNamespaceUri, "z-value");
+    QStringRef ubZValue = mXmlReader.attributes().value(mNamespaceUri, aZValue);
 
     qreal zValue = mGroupZIndex;
     if (!ubZValue.isNull())
     {
-        zValue = ubZValue.toString().toFloat();
+        zValue = ubZValue.toFloat();
     }
 
     QColor colorOnDarkBackground = mGroupDarkBackgroundColor;
 
-    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-dark-background");
+    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnDarkBackground);
     if (!ubFillOnDarkBackground.isNull())
     {
         colorOnDarkBackground.setNamedColor(ubFillOnDarkBackground.toString());
@@ -1946,7 +2504,7 @@ QList<UBGraphicsPolygonItem*> UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItem
 
     QColor colorOnLightBackground = mGroupLightBackgroundColor;
 
-    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-light-background");
+    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnLightBackground);
     if (!ubFillOnLightBackground.isNull())
     {
         QColor colorOnLightBackground;
@@ -1958,57 +2516,19 @@ QList<UBGraphicsPolygonItem*> UBSvgSubsetAdaptor::UBSvgSubsetReader::polygonItem
 
     colorOnLightBackground.setAlphaF(opacity);
 
-    QStringRef svgPoints = mXmlReader.attributes().value("points");
-
     QList<UBGraphicsPolygonItem*> polygonItems;
 
-    if (!svgPoints.isNull())
-    {
-        QStringList ts = svgPoints.toString().split(QLatin1Char(' '),
-                                                    QString::SkipEmptyParts);
-
-        QList<QPointF> points;
+    QPolygonF points = pointsFromSvg();
 
-        foreach(const QString sPoint, ts)
-        {
-            QStringList sCoord = sPoint.split(QLatin1Char(','), QString::SkipEmptyParts);
-
-            if (sCoord.size() == 2)
-            {
-                QPointF point;
-                point.setX(sCoord.at(0).toFloat());
-                point.setY(sCoord.at(1).toFloat());
-                points << point;
-            }
-            else if (sCoord.size() == 4){
-                //This is the case on system were the "," is used to seperate decimal
-                QPointF point;
-                QString x = sCoord.at(0) + "." + sCoord.at(1);
-                QString y = sCoord.at(2) + "." + sCoord.at(3);
-                point.setX(x.toFloat());
-                point.setY(y.toFloat());
-                points << point;
-            }
-            else
-            {
-                qWarning() << "cannot make sense of a 'point' value" << sCoord;
-            }
-        }
-
-        for (int i = 0; i < points.size() - 1; i++)
-        {
-            UBGraphicsPolygonItem* polygonItem = new UBGraphicsPolygonItem(QLineF(points.at(i), points.at(i + 1)), lineWidth);
-            polygonItem->setColor(brushColor);
-            UBGraphicsItem::assignZValue(polygonItem, zValue);
-            polygonItem->setColorOnDarkBackground(colorOnDarkBackground);
-            polygonItem->setColorOnLightBackground(colorOnLightBackground);
-
-            polygonItems <<polygonItem;
-        }
-    }
-    else
+    for (int i = 0; i < points.size() - 1; i++)
     {
-        qWarning() << "cannot make sense of 'points' value " << svgPoints.toString();
+        UBGraphicsPolygonItem* polygonItem = new UBGraphicsPolygonItem(QLineF(points.at(i), points.at(i + 1)), lineWidth);
+        polygonItem->setColor(brushColor);
+        UBGraphicsItem::assignZValue(polygonItem, zValue);
+        polygonItem->setColorOnDarkBackground(colorOnDarkBackground);
+        polygonItem->setColorOnLightBackground(colorOnLightBackground);
+
+        polygonItems <<polygonItem;
     }
 
     return polygonItems;
@@ -2038,7 +2558,7 @@ UBGraphicsPixmapItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::pixmapItemFromSvg()
 
     UBGraphicsPixmapItem* pixmapItem = new UBGraphicsPixmapItem();
 
-    QStringRef imageHref = mXmlReader.attributes().value(nsXLink, "href");
+    QStringRef imageHref = mXmlReader.attributes().value(nsXLink, aHref);
 
     if (!imageHref.isNull())
     {
@@ -2079,7 +2599,7 @@ UBGraphicsSvgItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::svgItemFromSvg()
 {
     UBGraphicsSvgItem* svgItem = 0;
 
-    QStringRef imageHref = mXmlReader.attributes().value(nsXLink, "href");
+    QStringRef imageHref = mXmlReader.attributes().value(nsXLink, aHref);
 
     if (!imageHref.isNull())
     {
@@ -2137,7 +2657,7 @@ UBGraphicsPDFItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::pdfItemFromPDF()
 {
     UBGraphicsPDFItem* pdfItem = 0;
 
-    QString href = mXmlReader.attributes().value(nsXLink, "href").toString();
+    QString href = mXmlReader.attributes().value(nsXLink, aHref).toString();
     QStringList parts = href.split("#page=");
     if (parts.count() != 2)
     {
@@ -2205,7 +2725,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::videoItemToLinkedVideo(UBGraphicsVid
 UBGraphicsMediaItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::audioItemFromSvg()
 {
 
-    QStringRef audioHref = mXmlReader.attributes().value(nsXLink, "href");
+    QStringRef audioHref = mXmlReader.attributes().value(nsXLink, aHref);
 
     if (audioHref.isNull())
     {
@@ -2227,7 +2747,7 @@ UBGraphicsMediaItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::audioItemFromSvg()
         audioItem->connect(UBApplication::boardController, SIGNAL(activeSceneChanged()), audioItem, SLOT(activeSceneChanged()));
 
     graphicsItemFromSvg(audioItem);
-    QStringRef ubPos = mXmlReader.attributes().value(mNamespaceUri, "position");
+    QStringRef ubPos = mXmlReader.attributes().value(mNamespaceUri, aPosition);
 
     qint64 p = 0;
     if (!ubPos.isNull())
@@ -2240,7 +2760,7 @@ UBGraphicsMediaItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::audioItemFromSvg()
 UBGraphicsMediaItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::videoItemFromSvg()
 {
 
-    QStringRef videoHref = mXmlReader.attributes().value(nsXLink, "href");
+    QStringRef videoHref = mXmlReader.attributes().value(nsXLink, aHref);
 
     if (videoHref.isNull())
     {
@@ -2263,7 +2783,7 @@ UBGraphicsMediaItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::videoItemFromSvg()
     }
 
     graphicsItemFromSvg(videoItem);
-    QStringRef ubPos = mXmlReader.attributes().value(mNamespaceUri, "position");
+    QStringRef ubPos = mXmlReader.attributes().value(mNamespaceUri, aPosition);
 
     qint64 p = 0;
     if (!ubPos.isNull())
@@ -2278,18 +2798,18 @@ UBGraphicsMediaItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::videoItemFromSvg()
 void UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsItemFromSvg(QGraphicsItem* gItem)
 {
 
-    QStringRef svgTransform = mXmlReader.attributes().value("transform");
+    QStringRef svgTransform = mXmlReader.attributes().value(aTransform);
 
     QTransform itemMatrix;
 
     if (!svgTransform.isNull())
     {
-        itemMatrix = fromSvgTransform(svgTransform.toString());
+        itemMatrix = transformFromSvgRef(svgTransform);
         gItem->setTransform(itemMatrix);
     }
 
-    QStringRef svgX = mXmlReader.attributes().value("x");
-    QStringRef svgY = mXmlReader.attributes().value("y");
+    QStringRef svgX = mXmlReader.attributes().value(aX);
+    QStringRef svgY = mXmlReader.attributes().value(aY);
 
     if (mFileVersion >= 40202)
     {
@@ -2299,7 +2819,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsItemFromSvg(QGraphicsItem* g
     {
         if (!svgX.isNull() && !svgY.isNull())
         {
-            gItem->setPos(svgX.toString().toFloat() * itemMatrix.m11(), svgY.toString().toFloat() * itemMatrix.m22());
+            gItem->setPos(svgX.toFloat() * itemMatrix.m11(), svgY.toFloat() * itemMatrix.m22());
         }
     }
     else
@@ -2307,7 +2827,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsItemFromSvg(QGraphicsItem* g
         if (!svgX.isNull() && !svgY.isNull())
         {
 #ifdef Q_OS_WIN
-            gItem->setPos(svgX.toString().toFloat(), svgY.toString().toFloat());
+            gItem->setPos(svgX.toFloat(), svgY.toFloat());
 #endif
         }
     }
@@ -2316,22 +2836,22 @@ void UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsItemFromSvg(QGraphicsItem* g
 
     if (rgi)
     {
-        QStringRef svgWidth = mXmlReader.attributes().value("width");
-        QStringRef svgHeight = mXmlReader.attributes().value("height");
+        QStringRef svgWidth = mXmlReader.attributes().value(aWidth);
+        QStringRef svgHeight = mXmlReader.attributes().value(aHeight);
 
         if (!svgWidth.isNull() && !svgHeight.isNull())
         {
-            rgi->resize(svgWidth.toString().toFloat(), svgHeight.toString().toFloat());
+            rgi->resize(svgWidth.toFloat(), svgHeight.toFloat());
         }
     }
 
-    QStringRef ubZValue = mXmlReader.attributes().value(mNamespaceUri, "z-value");
+    QStringRef ubZValue = mXmlReader.attributes().value(mNamespaceUri, aZValue);
 
     if (!ubZValue.isNull()){
         // FIX
         // In the firsts zvalue implemenations values outside the boudaries have been used.
         // No boundaries specified on documentation but to small values are not correctly handled.
-        qreal zValue = ubZValue.toString().toFloat();
+        qreal zValue = ubZValue.toFloat();
         while(zValue < -999999) zValue /= 10.;
         UBGraphicsItem::assignZValue(gItem, zValue);
     }
@@ -2340,20 +2860,20 @@ void UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsItemFromSvg(QGraphicsItem* g
 
     if (ubItem)
     {
-        QStringRef ubUuid = mXmlReader.attributes().value(mNamespaceUri, "uuid");
+        QStringRef ubUuid = mXmlReader.attributes().value(mNamespaceUri, aUuid);
 
         if (!ubUuid.isNull())
             ubItem->setUuid(QUuid(ubUuid.toString()));
         else
             ubItem->setUuid(QUuid::createUuid());
 
-        QStringRef ubSource = mXmlReader.attributes().value(mNamespaceUri, "source");
+        QStringRef ubSource = mXmlReader.attributes().value(mNamespaceUri, aSource);
 
         if (!ubSource.isNull())
             ubItem->setSourceUrl(QUrl(ubSource.toString()));
     }
 
-    QStringRef ubLocked = mXmlReader.attributes().value(mNamespaceUri, "locked");
+    QStringRef ubLocked = mXmlReader.attributes().value(mNamespaceUri, aLocked);
 
     if (!ubLocked.isNull())
     {
@@ -2361,7 +2881,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsItemFromSvg(QGraphicsItem* g
         gItem->setData(UBGraphicsItemData::ItemLocked, QVariant(isLocked));
     }
 
-    QStringRef ubEditable = mXmlReader.attributes().value(mNamespaceUri, "editable");
+    QStringRef ubEditable = mXmlReader.attributes().value(mNamespaceUri, aEditable);
 
     if (!ubEditable.isNull())
     {
@@ -2370,7 +2890,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsItemFromSvg(QGraphicsItem* g
     }
 
     //deprecated as of 4.4.a.12
-    QStringRef ubLayer = mXmlReader.attributes().value(mNamespaceUri, "layer");
+    QStringRef ubLayer = mXmlReader.attributes().value(mNamespaceUri, aLayer);
     if (!ubLayer.isNull())
     {
         bool ok;
@@ -2542,7 +3062,7 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::graphicsWidgetToSvg(UBGraphicsWidget
 UBGraphicsAppleWidgetItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsAppleWidgetFromSvg()
 {
 
-    QStringRef widgetUrl = mXmlReader.attributes().value(mNamespaceUri, "src");
+    QStringRef widgetUrl = mXmlReader.attributes().value(mNamespaceUri, aSrc);
 
     if (widgetUrl.isNull())
     {
@@ -2568,7 +3088,7 @@ UBGraphicsAppleWidgetItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsAppleW
 
 UBGraphicsW3CWidgetItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsW3CWidgetFromSvg()
 {
-    QStringRef widgetUrl = mXmlReader.attributes().value(mNamespaceUri, "src");
+    QStringRef widgetUrl = mXmlReader.attributes().value(mNamespaceUri, aSrc);
 
     if (widgetUrl.isNull())
     {
@@ -2586,12 +3106,12 @@ UBGraphicsW3CWidgetItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::graphicsW3CWidge
 
     UBGraphicsW3CWidgetItem* widgetItem = new UBGraphicsW3CWidgetItem(QUrl::fromLocalFile(href));
 
-    QStringRef uuid = mXmlReader.attributes().value(mNamespaceUri, "uuid");
+    QStringRef uuid = mXmlReader.attributes().value(mNamespaceUri, aUuid);
     QString pixPath = mDocumentPath + "/" + UBPersistenceManager::widgetDirectory + "/" + uuid.toString() + ".png";
 
     QPixmap snapshot(pixPath);
 
-    QStringRef frozen = mXmlReader.attributes().value(mNamespaceUri, "frozen");
+    QStringRef frozen = mXmlReader.attributes().value(mNamespaceUri, aFrozen);
 
     if (!frozen.isNull() && frozen.toString() == xmlTrue && !snapshot.isNull())
     {
@@ -2648,17 +3168,17 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::textItemToSvg(UBGraphicsTextItem* it
 
 UBGraphicsTextItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::textItemFromSvg()
 {
-    qreal width = mXmlReader.attributes().value("width").toString().toFloat();
-    qreal height = mXmlReader.attributes().value("height").toString().toFloat();
+    qreal width = mXmlReader.attributes().value(aWidth).toFloat();
+    qreal height = mXmlReader.attributes().value(aHeight).toFloat();
 
-    qreal originalPixelsPerPoint = mXmlReader.attributes().value(mNamespaceUri, "pixels-per-point").toString().toDouble();
+    qreal originalPixelsPerPoint = mXmlReader.attributes().value(mNamespaceUri, aPixelsPerPoint).toString().toDouble();
 
     UBGraphicsTextItem* textItem = new UBGraphicsTextItem();
 
     graphicsItemFromSvg(textItem);
 
-    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-dark-background");
-    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, "fill-on-light-background");
+    QStringRef ubFillOnDarkBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnDarkBackground);
+    QStringRef ubFillOnLightBackground = mXmlReader.attributes().value(mNamespaceUri, aFillOnLightBackground);
 
     if (!ubFillOnDarkBackground.isNull()) {
         QColor color;
@@ -2678,7 +3198,7 @@ UBGraphicsTextItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::textItemFromSvg()
 
     QString text;
 
-    while (!(mXmlReader.isEndElement() && (mXmlReader.name() == "font" || mXmlReader.name() == "foreignObject")))
+    while (!(mXmlReader.isEndElement() && (mXmlReader.name() == tFont || mXmlReader.name() == tForeignObject)))
     {
         if (mXmlReader.hasError())
         {
@@ -2692,7 +3212,7 @@ UBGraphicsTextItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::textItemFromSvg()
         {
             //for new documents from version 4.5.0
             if (mFileVersion >= 40500) {
-                if (mXmlReader.name() == "itemTextContent") {
+                if (mXmlReader.name() == tItemTextContent) {
                     text = mXmlReader.readElementText();
                     textItem->setHtml(text);
 
@@ -2729,15 +3249,15 @@ UBGraphicsTextItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::textItemFromSvg()
                 }
 
                 //tracking for backward capability with older versions
-            } else if (mXmlReader.name() == "font")  {
+            } else if (mXmlReader.name() == tFont)  {
                 QFont font = textItem->font();
 
-                QStringRef fontFamily = mXmlReader.attributes().value("face");
+                QStringRef fontFamily = mXmlReader.attributes().value(aFace);
 
                 if (!fontFamily.isNull()) {
                     font.setFamily(fontFamily.toString());
                 }
-                QStringRef fontStyle = mXmlReader.attributes().value("style");
+                QStringRef fontStyle = mXmlReader.attributes().value(aStyle);
                 if (!fontStyle.isNull()) {
                     foreach (QString styleToken, fontStyle.toString().split(";")) {
                         styleToken = styleToken.trimmed();
@@ -2768,14 +3288,14 @@ UBGraphicsTextItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::textItemFromSvg()
                 textItem->setTextCursor(curCursor);
                 textItem->setFont(font);
 
-                QStringRef fill = mXmlReader.attributes().value("color");
+                QStringRef fill = mXmlReader.attributes().value(aColor);
                 if (!fill.isNull()) {
                     QColor textColor;
                     textColor.setNamedColor(fill.toString());
                     textItem->setDefaultTextColor(textColor);
                 }
 
-                while (!(mXmlReader.isEndElement() && mXmlReader.name() == "font")) {
+                while (!(mXmlReader.isEndElement() && mXmlReader.name() == tFont)) {
                     if (mXmlReader.hasError()) {
                         break;
                     }
@@ -2784,7 +3304,7 @@ UBGraphicsTextItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::textItemFromSvg()
                         text += mXmlReader.text().toString();
                     }
 
-                    if (mXmlReader.isStartElement() && mXmlReader.name() == "br") {
+                    if (mXmlReader.isStartElement() && mXmlReader.name() == tBr) {
                         text += "\n";
                     }
                 }
@@ -2848,17 +3368,17 @@ UBGraphicsCurtainItem* UBSvgSubsetAdaptor::UBSvgSubsetReader::curtainItemFromSvg
 
     graphicsItemFromSvg(curtainItem);
 
-    QStringRef svgX = mXmlReader.attributes().value("x");
-    QStringRef svgY = mXmlReader.attributes().value("y");
-    QStringRef svgWidth = mXmlReader.attributes().value("width");
-    QStringRef svgHeight = mXmlReader.attributes().value("height");
+    QStringRef svgX = mXmlReader.attributes().value(aX);
+    QStringRef svgY = mXmlReader.attributes().value(aY);
+    QStringRef svgWidth = mXmlReader.attributes().value(aWidth);
+    QStringRef svgHeight = mXmlReader.attributes().value(aHeight);
 
 
     QRect rect;
-    rect.setX(svgX.toString().toFloat()-svgWidth.toString().toFloat()/2);
-    rect.setY(svgY.toString().toFloat()-svgHeight.toString().toFloat()/2);
-    rect.setWidth(svgWidth.toString().toFloat());
-    rect.setHeight(svgHeight.toString().toFloat());
+    rect.setX(svgX.toFloat()-svgWidth.toFloat()/2);
+    rect.setY(svgY.toFloat()-svgHeight.toFloat()/2);
+    rect.setWidth(svgWidth.toFloat());
+    rect.setHeight(svgHeight.toFloat());
 
     curtainItem->setRect(rect);
 
@@ -2944,14 +3464,14 @@ UBGraphicsRuler* UBSvgSubsetAdaptor::UBSvgSubsetReader::rulerFromSvg()
 
     ruler->setData(UBGraphicsItemData::ItemLayerType, QVariant(UBItemLayerType::Tool));
 
-    QStringRef svgWidth = mXmlReader.attributes().value("width");
-    QStringRef svgHeight = mXmlReader.attributes().value("height");
-    QStringRef svgX = mXmlReader.attributes().value("x");
-    QStringRef svgY = mXmlReader.attributes().value("y");
+    QStringRef svgWidth = mXmlReader.attributes().value(aWidth);
+    QStringRef svgHeight = mXmlReader.attributes().value(aHeight);
+    QStringRef svgX = mXmlReader.attributes().value(aX);
+    QStringRef svgY = mXmlReader.attributes().value(aY);
 
     if (!svgWidth.isNull() && !svgHeight.isNull() && !svgX.isNull() && !svgY.isNull())
     {
-        ruler->setRect(svgX.toString().toFloat(), svgY.toString().toFloat(),  svgWidth.toString().toFloat(), svgHeight.toString().toFloat());
+        ruler->setRect(svgX.toFloat(), svgY.toFloat(),  svgWidth.toFloat(), svgHeight.toFloat());
     }
 
     ruler->setVisible(true);
@@ -2967,23 +3487,23 @@ UBGraphicsAxes *UBSvgSubsetAdaptor::UBSvgSubsetReader::axesFromSvg()
 
     axes->setData(UBGraphicsItemData::ItemLayerType, QVariant(UBItemLayerType::Tool));
 
-    QStringRef svgX = mXmlReader.attributes().value("x");
-    QStringRef svgY = mXmlReader.attributes().value("y");
-    QStringRef svgLeft = mXmlReader.attributes().value("left");
-    QStringRef svgTop = mXmlReader.attributes().value("top");
-    QStringRef svgWidth = mXmlReader.attributes().value("width");
-    QStringRef svgHeight = mXmlReader.attributes().value("height");
-    QStringRef svgNumbers = mXmlReader.attributes().value("numbers");
+    QStringRef svgX = mXmlReader.attributes().value(aX);
+    QStringRef svgY = mXmlReader.attributes().value(aY);
+    QStringRef svgLeft = mXmlReader.attributes().value(aLeft);
+    QStringRef svgTop = mXmlReader.attributes().value(aTop);
+    QStringRef svgWidth = mXmlReader.attributes().value(aWidth);
+    QStringRef svgHeight = mXmlReader.attributes().value(aHeight);
+    QStringRef svgNumbers = mXmlReader.attributes().value(aNumbers);
 
     if (!svgX.isNull() && !svgY.isNull())
     {
-        axes->setPos(svgX.toString().toFloat(), svgY.toString().toFloat());
+        axes->setPos(svgX.toFloat(), svgY.toFloat());
     }
 
     if (!svgWidth.isNull() && !svgHeight.isNull() && !svgLeft.isNull() && !svgTop.isNull())
     {
-        axes->setRect(svgLeft.toString().toFloat(), svgTop.toString().toFloat(),
-                      svgWidth.toString().toFloat(), svgHeight.toString().toFloat());
+        axes->setRect(svgLeft.toFloat(), svgTop.toFloat(),
+                      svgWidth.toFloat(), svgHeight.toFloat());
     }
 
     if (!svgNumbers.isNull())
@@ -3039,15 +3559,15 @@ UBGraphicsCompass* UBSvgSubsetAdaptor::UBSvgSubsetReader::compassFromSvg()
 
     compass->setData(UBGraphicsItemData::ItemLayerType, QVariant(UBItemLayerType::Tool));
 
-    QStringRef svgX = mXmlReader.attributes().value("x");
-    QStringRef svgY = mXmlReader.attributes().value("y");
-    QStringRef svgWidth = mXmlReader.attributes().value("width");
-    QStringRef svgHeight = mXmlReader.attributes().value("height");
+    QStringRef svgX = mXmlReader.attributes().value(aX);
+    QStringRef svgY = mXmlReader.attributes().value(aY);
+    QStringRef svgWidth = mXmlReader.attributes().value(aWidth);
+    QStringRef svgHeight = mXmlReader.attributes().value(aHeight);
 
     if (!svgX.isNull() && !svgY.isNull() && !svgWidth.isNull() && !svgHeight.isNull())
     {
-        compass->setRect(svgX.toString().toFloat(), svgY.toString().toFloat()
-                         , svgWidth.toString().toFloat(), svgHeight.toString().toFloat());
+        compass->setRect(svgX.toFloat(), svgY.toFloat()
+                         , svgWidth.toFloat(), svgHeight.toFloat());
     }
 
     compass->setVisible(true);
@@ -3104,27 +3624,27 @@ UBGraphicsProtractor* UBSvgSubsetAdaptor::UBSvgSubsetReader::protractorFromSvg()
 
     graphicsItemFromSvg(protractor);
 
-    QStringRef angle = mXmlReader.attributes().value(mNamespaceUri, "angle");
+    QStringRef angle = mXmlReader.attributes().value(mNamespaceUri, aAngle);
     if (!angle.isNull())
     {
-        protractor->setAngle(angle.toString().toFloat());
+        protractor->setAngle(angle.toFloat());
     }
 
-    QStringRef markerAngle = mXmlReader.attributes().value(mNamespaceUri, "marker-angle");
+    QStringRef markerAngle = mXmlReader.attributes().value(mNamespaceUri, aMarkerAngle);
     if (!markerAngle.isNull())
     {
-        protractor->setMarkerAngle(markerAngle.toString().toFloat());
+        protractor->setMarkerAngle(markerAngle.toFloat());
     }
 
-    QStringRef svgX = mXmlReader.attributes().value("x");
-    QStringRef svgY = mXmlReader.attributes().value("y");
-    QStringRef svgWidth = mXmlReader.attributes().value("width");
-    QStringRef svgHeight = mXmlReader.attributes().value("height");
+    QStringRef svgX = mXmlReader.attributes().value(aX);
+    QStringRef svgY = mXmlReader.attributes().value(aY);
+    QStringRef svgWidth = mXmlReader.attributes().value(aWidth);
+    QStringRef svgHeight = mXmlReader.attributes().value(aHeight);
 
     if (!svgX.isNull() && !svgY.isNull() && !svgWidth.isNull() && !svgHeight.isNull())
     {
-        protractor->setRect(svgX.toString().toFloat(), svgY.toString().toFloat()
-                            , svgWidth.toString().toFloat(), svgHeight.toString().toFloat());
+        protractor->setRect(svgX.toFloat(), svgY.toFloat()
+                            , svgWidth.toFloat(), svgHeight.toFloat());
     }
 
     protractor->setVisible(true);
@@ -3174,18 +3694,18 @@ UBGraphicsTriangle* UBSvgSubsetAdaptor::UBSvgSubsetReader::triangleFromSvg()
 
     graphicsItemFromSvg(triangle);
 
-    QStringRef svgX = mXmlReader.attributes().value("x");
-    QStringRef svgY = mXmlReader.attributes().value("y");
-    QStringRef svgWidth = mXmlReader.attributes().value("width");
-    QStringRef svgHeight = mXmlReader.attributes().value("height");
+    QStringRef svgX = mXmlReader.attributes().value(aX);
+    QStringRef svgY = mXmlReader.attributes().value(aY);
+    QStringRef svgWidth = mXmlReader.attributes().value(aWidth);
+    QStringRef svgHeight = mXmlReader.attributes().value(aHeight);
 
-    QStringRef orientationStringRef = mXmlReader.attributes().value("orientation");
+    QStringRef orientationStringRef = mXmlReader.attributes().value(aOrientation);
     UBGraphicsTriangle::UBGraphicsTriangleOrientation orientation = UBGraphicsTriangle::orientationFromStr(orientationStringRef);
     triangle->setOrientation(orientation);
 
     if (!svgX.isNull() && !svgY.isNull() && !svgWidth.isNull() && !svgHeight.isNull())
     {
-        triangle->setRect(svgX.toString().toFloat(), svgY.toString().toFloat(), svgWidth.toString().toFloat(), svgHeight.toString().toFloat(), orientation);
+        triangle->setRect(svgX.toFloat(), svgY.toFloat(), svgWidth.toFloat(), svgHeight.toFloat(), orientation);
     }
 
     triangle->setVisible(true);
@@ -3199,18 +3719,18 @@ UBGraphicsCache* UBSvgSubsetAdaptor::UBSvgSubsetReader::cacheFromSvg()
 
     graphicsItemFromSvg(pCache);
 
-    QStringRef colorR = mXmlReader.attributes().value("colorR");
-    QStringRef colorG = mXmlReader.attributes().value("colorG");
-    QStringRef colorB = mXmlReader.attributes().value("colorB");
-    QStringRef colorA = mXmlReader.attributes().value("colorA");
-    QStringRef shape = mXmlReader.attributes().value("shape");
-    QStringRef shapeSize = mXmlReader.attributes().value("shapeSize");
+    QStringRef colorR = mXmlReader.attributes().value(aColorR);
+    QStringRef colorG = mXmlReader.attributes().value(aColorG);
+    QStringRef colorB = mXmlReader.attributes().value(aColorB);
+    QStringRef colorA = mXmlReader.attributes().value(aColorA);
+    QStringRef shape = mXmlReader.attributes().value(aShape);
+    QStringRef shapeSize = mXmlReader.attributes().value(aShapeSize);
 
-    QColor color(colorR.toString().toInt(), colorG.toString().toInt(), colorB.toString().toInt(), colorA.toString().toInt());
+    QColor color(colorR.toInt(), colorG.toInt(), colorB.toInt(), colorA.toInt());
 
     pCache->setMaskColor(color);
-    pCache->setShapeWidth(shapeSize.toString().toInt());
-    pCache->setMaskShape(static_cast<eMaskShape>(shape.toString().toInt()));
+    pCache->setShapeWidth(shapeSize.toInt());
+    pCache->setMaskShape(static_cast<eMaskShape>(shape.toInt()));
 
     pCache->setVisible(true);
 
@@ -3314,3 +3834,95 @@ void UBSvgSubsetAdaptor::convertSvgImagesToImages(UBDocumentProxy* proxy)
         }
     }
 }
+
+
+QString UBSvgSubsetAdaptor::strokeSidecarFileName(const QString& svgFileName)
+{
+    QFile file(svgFileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    // the stroke file is named on the root element, the rest of the page is not read
+    QXmlStreamReader xmlReader(&file);
+
+    while (!xmlReader.atEnd() && !xmlReader.isStartElement())
+        xmlReader.readNext();
+
+    QStringRef ubStrokes = xmlReader.attributes().value(UBSettings::uniboardDocumentNamespaceUri, aStrokes);
+
+    return ubStrokes.isNull() ? QString() : UBFileSystemUtils::normalizeFilePath(ubStrokes.toString());
+}
+
+
+QByteArray UBSvgSubsetAdaptor::inlineStrokeSidecar(const QString& documentPath, const QByteArray& svgData)
+{
+    QXmlStreamReader xmlReader(svgData);
+
+    QByteArray inlinedData;
+    QXmlStreamWriter xmlWriter(&inlinedData);
+
+    QVector<QPolygonF> sidecarStrokes;
+
+    while (!xmlReader.atEnd())
+    {
+        xmlReader.readNext();
+
+        if (!xmlReader.isStartElement())
+        {
+            xmlWriter.writeCurrentToken(xmlReader);
+            continue;
+        }
+
+        QXmlStreamAttributes attributes = xmlReader.attributes();
+        QStringRef ubStrokes = attributes.value(UBSettings::uniboardDocumentNamespaceUri, aStrokes);
+        QStringRef ubPointsIndex = attributes.value(UBSettings::uniboardDocumentNamespaceUri, aPointsIndex);
+
+        if (ubStrokes.isNull() && ubPointsIndex.isNull())
+        {
+            xmlWriter.writeCurrentToken(xmlReader);
+            continue;
+        }
+
+        if (!ubStrokes.isNull())
+            sidecarStrokes = UBStrokeSidecar::read(documentPath + "/" + UBFileSystemUtils::normalizeFilePath(ubStrokes.toString()));
+
+        int index = ubPointsIndex.isNull() ? -1 : ubPointsIndex.toInt();
+        bool inlined = index >= 0 && index < sidecarStrokes.size();
+
+        writeNamespaceDeclarations(xmlReader, xmlWriter);
+        xmlWriter.writeStartElement(xmlReader.namespaceUri().toString(), xmlReader.name().toString());
+
+        foreach (const QXmlStreamAttribute& attribute, attributes)
+        {
+            bool ubAttribute = attribute.namespaceUri() == UBSettings::uniboardDocumentNamespaceUri;
+
+            if (ubAttribute && (attribute.name() == aStrokes || attribute.name() == aPointsIndex))
+                continue;
+
+            // the points of the stroke file replace any written in the page
+            if (inlined && attribute.namespaceUri().isEmpty() && attribute.name() == aPoints)
+                continue;
+
+            xmlWriter.writeAttribute(attribute);
+        }
+
+        if (inlined)
+        {
+            QString svgPoints;
+
+            foreach (const QPointF& point, sidecarStrokes.at(index))
+                svgPoints += QString("%1,%2 ").arg(point.x()).arg(point.y());
+
+            xmlWriter.writeAttribute(aPoints, svgPoints);
+        }
+    }
+
+    if (xmlReader.hasError())
+    {
+        qWarning() << "cannot inline the stroke file of a page of" << documentPath << ":" << xmlReader.errorString();
+        return svgData;
+    }
+
+    return inlinedData;
+}
@@ -61,6 +61,31 @@ class UBGraphicsCache;
 class UBGraphicsGroupContainerItem;
 class UBGraphicsStrokesGroup;
 
+/**
+ * Page content read and pre-parsed outside of the GUI thread. The xml data is already
+ * cleaned, and the stroke point lists are keyed by the character offset of their element
+ * so that the reader can pick them up instead of parsing the "points" attributes or
+ * reading the stroke sidecar again.
+ */
+struct UBSvgPreparedScene
+{
+    QByteArray xmlData;
+    QHash<qint64, QPolygonF> points;
+};
+
+Q_DECLARE_METATYPE(UBSvgPreparedScene)
+
+/**
+ * Page content serialised on the GUI thread, ready to be written to disk outside of it.
+ * The sidecar file name is empty when the strokes are written inline.
+ */
+struct UBSvgSerializedScene
+{
+    QByteArray svgData;
+    QString sidecarFileName;
+    QVector<QPolygonF> sidecarStrokes;
+};
+
 class UBSvgSubsetAdaptor
 {
     private:
@@ -74,7 +99,17 @@ class UBSvgSubsetAdaptor
         static QByteArray loadSceneAsText(UBDocumentProxy* proxy, const int pageIndex);
         static UBGraphicsScene* loadScene(UBDocumentProxy* proxy, const QByteArray& pArray);
 
+        // prepareScene is safe to call from a worker thread, the prepared scene must be loaded on the GUI thread
+        static UBSvgPreparedScene prepareScene(UBDocumentProxy* proxy, const int pageIndex);
+        static UBSvgPreparedScene prepareScene(const QString& documentPath, const int pageIndex);
+        static UBGraphicsScene* loadScene(UBDocumentProxy* proxy, const UBSvgPreparedScene& preparedScene);
+
         static void persistScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex);
+
+        // serializeScene must be called on the GUI thread, writeScene is safe to call from a worker thread
+        static UBSvgSerializedScene serializeScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex);
+        static bool writeScene(UBDocumentProxy* proxy, const int pageIndex, const UBSvgSerializedScene& serializedScene);
+        static bool writeScene(UBDocumentProxy* proxy, const QString& fileName, const UBSvgSerializedScene& serializedScene);
         static void upgradeScene(UBDocumentProxy* proxy, const int pageIndex);
 
         static QUuid sceneUuid(UBDocumentProxy* proxy, const int pageIndex);
@@ -83,6 +118,15 @@ class UBSvgSubsetAdaptor
         static void convertPDFObjectsToImages(UBDocumentProxy* proxy);
         static void convertSvgImagesToImages(UBDocumentProxy* proxy);
 
+        // the stroke file named by a page svg, relative to its document, empty when its points are inline
+        static QString strokeSidecarFileName(const QString& svgFileName);
+
+        // the page with the points of its stroke file written in full, for the exports; safe to call from any thread
+        static QByteArray inlineStrokeSidecar(const QString& documentPath, const QByteArray& svgData);
+
+        // per element type parse times, only gathered in debug builds
+        static void dumpParseStatistics();
+
         static const QString nsSvg;
         static const QString nsXLink;
         static const QString nsXHtml;
@@ -104,14 +148,14 @@ class UBSvgSubsetAdaptor
         static const QString sFormerUniboardDocumentNamespaceUri;
 
         static QString toSvgTransform(const QTransform& matrix);
-        static QTransform fromSvgTransform(const QString& transform);
+        static QPolygonF fromSvgPoints(const QStringRef& svgPoints);
 
 
         class UBSvgSubsetReader
         {
             public:
 
-                UBSvgSubsetReader(UBDocumentProxy* proxy, const QByteArray& pXmlData);
+                UBSvgSubsetReader(UBDocumentProxy* proxy, const QByteArray& pXmlData, const QHash<qint64, QPolygonF>* pPreparedPoints = 0);
 
                 virtual ~UBSvgSubsetReader(){}
 
@@ -161,7 +205,12 @@ class UBSvgSubsetAdaptor
 
                 void graphicsItemFromSvg(QGraphicsItem* gItem);
 
+                QPolygonF pointsFromSvg();
+                void readStrokeSidecar();
+
                 QXmlStreamReader mXmlReader;
+                const QHash<qint64, QPolygonF>* mPreparedPoints;
+                QVector<QPolygonF> mSidecarStrokes;
                 int mFileVersion;
                 UBDocumentProxy *mProxy;
                 QString mDocumentPath;
@@ -185,12 +234,19 @@ class UBSvgSubsetAdaptor
 
                 UBSvgSubsetWriter(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex);
 
+                void setStrokeSidecarEnabled(bool enabled) { mUseStrokeSidecar = enabled; }
+
                 bool persistScene(UBDocumentProxy *proxy, int pageIndex);
+                UBSvgSerializedScene serializeScene(UBDocumentProxy *proxy);
 
                 virtual ~UBSvgSubsetWriter(){}
 
             private:
 
+                bool writeCachedFragment(QGraphicsItem *item, int context, qint64 &fragmentStart);
+                void cacheFragment(QGraphicsItem *item, int context, qint64 fragmentStart);
+                void itemToSvg(QGraphicsItem *item);
+
                 void persistGroupToDom(QGraphicsItem *groupItem, QDomElement *curParent, QDomDocument *curDomDocument);
                 void persistStrokeToDom(QGraphicsItem *strokeItem, QDomElement *curParent, QDomDocument *curDomDocument);
                 void polygonItemToSvgPolygon(UBGraphicsPolygonItem* polygonItem, bool groupHoldsInfo);
@@ -256,6 +312,7 @@ class UBSvgSubsetAdaptor
                 void cacheToSvg(UBGraphicsCache* item);
                 void triangleToSvg(UBGraphicsTriangle *item);
                 void writeSvgElement(UBDocumentProxy *proxy);
+                void writePointsAttribute(QVector<QPointF> points);
 
         private:
 
@@ -264,6 +321,9 @@ class UBSvgSubsetAdaptor
                 QString mDocumentPath;
                 int mPageIndex;
 
+                bool mUseStrokeSidecar;
+                QVector<QPolygonF> mSidecarStrokes;
+
         };
 };
 
@@ -45,53 +45,26 @@
 #include "domain/UBGraphicsScene.h"
 
 #include "UBSvgSubsetAdaptor.h"
+#include "UBThumbnailPack.h"
+#include "UBPageManifest.h"
 
 #include "core/memcheck.h"
 
-void UBThumbnailAdaptor::generateMissingThumbnails(UBDocumentProxy* proxy)
-{
-    int existingPageCount = proxy->pageCount();
-
-    for (int iPageNo = 0; iPageNo < existingPageCount; ++iPageNo)
-    {
-        QString thumbFileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", iPageNo);
-
-        QFile thumbFile(thumbFileName);
-
-        if (!thumbFile.exists())
-        {
-            bool displayMessage = (existingPageCount > 5);
-
-            int thumbCount = 0;
-
-            UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(proxy, iPageNo);
-
-            if (scene)
-            {
-                thumbCount++;
-
-                if (displayMessage && thumbCount == 1)
-                    UBApplication::showMessage(tr("Generating preview thumbnails ..."));
-
-                persistScene(proxy, scene, iPageNo);
-            }
-
-            if (displayMessage && thumbCount > 0)
-                UBApplication::showMessage(tr("%1 thumbnails generated ...").arg(thumbCount));
-
-        }
-    }
-}
-
 QPixmap UBThumbnailAdaptor::get(UBDocumentProxy* proxy, int pageIndex)
 {
     UBApplication::showMessage(tr("Loading thumbnail (%1/%2)").arg(pageIndex+1).arg(proxy->pageCount()));
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", pageIndex);
+    QString fileName = UBPageManifest::pageThumbnailPath(proxy->persistencePath(), pageIndex);
 
     QFile file(fileName);
     if (!file.exists())
     {
-        generateMissingThumbnails(proxy);
+        UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(proxy, pageIndex);
+
+        if (scene)
+        {
+            persistScene(proxy, scene, pageIndex);
+            delete scene;
+        }
     }
 
     QPixmap pix;
@@ -102,64 +75,90 @@ QPixmap UBThumbnailAdaptor::get(UBDocumentProxy* proxy, int pageIndex)
     return pix;
 }
 
-void UBThumbnailAdaptor::load(UBDocumentProxy* proxy, QList<std::shared_ptr<QPixmap>>& list)
+void UBThumbnailAdaptor::persistScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, int pageIndex, bool overrideModified)
 {
-    list.clear();
-    for(int i=0; i<proxy->pageCount(); i++)
+    QString fileName = UBPageManifest::pageThumbnailPath(proxy->persistencePath(), pageIndex);
+
+    QFile thumbFile(fileName);
+
+    if (pScene->isModified() || overrideModified || !thumbFile.exists())
     {
-        list.append(std::make_shared<QPixmap>(get(proxy, i)));
+        store(proxy->persistencePath(), pageIndex, render(pScene));
     }
 }
 
-void UBThumbnailAdaptor::persistScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, int pageIndex, bool overrideModified)
+void UBThumbnailAdaptor::store(const QString& documentPath, int pageIndex, const QImage& thumbnail)
 {
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", pageIndex);
+    QByteArray jpegData;
+    QBuffer buffer(&jpegData);
 
-    QFile thumbFile(fileName);
+    buffer.open(QIODevice::WriteOnly);
+    thumbnail.save(&buffer, "JPG");
+    buffer.close();
 
-    if (pScene->isModified() || overrideModified || !thumbFile.exists())
-    {
-        qreal nominalWidth = pScene->nominalSize().width();
-        qreal nominalHeight = pScene->nominalSize().height();
-        qreal ratio = nominalWidth / nominalHeight;
-        QRectF sceneRect = pScene->normalizedSceneRect(ratio);
+    int pageNumber = UBPageManifest::pageNumber(documentPath, pageIndex);
+    QString fileName = documentPath + "/" + UBPageManifest::thumbnailFileName(pageNumber);
 
-        qreal width = UBSettings::maxThumbnailWidth;
-        qreal height = width / ratio;
+    QFile file(fileName);
 
-        QImage thumb(width, height, QImage::Format_ARGB32);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCritical() << "cannot open " << fileName << " for writing ...";
+        return;
+    }
 
-        QRectF imageRect(0, 0, width, height);
+    bool written = file.write(jpegData) == jpegData.size();
+    file.close();
 
-        QPainter painter(&thumb);
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    // the pack entry remembers the file it matches, see UBThumbnailPack
+    if (written)
+        UBThumbnailPack::write(documentPath, pageNumber, jpegData, QFileInfo(fileName).lastModified().toMSecsSinceEpoch());
+}
 
-        if (pScene->isDarkBackground())
-        {
-            painter.fillRect(imageRect, Qt::black);
-        }
-        else
-        {
-            painter.fillRect(imageRect, Qt::white);
-        }
+QImage UBThumbnailAdaptor::render(UBGraphicsScene* pScene)
+{
+    qreal nominalWidth = pScene->nominalSize().width();
+    qreal nominalHeight = pScene->nominalSize().height();
+    qreal ratio = nominalWidth / nominalHeight;
+    QRectF sceneRect = pScene->normalizedSceneRect(ratio);
+
+    qreal width = UBSettings::maxThumbnailWidth;
+    qreal height = width / ratio;
 
-        pScene->setRenderingContext(UBGraphicsScene::NonScreen);
-        pScene->setRenderingQuality(UBItem::RenderingQualityHigh, UBItem::CacheNotAllowed);
+    QImage thumb(width, height, QImage::Format_ARGB32);
 
-        pScene->render(&painter, imageRect, sceneRect, Qt::KeepAspectRatio);
+    QRectF imageRect(0, 0, width, height);
 
-        pScene->setRenderingContext(UBGraphicsScene::Screen);
-        pScene->setRenderingQuality(UBItem::RenderingQualityNormal, UBItem::CacheAllowed);
+    QPainter painter(&thumb);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
 
-        thumb.scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation).save(fileName, "JPG");
+    if (pScene->isDarkBackground())
+    {
+        painter.fillRect(imageRect, Qt::black);
+    }
+    else
+    {
+        painter.fillRect(imageRect, Qt::white);
     }
+
+    pScene->setRenderingContext(UBGraphicsScene::NonScreen);
+    pScene->setRenderingQuality(UBItem::RenderingQualityHigh, UBItem::CacheNotAllowed);
+
+    pScene->render(&painter, imageRect, sceneRect, Qt::KeepAspectRatio);
+
+    pScene->setRenderingContext(UBGraphicsScene::Screen);
+    pScene->setRenderingQuality(UBItem::RenderingQualityNormal, UBItem::CacheAllowed);
+
+    painter.end();
+
+    return thumb;
 }
 
 
 QUrl UBThumbnailAdaptor::thumbnailUrl(UBDocumentProxy* proxy, int pageIndex)
 {
-    QString fileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", pageIndex);
+    QString fileName = UBPageManifest::pageThumbnailPath(proxy->persistencePath(), pageIndex);
 
     return QUrl::fromLocalFile(fileName);
 }
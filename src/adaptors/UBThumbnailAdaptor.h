@@ -44,13 +44,14 @@ public:
     static QUrl thumbnailUrl(UBDocumentProxy* proxy, int pageIndex);
 
     static void persistScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, int pageIndex, bool overrideModified = false);
+    static QImage render(UBGraphicsScene* pScene);
+
+    // safe to call from a worker thread, writes the jpeg file and its entry in the thumbnail pack
+    static void store(const QString& documentPath, int pageIndex, const QImage& thumbnail);
 
     static QPixmap get(UBDocumentProxy* proxy, int index);
-    static void load(UBDocumentProxy* proxy, QList<std::shared_ptr<QPixmap>>& list);
 
 private:
-    static void generateMissingThumbnails(UBDocumentProxy* proxy);
-
     UBThumbnailAdaptor() {}
 };
 
@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+#include "UBThumbnailPack.h"
+
+#include <QtEndian>
+
+#include "core/memcheck.h"
+
+const QString UBThumbnailPack::packFileName = "thumbnails.pack";
+
+QMutex UBThumbnailPack::sWriteMutex;
+
+static const quint32 sMagic = 0x55425450; // "UBTP"
+static const quint16 sVersion = 1;
+static const int sHeaderSize = 32;
+static const int sEntrySize = 32;
+static const int sMinimumIndexCapacity = 64;
+static const qint64 sCompactionSlack = 1024 * 1024;
+
+UBThumbnailPack::UBThumbnailPack(const QString& documentPath)
+    : mDocumentPath(documentPath)
+    , mOpened(false)
+    , mMap(0)
+    , mMapSize(0)
+{
+    // NOOP
+}
+
+
+UBThumbnailPack::~UBThumbnailPack()
+{
+    if (mMap)
+        mFile.unmap(mMap);
+
+    mFile.close();
+}
+
+
+void UBThumbnailPack::open()
+{
+    mOpened = true;
+
+    // a single listing of the document folder gives the size and date of every jpeg
+    QRegularExpression thumbnailName("^page(\\d+)\\.thumbnail\\.jpg$");
+
+    foreach(const QFileInfo& info, QDir(mDocumentPath).entryInfoList(QStringList() << "page*.thumbnail.jpg", QDir::Files))
+    {
+        QRegularExpressionMatch match = thumbnailName.match(info.fileName());
+
+        if (match.hasMatch())
+            mJpegFiles.insert(match.captured(1).toInt(), qMakePair(info.size(), info.lastModified().toMSecsSinceEpoch()));
+    }
+
+    mFile.setFileName(mDocumentPath + "/" + packFileName);
+
+    if (!mFile.exists() || !mFile.open(QIODevice::ReadOnly))
+        return;
+
+    quint64 indexOffset;
+
+    if (!readIndex(mFile, mIndex, indexOffset))
+    {
+        qWarning() << "cannot make sense of thumbnail pack" << mFile.fileName();
+        mIndex.clear();
+        mFile.close();
+        return;
+    }
+
+    mMapSize = mFile.size();
+    mMap = mFile.map(0, mMapSize);
+
+    if (!mMap)
+        mIndex.clear();
+}
+
+
+QByteArray UBThumbnailPack::read(int pageNumber)
+{
+    QMutexLocker locker(&mMutex);
+
+    if (!mOpened)
+        open();
+
+    if (pageNumber < 0 || pageNumber >= mIndex.size())
+        return QByteArray();
+
+    Entry entry = mIndex.at(pageNumber);
+
+    // older versions only write the jpegs, and their layout renames them when pages are moved
+    if (entry.size == 0 || mJpegFiles.value(pageNumber) != qMakePair(qint64(entry.size), entry.modified))
+        return QByteArray();
+
+    if (entry.offset + entry.size > quint64(mMapSize))
+        return QByteArray();
+
+    QByteArray data(reinterpret_cast<const char*>(mMap + entry.offset), entry.size);
+
+    locker.unlock();
+
+    // the slot may have been rewritten in place since the index was read
+    if (contentHash(data) != entry.hash)
+        return QByteArray();
+
+    return data;
+}
+
+
+bool UBThumbnailPack::write(const QString& documentPath, int pageNumber, const QByteArray& jpegData, qint64 jpegModified)
+{
+    if (pageNumber < 0 || jpegData.isEmpty())
+        return false;
+
+    QMutexLocker locker(&sWriteMutex);
+
+    QString fileName = documentPath + "/" + packFileName;
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        qCritical() << "cannot open " << fileName << " for writing ...";
+        return false;
+    }
+
+    const Entry emptyEntry = {0, 0, 0, 0, 0};
+
+    QVector<Entry> index;
+    quint64 indexOffset = 0;
+
+    if (!readIndex(file, index, indexOffset))
+    {
+        // missing or damaged, the pack is started again and refilled from the jpegs
+        file.resize(0);
+
+        index = QVector<Entry>(sMinimumIndexCapacity, emptyEntry);
+        indexOffset = sHeaderSize;
+
+        file.write(encodeHeader(index.size(), indexOffset));
+        file.write(encodeIndex(index));
+    }
+
+    bool relocateIndex = pageNumber >= index.size();
+
+    if (relocateIndex)
+        index.insert(index.size(), qMax(index.size() * 2, pageNumber + 1) - index.size(), emptyEntry);
+
+    Entry& entry = index[pageNumber];
+    quint32 size = jpegData.size();
+
+    if (entry.offset == 0 || entry.capacity < size)
+    {
+        // a new slot at the end, with some room so that the next versions of the thumbnail fit in place
+        entry.offset = file.size();
+        entry.capacity = size + size / 4;
+        file.resize(entry.offset + entry.capacity);
+    }
+
+    entry.size = size;
+    entry.hash = contentHash(jpegData);
+    entry.modified = jpegModified;
+
+    bool ok = file.seek(entry.offset) && file.write(jpegData) == jpegData.size();
+
+    // the data is in place before the index refers to it
+    if (ok && relocateIndex)
+    {
+        // the old index is left behind until the pack is compacted
+        quint64 newIndexOffset = file.size();
+
+        ok = file.seek(newIndexOffset) && file.write(encodeIndex(index)) == qint64(index.size()) * sEntrySize
+                && file.seek(0) && file.write(encodeHeader(index.size(), newIndexOffset)) == sHeaderSize;
+    }
+    else if (ok)
+    {
+        QByteArray encodedEntry = encodeIndex(QVector<Entry>() << entry);
+
+        ok = file.seek(indexOffset + quint64(pageNumber) * sEntrySize) && file.write(encodedEntry) == sEntrySize;
+    }
+
+    qint64 usedSize = sHeaderSize + qint64(index.size()) * sEntrySize;
+
+    foreach(const Entry& usedEntry, index)
+        usedSize += usedEntry.capacity;
+
+    bool wasteful = file.size() > 2 * usedSize + sCompactionSlack;
+
+    file.close();
+
+    if (!ok)
+    {
+        qWarning() << "cannot write thumbnail" << pageNumber << "in" << fileName;
+        return false;
+    }
+
+    if (wasteful)
+        compact(fileName, index);
+
+    return true;
+}
+
+
+quint64 UBThumbnailPack::contentHash(const QByteArray& data)
+{
+    QByteArray digest = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+
+    return qFromBigEndian<quint64>(reinterpret_cast<const uchar*>(digest.constData()));
+}
+
+
+bool UBThumbnailPack::readIndex(QFile& file, QVector<Entry>& index, quint64& indexOffset)
+{
+    index.clear();
+
+    if (file.size() < sHeaderSize || !file.seek(0))
+        return false;
+
+    QByteArray header = file.read(sHeaderSize);
+
+    if (header.size() != sHeaderSize)
+        return false;
+
+    const uchar* pos = reinterpret_cast<const uchar*>(header.constData());
+
+    if (qFromBigEndian<quint32>(pos) != sMagic || qFromBigEndian<quint16>(pos + 4) != sVersion)
+        return false;
+
+    quint32 indexCapacity = qFromBigEndian<quint32>(pos + 8);
+    indexOffset = qFromBigEndian<quint64>(pos + 16);
+
+    if (indexOffset < quint64(sHeaderSize) || indexOffset + quint64(indexCapacity) * sEntrySize > quint64(file.size()))
+        return false;
+
+    if (!file.seek(indexOffset))
+        return false;
+
+    QByteArray data = file.read(qint64(indexCapacity) * sEntrySize);
+
+    if (data.size() != qint64(indexCapacity) * sEntrySize)
+        return false;
+
+    index.resize(indexCapacity);
+
+    for (quint32 i = 0; i < indexCapacity; i++)
+    {
+        const uchar* entryData = reinterpret_cast<const uchar*>(data.constData()) + i * sEntrySize;
+        Entry& entry = index[i];
+
+        entry.offset = qFromBigEndian<quint64>(entryData);
+        entry.size = qFromBigEndian<quint32>(entryData + 8);
+        entry.capacity = qFromBigEndian<quint32>(entryData + 12);
+        entry.hash = qFromBigEndian<quint64>(entryData + 16);
+        entry.modified = qFromBigEndian<qint64>(entryData + 24);
+
+        if (entry.size > entry.capacity)
+            entry.size = 0;
+    }
+
+    return true;
+}
+
+
+QByteArray UBThumbnailPack::encodeHeader(quint32 indexCapacity, quint64 indexOffset)
+{
+    QByteArray header(sHeaderSize, 0);
+    uchar* pos = reinterpret_cast<uchar*>(header.data());
+
+    qToBigEndian<quint32>(sMagic, pos);
+    qToBigEndian<quint16>(sVersion, pos + 4);
+    qToBigEndian<quint32>(indexCapacity, pos + 8);
+    qToBigEndian<quint64>(indexOffset, pos + 16);
+
+    return header;
+}
+
+
+QByteArray UBThumbnailPack::encodeIndex(const QVector<Entry>& index)
+{
+    QByteArray data(index.size() * sEntrySize, 0);
+    uchar* pos = reinterpret_cast<uchar*>(data.data());
+
+    foreach(const Entry& entry, index)
+    {
+        qToBigEndian<quint64>(entry.offset, pos);
+        qToBigEndian<quint32>(entry.size, pos + 8);
+        qToBigEndian<quint32>(entry.capacity, pos + 12);
+        qToBigEndian<quint64>(entry.hash, pos + 16);
+        qToBigEndian<qint64>(entry.modified, pos + 24);
+
+        pos += sEntrySize;
+    }
+
+    return data;
+}
+
+
+void UBThumbnailPack::compact(const QString& fileName, const QVector<Entry>& index)
+{
+    QFile source(fileName);
+
+    if (!source.open(QIODevice::ReadOnly))
+        return;
+
+    const Entry emptyEntry = {0, 0, 0, 0, 0};
+
+    QVector<Entry> compacted = index;
+    quint64 dataOffset = sHeaderSize + quint64(index.size()) * sEntrySize;
+    QByteArray data;
+
+    for (int i = 0; i < compacted.size(); i++)
+    {
+        Entry& entry = compacted[i];
+
+        QByteArray jpegData;
+
+        if (entry.size > 0 && source.seek(entry.offset))
+            jpegData = source.read(entry.size);
+
+        if (jpegData.size() != qint64(entry.size) || jpegData.isEmpty())
+        {
+            entry = emptyEntry;
+            continue;
+        }
+
+        entry.offset = dataOffset + data.size();
+        data.append(jpegData);
+        data.append(QByteArray(entry.capacity - entry.size, 0));
+    }
+
+    source.close();
+
+    QSaveFile target(fileName);
+
+    if (!target.open(QIODevice::WriteOnly))
+        return;
+
+    target.write(encodeHeader(compacted.size(), sHeaderSize));
+    target.write(encodeIndex(compacted));
+    target.write(data);
+
+    // replacing the file fails while a reader maps it on some systems, it is compacted another time then
+    if (!target.commit())
+        qWarning() << "cannot compact thumbnail pack" << fileName;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+#ifndef UBTHUMBNAILPACK_H
+#define UBTHUMBNAILPACK_H
+
+#include <QtCore>
+
+/**
+ * All the page thumbnails of a document in a single file, read through a memory mapping.
+ *
+ * The index gives, for every page file number, the offset, size and content hash of its jpeg, and the size and date
+ * of the pageNNN.thumbnail.jpg it was written with; see UBPageManifest for the number of a page. Those files are still written for the export and for older versions;
+ * an entry whose jpeg was since renamed or rewritten elsewhere is ignored, and the thumbnail is read from the file.
+ */
+class UBThumbnailPack
+{
+public:
+    UBThumbnailPack(const QString& documentPath);
+    ~UBThumbnailPack();
+
+    // safe to call from several threads, returns an empty array when the page is not in the pack
+    QByteArray read(int pageNumber);
+
+    // updates the entry of the page in place when the new jpeg fits in its slot
+    static bool write(const QString& documentPath, int pageNumber, const QByteArray& jpegData, qint64 jpegModified);
+
+    static const QString packFileName;
+
+private:
+    struct Entry
+    {
+        quint64 offset;
+        quint32 size;
+        quint32 capacity;
+        quint64 hash;
+        qint64 modified;
+    };
+
+    void open();
+
+    static quint64 contentHash(const QByteArray& data);
+    static bool readIndex(QFile& file, QVector<Entry>& index, quint64& indexOffset);
+    static QByteArray encodeHeader(quint32 indexCapacity, quint64 indexOffset);
+    static QByteArray encodeIndex(const QVector<Entry>& index);
+    static void compact(const QString& fileName, const QVector<Entry>& index);
+
+    QString mDocumentPath;
+    QMutex mMutex;
+    bool mOpened;
+
+    QFile mFile;
+    uchar* mMap;
+    qint64 mMapSize;
+
+    QVector<Entry> mIndex;
+    QHash<int, QPair<qint64, qint64> > mJpegFiles;
+
+    static QMutex sWriteMutex;
+};
+
+#endif // UBTHUMBNAILPACK_H
@@ -2,6 +2,7 @@
 HEADERS      += src/adaptors/UBExportAdaptor.h\
     $$PWD/UBWidgetUpgradeAdaptor.h \
                 src/adaptors/UBExportPDF.h \
+                src/adaptors/UBExportPDFPipeline.h \
                 src/adaptors/UBExportFullPDF.h \
                 src/adaptors/UBExportDocument.h \
                 src/adaptors/UBSvgSubsetAdaptor.h \
@@ -16,12 +17,16 @@ HEADERS      += src/adaptors/UBExportAdaptor.h\
     $$PWD/UBImportDocumentSetAdaptor.h \
     $$PWD/UBExportCFF.h \
     $$PWD/UBImportCFF.h \
-    $$PWD/UBCFFSubsetAdaptor.h
+    $$PWD/UBCFFSubsetAdaptor.h \
+    $$PWD/UBStrokeSidecar.h \
+    $$PWD/UBThumbnailPack.h \
+    $$PWD/UBPageManifest.h
 
 
 SOURCES      += src/adaptors/UBExportAdaptor.cpp\
     $$PWD/UBWidgetUpgradeAdaptor.cpp \
                 src/adaptors/UBExportPDF.cpp \
+                src/adaptors/UBExportPDFPipeline.cpp \
                 src/adaptors/UBExportFullPDF.cpp \
                 src/adaptors/UBExportDocument.cpp \
                 src/adaptors/UBSvgSubsetAdaptor.cpp \
@@ -36,4 +41,7 @@ SOURCES      += src/adaptors/UBExportAdaptor.cpp\
     $$PWD/UBImportDocumentSetAdaptor.cpp \
     $$PWD/UBExportCFF.cpp \
     $$PWD/UBImportCFF.cpp \
-    $$PWD/UBCFFSubsetAdaptor.cpp
+    $$PWD/UBCFFSubsetAdaptor.cpp \
+    $$PWD/UBStrokeSidecar.cpp \
+    $$PWD/UBThumbnailPack.cpp \
+    $$PWD/UBPageManifest.cpp
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+#include "UBBackgroundGrid.h"
+
+#include "core/UBApplication.h"
+#include "core/UBSettings.h"
+
+#include "core/memcheck.h"
+
+// Above this size, in pixels, the few lines that are visible are drawn directly
+static const int sMaxTileSize = 1024;
+
+UBBackgroundGrid* UBBackgroundGrid::sBackgroundGrid = 0;
+
+UBBackgroundGrid* UBBackgroundGrid::backgroundGrid()
+{
+    if (!sBackgroundGrid)
+        sBackgroundGrid = new UBBackgroundGrid(qApp);
+
+    return sBackgroundGrid;
+}
+
+UBBackgroundGrid::UBBackgroundGrid(QObject* parent)
+    : QObject(parent)
+{
+    connect(UBSettings::settings()->boardCrossColorDarkBackground, SIGNAL(changed(QVariant)), this, SLOT(crossColorChanged()));
+    connect(UBSettings::settings()->boardCrossColorLightBackground, SIGNAL(changed(QVariant)), this, SLOT(crossColorChanged()));
+
+    crossColorChanged();
+}
+
+void UBBackgroundGrid::crossColorChanged()
+{
+    // the tiles of the previous colours are keyed by colour, they expire from the pixmap cache
+    mCrossColorDarkBackground = QColor(UBSettings::settings()->boardCrossColorDarkBackground->get().toString());
+    mCrossColorLightBackground = QColor(UBSettings::settings()->boardCrossColorLightBackground->get().toString());
+}
+
+/**
+ * @brief Fill rect with the background of a page
+ * @param zoom The zoom of the page, the grid fades below 0.7 and disappears below 0.5
+ */
+void UBBackgroundGrid::paint(QPainter* painter, const QRectF& rect, UBPageBackground background, qreal gridSize,
+                             bool intermediateLines, bool darkBackground, qreal zoom)
+{
+    QColor backgroundColor = darkBackground ? QColor(Qt::black) : QColor(Qt::white);
+
+    if (background == UBPageBackground::plain || zoom <= 0.5 || gridSize <= 0)
+    {
+        painter->fillRect(rect, backgroundColor);
+        return;
+    }
+
+    QColor lineColor = darkBackground ? mCrossColorDarkBackground : mCrossColorLightBackground;
+
+    if (zoom < 0.7)
+    {
+        int alpha = 255 * zoom / 2;
+        lineColor.setAlpha(alpha); // fade the crossing on small zooms
+    }
+
+    // The lines are drawn with a pen of width 1 in the coordinates of the page
+    QTransform deviceTransform = painter->deviceTransform();
+    qreal penWidth = deviceTransform.m11();
+    int tileSize = qRound(gridSize * penWidth);
+
+    QPaintEngine* engine = painter->paintEngine();
+    bool rasterDevice = engine && (engine->type() == QPaintEngine::Raster || engine->type() == QPaintEngine::OpenGL2);
+
+    // Printers and PDF exports keep vector lines
+    if (!rasterDevice || deviceTransform.isRotating() || tileSize < 2 || tileSize > sMaxTileSize)
+    {
+        painter->fillRect(rect, backgroundColor);
+        drawLines(painter, rect, background, gridSize, intermediateLines, lineColor);
+        return;
+    }
+
+    QString key = QString("UBBackgroundGrid:%1:%2:%3:%4:%5:%6:%7")
+            .arg(background)
+            .arg(gridSize)
+            .arg(tileSize)
+            .arg(darkBackground)
+            .arg(intermediateLines)
+            .arg(lineColor.rgba())
+            .arg(qRound(penWidth * 100));
+
+    QPixmap tile;
+
+    if (!QPixmapCache::find(key, &tile))
+    {
+        tile = renderTile(background, tileSize, penWidth, intermediateLines, backgroundColor, lineColor);
+        QPixmapCache::insert(key, tile);
+    }
+
+    QBrush brush(tile);
+    brush.setTransform(QTransform::fromScale(gridSize / tileSize, gridSize / tileSize));
+
+    painter->fillRect(rect, brush);
+}
+
+/**
+ * @brief Render one period of the grid, whose lines are at the edges of the tile
+ */
+QPixmap UBBackgroundGrid::renderTile(UBPageBackground background, int tileSize, qreal penWidth, bool intermediateLines,
+                                     const QColor& backgroundColor, const QColor& lineColor)
+{
+    QPixmap tile(tileSize, tileSize);
+    tile.fill(backgroundColor);
+
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // each line is drawn on both edges, so that the halves of it meet when the tiles are put together
+    QPen pen(lineColor, penWidth);
+    painter.setPen(pen);
+
+    painter.drawLine(QLineF(0, 0, tileSize, 0));
+    painter.drawLine(QLineF(0, tileSize, tileSize, tileSize));
+
+    if (background == UBPageBackground::crossed)
+    {
+        painter.drawLine(QLineF(0, 0, 0, tileSize));
+        painter.drawLine(QLineF(tileSize, 0, tileSize, tileSize));
+    }
+
+    if (intermediateLines)
+    {
+        QColor intermediateColor = lineColor;
+        intermediateColor.setAlphaF(0.5 * lineColor.alphaF());
+        pen.setColor(intermediateColor);
+        painter.setPen(pen);
+
+        qreal middle = tileSize / 2.0;
+
+        painter.drawLine(QLineF(0, middle, tileSize, middle));
+
+        if (background == UBPageBackground::crossed)
+            painter.drawLine(QLineF(middle, 0, middle, tileSize));
+    }
+
+    return tile;
+}
+
+void UBBackgroundGrid::drawLines(QPainter* painter, const QRectF& rect, UBPageBackground background, qreal gridSize,
+                                 bool intermediateLines, const QColor& lineColor)
+{
+    painter->setPen(lineColor);
+
+    qreal firstY = ((int) (rect.y () / gridSize)) * gridSize;
+
+    for (qreal yPos = firstY; yPos < rect.y () + rect.height (); yPos += gridSize)
+    {
+        painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
+    }
+
+    qreal firstX = ((int) (rect.x () / gridSize)) * gridSize;
+
+    if (background == UBPageBackground::crossed)
+    {
+        for (qreal xPos = firstX; xPos < rect.x () + rect.width (); xPos += gridSize)
+        {
+            painter->drawLine (xPos, rect.y (), xPos, rect.y () + rect.height ());
+        }
+    }
+
+    if (intermediateLines)
+    {
+        QColor intermediateColor = lineColor;
+        intermediateColor.setAlphaF(0.5 * lineColor.alphaF());
+        painter->setPen(intermediateColor);
+
+        for (qreal yPos = firstY - gridSize/2; yPos < rect.y () + rect.height (); yPos += gridSize)
+        {
+            painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
+        }
+
+        if (background == UBPageBackground::crossed)
+        {
+            for (qreal xPos = firstX - gridSize/2; xPos < rect.x () + rect.width (); xPos += gridSize)
+            {
+                painter->drawLine (xPos, rect.y (), xPos, rect.y () + rect.height ());
+            }
+        }
+    }
+}
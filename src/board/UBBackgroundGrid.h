@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+#ifndef UBBACKGROUNDGRID_H_
+#define UBBACKGROUNDGRID_H_
+
+#include <QtGui>
+
+#include "core/UB.h"
+
+/**
+ * @brief Paints the crossed and ruled page backgrounds
+ *
+ * On raster devices, one period of the grid is pre-rendered at the resolution of the device and the background is
+ * filled with it as a tiled brush. The tiles are kept in the QPixmapCache, so that the board views and the scenes
+ * share them.
+ */
+class UBBackgroundGrid : public QObject
+{
+    Q_OBJECT
+
+    public:
+        static UBBackgroundGrid* backgroundGrid();
+
+        void paint(QPainter* painter, const QRectF& rect, UBPageBackground background, qreal gridSize,
+                   bool intermediateLines, bool darkBackground, qreal zoom);
+
+    private slots:
+        void crossColorChanged();
+
+    private:
+        UBBackgroundGrid(QObject* parent = 0);
+
+        static QPixmap renderTile(UBPageBackground background, int tileSize, qreal penWidth, bool intermediateLines,
+                                  const QColor& backgroundColor, const QColor& lineColor);
+        static void drawLines(QPainter* painter, const QRectF& rect, UBPageBackground background, qreal gridSize,
+                              bool intermediateLines, const QColor& lineColor);
+
+        static UBBackgroundGrid* sBackgroundGrid;
+
+        QColor mCrossColorDarkBackground;
+        QColor mCrossColorLightBackground;
+};
+
+#endif /* UBBACKGROUNDGRID_H_ */
@@ -1568,6 +1568,8 @@ void UBBoardController::setActiveDocumentScene(UBDocumentProxy* pDocumentProxy,
         if (mActiveScene && !onImport)
         {
             persistCurrentScene();
+            // the page may have grown while displayed (strokes, rendered PDF zoom levels)
+            UBPersistenceManager::persistenceManager()->updateSceneCost(selectedDocument(), mActiveSceneIndex);
             freezeW3CWidgets(true);
             ClearUndoStack();
         }else
@@ -54,6 +54,7 @@
 #include "gui/UBMainWindow.h"
 #include "gui/UBThumbnailWidget.h"
 
+#include "board/UBBackgroundGrid.h"
 #include "board/UBBoardController.h"
 #include "board/UBBoardPaletteManager.h"
 
@@ -168,7 +169,12 @@ void UBBoardView::init ()
     mMouseButtonIsPressed = false;
     mPendingStylusReleaseEvent = false;
 
-    setCacheMode (QGraphicsView::CacheBackground);
+    mTabletSampleTimer.setSingleShot(true);
+    mTabletSampleTimer.setTimerType(Qt::PreciseTimer);
+    connect(&mTabletSampleTimer, SIGNAL(timeout()), this, SLOT(flushTabletSamples()));
+
+    // the grid is filled with pre-rendered tiles, cheaper than a background cache redrawn at each zoom
+    setCacheMode (QGraphicsView::CacheNone);
 
     mUsingTabletEraser = false;
     mIsCreatingTextZone = false;
@@ -348,7 +354,7 @@ void UBBoardView::tabletEvent (QTabletEvent * event)
 
     UBDrawingController *dc = UBDrawingController::drawingController ();
 
-    QPointF tabletPos = event->pos();
+    QPointF tabletPos = event->posF();
     UBStylusTool::Enum currentTool = (UBStylusTool::Enum)dc->stylusTool ();
 
     if (event->type () == QEvent::TabletPress || event->type () == QEvent::TabletEnterProximity) {
@@ -391,21 +397,31 @@ void UBBoardView::tabletEvent (QTabletEvent * event)
 
     switch (event->type ()) {
     case QEvent::TabletPress: {
+        flushTabletSamples();
+
         mTabletStylusIsPressed = true;
         scene()->inputDevicePress (scenePos, pressure);
 
         break;
     }
     case QEvent::TabletMove: {
-        if (mTabletStylusIsPressed)
-            scene ()->inputDeviceMove (scenePos, pressure);
+        if (mTabletStylusIsPressed) {
+            // The tablet reports samples faster than the screen refreshes, they are drawn together once per frame
+            UBInputSample sample = { scenePos, pressure, static_cast<qint64>(event->timestamp()) };
+            mTabletSamples.append(sample);
 
-        acceptEvent = false; // rerouted to mouse move
+            if (!mTabletSampleTimer.isActive())
+                mTabletSampleTimer.start(tabletSampleInterval());
+        }
+        else
+            acceptEvent = false; // rerouted to mouse move
 
         break;
 
     }
     case QEvent::TabletRelease: {
+        flushTabletSamples();
+
         UBStylusTool::Enum currentTool = (UBStylusTool::Enum)dc->stylusTool ();
         scene ()->setToolCursor (currentTool);
         setToolCursor (currentTool);
@@ -436,6 +452,28 @@ void UBBoardView::tabletEvent (QTabletEvent * event)
 
 }
 
+int UBBoardView::tabletSampleInterval() const
+{
+    QScreen *screen = window()->windowHandle() ? window()->windowHandle()->screen() : QGuiApplication::primaryScreen();
+    qreal refreshRate = screen ? screen->refreshRate() : 60;
+
+    return qMax(1, qRound(1000 / qMax(refreshRate, qreal(1))));
+}
+
+void UBBoardView::flushTabletSamples()
+{
+    mTabletSampleTimer.stop();
+
+    if (mTabletSamples.isEmpty())
+        return;
+
+    QVector<UBInputSample> samples;
+    samples.swap(mTabletSamples);
+
+    if (scene())
+        scene()->inputDeviceMove(samples);
+}
+
 bool UBBoardView::itemIsLocked(QGraphicsItem *item)
 {
     if (!item)
@@ -1526,6 +1564,7 @@ void UBBoardView::forcedTabletRelease ()
         qWarning () << "mPendingStylusReleaseEvent" << mPendingStylusReleaseEvent;
         qWarning () << "forcing device release";
 
+        flushTabletSamples();
         scene ()->inputDeviceRelease ();
 
         mMouseButtonIsPressed = false;
@@ -1673,90 +1712,16 @@ void UBBoardView::drawBackground (QPainter *painter, const QRectF &rect)
 
     bool darkBackground = scene () && scene ()->isDarkBackground ();
 
-    if (darkBackground)
+    if (scene ())
     {
-        painter->fillRect (rect, QBrush (QColor (Qt::black)));
+        UBBackgroundGrid::backgroundGrid()->paint(painter, rect, scene()->pageBackground(), scene()->backgroundGridSize(),
+                                                  scene()->intermediateLines(), darkBackground, transform ().m11 ());
     }
     else
     {
         painter->fillRect (rect, QBrush (QColor (Qt::white)));
     }
 
-    if (transform ().m11 () > 0.5)
-    {
-        QColor bgCrossColor;
-
-        if (darkBackground)
-            bgCrossColor = QColor(UBSettings::settings()->boardCrossColorDarkBackground->get().toString());
-        else
-            bgCrossColor = QColor(UBSettings::settings()->boardCrossColorLightBackground->get().toString());
-
-        if (transform ().m11 () < 0.7)
-        {
-            int alpha = 255 * transform ().m11 () / 2;
-            bgCrossColor.setAlpha (alpha); // fade the crossing on small zooms
-        }
-
-        qreal gridSize = scene()->backgroundGridSize();
-        bool intermediateLines = scene()->intermediateLines();
-
-        painter->setPen (bgCrossColor);
-
-        if (scene () && scene ()->pageBackground() == UBPageBackground::crossed)
-        {
-            qreal firstY = ((int) (rect.y () / gridSize)) * gridSize;
-
-            for (qreal yPos = firstY; yPos < rect.y () + rect.height (); yPos += gridSize)
-            {
-                painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
-            }
-
-            qreal firstX = ((int) (rect.x () / gridSize)) * gridSize;
-
-            for (qreal xPos = firstX; xPos < rect.x () + rect.width (); xPos += gridSize)
-            {
-                painter->drawLine (xPos, rect.y (), xPos, rect.y () + rect.height ());
-            }
-
-            if (intermediateLines) {
-                QColor intermediateColor = bgCrossColor;
-                intermediateColor.setAlphaF(0.5 * bgCrossColor.alphaF());
-                painter->setPen(intermediateColor);
-
-                for (qreal yPos = firstY - gridSize/2; yPos < rect.y () + rect.height (); yPos += gridSize)
-                {
-                    painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
-                }
-
-                for (qreal xPos = firstX - gridSize/2; xPos < rect.x () + rect.width (); xPos += gridSize)
-                {
-                    painter->drawLine (xPos, rect.y (), xPos, rect.y () + rect.height ());
-                }
-            }
-        }
-
-        if (scene() && scene()->pageBackground() == UBPageBackground::ruled)
-        {
-            qreal firstY = ((int) (rect.y () / gridSize)) * gridSize;
-
-            for (qreal yPos = firstY; yPos < rect.y () + rect.height (); yPos += gridSize)
-            {
-                painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
-            }
-
-            if (intermediateLines) {
-                QColor intermediateColor = bgCrossColor;
-                intermediateColor.setAlphaF(0.5 * bgCrossColor.alphaF());
-                painter->setPen(intermediateColor);
-
-                for (qreal yPos = firstY - gridSize/2; yPos < rect.y () + rect.height (); yPos += gridSize)
-                {
-                    painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
-                }
-            }
-        }
-    }
-
     if (!mFilterZIndex && scene ())
     {
         QSize pageNominalSize = scene ()->nominalSize ();
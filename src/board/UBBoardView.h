@@ -42,6 +42,7 @@ class UBBoardController;
 class UBGraphicsScene;
 class UBGraphicsWidgetItem;
 class UBRubberBand;
+struct UBInputSample;
 
 class UBBoardView : public QGraphicsView
 {
@@ -135,6 +136,11 @@ private:
     bool mTabletStylusIsPressed;
     bool mUsingTabletEraser;
 
+    // tablet samples received since the last frame, sent to the scene together
+    QVector<UBInputSample> mTabletSamples;
+    QTimer mTabletSampleTimer;
+    int tabletSampleInterval() const;
+
     bool mPendingStylusReleaseEvent;
 
     bool mMouseButtonIsPressed;
@@ -204,6 +210,7 @@ private:
 private slots:
     void settingChanged(QVariant newValue);
     void movingItemDestroyed(QObject* item = nullptr);
+    void flushTabletSamples();
 
 public slots:
     void virtualKeyboardActivated(bool b);
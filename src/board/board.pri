@@ -1,11 +1,13 @@
 
-HEADERS      += src/board/UBBoardController.h \
+HEADERS      += src/board/UBBackgroundGrid.h \
+                src/board/UBBoardController.h \
                 src/board/UBBoardPaletteManager.h \
                 src/board/UBBoardView.h \
                 src/board/UBDrawingController.h \
 		src/board/UBFeaturesController.h
 
-SOURCES      += src/board/UBBoardController.cpp \
+SOURCES      += src/board/UBBackgroundGrid.cpp \
+                src/board/UBBoardController.cpp \
                 src/board/UBBoardPaletteManager.cpp \
                 src/board/UBBoardView.cpp \
                 src/board/UBDrawingController.cpp \
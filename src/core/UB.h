@@ -173,6 +173,7 @@ struct UBGraphicsItemType
         GraphicsWidgetItemType,                         //65556
         UserTypesCount,                                 //65557
         AxesItemType,                                   //65558
+        LiveStrokeItemType,                             //65559
         SelectionFrameType                              // this line must be the last line in this enum because it is types counter.
     };
 };
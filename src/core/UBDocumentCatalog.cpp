@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+
+
+#include "UBDocumentCatalog.h"
+
+#include "core/UBPersistenceManager.h"
+#include "core/UBSettings.h"
+
+#include "adaptors/UBMetadataDcSubsetAdaptor.h"
+
+#include "core/memcheck.h"
+
+const QString UBDocumentCatalog::catalogFileName = "catalog.dat";
+
+static const quint32 catalogMagic = 0x55424443; // "UBDC"
+static const quint32 catalogVersion = 1;
+
+static qint64 modificationTime(const QString& path)
+{
+    QFileInfo info(path);
+    return info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+bool UBDocumentCatalog::load(const QString& repositoryPath, QList<Entry>& entries)
+{
+    QFile file(repositoryPath + "/" + catalogFileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+
+    in >> magic >> version;
+
+    if (magic != catalogMagic || version != catalogVersion)
+        return false;
+
+    in >> count;
+
+    QDir repositoryDir(repositoryPath);
+    QList<Entry> loadedEntries;
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        Entry entry;
+        QString directoryName;
+        qint32 pageCount = 0;
+
+        in >> directoryName >> entry.directoryModified >> entry.metadataModified >> pageCount >> entry.metadata;
+
+        // same form as the paths listed by the repository scan
+        entry.path = QFileInfo(repositoryDir, directoryName).absoluteFilePath();
+        entry.pageCount = pageCount;
+
+        loadedEntries << entry;
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        qWarning() << "Unreadable document catalog" << file.fileName();
+        return false;
+    }
+
+    entries = loadedEntries;
+
+    return true;
+}
+
+bool UBDocumentCatalog::save(const QString& repositoryPath, const QList<Entry>& entries)
+{
+    QSaveFile file(repositoryPath + "/" + catalogFileName);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Cannot write document catalog" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << catalogMagic << catalogVersion << quint32(entries.size());
+
+    foreach (const Entry& entry, entries)
+    {
+        out << QFileInfo(entry.path).fileName() << entry.directoryModified << entry.metadataModified
+            << qint32(entry.pageCount) << entry.metadata;
+    }
+
+    return file.commit();
+}
+
+UBDocumentCatalog::Reconciliation UBDocumentCatalog::reconcile(const QString& repositoryPath, const QList<Entry>& catalogEntries)
+{
+    Reconciliation result;
+
+    QHash<QString, int> catalogIndexes;
+
+    for (int i = 0; i < catalogEntries.size(); i++)
+        catalogIndexes.insert(catalogEntries.at(i).path, i);
+
+    QDir repositoryDir(repositoryPath);
+    QFileInfoList contentInfoList = repositoryDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed);
+
+    QSet<QString> documentPaths;
+    bool catalogChanged = false;
+
+    foreach (const QFileInfo& contentInfo, contentInfoList)
+    {
+        QString path = contentInfo.absoluteFilePath();
+        int catalogIndex = catalogIndexes.value(path, -1);
+
+        if (catalogIndex >= 0 && isUpToDate(catalogEntries.at(catalogIndex)))
+        {
+            result.entries << catalogEntries.at(catalogIndex);
+            documentPaths << path;
+            continue;
+        }
+
+        Entry entry;
+        catalogChanged = true;
+
+        if (read(path, entry))
+        {
+            result.entries << entry;
+            documentPaths << path;
+
+            if (catalogIndex >= 0)
+                result.changedPaths << path;
+        }
+    }
+
+    foreach (const Entry& entry, catalogEntries)
+    {
+        if (!documentPaths.contains(entry.path))
+        {
+            result.removedPaths << entry.path;
+            catalogChanged = true;
+        }
+    }
+
+    if (catalogChanged)
+        save(repositoryPath, result.entries);
+
+    return result;
+}
+
+bool UBDocumentCatalog::read(const QString& documentPath, Entry& entry)
+{
+    // times are taken first, so that a change made while reading leaves the entry out of date
+    entry.path = documentPath;
+    entry.directoryModified = modificationTime(documentPath);
+    entry.metadataModified = modificationTime(documentPath + "/" + UBMetadataDcSubsetAdaptor::metadataFilename);
+
+    QDir dir(documentPath);
+
+    if (dir.entryList(QDir::Files | QDir::NoDotAndDotDot).isEmpty())
+        return false;
+
+    entry.metadata = UBMetadataDcSubsetAdaptor::load(documentPath);
+
+    if (entry.metadata.value(UBSettings::documentName, QString()).toString().isEmpty())
+        return false;
+
+    entry.pageCount = UBPersistenceManager::sceneCount(documentPath);
+
+    return true;
+}
+
+bool UBDocumentCatalog::isUpToDate(const Entry& entry)
+{
+    return entry.directoryModified != 0
+        && modificationTime(entry.path) == entry.directoryModified
+        && modificationTime(entry.path + "/" + UBMetadataDcSubsetAdaptor::metadataFilename) == entry.metadataModified;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#ifndef UBDOCUMENTCATALOG_H
+#define UBDOCUMENTCATALOG_H
+
+#include <QtCore>
+
+/**
+ * The metadata and page count of every document of the repository, kept in a single file.
+ *
+ * Startup fills the document tree from the catalog instead of reading the metadata.rdf and counting the pages
+ * of every document, then reconciles it with the repository in the background. An entry stays valid while the
+ * modification times of its directory and of its metadata.rdf are unchanged: adding, removing or renaming a page
+ * changes the directory, saving the metadata changes the file.
+ */
+class UBDocumentCatalog
+{
+public:
+    struct Entry
+    {
+        Entry() : directoryModified(0), metadataModified(0), pageCount(0) {}
+
+        QString path;
+        qint64 directoryModified;
+        qint64 metadataModified;
+        QMap<QString, QVariant> metadata;
+        int pageCount;
+    };
+
+    struct Reconciliation
+    {
+        QList<Entry> entries;
+        QSet<QString> changedPaths;  // catalog entries that were out of date, and were read again
+        QSet<QString> removedPaths;  // catalog entries whose document is gone
+    };
+
+    // returns false when there is no catalog, or it is unreadable or of another version
+    static bool load(const QString& repositoryPath, QList<Entry>& entries);
+    static bool save(const QString& repositoryPath, const QList<Entry>& entries);
+
+    // runs on a worker thread, only the documents that changed since the catalog was saved are read;
+    // the catalog is saved again when it was out of date
+    static Reconciliation reconcile(const QString& repositoryPath, const QList<Entry>& catalogEntries);
+
+    // false when the directory holds no document; the repository scan reads the documents this way too,
+    // and so writes the first catalog without reading them again
+    static bool read(const QString& documentPath, Entry& entry);
+
+    static const QString catalogFileName;
+
+private:
+    static bool isUpToDate(const Entry& entry);
+};
+
+#endif // UBDOCUMENTCATALOG_H
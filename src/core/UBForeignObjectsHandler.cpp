@@ -30,6 +30,8 @@
 #include <QtXml>
 #include "UBSettings.h"
 
+#include "adaptors/UBPageManifest.h"
+
 const QString tVideo = "video";
 const QString tAudio = "audio";
 const QString tImage = "image";
@@ -45,6 +47,8 @@ const QString aSrc = "ub:src";
 const QString aMediaType = "mediaType";
 const QString aRelativePath = "relativePath";
 const QString aActionMedia = "ub:actionFirstParameter";
+const QString aStrokes = "ub:strokes";
+const QString aUuid = "ub:uuid";
 
 const QString vText = "text";
 const QString vReqExt = "http://ns.adobe.com/pdf/1.3/";
@@ -152,12 +156,6 @@ static QString thumbFileNameFrom(const QString &filePath)
     return thumbPath;
 }
 
-
-QString svgPageName(int pageIndex)
-{
-    return QString("page%1.svg").arg(pageIndex, 3, 10, QLatin1Char('0'));
-}
-
 static QDomDocument createDomFromSvg(const QString &svgUrl)
 {
     Q_ASSERT(QFile::exists(svgUrl));
@@ -485,8 +483,8 @@ public:
         mFromIndex = fromIndex;
         mToIndex = toIndex;
 
-        QString svgFrom = mFromDir + "/" + svgPageName(fromIndex);
-        QString svgTo = toDir.toLocalFile() + "/" + svgPageName(toIndex);
+        QString svgFrom = UBPageManifest::pageSvgPath(mFromDir, fromIndex);
+        QString svgTo = UBPageManifest::pageSvgPath(mToDir, toIndex);
         QDomDocument dd = createDomFromSvg(svgFrom);
         QFile fl(svgTo);
         if (!fl.open(QIODevice::WriteOnly)) {
@@ -494,6 +492,7 @@ public:
             return;
         }
         cureIdsFromSvgDom(dd);
+        cureStrokesFromSvgRoot(dd.documentElement());
 
         QTextStream str(&fl);
         dd.save(str, 0);
@@ -562,6 +561,18 @@ private:
         }
     }
 
+    void cureStrokesFromSvgRoot(QDomElement root)
+    {
+        if (!root.hasAttribute(aStrokes))
+            return;
+
+        QString newRelative = cureNCopy(root.attribute(aStrokes));
+        root.setAttribute(aStrokes, newRelative);
+
+        // the stroke file is named after the page uuid, give the copy the uuid of its own file
+        root.setAttribute(aUuid, QFileInfo(newRelative).completeBaseName());
+    }
+
     QString cureNCopy(const QString &relativePath, bool createNewUuid=true)
     {
         QString relative = relativePath;
@@ -50,6 +50,8 @@
 #include "adaptors/UBSvgSubsetAdaptor.h"
 #include "adaptors/UBThumbnailAdaptor.h"
 #include "adaptors/UBMetadataDcSubsetAdaptor.h"
+#include "adaptors/UBPageManifest.h"
+#include "adaptors/UBThumbnailPack.h"
 
 #include "domain/UBGraphicsMediaItem.h"
 #include "domain/UBGraphicsWidgetItem.h"
@@ -69,6 +71,7 @@ const QString UBPersistenceManager::widgetDirectory = "widgets"; // added to UBP
 const QString UBPersistenceManager::videoDirectory = "videos"; // added to UBPersistenceManager::mAllDirectories
 const QString UBPersistenceManager::audioDirectory = "audios"; // added to
 const QString UBPersistenceManager::fileDirectory = "files"; // Issue 1683 (Evolution) - AOU - 20131206
+const QString UBPersistenceManager::strokeDirectory = "strokes"; // added to UBPersistenceManager::mAllDirectories
 
 const QString UBPersistenceManager::myDocumentsName = "MyDocuments";
 const QString UBPersistenceManager::modelsName = "Models";
@@ -82,6 +85,11 @@ UBPersistenceManager * UBPersistenceManager::sSingleton = 0;
 UBPersistenceManager::UBPersistenceManager(QObject *pParent)
     : QObject(pParent)
     , mHasPurgedDocuments(false)
+    , mPrefetchGeneration(0)
+    , mPrefetchDocument(0)
+    , mPrefetchIndex(0)
+    , mIsWorkerFinished(false)
+    , mIsApplicationClosing(false)
 {
 
     xmlFolderStructureFilename = "model";
@@ -92,30 +100,30 @@ UBPersistenceManager::UBPersistenceManager(QObject *pParent)
     mDocumentSubDirectories << videoDirectory;
     mDocumentSubDirectories << audioDirectory;
     mDocumentSubDirectories << fileDirectory; // Issue 1683 (Evolution) - AOU - 20131206
+    mDocumentSubDirectories << strokeDirectory;
 
     mDocumentRepositoryPath = UBSettings::userDocumentDirectory();
     mFoldersXmlStorageName =  mDocumentRepositoryPath + "/" + fFolders;
 
     mDocumentTreeStructureModel = new UBDocumentTreeModel(this);
+
+    connect(&mCatalogWatcher, SIGNAL(finished()), this, SLOT(onCatalogReconciled()));
+
     createDocumentProxiesStructure();
 
     emit proxyListChanged();
 
-    mThread = new QThread;
+    qRegisterMetaType<UBSvgPreparedScene>("UBSvgPreparedScene");
+
     mWorker = new UBPersistenceWorker();
-    mWorker->moveToThread(mThread);
 
     connect(mWorker, SIGNAL(error(QString)), this, SLOT(errorString(QString)));
-    connect(mThread, SIGNAL(started()), mWorker, SLOT(process()));
-    connect(mWorker, SIGNAL(finished()), mThread, SLOT(quit()));
     connect(mWorker, SIGNAL(finished()), this, SLOT(onWorkerFinished()));
     connect(mWorker, SIGNAL(finished()), mWorker, SLOT(deleteLater()));
-    connect(mThread, SIGNAL(finished()), mThread, SLOT(deleteLater()));
-    connect(mWorker, SIGNAL(sceneLoaded(QByteArray,UBDocumentProxy*,int)), this, SLOT(onSceneLoaded(QByteArray,UBDocumentProxy*,int)));
-    connect(mWorker, SIGNAL(scenePersisted(UBGraphicsScene*)), this, SLOT(onScenePersisted(UBGraphicsScene*)));
+    connect(mWorker, SIGNAL(sceneLoaded(UBSvgPreparedScene,UBDocumentProxy*,int,int)), this, SLOT(onSceneLoaded(UBSvgPreparedScene,UBDocumentProxy*,int,int)));
     connect(mWorker, SIGNAL(metadataPersisted(UBDocumentProxy*)), this, SLOT(onMetadataPersisted(UBDocumentProxy*)));
 
-    mThread->start();
+    mWorker->start();
 }
 
 UBPersistenceManager* UBPersistenceManager::persistenceManager()
@@ -135,14 +143,6 @@ void UBPersistenceManager::destroy()
     sSingleton = NULL;
 }
 
-void UBPersistenceManager::onScenePersisted(UBGraphicsScene* scene)
-{
-    if (!mIsApplicationClosing) {
-        delete scene;
-        scene = NULL;
-    }
-}
-
 void UBPersistenceManager::onMetadataPersisted(UBDocumentProxy* proxy)
 {
     delete proxy;
@@ -168,6 +168,9 @@ UBPersistenceManager::~UBPersistenceManager()
         QCoreApplication::processEvents(QEventLoop::AllEvents, 100);
     qDebug() << "stop waiting after " << t.elapsed() << " ms";
 
+    // the reconciliation may still be writing the catalog
+    mCatalogWatcher.waitForFinished();
+
     // to be sure that all the scenes are stored on disk
 }
 
@@ -176,57 +179,83 @@ void UBPersistenceManager::errorString(QString error)
     qWarning() << "An error occured in the peristence thread " << error;
 }
 
-void UBPersistenceManager::onSceneLoaded(QByteArray scene, UBDocumentProxy* proxy, int sceneIndex)
+void UBPersistenceManager::onSceneLoaded(UBSvgPreparedScene preparedScene, UBDocumentProxy* proxy, int sceneIndex, int generation)
 {
-    Q_UNUSED(scene);
+    // pages were moved or deleted since the request, or the user went elsewhere meanwhile
+    if (generation != mPrefetchGeneration || proxy != mPrefetchDocument)
+        return;
+
+    int window = UBSettings::settings()->pagePrefetchWindow->get().toInt();
+
+    if (qAbs(sceneIndex - mPrefetchIndex) > window || mSceneCache.contains(proxy, sceneIndex) || preparedScene.xmlData.isEmpty())
+        return;
+
     qDebug() << "scene loaded " << sceneIndex;
-    QTime time;
+    QElapsedTimer time;
     time.start();
-    mSceneCache.insert(proxy, sceneIndex, loadDocumentScene(proxy, sceneIndex, false));
+
+    UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(proxy, preparedScene);
+
+    if (scene)
+        mSceneCache.insert(proxy, sceneIndex, scene);
+
     qDebug() << "millisecond for sceneCache " << time.elapsed();
 }
 
-void UBPersistenceManager::createDocumentProxiesStructure(const QFileInfoList &contentInfoList, bool interactive)
+QList<UBDocumentCatalog::Entry> UBPersistenceManager::createDocumentProxiesStructure(const QFileInfoList &contentInfoList, bool interactive)
 {
     // Create a QFutureWatcher and connect signals and slots.
-    QFutureWatcher<UBDocumentProxy*> futureWatcher;
+    QFutureWatcher<UBDocumentCatalog::Entry> futureWatcher;
     QObject::connect(&futureWatcher, &QFutureWatcher<void>::finished, &mProgress, &QProgressDialog::reset);
     QObject::connect(&futureWatcher,  &QFutureWatcher<void>::progressRangeChanged, &mProgress, &QProgressDialog::setRange);
     QObject::connect(&futureWatcher, &QFutureWatcher<void>::progressValueChanged,  &mProgress, &QProgressDialog::setValue);
 
-    // Start the computation.
-    std::function<UBDocumentProxy* (QFileInfo contentInfo)> createDocumentProxyLambda = [=](QFileInfo contentInfo) {
-        return createDocumentProxyStructure(contentInfo);
+    // Start the computation, the documents are read as the catalog would read them so that the scan can fill it.
+    std::function<UBDocumentCatalog::Entry (QFileInfo contentInfo)> readDocumentLambda = [=](QFileInfo contentInfo) {
+        UBDocumentCatalog::Entry entry;
+
+        if (!UBDocumentCatalog::read(contentInfo.absoluteFilePath(), entry))
+            entry.path.clear();
+
+        return entry;
     };
 
-    QFuture<UBDocumentProxy*> proxiesFuture = QtConcurrent::mapped(contentInfoList, createDocumentProxyLambda);
-    futureWatcher.setFuture(proxiesFuture);
+    QFuture<UBDocumentCatalog::Entry> entriesFuture = QtConcurrent::mapped(contentInfoList, readDocumentLambda);
+    futureWatcher.setFuture(entriesFuture);
 
     // Display the dialog and start the event loop.
     mProgress.exec();
 
     futureWatcher.waitForFinished();
 
-    QList<UBDocumentProxy*> proxies = futureWatcher.future().results();
+    QList<UBDocumentCatalog::Entry> entries;
 
-    for (auto&& proxy : qAsConst(proxies))
+    foreach (const UBDocumentCatalog::Entry& entry, futureWatcher.future().results())
     {
-        if (proxy)
-        {
-            QString docGroupName = proxy->metaData(UBSettings::documentGroupName).toString();
-            QModelIndex parentIndex = mDocumentTreeStructureModel->goTo(docGroupName);
-            if (parentIndex.isValid())
-            {
-                if (!interactive)
-                   mDocumentTreeStructureModel->addDocument(proxy, parentIndex);
-                else
-                   processInteractiveReplacementDialog(proxy);
-            }
-            else
-            {
-                qDebug() << "something went wrong";
-            }
-        }
+        if (entry.path.isEmpty())
+            continue;
+
+        addDocumentProxyToTree(createDocumentProxyStructure(entry), interactive);
+        entries << entry;
+    }
+
+    return entries;
+}
+
+void UBPersistenceManager::addDocumentProxyToTree(UBDocumentProxy* proxy, bool interactive)
+{
+    QString docGroupName = proxy->metaData(UBSettings::documentGroupName).toString();
+    QModelIndex parentIndex = mDocumentTreeStructureModel->goTo(docGroupName);
+    if (parentIndex.isValid())
+    {
+        if (!interactive)
+           mDocumentTreeStructureModel->addDocument(proxy, parentIndex);
+        else
+           processInteractiveReplacementDialog(proxy);
+    }
+    else
+    {
+        qDebug() << "something went wrong";
     }
 }
 
@@ -237,13 +266,25 @@ void UBPersistenceManager::createDocumentProxiesStructure(bool interactive)
     QDir rootDir(mDocumentRepositoryPath);
     rootDir.mkpath(rootDir.path());
 
-    QFileInfoList contentInfoList = rootDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed);
+    QList<UBDocumentCatalog::Entry> catalogEntries;
+    bool catalogLoaded = !interactive && UBDocumentCatalog::load(mDocumentRepositoryPath, catalogEntries);
 
-    mProgress.setWindowFlags(Qt::Window | Qt::WindowTitleHint | Qt::CustomizeWindowHint);
-    mProgress.setLabelText(tr("Retrieving all your documents (found : %1)").arg(contentInfoList.size()));
-    mProgress.setCancelButton(nullptr);
+    if (catalogLoaded)
+    {
+        // the tree is filled from the catalog at once, the repository is checked against it in the background
+        foreach (const UBDocumentCatalog::Entry& entry, catalogEntries)
+            addDocumentProxyToTree(createDocumentProxyStructure(entry), interactive);
+    }
+    else
+    {
+        QFileInfoList contentInfoList = rootDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed);
+
+        mProgress.setWindowFlags(Qt::Window | Qt::WindowTitleHint | Qt::CustomizeWindowHint);
+        mProgress.setLabelText(tr("Retrieving all your documents (found : %1)").arg(contentInfoList.size()));
+        mProgress.setCancelButton(nullptr);
 
-    createDocumentProxiesStructure(contentInfoList, interactive);
+        catalogEntries = createDocumentProxiesStructure(contentInfoList, interactive);
+    }
 
     if (QFileInfo(mFoldersXmlStorageName).exists()) {
         QDomDocument xmlDom;
@@ -268,38 +309,89 @@ void UBPersistenceManager::createDocumentProxiesStructure(bool interactive)
                      << "Error:" << inFile.errorString();
         }
     }
+
+    if (interactive)
+        return;
+
+    // the first catalog comes from the scan, that just read every document
+    if (!catalogLoaded)
+        UBDocumentCatalog::save(mDocumentRepositoryPath, catalogEntries);
+    else if (!mCatalogWatcher.isRunning())
+        mCatalogWatcher.setFuture(QtConcurrent::run(&UBDocumentCatalog::reconcile, mDocumentRepositoryPath, catalogEntries));
+}
+
+UBDocumentProxy* UBPersistenceManager::createDocumentProxyStructure(const UBDocumentCatalog::Entry& entry)
+{
+    UBDocumentProxy* docProxy = new UBDocumentProxy(entry.path); // managed in UBDocumentTreeNode
+    foreach(QString key, entry.metadata.keys()) {
+        docProxy->setMetaData(key, entry.metadata.value(key));
+    }
+
+    docProxy->setPageCount(entry.pageCount);
+
+    return docProxy;
+}
+
+void UBPersistenceManager::collectDocumentProxies(UBDocumentTreeNode* node, QHash<QString, UBDocumentProxy*>& proxies) const
+{
+    foreach (UBDocumentTreeNode* child, node->children())
+    {
+        if (child->proxyData())
+            proxies.insert(child->proxyData()->persistencePath(), child->proxyData());
+        else
+            collectDocumentProxies(child, proxies);
+    }
 }
 
-UBDocumentProxy* UBPersistenceManager::createDocumentProxyStructure(QFileInfo& contentInfo)
+void UBPersistenceManager::onCatalogReconciled()
 {
-    QString fullPath = contentInfo.absoluteFilePath();
-    QDir dir(fullPath);
+    UBDocumentCatalog::Reconciliation reconciliation = mCatalogWatcher.result();
 
-    if (dir.entryList(QDir::Files | QDir::NoDotAndDotDot).size() > 0)
+    if (mIsApplicationClosing)
+        return;
+
+    QHash<QString, UBDocumentProxy*> proxies;
+    collectDocumentProxies(mDocumentTreeStructureModel->rootNode(), proxies);
+
+    // the document on the board holds changes the disk does not know about yet
+    UBDocumentProxy* selectedDocument = UBApplication::boardController ? UBApplication::boardController->selectedDocument() : 0;
+
+    foreach (const UBDocumentCatalog::Entry& entry, reconciliation.entries)
     {
-        QMap<QString, QVariant> metadatas = UBMetadataDcSubsetAdaptor::load(fullPath);
-        QString docGroupName = metadatas.value(UBSettings::documentGroupName, QString()).toString();
-        QString docName = metadatas.value(UBSettings::documentName, QString()).toString();
+        UBDocumentProxy* proxy = proxies.value(entry.path);
 
-        if (docName.isEmpty()) {
-            qDebug() << "Group name and document name are empty in UBPersistenceManager::createDocumentProxiesStructure()";
-            return nullptr;
+        if (!proxy)
+        {
+            // deleted from the tree while the catalog was reconciled
+            if (QFileInfo(entry.path).exists())
+                addDocumentProxyToTree(createDocumentProxyStructure(entry), false);
         }
+        else if (reconciliation.changedPaths.contains(entry.path) && proxy != selectedDocument && !proxy->isModified())
+        {
+            foreach(QString key, entry.metadata.keys()) {
+                proxy->setMetaData(key, entry.metadata.value(key));
+            }
 
-        UBDocumentProxy* docProxy = new UBDocumentProxy(fullPath); // managed in UBDocumentTreeNode
-        foreach(QString key, metadatas.keys()) {
-            docProxy->setMetaData(key, metadatas.value(key));
+            proxy->setPageCount(entry.pageCount);
         }
+    }
 
-        docProxy->setPageCount(sceneCount(docProxy));
+    foreach (const QString& path, reconciliation.removedPaths)
+    {
+        UBDocumentProxy* proxy = proxies.value(path);
 
-        docProxy->moveToThread(UBApplication::instance()->thread());
+        if (!proxy || proxy == selectedDocument || QFileInfo(path).exists())
+            continue;
 
-        return docProxy;
-    }
+        QModelIndex index = mDocumentTreeStructureModel->indexForProxy(proxy);
 
-    return nullptr;
-};
+        if (index.isValid())
+        {
+            emit documentWillBeDeleted(proxy);
+            mDocumentTreeStructureModel->removeRow(index.row(), index.parent());
+        }
+    }
+}
 
 QDialog::DialogCode UBPersistenceManager::processInteractiveReplacementDialog(UBDocumentProxy *pProxy)
 {
@@ -398,6 +490,12 @@ QString UBPersistenceManager::adjustDocumentVirtualPath(const QString &str)
 
 void UBPersistenceManager::closing()
 {
+    mSceneCache.dumpStatistics();
+    UBSvgSubsetAdaptor::dumpParseStatistics();
+
+    if (mWorker)
+        mWorker->dumpStatistics();
+
     QDir rootDir(mDocumentRepositoryPath);
     rootDir.mkpath(rootDir.path());
 
@@ -616,15 +714,17 @@ UBDocumentProxy* UBPersistenceManager::createDocumentFromDir(const QString& pDoc
 
     QMap<QString, QVariant> metadatas = UBMetadataDcSubsetAdaptor::load(pDocumentDirectory);
 
-    if(withEmptyPage) createDocumentSceneAt(doc, 0);
-    if(addTitlePage) persistDocumentScene(doc, mSceneCache.createScene(doc, 0, false), 0);
-
     foreach(QString key, metadatas.keys())
     {
         doc->setMetaData(key, metadatas.value(key));
     }
 
+    // the final uuid must be known before any page is cached, as it is part of the cache key
     doc->setUuid(QUuid::createUuid());
+
+    if(withEmptyPage) createDocumentSceneAt(doc, 0);
+    if(addTitlePage) persistDocumentScene(doc, mSceneCache.createScene(doc, 0, false), 0);
+
     doc->setPageCount(sceneCount(doc));
 
     for(int i = 0; i < doc->pageCount(); i++)
@@ -632,6 +732,9 @@ UBDocumentProxy* UBPersistenceManager::createDocumentFromDir(const QString& pDoc
         UBSvgSubsetAdaptor::setSceneUuid(doc, i, QUuid::createUuid());
     }
 
+    // the pages got stroke files named after their new uuid
+    purgeStrokeSidecars(doc);
+
     //work around the
     bool addDoc = false;
     if (!promptDialogIfExists) {
@@ -656,6 +759,7 @@ UBDocumentProxy* UBPersistenceManager::createDocumentFromDir(const QString& pDoc
 void UBPersistenceManager::deleteDocument(UBDocumentProxy* pDocumentProxy)
 {
     checkIfDocumentRepositoryExists();
+    cancelPrefetch();
 
     emit documentWillBeDeleted(pDocumentProxy);
 
@@ -663,6 +767,7 @@ void UBPersistenceManager::deleteDocument(UBDocumentProxy* pDocumentProxy)
         UBFileSystemUtils::deleteDir(pDocumentProxy->persistencePath());
 
     mSceneCache.removeAllScenes(pDocumentProxy);
+    UBPageManifest::forget(pDocumentProxy->persistencePath());
 
     pDocumentProxy->deleteLater();
 }
@@ -683,6 +788,8 @@ UBDocumentProxy* UBPersistenceManager::duplicateDocument(UBDocumentProxy* pDocum
         UBSvgSubsetAdaptor::setSceneUuid(pDocumentProxy, i, QUuid::createUuid());
     }
 
+    purgeStrokeSidecars(pDocumentProxy);
+
     foreach(QString key, pDocumentProxy->metaDatas().keys())
     {
         copy->setMetaData(key, pDocumentProxy->metaDatas().value(key));
@@ -709,6 +816,7 @@ UBDocumentProxy* UBPersistenceManager::duplicateDocument(UBDocumentProxy* pDocum
 void UBPersistenceManager::deleteDocumentScenes(UBDocumentProxy* proxy, const QList<int>& indexes)
 {
     checkIfDocumentRepositoryExists();
+    cancelPrefetch();
 
     int pageCount = UBPersistenceManager::persistenceManager()->sceneCount(proxy);
 
@@ -753,29 +861,31 @@ void UBPersistenceManager::deleteDocumentScenes(UBDocumentProxy* proxy, const QL
         }
     }
 
-    for (int i = 1; i < pageCount; i++)
-    {
-        renamePage(trashDocProxy, i , i - 1);
-    }
+    std::sort(compactedIndexes.begin(), compactedIndexes.end());
 
-    foreach(int index, compactedIndexes)
+    // the files of the queued saves were chosen before the pages are renumbered
+    mWorker->waitForWrites(proxy);
+
+    // from the last one, so that the indexes of the pages still to remove are unchanged
+    for (int i = compactedIndexes.size() - 1; i >= 0; i--)
     {
-        QString svgFileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", index);
+        int index = compactedIndexes.at(i);
+        QString sidecarFileName = UBSvgSubsetAdaptor::strokeSidecarFileName(UBPageManifest::pageSvgPath(proxy->persistencePath(), index));
 
-        QFile::remove(svgFileName);
+        if (!sidecarFileName.isEmpty())
+            QFile::remove(proxy->persistencePath() + "/" + sidecarFileName);
 
-        QString thumbFileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", index);
+        int pageNumber = UBPageManifest::removePage(proxy->persistencePath(), index);
 
-        QFile::remove(thumbFileName);
+        QFile::remove(proxy->persistencePath() + "/" + UBPageManifest::svgFileName(pageNumber));
+        QFile::remove(proxy->persistencePath() + "/" + UBPageManifest::thumbnailFileName(pageNumber));
+        UBPageManifest::fillNumber(proxy->persistencePath(), pageNumber);
 
         mSceneCache.removeScene(proxy, index);
 
         proxy->decPageCount();
-
     }
 
-    std::sort(compactedIndexes.begin(), compactedIndexes.end());
-
     int offset = 1;
 
     for (int i = compactedIndexes.at(0) + 1; i < pageCount; i++)
@@ -786,27 +896,26 @@ void UBPersistenceManager::deleteDocumentScenes(UBDocumentProxy* proxy, const QL
         }
         else
         {
-            renamePage(proxy, i , i - offset);
-
             mSceneCache.moveScene(proxy, i, i - offset);
-
         }
     }
+
+    purgeStrokeSidecars(proxy);
 }
 
 
 void UBPersistenceManager::duplicateDocumentScene(UBDocumentProxy* proxy, int index)
 {
     checkIfDocumentRepositoryExists();
+    cancelPrefetch();
 
     int pageCount = UBPersistenceManager::persistenceManager()->sceneCount(proxy);
 
+    UBPageManifest::insertPage(proxy->persistencePath(), index + 1);
+
     for (int i = pageCount; i > index + 1; i--)
     {
-        renamePage(proxy, i - 1 , i);
-
         mSceneCache.moveScene(proxy, i - 1, i);
-
     }
 
     copyPage(proxy, index , index + 1);
@@ -894,10 +1003,13 @@ void UBPersistenceManager::copyDocumentScene(UBDocumentProxy *from, int fromInde
         return;
     }
 
+    cancelPrefetch();
+
     checkIfDocumentRepositoryExists();
 
+    UBPageManifest::insertPage(to->persistencePath(), toIndex);
+
     for (int i = to->pageCount(); i > toIndex; i--) {
-        renamePage(to, i - 1, i);
         mSceneCache.moveScene(to, i - 1, i);
     }
 
@@ -907,8 +1019,8 @@ void UBPersistenceManager::copyDocumentScene(UBDocumentProxy *from, int fromInde
 
     to->incPageCount();
 
-    QString thumbTmp(from->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", fromIndex));
-    QString thumbTo(to->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", toIndex));
+    QString thumbTmp(UBPageManifest::pageThumbnailPath(from->persistencePath(), fromIndex));
+    QString thumbTo(UBPageManifest::pageThumbnailPath(to->persistencePath(), toIndex));
 
     QFile::remove(thumbTo);
     QFile::copy(thumbTmp, thumbTo);
@@ -926,12 +1038,11 @@ void UBPersistenceManager::copyDocumentScene(UBDocumentProxy *from, int fromInde
 
 UBGraphicsScene* UBPersistenceManager::createDocumentSceneAt(UBDocumentProxy* proxy, int index, bool useUndoRedoStack)
 {
+    cancelPrefetch();
+
     int count = proxy->pageCount();
 
-    for(int i = count - 1; i >= index; i--)
-    {
-        renamePage(proxy, i , i + 1);
-    }
+    UBPageManifest::insertPage(proxy->persistencePath(), index);
 
     mSceneCache.shiftUpScenes(proxy, index, count -1);
 
@@ -954,14 +1065,13 @@ UBGraphicsScene* UBPersistenceManager::createDocumentSceneAt(UBDocumentProxy* pr
 
 void UBPersistenceManager::insertDocumentSceneAt(UBDocumentProxy* proxy, UBGraphicsScene* scene, int index, bool persist, bool deleting)
 {
+    cancelPrefetch();
+
     scene->setDocument(proxy);
 
     int count = sceneCount(proxy);
 
-    for(int i = count - 1; i >= index; i--)
-    {
-        renamePage(proxy, i , i + 1);
-    }
+    UBPageManifest::insertPage(proxy->persistencePath(), index);
 
     mSceneCache.shiftUpScenes(proxy, index, count -1);
 
@@ -982,36 +1092,12 @@ void UBPersistenceManager::insertDocumentSceneAt(UBDocumentProxy* proxy, UBGraph
 void UBPersistenceManager::moveSceneToIndex(UBDocumentProxy* proxy, int source, int target)
 {
     checkIfDocumentRepositoryExists();
+    cancelPrefetch();
 
     if (source == target)
         return;
 
-    QFile svgTmp(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", source));
-    svgTmp.rename(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.tmp", target));
-
-    QFile thumbTmp(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", source));
-    thumbTmp.rename(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.tmp", target));
-
-    if (source < target)
-    {
-        for (int i = source + 1; i <= target; i++)
-        {
-            renamePage(proxy, i , i - 1);
-        }
-    }
-    else
-    {
-        for (int i = source - 1; i >= target; i--)
-        {
-            renamePage(proxy, i , i + 1);
-        }
-    }
-
-    QFile svg(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.tmp", target));
-    svg.rename(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", target));
-
-    QFile thumb(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.tmp", target));
-    thumb.rename(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", target));
+    UBPageManifest::movePage(proxy->persistencePath(), source, target);
 
     mSceneCache.moveScene(proxy, source, target);
 }
@@ -1019,13 +1105,9 @@ void UBPersistenceManager::moveSceneToIndex(UBDocumentProxy* proxy, int source,
 
 UBGraphicsScene* UBPersistenceManager::loadDocumentScene(UBDocumentProxy* proxy, int sceneIndex, bool cacheNeighboringScenes)
 {
-    UBGraphicsScene* scene = nullptr;
+    UBGraphicsScene* scene = mSceneCache.value(proxy, sceneIndex);
 
-    if (mSceneCache.contains(proxy, sceneIndex))
-    {
-        return mSceneCache.value(proxy, sceneIndex);
-    }
-    else
+    if (!scene)
     {
         scene = UBSvgSubsetAdaptor::loadScene(proxy, sceneIndex);
         if(!scene)
@@ -1038,21 +1120,56 @@ UBGraphicsScene* UBPersistenceManager::loadDocumentScene(UBDocumentProxy* proxy,
             mSceneCache.insert(proxy, sceneIndex, scene);
     }
 
+    // on a hit too, so that the window follows the user through the pages it already prefetched
     if (cacheNeighboringScenes)
-    {
-        if(sceneIndex + 1 < proxy->pageCount() &&  !mSceneCache.contains(proxy, sceneIndex + 1))
-            mWorker->readScene(proxy,sceneIndex+1);
+        prefetchScenes(proxy, sceneIndex);
+
+    return scene;
+}
+
+void UBPersistenceManager::prefetchScenes(UBDocumentProxy* proxy, int sceneIndex)
+{
+    int window = UBSettings::settings()->pagePrefetchWindow->get().toInt();
 
-        if(sceneIndex - 1 >= 0 &&  !mSceneCache.contains(proxy, sceneIndex - 1))
-            mWorker->readScene(proxy,sceneIndex-1);
+    int direction = 1;
+    if (proxy == mPrefetchDocument && sceneIndex < mPrefetchIndex)
+        direction = -1;
+
+    mPrefetchDocument = proxy;
+    mPrefetchIndex = sceneIndex;
+
+    // requests still queued from the previous page are dropped and queued again below in the new order,
+    // a read already running is delivered and discarded by onSceneLoaded if it falls outside the window
+    mWorker->cancelReadScenes();
+
+    QList<int> indexes;
+
+    // the pages the user is heading toward come first, only the closest page is kept behind
+    for (int i = 1; i <= window; i++)
+        indexes << sceneIndex + direction * i;
+
+    if (window > 0)
+        indexes << sceneIndex - direction;
+
+    foreach (int index, indexes)
+    {
+        if (index >= 0 && index < proxy->pageCount() && !mSceneCache.contains(proxy, index))
+            mWorker->readScene(proxy, index, mPrefetchGeneration);
     }
+}
 
+void UBPersistenceManager::cancelPrefetch()
+{
+    mPrefetchGeneration++;
+    mPrefetchDocument = 0;
 
-    return scene;
+    mWorker->cancelReadScenes();
 }
 
 void UBPersistenceManager::reassignDocProxy(UBDocumentProxy *newDocument, UBDocumentProxy *oldDocument)
 {
+    cancelPrefetch();
+
     return mSceneCache.reassignDocProxy(newDocument, oldDocument);
 }
 
@@ -1081,8 +1198,9 @@ void UBPersistenceManager::persistDocumentScene(UBDocumentProxy* pDocumentProxy,
         }
         else
         {
-           UBGraphicsScene* copiedScene = pScene->sceneDeepCopy();
-           mWorker->saveScene(pDocumentProxy, copiedScene, pSceneIndex);
+            // only the items changed since the last save are serialised again, the worker writes the result
+            UBSvgSerializedScene serializedScene = UBSvgSubsetAdaptor::serializeScene(pDocumentProxy, pScene, pSceneIndex);
+            mWorker->saveScene(pDocumentProxy, serializedScene, pSceneIndex);
         }
 
         UBThumbnailAdaptor::persistScene(pDocumentProxy, pScene, pSceneIndex);
@@ -1110,60 +1228,135 @@ UBDocumentProxy* UBPersistenceManager::persistDocumentMetadata(UBDocumentProxy*
 }
 
 
-void UBPersistenceManager::renamePage(UBDocumentProxy* pDocumentProxy, const int sourceIndex, const int targetIndex)
+void UBPersistenceManager::copyPage(UBDocumentProxy* pDocumentProxy, const int sourceIndex, const int targetIndex)
 {
-    UBApplication::showMessage(tr("Renaming pages (%1/%2)").arg(sourceIndex).arg(pDocumentProxy->pageCount()));
-    QFile svg(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", sourceIndex));
-    svg.rename(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg",  targetIndex));
+    QFile svg(UBPageManifest::pageSvgPath(pDocumentProxy->persistencePath(), sourceIndex));
+    svg.copy(UBPageManifest::pageSvgPath(pDocumentProxy->persistencePath(), targetIndex));
 
-    QFile thumb(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", sourceIndex));
-    thumb.rename(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetIndex));
+    UBSvgSubsetAdaptor::setSceneUuid(pDocumentProxy, targetIndex, QUuid::createUuid());
+
+    QFile thumb(UBPageManifest::pageThumbnailPath(pDocumentProxy->persistencePath(), sourceIndex));
+    thumb.copy(UBPageManifest::pageThumbnailPath(pDocumentProxy->persistencePath(), targetIndex));
 }
 
 
-void UBPersistenceManager::copyPage(UBDocumentProxy* pDocumentProxy, const int sourceIndex, const int targetIndex)
+void UBPersistenceManager::waitForWrites(UBDocumentProxy* pDocumentProxy)
 {
-    QFile svg(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg",sourceIndex));
-    svg.copy(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", targetIndex));
-
-    UBSvgSubsetAdaptor::setSceneUuid(pDocumentProxy, targetIndex, QUuid::createUuid());
-
-    QFile thumb(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", sourceIndex));
-    thumb.copy(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetIndex));
+    mWorker->waitForWrites(pDocumentProxy);
 }
 
 
-int UBPersistenceManager::sceneCount(const UBDocumentProxy* proxy)
+bool UBPersistenceManager::copyDocumentForExport(UBDocumentProxy* pDocumentProxy, const QString& targetPath)
 {
-    const QString pPath = proxy->persistencePath();
+    // the copy is taken from the disk, the queued saves go first
+    mWorker->waitForWrites(pDocumentProxy);
 
-    int pageIndex = 0;
-    bool moreToProcess = true;
-    bool addedMissingZeroPage = false;
+    QString documentPath = pDocumentProxy->persistencePath();
+    QRegularExpression pageFileName("^page\\d+(\\.svg|\\.thumbnail\\.jpg)$");
 
-    while (moreToProcess)
+    if (!QDir().mkpath(targetPath))
+        return false;
+
+    // the pages are written under the names that follow their order, the manifest and the pack indexed by
+    // file number would only mislead the readers of the export
+    foreach (QFileInfo entry, QDir(documentPath).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System))
     {
-        QString fileName = pPath + UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex);
+        QString fileName = entry.fileName();
 
-        QFile file(fileName);
+        if (fileName == UBPageManifest::manifestFileName || fileName == UBThumbnailPack::packFileName || pageFileName.match(fileName).hasMatch())
+            continue;
 
-        if (file.exists())
+        if (!UBFileSystemUtils::copy(entry.absoluteFilePath(), targetPath + "/" + fileName, true))
         {
-            pageIndex++;
+            qWarning() << "cannot copy" << entry.absoluteFilePath() << "to" << targetPath;
+            return false;
         }
-        else
+    }
+
+    int pageCount = sceneCount(pDocumentProxy);
+
+    for (int i = 0; i < pageCount; i++)
+    {
+        if (!UBFileSystemUtils::copyFile(UBPageManifest::pageSvgPath(documentPath, i), targetPath + "/" + UBPageManifest::svgFileName(i), true))
         {
-            moreToProcess = false;
+            qWarning() << "cannot copy page" << i << "of" << documentPath << "to" << targetPath;
+            return false;
         }
+
+        // a missing thumbnail is made again by the reader
+        QString thumbnailPath = UBPageManifest::pageThumbnailPath(documentPath, i);
+
+        if (QFile::exists(thumbnailPath))
+            UBFileSystemUtils::copyFile(thumbnailPath, targetPath + "/" + UBPageManifest::thumbnailFileName(i), true);
     }
 
-    if(pageIndex == 1 && addedMissingZeroPage){
-        // increment is done only to check if there are other pages than the missing zero page
-        // This situation means -> no pages on the document
-        return 0;
+    for (int i = 0; i < pageCount; i++)
+    {
+        QString svgPath = targetPath + "/" + UBPageManifest::svgFileName(i);
+
+        if (UBSvgSubsetAdaptor::strokeSidecarFileName(svgPath).isEmpty())
+            continue;
+
+        QFile svg(svgPath);
+
+        if (!svg.open(QIODevice::ReadOnly))
+            return false;
+
+        QByteArray svgData = UBSvgSubsetAdaptor::inlineStrokeSidecar(targetPath, svg.readAll());
+        svg.close();
+
+        if (!svg.open(QIODevice::WriteOnly | QIODevice::Truncate) || svg.write(svgData) != svgData.size())
+        {
+            qWarning() << "cannot write the points of the strokes in" << svgPath;
+            return false;
+        }
+
+        svg.close();
     }
 
-    return pageIndex;
+    // readers older than the stroke files have no use of them once the points are in the pages
+    UBFileSystemUtils::deleteDir(targetPath + "/" + strokeDirectory);
+
+    return true;
+}
+
+
+void UBPersistenceManager::purgeStrokeSidecars(UBDocumentProxy* pDocumentProxy)
+{
+    // a queued save writes the stroke file before the page that refers to it
+    mWorker->waitForWrites(pDocumentProxy);
+
+    QDir strokeDir(pDocumentProxy->persistencePath() + "/" + strokeDirectory);
+
+    if (!strokeDir.exists())
+        return;
+
+    QSet<QString> referencedFiles;
+
+    for (int i = 0; i < sceneCount(pDocumentProxy); i++)
+    {
+        QString sidecarFileName = UBSvgSubsetAdaptor::strokeSidecarFileName(UBPageManifest::pageSvgPath(pDocumentProxy->persistencePath(), i));
+
+        if (!sidecarFileName.isEmpty())
+            referencedFiles << QFileInfo(sidecarFileName).fileName();
+    }
+
+    foreach (QString fileName, strokeDir.entryList(QDir::Files))
+    {
+        if (!referencedFiles.contains(fileName))
+            strokeDir.remove(fileName);
+    }
+}
+
+
+int UBPersistenceManager::sceneCount(const UBDocumentProxy* proxy)
+{
+    return sceneCount(proxy->persistencePath());
+}
+
+int UBPersistenceManager::sceneCount(const QString& pPath)
+{
+    return UBPageManifest::pageCount(pPath);
 }
 
 QStringList UBPersistenceManager::getSceneFileNames(const QString& folder)
@@ -1206,16 +1399,18 @@ bool UBPersistenceManager::addDirectoryContentToDocument(const QString& document
     for(int sourceIndex = 0 ; sourceIndex < sourceScenes.size(); sourceIndex++)
     {
         int targetIndex = targetPageCount + sourceIndex;
+        int targetNumber = UBPageManifest::insertPage(pDocument->persistencePath(), targetIndex);
 
         QFile svg(documentRootFolder + "/" + sourceScenes[sourceIndex]);
-        if (!svg.copy(pDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", targetIndex)))
+        if (!svg.copy(pDocument->persistencePath() + "/" + UBPageManifest::svgFileName(targetNumber)))
+        {
+            UBPageManifest::removePage(pDocument->persistencePath(), targetIndex);
             return false;
-
-        UBSvgSubsetAdaptor::setSceneUuid(pDocument, targetIndex, QUuid::createUuid());
+        }
 
         QFile thumb(documentRootFolder + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", sourceIndex));
         // We can ignore error in this case, thumbnail will be genarated
-        thumb.copy(pDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetIndex));
+        thumb.copy(pDocument->persistencePath() + "/" + UBPageManifest::thumbnailFileName(targetNumber));
     }
 
     foreach(QString dir, mDocumentSubDirectories)
@@ -1228,6 +1423,14 @@ bool UBPersistenceManager::addDirectoryContentToDocument(const QString& document
                 return false;
     }
 
+    // once the stroke files are there, so that each page gets a copy named after its new uuid
+    for(int sourceIndex = 0 ; sourceIndex < sourceScenes.size(); sourceIndex++)
+    {
+        UBSvgSubsetAdaptor::setSceneUuid(pDocument, targetPageCount + sourceIndex, QUuid::createUuid());
+    }
+
+    purgeStrokeSidecars(pDocument);
+
     pDocument->setPageCount(sceneCount(pDocument));
 
     //issue NC - NNE - 20131213 : At this point, all is well done.
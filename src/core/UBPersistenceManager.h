@@ -33,6 +33,7 @@
 
 #include "UBSceneCache.h"
 #include "UBPersistenceWorker.h"
+#include "UBDocumentCatalog.h"
 
 class QDomNode;
 class QDomElement;
@@ -60,6 +61,7 @@ class UBPersistenceManager : public QObject
         static const QString audioDirectory;
         static const QString widgetDirectory;
         static const QString fileDirectory; // Issue 1683 (Evolution) - AOU - 20131206
+        static const QString strokeDirectory;
 
         static const QString myDocumentsName;
         static const QString modelsName;
@@ -114,6 +116,8 @@ class UBPersistenceManager : public QObject
 
         virtual UBGraphicsScene* loadDocumentScene(UBDocumentProxy* pDocumentProxy, int sceneIndex, bool cacheNeighboringScenes = true);
         UBGraphicsScene *getDocumentScene(UBDocumentProxy* pDocumentProxy, int sceneIndex) {return mSceneCache.value(pDocumentProxy, sceneIndex);}
+        void updateSceneCost(UBDocumentProxy* pDocumentProxy, int sceneIndex) {mSceneCache.updateSceneCost(pDocumentProxy, sceneIndex);}
+        const UBSceneCache& sceneCache() const {return mSceneCache;}
         void reassignDocProxy(UBDocumentProxy *newDocument, UBDocumentProxy *oldDocument);
 
 //        QList<QPointer<UBDocumentProxy> > documentProxies;
@@ -132,8 +136,9 @@ class UBPersistenceManager : public QObject
         bool addDirectoryContentToDocument(const QString& documentRootFolder, UBDocumentProxy* pDocument);
 
         void createDocumentProxiesStructure(bool interactive = false);
-        void createDocumentProxiesStructure(const QFileInfoList &contentInfoList, bool interactive = false);
-        UBDocumentProxy* createDocumentProxyStructure(QFileInfo &contentInfo);
+        // returns the catalog entries of the documents found
+        QList<UBDocumentCatalog::Entry> createDocumentProxiesStructure(const QFileInfoList &contentInfoList, bool interactive = false);
+        UBDocumentProxy* createDocumentProxyStructure(const UBDocumentCatalog::Entry& entry);
         QDialog::DialogCode processInteractiveReplacementDialog(UBDocumentProxy *pProxy);
 
         QStringList documentSubDirectories()
@@ -155,6 +160,18 @@ class UBPersistenceManager : public QObject
 
         QString adjustDocumentVirtualPath(const QString &str);
 
+        // blocks until the queued saves of the document are on disk
+        void waitForWrites(UBDocumentProxy* pDocumentProxy);
+
+        // copies the document for the exports, with the pages under names that follow their order and the points
+        // of the stroke files written in them; the document itself is left as it is
+        bool copyDocumentForExport(UBDocumentProxy* pDocumentProxy, const QString& targetPath);
+
+        // removes the stroke files that no page of the document refers to
+        void purgeStrokeSidecars(UBDocumentProxy* pDocumentProxy);
+
+        static int sceneCount(const QString& documentPath);
+
         void closing();
         bool isSceneInCached(UBDocumentProxy *proxy, int index) const;
 
@@ -171,13 +188,17 @@ class UBPersistenceManager : public QObject
 private:
         int sceneCount(const UBDocumentProxy* pDocumentProxy);
         static QStringList getSceneFileNames(const QString& folder);
-        void renamePage(UBDocumentProxy* pDocumentProxy,
-                        const int sourceIndex, const int targetIndex);
         void copyPage(UBDocumentProxy* pDocumentProxy,
                       const int sourceIndex, const int targetIndex);
         void generatePathIfNeeded(UBDocumentProxy* pDocumentProxy);
         void checkIfDocumentRepositoryExists();
 
+        void addDocumentProxyToTree(UBDocumentProxy* proxy, bool interactive);
+        void collectDocumentProxies(UBDocumentTreeNode* node, QHash<QString, UBDocumentProxy*>& proxies) const;
+
+        void prefetchScenes(UBDocumentProxy* proxy, int sceneIndex);
+        void cancelPrefetch();
+
         void saveFoldersTreeToXml(QXmlStreamWriter &writer, const QModelIndex &parentIndex);
         void loadFolderTreeFromXml(const QString &path, const QDomElement &element);
 
@@ -191,9 +212,13 @@ private:
         QString mFoldersXmlStorageName;
         QProgressDialog mProgress;
         QFutureWatcher<void> futureWatcher;
+        QFutureWatcher<UBDocumentCatalog::Reconciliation> mCatalogWatcher;
         UBPersistenceWorker* mWorker;
 
-        QThread* mThread;
+        int mPrefetchGeneration;
+        UBDocumentProxy* mPrefetchDocument;
+        int mPrefetchIndex;
+
         bool mIsWorkerFinished;
 
         bool mIsApplicationClosing;
@@ -201,10 +226,10 @@ private:
     private slots:
         void documentRepositoryChanged(const QString& path);
         void errorString(QString error);
-        void onSceneLoaded(QByteArray,UBDocumentProxy*,int);
+        void onSceneLoaded(UBSvgPreparedScene,UBDocumentProxy*,int,int);
         void onWorkerFinished();
-        void onScenePersisted(UBGraphicsScene* scene);
         void onMetadataPersisted(UBDocumentProxy* proxy);
+        void onCatalogReconciled();
 
 };
 
@@ -27,67 +27,297 @@
 
 
 #include "UBPersistenceWorker.h"
+
+#include <QThread>
+
 #include "adaptors/UBSvgSubsetAdaptor.h"
 #include "adaptors/UBThumbnailAdaptor.h"
 #include "adaptors/UBMetadataDcSubsetAdaptor.h"
+#include "adaptors/UBPageManifest.h"
+
+class UBPersistenceThread : public QThread
+{
+    public:
+        UBPersistenceThread(UBPersistenceWorker* worker)
+            : QThread(worker)
+            , mWorker(worker)
+        {
+            // NOOP
+        }
+
+    protected:
+        virtual void run()
+        {
+            mWorker->process();
+        }
+
+    private:
+        UBPersistenceWorker* mWorker;
+};
 
 UBPersistenceWorker::UBPersistenceWorker(QObject *parent) :
     QObject(parent)
   , mReceivedApplicationClosing(false)
+  , mRunningThreads(0)
+  , mMaxQueueDepth(0)
 {
+    mClock.start();
 }
 
-void UBPersistenceWorker::saveScene(UBDocumentProxy* proxy, UBGraphicsScene* scene, const int pageIndex)
+UBPersistenceWorker::~UBPersistenceWorker()
 {
-    PersistenceInformation entry = {WriteScene, proxy, scene, pageIndex};
+    foreach(QThread* thread, mThreads)
+        thread->wait();
+}
 
-    saves.append(entry);
-    mSemaphore.release();
+void UBPersistenceWorker::start()
+{
+    // at least one thread can always read while another one writes
+    int threadCount = qBound(2, QThread::idealThreadCount() / 2, 4);
+
+    mRunningThreads = threadCount;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        QThread* thread = new UBPersistenceThread(this);
+        mThreads << thread;
+        thread->start();
+    }
 }
 
-void UBPersistenceWorker::readScene(UBDocumentProxy* proxy, const int pageIndex)
+void UBPersistenceWorker::saveScene(UBDocumentProxy* proxy, const UBSvgSerializedScene& serializedScene, const int pageIndex)
 {
-    PersistenceInformation entry = {ReadScene, proxy, 0, pageIndex};
+    // the file is chosen now, a page moved in the meantime is still written to its own file
+    QString file = UBPageManifest::pageSvgPath(proxy->persistencePath(), pageIndex);
+    PersistenceInformation entry = {WriteScene, proxy, pageIndex, 0, serializedScene, file, 0};
 
-    saves.append(entry);
-    mSemaphore.release();
+    enqueue(entry);
+}
+
+void UBPersistenceWorker::readScene(UBDocumentProxy* proxy, const int pageIndex, const int generation)
+{
+    QString file = UBPageManifest::pageSvgPath(proxy->persistencePath(), pageIndex);
+    PersistenceInformation entry = {ReadScene, proxy, pageIndex, generation, UBSvgSerializedScene(), file, 0};
+
+    enqueue(entry);
+}
+
+void UBPersistenceWorker::cancelReadScenes()
+{
+    QMutexLocker locker(&mMutex);
+
+    for (int i = saves.size() - 1; i >= 0; i--)
+    {
+        if (saves.at(i).action == ReadScene)
+            saves.removeAt(i);
+    }
 }
 
 void UBPersistenceWorker::saveMetadata(UBDocumentProxy *proxy)
 {
-    PersistenceInformation entry = {WriteMetadata, proxy, NULL, 0};
+    QString file = proxy->persistencePath() + "/" + UBMetadataDcSubsetAdaptor::metadataFilename;
+    PersistenceInformation entry = {WriteMetadata, proxy, 0, 0, UBSvgSerializedScene(), file, 0};
+
+    enqueue(entry);
+}
+
+void UBPersistenceWorker::waitForWrites(UBDocumentProxy* proxy)
+{
+    QMutexLocker locker(&mMutex);
+
+    while (hasWrites(proxy))
+        mJobDone.wait(&mMutex);
+}
+
+bool UBPersistenceWorker::hasWrites(UBDocumentProxy* proxy) const
+{
+    QString documentPrefix = proxy->persistencePath() + "/";
+
+    foreach (const PersistenceInformation& info, saves)
+    {
+        if (info.action == WriteScene && info.proxy == proxy)
+            return true;
+    }
+
+    foreach (const QString& file, mRunningFiles)
+    {
+        if (file.startsWith(documentPrefix))
+            return true;
+    }
+
+    return false;
+}
+
+void UBPersistenceWorker::enqueue(PersistenceInformation entry)
+{
+    QMutexLocker locker(&mMutex);
+
+    entry.queuedAt = mClock.elapsed();
+
+    if (entry.action != ReadScene)
+    {
+        // a queued save of the same file is replaced in place, so that the newest content
+        // is written as early as the first request asked for
+        for (int i = 0; i < saves.size(); i++)
+        {
+            PersistenceInformation& queued = saves[i];
+
+            if (queued.action == entry.action && queued.file == entry.file)
+            {
+                // the proxy of a metadata save is a copy owned by the job
+                if (queued.action == WriteMetadata)
+                    delete queued.proxy;
+
+                entry.queuedAt = queued.queuedAt;
+                queued = entry;
+                mStatistics[entry.action].coalesced++;
+
+                return;
+            }
+        }
+    }
+
     saves.append(entry);
-    mSemaphore.release();
+    mMaxQueueDepth = qMax(mMaxQueueDepth, saves.size());
+
+    mJobAvailable.wakeOne();
+}
+
+int UBPersistenceWorker::nextJobIndex() const
+{
+    // a job waits for the jobs queued or running before it on the same file
+    QSet<QString> busyFiles = mRunningFiles;
+    int firstWrite = -1;
+
+    for (int i = 0; i < saves.size(); i++)
+    {
+        const PersistenceInformation& info = saves.at(i);
+
+        if (!busyFiles.contains(info.file))
+        {
+            if (info.action == ReadScene)
+                return i;
+
+            if (firstWrite < 0)
+                firstWrite = i;
+        }
+
+        busyFiles.insert(info.file);
+    }
+
+    return firstWrite;
+}
+
+int UBPersistenceWorker::queueDepth()
+{
+    QMutexLocker locker(&mMutex);
+
+    return saves.size();
+}
+
+void UBPersistenceWorker::dumpStatistics()
+{
+    QMutexLocker locker(&mMutex);
+
+    qDebug() << "UBPersistenceWorker::dumpStatistics:"
+             << "threads" << mThreads.size()
+             << "queued" << saves.size()
+             << "max queued" << mMaxQueueDepth;
+
+    QHash<int, JobStatistic>::const_iterator it;
+    for (it = mStatistics.constBegin(); it != mStatistics.constEnd(); ++it)
+    {
+        const JobStatistic& statistic = it.value();
+        int count = qMax(1, statistic.count);
+
+        qDebug() << "   " << (it.key() == WriteScene ? "write scene" : it.key() == ReadScene ? "read scene" : "write metadata")
+                 << "jobs" << statistic.count
+                 << "coalesced" << statistic.coalesced
+                 << "average wait" << statistic.waitTime / count << "ms"
+                 << "max wait" << statistic.maxWaitTime << "ms"
+                 << "average run" << statistic.runTime / count << "ms";
+    }
 }
 
 void UBPersistenceWorker::applicationWillClose()
 {
     qDebug() << "applicaiton Will close signal received";
+
+    QMutexLocker locker(&mMutex);
+
+    // reads only prefetch pages, queued writes are still done before the threads stop
+    for (int i = saves.size() - 1; i >= 0; i--)
+    {
+        if (saves.at(i).action == ReadScene)
+            saves.removeAt(i);
+    }
+
     mReceivedApplicationClosing = true;
-    mSemaphore.release();
+    mJobAvailable.wakeAll();
 }
 
 void UBPersistenceWorker::process()
 {
     qDebug() << "process starts";
-    mSemaphore.acquire();
-    do{
-        PersistenceInformation info = saves.takeFirst();
-        if(info.action == WriteScene){
-            UBSvgSubsetAdaptor::persistScene(info.proxy, info.scene, info.sceneIndex);
-            emit scenePersisted(info.scene);
-        }
-        else if (info.action == ReadScene){
-            emit sceneLoaded(UBSvgSubsetAdaptor::loadSceneAsText(info.proxy,info.sceneIndex), info.proxy, info.sceneIndex);
-        }
-        else if (info.action == WriteMetadata) {
-            if (info.proxy->isModified()) {
-                UBMetadataDcSubsetAdaptor::persist(info.proxy);
-                emit metadataPersisted(info.proxy);
-            }
+
+    mMutex.lock();
+
+    forever
+    {
+        int index = nextJobIndex();
+
+        if (index < 0)
+        {
+            if (mReceivedApplicationClosing && saves.isEmpty())
+                break;
+
+            mJobAvailable.wait(&mMutex);
+            continue;
         }
-        mSemaphore.acquire();
-    }while(!mReceivedApplicationClosing);
+
+        PersistenceInformation info = saves.takeAt(index);
+        mRunningFiles.insert(info.file);
+        mMutex.unlock();
+
+        qint64 startedAt = mClock.elapsed();
+        execute(info);
+        qint64 endedAt = mClock.elapsed();
+
+        mMutex.lock();
+        mRunningFiles.remove(info.file);
+
+        JobStatistic& statistic = mStatistics[info.action];
+        statistic.count++;
+        statistic.waitTime += startedAt - info.queuedAt;
+        statistic.maxWaitTime = qMax(statistic.maxWaitTime, startedAt - info.queuedAt);
+        statistic.runTime += endedAt - startedAt;
+
+        // the jobs that were waiting for that file may run now
+        mJobAvailable.wakeAll();
+        mJobDone.wakeAll();
+    }
+
+    bool lastThread = --mRunningThreads == 0;
+    mMutex.unlock();
+
     qDebug() << "process will stop";
-    emit finished();
+
+    if (lastThread)
+        emit finished();
+}
+
+void UBPersistenceWorker::execute(const PersistenceInformation& info)
+{
+    if(info.action == WriteScene){
+        UBSvgSubsetAdaptor::writeScene(info.proxy, info.file, info.serializedScene);
+    }
+    else if (info.action == ReadScene){
+        emit sceneLoaded(UBSvgSubsetAdaptor::prepareScene(info.proxy, info.sceneIndex), info.proxy, info.sceneIndex, info.generation);
+    }
+    else if (info.action == WriteMetadata) {
+        if (info.proxy->isModified()) {
+            UBMetadataDcSubsetAdaptor::persist(info.proxy);
+            emit metadataPersisted(info.proxy);
+        }
+    }
 }
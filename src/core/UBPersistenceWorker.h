@@ -30,9 +30,14 @@
 #define UBPERSISTENCEWORKER_H
 
 #include <QObject>
-#include <QSemaphore>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
 #include "document/UBDocumentProxy.h"
 #include "domain/UBGraphicsScene.h"
+#include "adaptors/UBSvgSubsetAdaptor.h"
+
+class QThread;
 
 typedef enum{
     WriteScene = 0,
@@ -43,35 +48,81 @@ typedef enum{
 typedef struct{
     ActionType action;
     UBDocumentProxy* proxy;
-    UBGraphicsScene* scene;
     int sceneIndex;
+    int generation;
+    UBSvgSerializedScene serializedScene;
+    QString file;
+    qint64 queuedAt;
 }PersistenceInformation;
 
+/**
+ * Small pool of threads reading and writing documents in the background.
+ *
+ * Jobs on the same file of a document run one after the other in the order they were
+ * queued, jobs on different files run in parallel. A save replaces a queued save of the
+ * same file, and reads are picked before writes, as the user may be waiting on them.
+ */
 class UBPersistenceWorker : public QObject
 {
     Q_OBJECT
 public:
     explicit UBPersistenceWorker(QObject *parent = 0);
+    virtual ~UBPersistenceWorker();
 
-    void saveScene(UBDocumentProxy* proxy, UBGraphicsScene* scene, const int pageIndex);
-    void readScene(UBDocumentProxy* proxy, const int pageIndex);
+    void start();
+
+    void saveScene(UBDocumentProxy* proxy, const UBSvgSerializedScene& serializedScene, const int pageIndex);
+    void readScene(UBDocumentProxy* proxy, const int pageIndex, const int generation);
+    void cancelReadScenes();
     void saveMetadata(UBDocumentProxy* proxy);
 
+    // blocks until the scenes of the document queued for writing are on disk
+    void waitForWrites(UBDocumentProxy* proxy);
+
+    int queueDepth();
+    void dumpStatistics();
+
+    // runs on each thread of the pool
+    void process();
+
 signals:
    void finished();
    void error(QString string);
-   void sceneLoaded(QByteArray text,UBDocumentProxy* proxy, const int pageIndex);
-   void scenePersisted(UBGraphicsScene* scene);
+   void sceneLoaded(UBSvgPreparedScene preparedScene, UBDocumentProxy* proxy, const int pageIndex, const int generation);
    void metadataPersisted(UBDocumentProxy* proxy);
 
 public slots:
-   void process();
    void applicationWillClose();
 
 protected:
+   void enqueue(PersistenceInformation entry);
+   int nextJobIndex() const;
+   bool hasWrites(UBDocumentProxy* proxy) const;
+   void execute(const PersistenceInformation& info);
+
+   struct JobStatistic
+   {
+       JobStatistic() : count(0), coalesced(0), waitTime(0), maxWaitTime(0), runTime(0) {}
+
+       int count;
+       int coalesced;
+       qint64 waitTime;
+       qint64 maxWaitTime;
+       qint64 runTime;
+   };
+
    bool mReceivedApplicationClosing;
-   QSemaphore mSemaphore;
+   QMutex mMutex;
+   QWaitCondition mJobAvailable;
+   QWaitCondition mJobDone;
    QList<PersistenceInformation> saves;
+   QSet<QString> mRunningFiles;
+   QList<QThread*> mThreads;
+   int mRunningThreads;
+
+   QElapsedTimer mClock;
+   QHash<int, JobStatistic> mStatistics;
+   int mMaxQueueDepth;
 };
 
 #endif // UBPERSISTENCEWORKER_H
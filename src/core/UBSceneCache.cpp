@@ -30,6 +30,9 @@
 #include "UBSceneCache.h"
 
 #include "domain/UBGraphicsScene.h"
+#include "domain/UBGraphicsPixmapItem.h"
+#include "domain/UBGraphicsPolygonItem.h"
+#include "domain/UBGraphicsPDFItem.h"
 
 #include "core/UBPersistenceManager.h"
 #include "core/UBApplication.h"
@@ -38,12 +41,35 @@
 
 #include "document/UBDocumentProxy.h"
 
+#include "board/UBBoardController.h"
+
 #include "core/memcheck.h"
 
+UBSceneCacheID::UBSceneCacheID(UBDocumentProxy* pDocumentProxy, int pPageIndex)
+    : documentUuid(pDocumentProxy ? pDocumentProxy->uuid() : QUuid())
+    , pageIndex(pPageIndex)
+{
+    // NOOP
+}
+
+
+namespace
+{
+    // rough bookkeeping overhead of a QGraphicsItem (item data, BSP tree entry, delegate)
+    const qint64 itemBaseCost = 512;
+}
+
 UBSceneCache::UBSceneCache()
     : mCachedSceneCount(0)
+    , mUseClock(0)
+    , mTotalCost(0)
+    , mMemoryBudget(0)
+    , mHitCount(0)
+    , mMissCount(0)
+    , mInsertCount(0)
+    , mEvictionCount(0)
 {
-    // NOOP
+    setMemoryBudget(UBSettings::settings()->pageCacheMemoryBudget->get().toLongLong() * 1024 * 1024);
 }
 
 
@@ -65,32 +91,27 @@ UBGraphicsScene* UBSceneCache::createScene(UBDocumentProxy* proxy, int pageIndex
 
 void UBSceneCache::insert (UBDocumentProxy* proxy, int pageIndex, UBGraphicsScene* scene)
 {
-    QList<UBSceneCacheID> existingKeys = QHash<UBSceneCacheID, UBGraphicsScene*>::keys(scene);
-
-    foreach(UBSceneCacheID key, existingKeys)
+    if (mSceneKeys.contains(scene))
     {
-        mCachedSceneCount -= QHash<UBSceneCacheID, UBGraphicsScene*>::remove(key);
+        takeEntry(mSceneKeys.value(scene));
     }
 
     UBSceneCacheID key(proxy, pageIndex);
 
     if (QHash<UBSceneCacheID, UBGraphicsScene*>::contains(key))
     {
-        QHash<UBSceneCacheID, UBGraphicsScene*>::insert(key, scene);
-        mCachedKeyFIFO.enqueue(key);
+        takeEntry(key);
     }
-    else
-    {
-        QHash<UBSceneCacheID, UBGraphicsScene*>::insert(key, scene);
-        mCachedKeyFIFO.enqueue(key);
 
-        mCachedSceneCount++;
-    }
+    insertEntry(key, scene);
+    mInsertCount++;
 
     if (mViewStates.contains(key))
     {
         scene->setViewState(mViewStates.value(key));
     }
+
+    evictScenes(key);
 }
 
 
@@ -109,13 +130,15 @@ UBGraphicsScene* UBSceneCache::value(UBDocumentProxy* proxy, int pageIndex)
     {
         UBGraphicsScene* scene = QHash<UBSceneCacheID, UBGraphicsScene*>::value(key);
 
-        mCachedKeyFIFO.removeAll(key);
-        mCachedKeyFIFO.enqueue(key);
+        touch(key);
+        mHitCount++;
 
         return scene;
     }
     else
     {
+        mMissCount++;
+
         return 0;
     }
 }
@@ -123,71 +146,55 @@ UBGraphicsScene* UBSceneCache::value(UBDocumentProxy* proxy, int pageIndex)
 
 void UBSceneCache::removeScene(UBDocumentProxy* proxy, int pageIndex)
 {
-    UBGraphicsScene* scene = value(proxy, pageIndex);
+    removeScene(UBSceneCacheID(proxy, pageIndex));
+}
+
+
+void UBSceneCache::removeScene(const UBSceneCacheID& key)
+{
+    UBGraphicsScene* scene = value(key);
+
     if (scene && !scene->isActive())
     {
-        UBSceneCacheID key(proxy, pageIndex);
-        int count = QHash<UBSceneCacheID, UBGraphicsScene*>::remove(key);
-        mCachedKeyFIFO.removeAll(key);
+        takeEntry(key);
 
         mViewStates.insert(key, scene->viewState());
 
         scene->deleteLater();
-
-        mCachedSceneCount -= count;
     }
 }
 
 
 void UBSceneCache::removeAllScenes(UBDocumentProxy* proxy)
 {
-    for(int i = 0 ; i < proxy->pageCount(); i++)
+    QUuid documentUuid = proxy->uuid();
+
+    foreach(int pageIndex, mDocumentPageIndexes.value(documentUuid))
     {
-        removeScene(proxy, i);
+        removeScene(UBSceneCacheID(documentUuid, pageIndex));
     }
 }
 
 
 void UBSceneCache::moveScene(UBDocumentProxy* proxy, int sourceIndex, int targetIndex)
 {
-    UBSceneCacheID keySource(proxy, sourceIndex);
+    QUuid documentUuid = proxy->uuid();
 
-    UBGraphicsScene *scene = 0;
+    // the pages between source and target slide by one to fill the gap left by the moved page
+    int shift = sourceIndex < targetIndex ? -1 : 1;
 
-    if (QHash<UBSceneCacheID, UBGraphicsScene*>::contains(keySource))
-    {
-        scene = QHash<UBSceneCacheID, UBGraphicsScene*>::value(keySource);
-        mCachedKeyFIFO.removeAll(keySource);
-    }
+    QList<QPair<int, CachedEntry> > movedEntries;
 
-    if (sourceIndex < targetIndex)
+    foreach(int pageIndex, cachedPageIndexes(documentUuid, qMin(sourceIndex, targetIndex), qMax(sourceIndex, targetIndex)))
     {
-        for (int i = sourceIndex + 1; i <= targetIndex; i++)
-        {
-            internalMoveScene(proxy, i, i - 1);
-        }
-    }
-    else
-    {
-        for (int i = sourceIndex - 1; i >= targetIndex; i--)
-        {
-            internalMoveScene(proxy, i, i + 1);
-        }
+        int newIndex = pageIndex == sourceIndex ? targetIndex : pageIndex + shift;
+        movedEntries << qMakePair(newIndex, takeEntry(UBSceneCacheID(documentUuid, pageIndex)));
     }
 
-    UBSceneCacheID keyTarget(proxy, targetIndex);
-
-    if (scene)
+    for (int i = 0; i < movedEntries.size(); i++)
     {
-        insert(proxy, targetIndex, scene);
-        mCachedKeyFIFO.enqueue(keyTarget);
+        insertEntry(UBSceneCacheID(documentUuid, movedEntries.at(i).first), movedEntries.at(i).second);
     }
-    else if (QHash<UBSceneCacheID, UBGraphicsScene*>::contains(keyTarget))
-    {
-        scene = QHash<UBSceneCacheID, UBGraphicsScene*>::take(keyTarget);
-        mCachedKeyFIFO.removeAll(keyTarget);
-    }
-
 }
 
 void UBSceneCache::reassignDocProxy(UBDocumentProxy *newDocument, UBDocumentProxy *oldDocument)
@@ -201,18 +208,26 @@ void UBSceneCache::reassignDocProxy(UBDocumentProxy *newDocument, UBDocumentProx
     if (!QFileInfo(oldDocument->persistencePath()).exists()) {
         return;
     }
-    for (int i = 0; i < oldDocument->pageCount(); i++) {
 
-        UBSceneCacheID sourceKey(oldDocument, i);
+    QUuid oldUuid = oldDocument->uuid();
+    QUuid newUuid = newDocument->uuid();
+
+    foreach(int pageIndex, mDocumentPageIndexes.value(oldUuid)) {
+
+        UBSceneCacheID sourceKey(oldUuid, pageIndex);
         UBGraphicsScene *currentScene = value(sourceKey);
         if (currentScene) {
             currentScene->setDocument(newDocument);
         }
-        mCachedKeyFIFO.removeAll(sourceKey);
-        int count = QHash<UBSceneCacheID, UBGraphicsScene*>::remove(sourceKey);
-        mCachedSceneCount -= count;
 
-        insert(newDocument, i, currentScene);
+        if (oldUuid != newUuid) {
+            UBSceneCacheID targetKey(newUuid, pageIndex);
+            CachedEntry entry = takeEntry(sourceKey);
+            if (QHash<UBSceneCacheID, UBGraphicsScene*>::contains(targetKey)) {
+                takeEntry(targetKey);
+            }
+            insertEntry(targetKey, entry);
+        }
     }
 
 }
@@ -220,40 +235,238 @@ void UBSceneCache::reassignDocProxy(UBDocumentProxy *newDocument, UBDocumentProx
 
 void UBSceneCache::shiftUpScenes(UBDocumentProxy* proxy, int startIncIndex, int endIncIndex)
 {
-    for(int i = endIncIndex; i >= startIncIndex; i--)
+    QUuid documentUuid = proxy->uuid();
+
+    QList<QPair<int, CachedEntry> > movedEntries;
+
+    // the page right after the range is overwritten by the shift
+    foreach(int pageIndex, cachedPageIndexes(documentUuid, startIncIndex, endIncIndex + 1))
     {
-        UBApplication::showMessage(QObject::tr("Moving cached scenes (%1/%2)").arg(i).arg(endIncIndex));
-        internalMoveScene(proxy, i, i + 1);
+        CachedEntry entry = takeEntry(UBSceneCacheID(documentUuid, pageIndex));
+
+        if (pageIndex <= endIncIndex)
+            movedEntries << qMakePair(pageIndex + 1, entry);
+    }
+
+    for (int i = 0; i < movedEntries.size(); i++)
+    {
+        insertEntry(UBSceneCacheID(documentUuid, movedEntries.at(i).first), movedEntries.at(i).second);
     }
 }
 
 
-void UBSceneCache::internalMoveScene(UBDocumentProxy* proxy, int sourceIndex, int targetIndex)
+void UBSceneCache::updateSceneCost(UBDocumentProxy* proxy, int pageIndex)
 {
-    UBSceneCacheID sourceKey(proxy, sourceIndex);
+    UBSceneCacheID key(proxy, pageIndex);
+    UBGraphicsScene* scene = value(key);
 
-    if (QHash<UBSceneCacheID, UBGraphicsScene*>::contains(sourceKey))
+    if (scene)
     {
-        UBGraphicsScene* scene = QHash<UBSceneCacheID, UBGraphicsScene*>::take(sourceKey);
-        mCachedKeyFIFO.removeAll(sourceKey);
-
-        UBSceneCacheID targetKey(proxy, targetIndex);
-        QHash<UBSceneCacheID, UBGraphicsScene*>::insert(targetKey, scene);
-        mCachedKeyFIFO.enqueue(targetKey);
+        qint64 cost = estimateSceneCost(scene);
 
+        // eviction is left to the next insertion, the caller may still hold other scenes
+        mTotalCost += cost - mSceneCosts.value(key);
+        mSceneCosts.insert(key, cost);
     }
-    else
+}
+
+
+qint64 UBSceneCache::estimateSceneCost(UBGraphicsScene* scene)
+{
+    if (!scene)
+        return 0;
+
+    qint64 cost = sizeof(UBGraphicsScene);
+
+    foreach(QGraphicsItem* item, scene->items())
     {
-        UBSceneCacheID targetKey(proxy, targetIndex);
-        if (QHash<UBSceneCacheID, UBGraphicsScene*>::contains(targetKey))
-        {
-            /*UBGraphicsScene* scene = */QHash<UBSceneCacheID, UBGraphicsScene*>::take(targetKey);
+        cost += itemBaseCost;
 
-            mCachedKeyFIFO.removeAll(targetKey);
+        switch (item->type())
+        {
+            case UBGraphicsItemType::PolygonItemType:
+            {
+                UBGraphicsPolygonItem* polygonItem = qgraphicsitem_cast<UBGraphicsPolygonItem*>(item);
+                if (polygonItem)
+                    cost += polygonItem->polygon().size() * sizeof(QPointF);
+                break;
+            }
+            case UBGraphicsItemType::PixmapItemType:
+            {
+                UBGraphicsPixmapItem* pixmapItem = qgraphicsitem_cast<UBGraphicsPixmapItem*>(item);
+                if (pixmapItem)
+                {
+                    const QPixmap& pixmap = pixmapItem->pixmap();
+                    cost += (qint64)pixmap.width() * pixmap.height() * pixmap.depth() / 8;
+                }
+                break;
+            }
+            case UBGraphicsItemType::PDFItemType:
+            {
+                UBGraphicsPDFItem* pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*>(item);
+                if (pdfItem)
+                    cost += pdfItem->cachedBytes();
+                break;
+            }
+            default:
+                break;
         }
     }
+
+    return cost;
+}
+
+
+void UBSceneCache::setMemoryBudget(qint64 bytes)
+{
+    mMemoryBudget = bytes;
+
+    if (!isEmpty())
+        evictScenes(UBSceneCacheID());
+}
+
+
+void UBSceneCache::dumpStatistics() const
+{
+    qDebug() << "UBSceneCache::dumpStatistics:"
+             << "scenes" << mCachedSceneCount
+             << "cost" << mTotalCost / 1024 << "KB"
+             << "budget" << mMemoryBudget / 1024 << "KB"
+             << "hits" << mHitCount
+             << "misses" << mMissCount
+             << "inserts" << mInsertCount
+             << "evictions" << mEvictionCount;
+}
+
+
+QList<int> UBSceneCache::cachedPageIndexes(const QUuid& documentUuid, int firstIndex, int lastIndex) const
+{
+    QList<int> pageIndexes;
+
+    foreach(int pageIndex, mDocumentPageIndexes.value(documentUuid))
+    {
+        if (pageIndex >= firstIndex && pageIndex <= lastIndex)
+            pageIndexes << pageIndex;
+    }
+
+    std::sort(pageIndexes.begin(), pageIndexes.end());
+
+    return pageIndexes;
+}
+
+
+void UBSceneCache::insertEntry(const UBSceneCacheID& key, UBGraphicsScene* scene)
+{
+    CachedEntry entry;
+    entry.scene = scene;
+    entry.cost = estimateSceneCost(scene);
+
+    insertEntry(key, entry);
+
+    touch(key);
+}
+
+
+void UBSceneCache::insertEntry(const UBSceneCacheID& key, const CachedEntry& entry)
+{
+    QHash<UBSceneCacheID, UBGraphicsScene*>::insert(key, entry.scene);
+
+    mSceneCosts.insert(key, entry.cost);
+    mTotalCost += entry.cost;
+
+    if (entry.useStamp)
+    {
+        mUseStamps.insert(key, entry.useStamp);
+        mLruKeys.insert(entry.useStamp, key);
+    }
+
+    mDocumentPageIndexes[key.documentUuid].insert(key.pageIndex);
+
+    if (entry.scene)
+        mSceneKeys.insert(entry.scene, key);
+
+    mCachedSceneCount++;
 }
 
+
+UBSceneCache::CachedEntry UBSceneCache::takeEntry(const UBSceneCacheID& key)
+{
+    CachedEntry entry;
+
+    entry.scene = QHash<UBSceneCacheID, UBGraphicsScene*>::take(key);
+    entry.cost = mSceneCosts.take(key);
+    entry.useStamp = mUseStamps.take(key);
+
+    mTotalCost -= entry.cost;
+    mLruKeys.remove(entry.useStamp);
+
+    QHash<QUuid, QSet<int> >::iterator documentPages = mDocumentPageIndexes.find(key.documentUuid);
+    if (documentPages != mDocumentPageIndexes.end())
+    {
+        documentPages->remove(key.pageIndex);
+        if (documentPages->isEmpty())
+            mDocumentPageIndexes.erase(documentPages);
+    }
+
+    if (entry.scene && mSceneKeys.value(entry.scene) == key)
+        mSceneKeys.remove(entry.scene);
+
+    mCachedSceneCount--;
+
+    return entry;
+}
+
+
+void UBSceneCache::touch(const UBSceneCacheID& key)
+{
+    if (mUseStamps.contains(key))
+        mLruKeys.remove(mUseStamps.value(key));
+
+    mUseClock++;
+    mUseStamps.insert(key, mUseClock);
+    mLruKeys.insert(mUseClock, key);
+}
+
+
+void UBSceneCache::evictScenes(const UBSceneCacheID& keptKey)
+{
+    if (mMemoryBudget <= 0 || mTotalCost <= mMemoryBudget)
+        return;
+
+    QList<UBSceneCacheID> evictedKeys;
+    qint64 remainingCost = mTotalCost;
+
+    foreach(UBSceneCacheID key, mLruKeys)
+    {
+        if (remainingCost <= mMemoryBudget)
+            break;
+
+        UBGraphicsScene* scene = value(key);
+
+        // never drop the page being used, displayed or holding unsaved changes
+        if (key == keptKey || !scene || scene->isActive() || scene->isModified())
+            continue;
+
+        if (UBApplication::boardController && UBApplication::boardController->activeScene() == scene)
+            continue;
+
+        evictedKeys << key;
+        remainingCost -= mSceneCosts.value(key);
+    }
+
+    foreach(UBSceneCacheID key, evictedKeys)
+    {
+        UBGraphicsScene* scene = takeEntry(key).scene;
+
+        mViewStates.insert(key, scene->viewState());
+
+        scene->deleteLater();
+
+        mEvictionCount++;
+    }
+}
+
+
 void UBSceneCache::dumpCacheContent()
 {
     foreach(UBSceneCacheID key, keys())
@@ -36,7 +36,6 @@
 
 class UBDocumentProxy;
 class UBGraphicsScene;
-class UBGraphicsScene;
 
 class UBSceneCacheID
 {
@@ -44,32 +43,34 @@ class UBSceneCacheID
     public:
 
         UBSceneCacheID()
-            : documentProxy(0)
-            , pageIndex(-1)
+            : pageIndex(-1)
         {
             // NOOP
         }
 
-        UBSceneCacheID(UBDocumentProxy* pDocumentProxy, int pPageIndex)
+        UBSceneCacheID(UBDocumentProxy* pDocumentProxy, int pPageIndex);
+
+        UBSceneCacheID(const QUuid& pDocumentUuid, int pPageIndex)
+            : documentUuid(pDocumentUuid)
+            , pageIndex(pPageIndex)
         {
-            documentProxy = pDocumentProxy;
-            pageIndex = pPageIndex;
+            // NOOP
         }
 
-        UBDocumentProxy* documentProxy;
+        QUuid documentUuid;
         int pageIndex;
 
 };
 
 inline bool operator==(const UBSceneCacheID &id1, const UBSceneCacheID &id2)
 {
-    return id1.documentProxy == id2.documentProxy
-        && id1.pageIndex == id2.pageIndex;
+    return id1.pageIndex == id2.pageIndex
+        && id1.documentUuid == id2.documentUuid;
 }
 
-inline uint qHash(const UBSceneCacheID &id)
+inline uint qHash(const UBSceneCacheID &id, uint seed = 0)
 {
-    return qHash(id.pageIndex);
+    return qHash(id.documentUuid, seed) ^ uint(id.pageIndex);
 }
 
 class UBSceneCache : public QHash<UBSceneCacheID, UBGraphicsScene*>
@@ -102,16 +103,91 @@ class UBSceneCache : public QHash<UBSceneCacheID, UBGraphicsScene*>
 
         void shiftUpScenes(UBDocumentProxy* proxy, int startIncIndex, int endIncIndex);
 
+        void updateSceneCost(UBDocumentProxy* proxy, int pageIndex);
+
+        static qint64 estimateSceneCost(UBGraphicsScene* scene);
+
+        void setMemoryBudget(qint64 bytes);
+
+        qint64 memoryBudget() const
+        {
+            return mMemoryBudget;
+        }
+
+        qint64 totalCost() const
+        {
+            return mTotalCost;
+        }
+
+        int hitCount() const
+        {
+            return mHitCount;
+        }
+
+        int missCount() const
+        {
+            return mMissCount;
+        }
+
+        // scenes stored, whether created, loaded on a miss or prefetched
+        int insertCount() const
+        {
+            return mInsertCount;
+        }
+
+        int evictionCount() const
+        {
+            return mEvictionCount;
+        }
+
+        void dumpStatistics() const;
 
     private:
 
-        void internalMoveScene(UBDocumentProxy* proxy, int sourceIndex, int targetIndex);
+        struct CachedEntry
+        {
+            CachedEntry() : scene(0), cost(0), useStamp(0) {}
+
+            UBGraphicsScene* scene;
+            qint64 cost;
+            quint64 useStamp;
+        };
+
+        void removeScene(const UBSceneCacheID& key);
+
+        QList<int> cachedPageIndexes(const QUuid& documentUuid, int firstIndex, int lastIndex) const;
+
+        void insertEntry(const UBSceneCacheID& key, UBGraphicsScene* scene);
+
+        void insertEntry(const UBSceneCacheID& key, const CachedEntry& entry);
+
+        CachedEntry takeEntry(const UBSceneCacheID& key);
+
+        void touch(const UBSceneCacheID& key);
+
+        void evictScenes(const UBSceneCacheID& keptKey);
 
         void dumpCacheContent();
 
         int mCachedSceneCount;
 
-        QQueue<UBSceneCacheID> mCachedKeyFIFO;
+        // least recently used keys come first, ordered by their use stamp
+        QMap<quint64, UBSceneCacheID> mLruKeys;
+        QHash<UBSceneCacheID, quint64> mUseStamps;
+        quint64 mUseClock;
+
+        QHash<UBSceneCacheID, qint64> mSceneCosts;
+        qint64 mTotalCost;
+        qint64 mMemoryBudget;
+
+        int mHitCount;
+        int mMissCount;
+        int mInsertCount;
+        int mEvictionCount;
+
+        // secondary indexes, so that document wide operations only visit the pages of that document
+        QHash<QUuid, QSet<int> > mDocumentPageIndexes;
+        QHash<UBGraphicsScene*, UBSceneCacheID> mSceneKeys;
 
         QHash<UBSceneCacheID, UBGraphicsScene::SceneViewState> mViewStates;
 
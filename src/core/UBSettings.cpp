@@ -286,11 +286,10 @@ void UBSettings::init()
 
     boardInterpolatePenStrokes = new UBSetting(this, "Board", "InterpolatePenStrokes", true);
     boardSimplifyPenStrokes = new UBSetting(this, "Board", "SimplifyPenStrokes", true);
-    boardSimplifyPenStrokesThresholdAngle = new UBSetting(this, "Board", "SimplifyPenStrokesThresholdAngle", 2);
-    boardSimplifyPenStrokesThresholdWidthDifference = new UBSetting(this, "Board", "SimplifyPenStrokesThresholdWidthDifference", 2.0);
 
     boardInterpolateMarkerStrokes = new UBSetting(this, "Board", "InterpolateMarkerStrokes", true);
     boardSimplifyMarkerStrokes = new UBSetting(this, "Board", "SimplifyMarkerStrokes", true);
+    boardSimplifyStrokesTolerance = new UBSetting(this, "Board", "SimplifyStrokesTolerance", 0.5);
 
     boardKeyboardPaletteKeyBtnSize = new UBSetting(this, "Board", "KeyboardPaletteKeyBtnSize", "16x16");
     ValidateKeyboardPaletteKeyBtnSize();
@@ -371,7 +370,9 @@ void UBSettings::init()
     webCookiePolicy = new UBSetting(this, "Web", "CookiePolicy", "DenyThirdParty");
     webPrivateBrowsing = new UBSetting(this, "Web", "PrivateBrowsing", false);
 
-    pageCacheSize = new UBSetting(this, "App", "PageCacheSize", 20);
+    pageCacheMemoryBudget = new UBSetting(this, "App", "PageCacheMemoryBudgetInMB", 512);
+    pagePrefetchWindow = new UBSetting(this, "App", "PagePrefetchWindow", 2);
+    useStrokeSidecar = new UBSetting(this, "App", "UseStrokeSidecar", false);
 
     bitmapFileExtensions << "jpg" << "jpeg" <<  "png" <<  "tiff" << "tif" << "bmp" << "gif";
     vectoFileExtensions << "svg" <<  "svgz";
@@ -418,14 +419,19 @@ void UBSettings::init()
     pdfMargin = new UBSetting(this, "PDF", "Margin", "20");
     pdfPageFormat = new UBSetting(this, "PDF", "PageFormat", "A4");
     pdfUsePDFMerger = new UBSetting(this, "PDF", "UsePDFMerger", "true");
+    pdfMergeAsIncrementalUpdate = new UBSetting(this, "PDF", "MergeAsIncrementalUpdate", true);
     pdfResolution = new UBSetting(this, "PDF", "Resolution", "300");
 
     pdfZoomBehavior = new UBSetting(this, "PDF", "ZoomBehavior", "4");
+    pdfTileCacheMemoryBudget = new UBSetting(this, "PDF", "TileCacheMemoryBudgetInMB", 256);
+    pdfRasterCacheDiskBudget = new UBSetting(this, "PDF", "RasterCacheDiskBudgetInMB", 1024);
     enableQualityLossToIncreaseZoomPerfs = new UBSetting(this, "PDF", "enableQualityLossToIncreaseZoomPerfs", true);
     exportBackgroundGrid = new UBSetting(this, "PDF", "ExportBackgroundGrid", false);
     exportBackgroundColor = new UBSetting(this, "PDF", "ExportBackgroundColor", false);
 
     podcastFramesPerSecond = new UBSetting(this, "Podcast", "FramesPerSecond", 10);
+    podcastVariableFrameRate = new UBSetting(this, "Podcast", "VariableFrameRate", true);
+    podcastKeyframeIntervalInSeconds = new UBSetting(this, "Podcast", "KeyframeIntervalInSeconds", 5);
     podcastVideoSize = new UBSetting(this, "Podcast", "VideoSize", "Medium");
     podcastAudioRecordingDevice = new UBSetting(this, "Podcast", "AudioRecordingDevice", "Default");
 
@@ -291,10 +291,9 @@ class UBSettings : public QObject
 
         UBSetting* boardInterpolatePenStrokes;
         UBSetting* boardSimplifyPenStrokes;
-        UBSetting* boardSimplifyPenStrokesThresholdAngle;
-        UBSetting* boardSimplifyPenStrokesThresholdWidthDifference;
         UBSetting* boardInterpolateMarkerStrokes;
         UBSetting* boardSimplifyMarkerStrokes;
+        UBSetting* boardSimplifyStrokesTolerance;
 
         UBSetting* boardKeyboardPaletteKeyBtnSize;
 
@@ -339,7 +338,9 @@ class UBSettings : public QObject
         UBSetting* webCookiePolicy;
         UBSetting* webPrivateBrowsing;
 
-        UBSetting* pageCacheSize;
+        UBSetting* pageCacheMemoryBudget;
+        UBSetting* pagePrefetchWindow;
+        UBSetting* useStrokeSidecar;
 
         UBSetting* boardZoomBase;
         UBSetting* boardZoomFactor;
@@ -366,14 +367,20 @@ class UBSettings : public QObject
         UBSetting* pdfMargin;
         UBSetting* pdfPageFormat;
         UBSetting* pdfUsePDFMerger;
+        // only used when every page of the background PDF is in the document, the update ships the whole file
+        UBSetting* pdfMergeAsIncrementalUpdate;
         UBSetting* pdfResolution;
 
         UBSetting* pdfZoomBehavior;
+        UBSetting* pdfTileCacheMemoryBudget;
+        UBSetting* pdfRasterCacheDiskBudget;
         UBSetting* enableQualityLossToIncreaseZoomPerfs;
         UBSetting* exportBackgroundGrid;
         UBSetting* exportBackgroundColor;
 
         UBSetting* podcastFramesPerSecond;
+        UBSetting* podcastVariableFrameRate;
+        UBSetting* podcastKeyframeIntervalInSeconds;
         UBSetting* podcastVideoSize;
         UBSetting* podcastWindowsMediaBitsPerSecond;
         UBSetting* podcastAudioRecordingDevice;
@@ -5,6 +5,7 @@ HEADERS      += src/core/UB.h \
                 src/core/UBSetting.h \
                 src/core/UBPersistenceManager.h \
                 src/core/UBSceneCache.h \
+                src/core/UBDocumentCatalog.h \
                 src/core/UBPreferencesController.h \
                 src/core/UBMimeData.h \
                 src/core/UBIdleTimer.h \
@@ -24,6 +25,7 @@ SOURCES      += src/core/main.cpp \
                 src/core/UBSetting.cpp \
                 src/core/UBPersistenceManager.cpp \
                 src/core/UBSceneCache.cpp \
+                src/core/UBDocumentCatalog.cpp \
                 src/core/UBPreferencesController.cpp \
                 src/core/UBMimeData.cpp \
                 src/core/UBIdleTimer.cpp \
@@ -140,6 +140,16 @@ void UBDocumentContainer::updateThumbPage(int index)
     }
 }
 
+void UBDocumentContainer::setThumbPage(int index, std::shared_ptr<QPixmap> thumbnailPixmap)
+{
+    if (mDocumentThumbs.size() > index)
+    {
+        mDocumentThumbs[index] = thumbnailPixmap;
+
+        emit documentPageUpdated(index);
+    }
+}
+
 void UBDocumentContainer::insertThumbPage(int index)
 {
     QPixmap newPixmap = UBThumbnailAdaptor::get(mCurrentDocument, index);
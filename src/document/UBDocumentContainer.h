@@ -77,6 +77,7 @@ class UBDocumentContainer : public QObject
         void addEmptyThumbPage();
         void deleteThumbPage(int index);
         void updateThumbPage(int index);
+        void setThumbPage(int index, std::shared_ptr<QPixmap> thumbnailPixmap);
         void moveThumbPage(int source, int target);
 
     private:
@@ -48,6 +48,7 @@
 #include "adaptors/UBWidgetUpgradeAdaptor.h"
 
 #include "adaptors/UBMetadataDcSubsetAdaptor.h"
+#include "adaptors/UBPageManifest.h"
 
 #include "board/UBBoardController.h"
 #include "board/UBBoardPaletteManager.h"
@@ -65,6 +66,7 @@
 #include "domain/UBGraphicsPixmapItem.h"
 
 #include "document/UBDocumentProxy.h"
+#include "document/UBThumbnailService.h"
 
 #include "ui_documents.h"
 #include "ui_mainWindow.h"
@@ -1549,8 +1551,8 @@ void UBDocumentTreeView::dropEvent(QDropEvent *event)
 
                 UBPersistenceManager::persistenceManager()->insertDocumentSceneAt(targetDocProxy, sceneClone, targetDocProxy->pageCount());
 
-                QString thumbTmp(fromProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", fromIndex));
-                QString thumbTo(targetDocProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", toIndex));
+                QString thumbTmp(UBPageManifest::pageThumbnailPath(fromProxy->persistencePath(), fromIndex));
+                QString thumbTo(UBPageManifest::pageThumbnailPath(targetDocProxy->persistencePath(), toIndex));
 
                 QFile::remove(thumbTo);
                 QFile::copy(thumbTmp, thumbTo);
@@ -3104,9 +3106,10 @@ void UBDocumentController::insertThumbnail(int index, const QPixmap& pix)
 
 void UBDocumentController::updateThumbnail(int index)
 {
-    auto pix = UBApplication::boardController->pageAt(index);
+    auto pix = pageAt(index);
 
-    mDocumentUI->thumbnailWidget->updateThumbnailPixmap(index, *pix);
+    if (pix)
+        mDocumentUI->thumbnailWidget->updateThumbnailPixmap(index, *pix);
 }
 
 
@@ -3813,10 +3816,8 @@ void UBDocumentController:: refreshDocumentThumbnailsView(UBDocumentContainer* s
         return;
     }
 
-    if (currentDocumentProxy)
-    {
-        UBThumbnailAdaptor::load(currentDocumentProxy, documentThumbs());
-    }
+    // placeholders at first, each thumbnail is shown as soon as it is loaded
+    UBThumbnailService::thumbnailService()->load(this);
 
     QList<QGraphicsItem*> items;
     QList<QUrl> itemsPath;
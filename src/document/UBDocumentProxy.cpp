@@ -65,6 +65,10 @@ UBDocumentProxy::UBDocumentProxy(const QString& pPersistancePath)
     setPersistencePath(pPersistancePath);
 
     mMetaDatas = UBMetadataDcSubsetAdaptor::load(pPersistancePath);
+
+    // the uuid identifies the document in the scene cache, old documents may lack it
+    if (uuid().isNull())
+        setUuid(QUuid::createUuid());
 }
 
 
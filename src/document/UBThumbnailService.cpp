@@ -0,0 +1,424 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#include "UBThumbnailService.h"
+
+#include <QtConcurrent>
+
+#include "core/UBSettings.h"
+
+#include "adaptors/UBThumbnailAdaptor.h"
+#include "adaptors/UBThumbnailPack.h"
+#include "adaptors/UBPageManifest.h"
+
+#include "document/UBDocumentContainer.h"
+#include "document/UBDocumentProxy.h"
+
+#include "domain/UBGraphicsScene.h"
+
+#include "core/memcheck.h"
+
+UBThumbnailService* UBThumbnailService::sThumbnailService = 0;
+
+UBThumbnailService* UBThumbnailService::thumbnailService()
+{
+    if (!sThumbnailService)
+        sThumbnailService = new UBThumbnailService(qApp);
+
+    return sThumbnailService;
+}
+
+UBThumbnailService::UBThumbnailService(QObject* parent)
+    : QObject(parent)
+    , mLastJobId(0)
+    , mRenderScheduled(false)
+{
+    // NOOP
+}
+
+UBThumbnailService::~UBThumbnailService()
+{
+    qDeleteAll(mJobs);
+}
+
+void UBThumbnailService::load(UBDocumentContainer* container)
+{
+    cancel(container);
+
+    UBDocumentProxy* proxy = container->selectedDocument();
+    QList<std::shared_ptr<QPixmap>>& thumbs = container->documentThumbs();
+
+    thumbs.clear();
+
+    if (!proxy)
+        return;
+
+    // a blank page stands in for each thumbnail until it is loaded
+    QSize documentSize = proxy->defaultDocumentSize();
+    qreal ratio = documentSize.isEmpty() ? UBSettings::minScreenRatio : (qreal)documentSize.width() / documentSize.height();
+
+    QPixmap placeholder(UBSettings::maxThumbnailWidth, qRound(UBSettings::maxThumbnailWidth / ratio));
+    placeholder.fill(Qt::white);
+
+    Job* job = new Job;
+    job->id = ++mLastJobId;
+    job->generation = 0;
+    job->container = container;
+    job->proxy = proxy;
+    job->documentPath = proxy->persistencePath();
+    job->pack = std::make_shared<UBThumbnailPack>(job->documentPath);
+
+    for (int i = 0; i < proxy->pageCount(); i++)
+    {
+        thumbs << std::make_shared<QPixmap>(placeholder);
+        job->pending << i;
+    }
+
+    mJobs << job;
+
+    connect(container, SIGNAL(documentPageInserted(int)), this, SLOT(pageInserted(int)), Qt::UniqueConnection);
+    connect(container, SIGNAL(documentPageRemoved(int)), this, SLOT(pageRemoved(int)), Qt::UniqueConnection);
+    connect(container, SIGNAL(documentPageMoved(int, int)), this, SLOT(pageMoved(int, int)), Qt::UniqueConnection);
+
+    dispatch(job);
+}
+
+void UBThumbnailService::cancel(UBDocumentContainer* container)
+{
+    Job* job = jobFor(container);
+
+    // the pages still being read are dropped when they come back
+    if (job)
+    {
+        mJobs.removeAll(job);
+        delete job;
+    }
+}
+
+void UBThumbnailService::prioritize(UBDocumentProxy* proxy, const QList<int>& pageIndexes)
+{
+    foreach (Job* job, mJobs)
+    {
+        if (job->proxy != proxy)
+            continue;
+
+        // going backwards keeps the given pages in their order at the front of the queues
+        for (int i = pageIndexes.size() - 1; i >= 0; i--)
+        {
+            int pageIndex = pageIndexes.at(i);
+
+            if (job->pending.removeOne(pageIndex))
+                job->pending.prepend(pageIndex);
+
+            for (int j = 0; j < job->toRender.size(); j++)
+            {
+                if (job->toRender.at(j).pageIndex == pageIndex)
+                {
+                    job->toRender.move(j, 0);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+UBThumbnailService::LoadedPage UBThumbnailService::loadPage(std::shared_ptr<UBThumbnailPack> pack, const QString& documentPath, int pageIndex)
+{
+    LoadedPage page;
+    page.pageIndex = pageIndex;
+
+    // the pack is indexed by file number, that follows the page when it is moved
+    int pageNumber = UBPageManifest::pageNumber(documentPath, pageIndex);
+    QByteArray jpegData = pack->read(pageNumber);
+
+    if (!jpegData.isEmpty())
+    {
+        page.thumbnail = QImage::fromData(jpegData, "JPG");
+    }
+    else
+    {
+        // not packed yet, or changed by an older version: the jpeg file is read and packed
+        QFile file(documentPath + "/" + UBPageManifest::thumbnailFileName(pageNumber));
+
+        if (file.open(QIODevice::ReadOnly))
+        {
+            jpegData = file.readAll();
+            qint64 modified = QFileInfo(file).lastModified().toMSecsSinceEpoch();
+            file.close();
+
+            page.thumbnail = QImage::fromData(jpegData, "JPG");
+
+            if (!page.thumbnail.isNull())
+                UBThumbnailPack::write(documentPath, pageNumber, jpegData, modified);
+        }
+    }
+
+    // a missing or unreadable thumbnail is rendered again from the page
+    if (page.thumbnail.isNull())
+        page.preparedScene = UBSvgSubsetAdaptor::prepareScene(documentPath, pageIndex);
+
+    return page;
+}
+
+UBThumbnailService::Job* UBThumbnailService::jobFor(QObject* container) const
+{
+    foreach (Job* job, mJobs)
+    {
+        if (job->container.data() == container)
+            return job;
+    }
+
+    return 0;
+}
+
+void UBThumbnailService::dispatch(Job* job)
+{
+    // the pages waiting to be rendered count too, so that parsed scenes do not pile up
+    int maxInFlight = qMax(2, QThreadPool::globalInstance()->maxThreadCount());
+
+    while (!job->pending.isEmpty() && job->running.size() + job->toRender.size() < maxInFlight)
+    {
+        int pageIndex = job->pending.takeFirst();
+        job->running << pageIndex;
+
+        int jobId = job->id;
+        int generation = job->generation;
+
+        QFutureWatcher<LoadedPage>* watcher = new QFutureWatcher<LoadedPage>(this);
+
+        connect(watcher, &QFutureWatcher<LoadedPage>::finished, this, [this, watcher, jobId, generation]() {
+            pageLoaded(jobId, generation, watcher->result());
+            watcher->deleteLater();
+        });
+
+        watcher->setFuture(QtConcurrent::run(&UBThumbnailService::loadPage, job->pack, job->documentPath, pageIndex));
+    }
+}
+
+void UBThumbnailService::pageLoaded(int jobId, int generation, const LoadedPage& page)
+{
+    Job* job = 0;
+
+    foreach (Job* candidate, mJobs)
+    {
+        if (candidate->id == jobId)
+            job = candidate;
+    }
+
+    // cancelled, or the pages were reordered meanwhile and this one is queued again
+    if (!job || job->generation != generation)
+        return;
+
+    job->running.removeOne(page.pageIndex);
+
+    if (!page.thumbnail.isNull())
+    {
+        if (!publish(job, page.pageIndex, page.thumbnail))
+            return;
+    }
+    else if (!page.preparedScene.xmlData.isEmpty())
+    {
+        job->toRender << page;
+        scheduleRendering();
+    }
+
+    dispatch(job);
+    finishIfDone(job);
+}
+
+void UBThumbnailService::scheduleRendering()
+{
+    if (!mRenderScheduled)
+    {
+        mRenderScheduled = true;
+        QTimer::singleShot(0, this, SLOT(renderNextPage()));
+    }
+}
+
+void UBThumbnailService::renderNextPage()
+{
+    mRenderScheduled = false;
+
+    Job* job = 0;
+
+    foreach (Job* candidate, mJobs)
+    {
+        if (!candidate->toRender.isEmpty())
+        {
+            job = candidate;
+            break;
+        }
+    }
+
+    if (!job)
+        return;
+
+    // one page at a time, the events queued meanwhile are handled before the next one
+    LoadedPage page = job->toRender.takeFirst();
+
+    UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(job->proxy, page.preparedScene);
+
+    if (scene)
+    {
+        QImage thumbnail = UBThumbnailAdaptor::render(scene);
+        delete scene;
+
+        QString documentPath = job->documentPath;
+        int pageIndex = page.pageIndex;
+
+        QtConcurrent::run([documentPath, pageIndex, thumbnail]() {
+            UBThumbnailAdaptor::store(documentPath, pageIndex, thumbnail);
+        });
+
+        if (!publish(job, page.pageIndex, thumbnail))
+            job = 0;
+    }
+
+    if (job)
+    {
+        dispatch(job);
+        finishIfDone(job);
+    }
+
+    foreach (Job* candidate, mJobs)
+    {
+        if (!candidate->toRender.isEmpty())
+        {
+            scheduleRendering();
+            break;
+        }
+    }
+}
+
+bool UBThumbnailService::publish(Job* job, int pageIndex, const QImage& thumbnail)
+{
+    // another document was selected without asking for its thumbnails
+    if (!job->container || job->container->selectedDocument() != job->proxy)
+    {
+        mJobs.removeAll(job);
+        delete job;
+
+        return false;
+    }
+
+    job->container->setThumbPage(pageIndex, std::make_shared<QPixmap>(QPixmap::fromImage(thumbnail)));
+
+    return true;
+}
+
+void UBThumbnailService::finishIfDone(Job* job)
+{
+    if (job->pending.isEmpty() && job->running.isEmpty() && job->toRender.isEmpty())
+    {
+        mJobs.removeAll(job);
+        delete job;
+    }
+}
+
+void UBThumbnailService::remapPages(Job* job, std::function<int(int)> map)
+{
+    // the pages being read may have moved, they are read again under their new index
+    QList<int> pages = job->running + job->pending;
+
+    job->running.clear();
+    job->pending.clear();
+
+    foreach (int pageIndex, pages)
+    {
+        int newIndex = map(pageIndex);
+
+        if (newIndex >= 0)
+            job->pending << newIndex;
+    }
+
+    QList<LoadedPage> toRender;
+
+    foreach (LoadedPage page, job->toRender)
+    {
+        page.pageIndex = map(page.pageIndex);
+
+        if (page.pageIndex >= 0)
+            toRender << page;
+    }
+
+    job->toRender = toRender;
+    job->generation++;
+
+    dispatch(job);
+}
+
+void UBThumbnailService::pageInserted(int index)
+{
+    Job* job = jobFor(sender());
+
+    if (job)
+    {
+        remapPages(job, [index](int pageIndex) {
+            return pageIndex >= index ? pageIndex + 1 : pageIndex;
+        });
+    }
+}
+
+void UBThumbnailService::pageRemoved(int index)
+{
+    Job* job = jobFor(sender());
+
+    if (job)
+    {
+        remapPages(job, [index](int pageIndex) {
+            if (pageIndex == index)
+                return -1;
+
+            return pageIndex > index ? pageIndex - 1 : pageIndex;
+        });
+
+        finishIfDone(job);
+    }
+}
+
+void UBThumbnailService::pageMoved(int from, int to)
+{
+    Job* job = jobFor(sender());
+
+    if (job)
+    {
+        remapPages(job, [from, to](int pageIndex) {
+            if (pageIndex == from)
+                return to;
+            else if (from < to && pageIndex > from && pageIndex <= to)
+                return pageIndex - 1;
+            else if (from > to && pageIndex >= to && pageIndex < from)
+                return pageIndex + 1;
+
+            return pageIndex;
+        });
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#ifndef UBTHUMBNAILSERVICE_H_
+#define UBTHUMBNAILSERVICE_H_
+
+#include <QtGui>
+#include <functional>
+#include <memory>
+
+#include "adaptors/UBSvgSubsetAdaptor.h"
+
+class UBDocumentContainer;
+class UBDocumentProxy;
+class UBThumbnailPack;
+
+/**
+ * @brief Loads the page thumbnails of a document without blocking the user interface
+ *
+ * The thumbnails are read from the document's thumbnail pack and decoded on the global thread pool. The pages missing a thumbnail are parsed
+ * there too, but their scene can only be built and rendered on the GUI thread, so this is done one page per
+ * event loop iteration. Each thumbnail replaces its placeholder in the container as soon as it is ready, and
+ * the pages shown by the thumbnail views are handled first.
+ */
+class UBThumbnailService : public QObject
+{
+    Q_OBJECT
+
+    public:
+        static UBThumbnailService* thumbnailService();
+
+        void load(UBDocumentContainer* container);
+        void cancel(UBDocumentContainer* container);
+
+        void prioritize(UBDocumentProxy* proxy, const QList<int>& pageIndexes);
+
+    private slots:
+        void renderNextPage();
+
+        void pageInserted(int index);
+        void pageRemoved(int index);
+        void pageMoved(int from, int to);
+
+    private:
+        struct LoadedPage
+        {
+            int pageIndex;
+            QImage thumbnail;
+            UBSvgPreparedScene preparedScene;
+        };
+
+        struct Job
+        {
+            int id;
+            int generation;
+            QPointer<UBDocumentContainer> container;
+            UBDocumentProxy* proxy;
+            // the pages are read by the pool threads, that do not touch the proxy
+            QString documentPath;
+            std::shared_ptr<UBThumbnailPack> pack;
+            QList<int> pending;
+            QList<int> running;
+            QList<LoadedPage> toRender;
+        };
+
+        UBThumbnailService(QObject* parent = 0);
+        virtual ~UBThumbnailService();
+
+        static LoadedPage loadPage(std::shared_ptr<UBThumbnailPack> pack, const QString& documentPath, int pageIndex);
+
+        Job* jobFor(QObject* container) const;
+        void dispatch(Job* job);
+        void pageLoaded(int jobId, int generation, const LoadedPage& page);
+        bool publish(Job* job, int pageIndex, const QImage& thumbnail);
+        void finishIfDone(Job* job);
+        void scheduleRendering();
+        void remapPages(Job* job, std::function<int(int)> map);
+
+        static UBThumbnailService* sThumbnailService;
+
+        QList<Job*> mJobs;
+        int mLastJobId;
+        bool mRenderScheduled;
+};
+
+#endif /* UBTHUMBNAILSERVICE_H_ */
@@ -2,10 +2,12 @@ HEADERS += \
     src/document/UBDocumentContainer.h \
     src/document/UBDocumentController.h \
     src/document/UBDocumentProxy.h \
-    src/document/UBSortFilterProxyModel.h
+    src/document/UBSortFilterProxyModel.h \
+    src/document/UBThumbnailService.h
 SOURCES += \
     src/document/UBDocumentContainer.cpp \
     src/document/UBDocumentController.cpp \
     src/document/UBDocumentProxy.cpp \
-    src/document/UBSortFilterProxyModel.cpp
+    src/document/UBSortFilterProxyModel.cpp \
+    src/document/UBThumbnailService.cpp
 
@@ -300,7 +300,7 @@ QVariant UBGraphicsItemDelegate::itemChange(QGraphicsItem::GraphicsItemChange ch
         {
             if (ubScene)
             {
-                ubScene->setModified(true);
+                ubScene->setItemModified(mDelegated);
             }
 
             if (controlsExist())
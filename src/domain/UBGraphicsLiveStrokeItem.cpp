@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "UBGraphicsLiveStrokeItem.h"
+
+#include <algorithm>
+
+#include "domain/UBGraphicsScene.h"
+
+#include "core/memcheck.h"
+
+
+namespace UBGraphicsLiveStrokeItemGeometry
+{
+    // The bounding rect grows by steps, each change of geometry repaints the whole item.
+    const qreal growthMargin = 256;
+}
+
+UBGraphicsLiveStrokeItem::UBGraphicsLiveStrokeItem(const QColor& color, QGraphicsItem* parent)
+    : QGraphicsItem(parent)
+    , mColor(color)
+{
+    // paint() only redraws the segments in the exposed rect
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+
+    setData(UBGraphicsItemData::itemLayerType, QVariant(itemLayerType::DrawingItem)); //Necessary to set if we want z value to be assigned correctly
+}
+
+void UBGraphicsLiveStrokeItem::appendSegment(const QPolygonF& segment)
+{
+    QPolygonF polygon = segment;
+
+    // The segments are filled as one path with the winding rule, they must turn the same way not to cancel each other
+    qreal area = 0;
+    for (int i = 0; i < polygon.size(); i++)
+    {
+        const QPointF& p1 = polygon.at(i);
+        const QPointF& p2 = polygon.at((i + 1) % polygon.size());
+        area += p1.x() * p2.y() - p2.x() * p1.y();
+    }
+
+    if (area < 0)
+        std::reverse(polygon.begin(), polygon.end());
+
+    QRectF rect = polygon.boundingRect();
+
+    mSegments << polygon;
+    mSegmentRects << rect;
+
+    growBoundingRect(rect);
+    update(rect);
+}
+
+void UBGraphicsLiveStrokeItem::setTail(const QPolygonF& tail)
+{
+    if (!mTail.isEmpty())
+        update(mTail.boundingRect());
+
+    mTail = tail;
+
+    growBoundingRect(mTail.boundingRect());
+    update(mTail.boundingRect());
+}
+
+QRectF UBGraphicsLiveStrokeItem::boundingRect() const
+{
+    return mBoundingRect;
+}
+
+void UBGraphicsLiveStrokeItem::growBoundingRect(const QRectF& rect)
+{
+    if (mBoundingRect.contains(rect))
+        return;
+
+    const qreal margin = UBGraphicsLiveStrokeItemGeometry::growthMargin;
+
+    prepareGeometryChange();
+    mBoundingRect = mBoundingRect.united(rect.adjusted(-margin, -margin, margin, margin));
+}
+
+void UBGraphicsLiveStrokeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(widget);
+
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill);
+
+    for (int i = 0; i < mSegments.size(); i++)
+    {
+        if (mSegmentRects.at(i).intersects(option->exposedRect))
+            path.addPolygon(mSegments.at(i));
+    }
+
+    if (!mTail.isEmpty() && mTail.boundingRect().intersects(option->exposedRect))
+        path.addPolygon(mTail);
+
+    UBGraphicsScene* ubScene = qobject_cast<UBGraphicsScene*>(scene());
+    if (mColor.alphaF() < 1.0 && ubScene && ubScene->isLightBackground())
+        painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+    painter->setRenderHints(QPainter::Antialiasing);
+    painter->fillPath(path, mColor);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UBGRAPHICSLIVESTROKEITEM_H_
+#define UBGRAPHICSLIVESTROKEITEM_H_
+
+#include <QtGui>
+#include <QGraphicsItem>
+
+#include "core/UB.h"
+
+/**
+ * Draws the stroke being drawn as a single item: the segments are appended to its buffer and only
+ * their area is repainted, instead of adding a polygon item to the scene for every input event.
+ * The scene turns the segments into polygon items of the stroke when the input device is released.
+ */
+class UBGraphicsLiveStrokeItem : public QGraphicsItem
+{
+    public:
+        UBGraphicsLiveStrokeItem(const QColor& color, QGraphicsItem* parent = 0);
+
+        void appendSegment(const QPolygonF& segment);
+
+        // the line from the last drawn point to the input device, replaced on every move
+        void setTail(const QPolygonF& tail);
+
+        enum { Type = UBGraphicsItemType::LiveStrokeItemType };
+
+        virtual int type() const
+        {
+            return Type;
+        }
+
+        virtual QRectF boundingRect() const;
+
+    protected:
+        virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
+
+    private:
+        void growBoundingRect(const QRectF& rect);
+
+        QColor mColor;
+
+        QVector<QPolygonF> mSegments;
+        QVector<QRectF> mSegmentRects;
+        QPolygonF mTail;
+
+        QRectF mBoundingRect;
+};
+
+#endif /* UBGRAPHICSLIVESTROKEITEM_H_ */
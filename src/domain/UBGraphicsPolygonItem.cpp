@@ -90,6 +90,12 @@ void UBGraphicsPolygonItem::initialize()
 {
     setData(UBGraphicsItemData::itemLayerType, QVariant(itemLayerType::DrawingItem)); //Necessary to set if we want z value to be assigned correctly
     setUuid(QUuid::createUuid());
+
+    // keeps the eraser index of the scene up to date when a parent group moves
+    setFlag(QGraphicsItem::ItemSendsScenePositionChanges, true);
+
+    // itemChange() is not called for a parent given to the constructor
+    invalidateStrokeIndex();
 }
 
 void UBGraphicsPolygonItem::setUuid(const QUuid &pUuid)
@@ -111,9 +117,42 @@ void UBGraphicsPolygonItem::clearStroke()
 
 UBGraphicsPolygonItem::~UBGraphicsPolygonItem()
 {
+    if (scene())
+        scene()->strokeIndex()->remove(this);
+
     clearStroke();
 }
 
+void UBGraphicsPolygonItem::invalidateStrokeIndex()
+{
+    if (scene())
+        scene()->strokeIndex()->invalidate(this);
+}
+
+QVariant UBGraphicsPolygonItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    switch (change)
+    {
+    case ItemSceneChange:
+        if (scene())
+            scene()->strokeIndex()->remove(this);
+        break;
+    case ItemParentChange:
+        // leaving its strokes group, e.g. when erased: the pending simplification must not replace it
+        if (mStroke)
+            mStroke->cancelSimplification();
+        break;
+    case ItemSceneHasChanged:
+    case ItemScenePositionHasChanged:
+        invalidateStrokeIndex();
+        break;
+    default:
+        break;
+    }
+
+    return QGraphicsPolygonItem::itemChange(change, value);
+}
+
 void UBGraphicsPolygonItem::setStrokesGroup(UBGraphicsStrokesGroup *group)
 {
     mpGroup = group;
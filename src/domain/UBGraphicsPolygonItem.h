@@ -73,6 +73,7 @@ class UBGraphicsPolygonItem : public QGraphicsPolygonItem, public UBItem
                 {
                     mIsNominalLine = false;
                     QGraphicsPolygonItem::setPolygon(subtractedPolygon);
+                    invalidateStrokeIndex();
                 }
             }
         }
@@ -85,6 +86,7 @@ class UBGraphicsPolygonItem : public QGraphicsPolygonItem, public UBItem
             {
                 mIsNominalLine = false;
                 QGraphicsPolygonItem::setPolygon(subtractedPolygon);
+                invalidateStrokeIndex();
             }
         }
 
@@ -99,6 +101,7 @@ class UBGraphicsPolygonItem : public QGraphicsPolygonItem, public UBItem
         {
             mIsNominalLine = false;
             QGraphicsPolygonItem::setPolygon(pPolygon);
+            invalidateStrokeIndex();
         }
 
         virtual UBItem* deepCopy() const;
@@ -136,11 +139,13 @@ class UBGraphicsPolygonItem : public QGraphicsPolygonItem, public UBItem
 
     protected:
         void paint ( QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget);
+        virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value);
 
 
     private:
 
         void clearStroke();
+        void invalidateStrokeIndex();
 
         bool mHasAlpha;
 
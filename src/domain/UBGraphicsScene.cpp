@@ -59,6 +59,7 @@
 
 #include "document/UBDocumentProxy.h"
 
+#include "board/UBBackgroundGrid.h"
 #include "board/UBBoardController.h"
 #include "board/UBDrawingController.h"
 #include "board/UBBoardView.h"
@@ -80,6 +81,7 @@
 #include "domain/UBGraphicsGroupContainerItem.h"
 
 #include "UBGraphicsStroke.h"
+#include "UBGraphicsLiveStrokeItem.h"
 
 #include "core/memcheck.h"
 
@@ -337,6 +339,8 @@ UBGraphicsScene::UBGraphicsScene(UBDocumentProxy* parent, bool enableUndoRedoSta
     , mZLayerController(new UBZLayerController(this))
     , mpLastPolygon(NULL)
     , mTempPolygon(NULL)
+    , mLiveStrokeEnabled(false)
+    , mLiveStroke(NULL)
     , mDrawWithCompass(false)
     , mCurrentPolygon(0)
     , mSelectionFrame(0)
@@ -369,6 +373,10 @@ UBGraphicsScene::UBGraphicsScene(UBDocumentProxy* parent, bool enableUndoRedoSta
 
 UBGraphicsScene::~UBGraphicsScene()
 {
+    // not in the scene yet when it is closed while drawing
+    qDeleteAll(mLivePolygons);
+    delete mTempPolygon;
+
     if (mCurrentStroke && mCurrentStroke->polygons().empty()){
         delete mCurrentStroke;
         mCurrentStroke = NULL;
@@ -450,6 +458,8 @@ bool UBGraphicsScene::inputDevicePress(const QPointF& scenePos, const qreal& pre
             mAddedItems.clear();
             mRemovedItems.clear();
 
+            mLiveStrokeEnabled = currentTool != UBStylusTool::Line && !UBDrawingController::drawingController()->mActiveRuler;
+
             if (UBDrawingController::drawingController()->mActiveRuler)
                 UBDrawingController::drawingController()->mActiveRuler->StartLine(scenePos, width);
             else {
@@ -480,7 +490,7 @@ bool UBGraphicsScene::inputDevicePress(const QPointF& scenePos, const qreal& pre
         }
     }
 
-    if (mCurrentStroke && mCurrentStroke->polygons().empty()){
+    if (mCurrentStroke && mCurrentStroke->polygons().empty() && mLivePolygons.empty()){
         delete mCurrentStroke;
         mCurrentStroke = NULL;
     }
@@ -595,37 +605,11 @@ bool UBGraphicsScene::inputDeviceMove(const QPointF& scenePos, const qreal& pres
 
                 qreal antiScaleRatio = 1./(UBApplication::boardController->systemScaleFactor() * UBApplication::boardController->currentZoom());
                 qreal MIN_DISTANCE = 10*antiScaleRatio; // arbitrary. Move to settings if relevant.
-                qreal distance = QLineF(mPreviousPoint, scenePos).length();
-
-                mDistanceFromLastStrokePoint += distance;
-
-                if (mDistanceFromLastStrokePoint > MIN_DISTANCE) {
-                    QList<QPair<QPointF, qreal> > newPoints = mCurrentStroke->addPoint(scenePos, width, interpolate);
-                    if (newPoints.length() > 1)
-                        drawCurve(newPoints);
-
-                    mDistanceFromLastStrokePoint = 0;
-                }
 
-                if (interpolate) {
-                    // Bezier curves aren't drawn all the way to the scenePos (they stop halfway between the previous and
-                    // current scenePos), so we add a line from the last drawn position in the stroke and the
-                    // scenePos, to make the drawing feel more responsive. This line is then deleted if a new segment is
-                    // added to the stroke. (Or it is added to the stroke when we stop drawing)
+                addFreehandPoint(scenePos, width, interpolate, MIN_DISTANCE);
 
-                    if (mTempPolygon) {
-                        removeItem(mTempPolygon);
-                        mTempPolygon = NULL;
-                    }
-
-                    if (!mCurrentStroke->points().empty())
-                    {
-                        QPointF lastDrawnPoint = mCurrentStroke->points().last().first;
-
-                        mTempPolygon = lineToPolygonItem(QLineF(lastDrawnPoint, scenePos), mPreviousWidth, width);
-                        addItem(mTempPolygon);
-                    }
-                }
+                if (interpolate)
+                    updateFreehandTail(scenePos, width);
             }
         }
         else if (currentTool == UBStylusTool::Eraser)
@@ -647,6 +631,94 @@ bool UBGraphicsScene::inputDeviceMove(const QPointF& scenePos, const qreal& pres
     return accepted;
 }
 
+/**
+ * @brief Draw a batch of samples of the input device, received during the same frame
+ *
+ * Freehand strokes take every sample of the batch but the temporary line to the input device is only
+ * rebuilt once, the other tools go through the single sample path. The points are kept by distance and
+ * each takes its own pressure, as in the single sample path, so the timestamps are not needed here.
+ */
+bool UBGraphicsScene::inputDeviceMove(const QVector<UBInputSample>& samples)
+{
+    if (samples.isEmpty())
+        return false;
+
+    UBDrawingController *dc = UBDrawingController::drawingController();
+    UBStylusTool::Enum currentTool = (UBStylusTool::Enum)dc->stylusTool();
+
+    if (!mInputDeviceIsPressed || !mLiveStrokeEnabled || !mCurrentStroke || dc->mActiveRuler
+            || (currentTool != UBStylusTool::Pen && currentTool != UBStylusTool::Marker))
+    {
+        bool accepted = false;
+
+        foreach (const UBInputSample& sample, samples)
+            accepted = inputDeviceMove(sample.scenePos, sample.pressure) || accepted;
+
+        return accepted;
+    }
+
+    if (currentTool == UBStylusTool::Marker)
+        hideMarkerCircle();
+    else
+        hidePenCircle();
+
+    bool interpolate = (currentTool == UBStylusTool::Pen && UBSettings::settings()->boardInterpolatePenStrokes->get().toBool())
+            || (currentTool == UBStylusTool::Marker && UBSettings::settings()->boardInterpolateMarkerStrokes->get().toBool());
+
+    qreal antiScaleRatio = 1./(UBApplication::boardController->systemScaleFactor() * UBApplication::boardController->currentZoom());
+    qreal minDistance = 10*antiScaleRatio; // same as inputDeviceMove(const QPointF&, const qreal&)
+    qreal toolWidth = dc->currentToolWidth() * antiScaleRatio;
+    qreal width = toolWidth;
+
+    foreach (const UBInputSample& sample, samples)
+    {
+        width = toolWidth * qMax(sample.pressure, 0.2);
+        addFreehandPoint(sample.scenePos, width, interpolate, minDistance);
+    }
+
+    if (interpolate)
+        updateFreehandTail(samples.last().scenePos, width);
+
+    return true;
+}
+
+void UBGraphicsScene::addFreehandPoint(const QPointF& scenePos, qreal width, bool interpolate, qreal minDistance)
+{
+    qreal distance = QLineF(mPreviousPoint, scenePos).length();
+
+    mDistanceFromLastStrokePoint += distance;
+
+    if (mDistanceFromLastStrokePoint > minDistance) {
+        QList<QPair<QPointF, qreal> > newPoints = mCurrentStroke->addPoint(scenePos, width, interpolate);
+        if (newPoints.length() > 1)
+            drawCurve(newPoints);
+
+        mDistanceFromLastStrokePoint = 0;
+    }
+}
+
+void UBGraphicsScene::updateFreehandTail(const QPointF& scenePos, qreal width)
+{
+    // Bezier curves aren't drawn all the way to the scenePos (they stop halfway between the previous and
+    // current scenePos), so we add a line from the last drawn position in the stroke and the
+    // scenePos, to make the drawing feel more responsive. This line is then deleted if a new segment is
+    // added to the stroke. (Or it is added to the stroke when we stop drawing)
+
+    // The temporary line is drawn by the live stroke, it never enters the scene.
+    delete mTempPolygon;
+    mTempPolygon = NULL;
+
+    if (!mCurrentStroke->points().empty())
+    {
+        QPointF lastDrawnPoint = mCurrentStroke->points().last().first;
+
+        mTempPolygon = lineToPolygonItem(QLineF(lastDrawnPoint, scenePos), mPreviousWidth, width);
+
+        if (mLiveStroke)
+            mLiveStroke->setTail(mTempPolygon->polygon());
+    }
+}
+
 bool UBGraphicsScene::inputDeviceRelease(int tool)
 {
     bool accepted = false;
@@ -701,21 +773,17 @@ bool UBGraphicsScene::inputDeviceRelease(int tool)
             mDrawWithCompass = false;
         }
         else if (mCurrentStroke){
+            finishLiveStroke();
+
             if (mTempPolygon) {
-                UBGraphicsPolygonItem * poly = dynamic_cast<UBGraphicsPolygonItem*>(mTempPolygon->deepCopy());
-                removeItem(mTempPolygon);
+                UBGraphicsPolygonItem * poly = mTempPolygon;
                 mTempPolygon = NULL;
                 addPolygonItemToCurrentStroke(poly);
-            }
 
-            // replace the stroke by a simplified version of it
-            if ((currentTool == UBStylusTool::Pen && UBSettings::settings()->boardSimplifyPenStrokes->get().toBool())
-                || (currentTool == UBStylusTool::Marker && UBSettings::settings()->boardSimplifyMarkerStrokes->get().toBool()))
-            {
-                simplifyCurrentStroke();
+                // the centre-line ends where the temporary line did
+                mCurrentStroke->addPoint(poly->originalLine().p2(), poly->originalWidth());
             }
 
-
             UBGraphicsStrokesGroup* pStrokes = new UBGraphicsStrokesGroup();
 
             // Remove the strokes that were just drawn here and replace them by a stroke item
@@ -737,6 +805,12 @@ bool UBGraphicsScene::inputDeviceRelease(int tool)
                 delete mCurrentStroke;
                 mCurrentStroke = 0;
             }
+            // replace the stroke by a simplified version of it, once it is computed
+            else if ((currentTool == UBStylusTool::Pen && UBSettings::settings()->boardSimplifyPenStrokes->get().toBool())
+                || (currentTool == UBStylusTool::Marker && UBSettings::settings()->boardSimplifyMarkerStrokes->get().toBool()))
+            {
+                simplifyCurrentStroke();
+            }
             mCurrentPolygon = 0;
         }
     }
@@ -943,7 +1017,11 @@ void UBGraphicsScene::drawLineTo(const QPointF &pEndPoint, const qreal &startWid
     }
 
     UBGraphicsPolygonItem *polygonItem = lineToPolygonItem(QLineF(mPreviousPoint, pEndPoint), initialWidth, endWidth);
-    addPolygonItemToCurrentStroke(polygonItem);
+
+    if (mLiveStrokeEnabled && !bLineStyle)
+        addPolygonItemToLiveStroke(polygonItem);
+    else
+        addPolygonItemToCurrentStroke(polygonItem);
 
     if (!bLineStyle) {
         mPreviousPoint = pEndPoint;
@@ -954,7 +1032,11 @@ void UBGraphicsScene::drawLineTo(const QPointF &pEndPoint, const qreal &startWid
 void UBGraphicsScene::drawCurve(const QList<QPair<QPointF, qreal> >& points)
 {
     UBGraphicsPolygonItem* polygonItem = curveToPolygonItem(points);
-    addPolygonItemToCurrentStroke(polygonItem);
+
+    if (mLiveStrokeEnabled)
+        addPolygonItemToLiveStroke(polygonItem);
+    else
+        addPolygonItemToCurrentStroke(polygonItem);
 
     mPreviousPoint = points.last().first;
     mPreviousWidth = points.last().second;
@@ -963,7 +1045,11 @@ void UBGraphicsScene::drawCurve(const QList<QPair<QPointF, qreal> >& points)
 void UBGraphicsScene::drawCurve(const QList<QPointF>& points, qreal startWidth, qreal endWidth)
 {
     UBGraphicsPolygonItem* polygonItem = curveToPolygonItem(points, startWidth, endWidth);
-    addPolygonItemToCurrentStroke(polygonItem);
+
+    if (mLiveStrokeEnabled)
+        addPolygonItemToLiveStroke(polygonItem);
+    else
+        addPolygonItemToCurrentStroke(polygonItem);
 
     mPreviousWidth = endWidth;
     mPreviousPoint = points.last();
@@ -997,6 +1083,39 @@ void UBGraphicsScene::addPolygonItemToCurrentStroke(UBGraphicsPolygonItem* polyg
 
 }
 
+void UBGraphicsScene::addPolygonItemToLiveStroke(UBGraphicsPolygonItem* polygonItem)
+{
+    if (!mLiveStroke)
+    {
+        mLiveStroke = new UBGraphicsLiveStrokeItem(polygonItem->color());
+        addItem(mLiveStroke);
+    }
+
+    // Only the area of the new segment is repainted, the polygon item enters the scene on release
+    mLiveStroke->appendSegment(polygonItem->polygon());
+    mLivePolygons << polygonItem;
+
+    if (!mCurrentStroke)
+        mCurrentStroke = new UBGraphicsStroke(this);
+}
+
+void UBGraphicsScene::finishLiveStroke()
+{
+    mLiveStrokeEnabled = false;
+
+    foreach (UBGraphicsPolygonItem* polygonItem, mLivePolygons)
+        addPolygonItemToCurrentStroke(polygonItem);
+
+    mLivePolygons.clear();
+
+    if (mLiveStroke)
+    {
+        removeItem(mLiveStroke);
+        UBCoreGraphicsScene::deleteItem(mLiveStroke);
+        mLiveStroke = NULL;
+    }
+}
+
 void UBGraphicsScene::eraseLineTo(const QPointF &pEndPoint, const qreal &pWidth)
 {
     const QLineF line(mPreviousPoint, pEndPoint);
@@ -1008,45 +1127,63 @@ void UBGraphicsScene::eraseLineTo(const QPointF &pEndPoint, const qreal &pWidth)
     QPainterPath eraserPath;
     eraserPath.addPolygon(eraserPolygon);
 
-    // Get all the items that are intersecting with the eraser path
-    QList<QGraphicsItem*> collidItems = items(eraserBoundingRect, Qt::IntersectsItemBoundingRect);
+    // Get all the polygons that are intersecting with the eraser path
+    QList<UBGraphicsPolygonItem*> collidItems = mStrokeIndex.items(eraserBoundingRect);
 
     QList<UBGraphicsPolygonItem*> intersectedItems;
 
     typedef QList<QPolygonF> POLYGONSLIST;
     QList<POLYGONSLIST> intersectedPolygons;
 
-    #pragma omp parallel for
-    for(int i=0; i<collidItems.size(); i++)
+    QList<UBGraphicsStroke*> erasedStrokes;
+    bool erased = false;
+
+    foreach (UBGraphicsPolygonItem *pi, collidItems)
     {
-        UBGraphicsPolygonItem *pi = qgraphicsitem_cast<UBGraphicsPolygonItem*>(collidItems[i]);
-        if(pi == NULL)
-            continue;
+        // Strokes drawn in this session are cut along their centre-line, which is much cheaper than
+        // subtracting the eraser from their polygons
+        UBGraphicsStroke *stroke = pi->stroke();
+        if (stroke && stroke != mCurrentStroke && stroke->hasCentreLine())
+        {
+            bool wholeStrokeInScene = true;
+            foreach (UBGraphicsPolygonItem *strokePolygon, stroke->polygons())
+            {
+                if (strokePolygon->QGraphicsPolygonItem::scene() != this || strokePolygon->parentItem() != pi->parentItem())
+                    wholeStrokeInScene = false;
+            }
+
+            if (wholeStrokeInScene)
+            {
+                if (!erasedStrokes.contains(stroke))
+                    erasedStrokes << stroke;
+                continue;
+            }
+        }
 
         QPainterPath itemPainterPath;
         itemPainterPath.addPolygon(pi->sceneTransform().map(pi->polygon()));
 
         if (eraserPath.contains(itemPainterPath))
         {
-            #pragma omp critical
-            {
-                // Compete remove item
-                intersectedItems << pi;
-                intersectedPolygons << QList<QPolygonF>();
-            }
+            // Compete remove item
+            intersectedItems << pi;
+            intersectedPolygons << QList<QPolygonF>();
         }
         else if (eraserPath.intersects(itemPainterPath))
         {
             itemPainterPath.setFillRule(Qt::WindingFill);
             QPainterPath newPath = itemPainterPath.subtracted(eraserPath);
-            #pragma omp critical
-            {
-               intersectedItems << pi;
-               intersectedPolygons << newPath.simplified().toFillPolygons(pi->sceneTransform().inverted());
-            }
+            intersectedItems << pi;
+            intersectedPolygons << newPath.simplified().toFillPolygons(pi->sceneTransform().inverted());
         }
     }
 
+    foreach (UBGraphicsStroke *stroke, erasedStrokes)
+    {
+        if (eraseStrokeCentreLine(stroke, line, pWidth))
+            erased = true;
+    }
+
     for(int i=0; i<intersectedItems.size(); i++)
     {
         // item who intersects with eraser
@@ -1074,26 +1211,82 @@ void UBGraphicsScene::eraseLineTo(const QPointF &pEndPoint, const qreal &pWidth)
         }
 
         //remove full polygon item for replace it by couple of polygons which creates the same stroke without a part intersects with eraser
-         mRemovedItems << intersectedPolygonItem;
+        removeErasedPolygon(intersectedPolygonItem);
+        erased = true;
+    }
+
+    if (erased)
+        setModified(true);
+}
+
+bool UBGraphicsScene::eraseStrokeCentreLine(UBGraphicsStroke *stroke, const QLineF &eraserLine, qreal eraserWidth)
+{
+    // The centre-line is in the coordinates of the polygons, which share the same parent
+    QList<UBGraphicsPolygonItem*> strokePolygons = stroke->polygons();
+    UBGraphicsPolygonItem *model = strokePolygons.first();
+    QTransform sceneTransform = model->sceneTransform();
+    qreal scale = qSqrt(qAbs(sceneTransform.determinant()));
 
-        QTransform t;
-        bool bApplyTransform = false;
-        if (intersectedPolygonItem->strokesGroup())
+    if (qFuzzyIsNull(scale))
+        return false;
+
+    bool erased = false;
+    QList<QList<QPair<QPointF, qreal> > > pieces = stroke->erasedCentreLine(sceneTransform.inverted().map(eraserLine), eraserWidth / 2 / scale, &erased);
+
+    if (!erased)
+        return false;
+
+    // Each remaining piece becomes a stroke of its own, so that it can be cut again
+    foreach (const QList<QPair<QPointF, qreal> > &piece, pieces)
+    {
+        QList<QPolygonF> outlines = UBGraphicsStroke::outlinePolygons(piece, stroke->hasAlpha());
+        if (outlines.isEmpty())
+            continue;
+
+        UBGraphicsStroke *pieceStroke = new UBGraphicsStroke(this);
+        pieceStroke->setCentreLine(piece);
+
+        foreach (const QPolygonF &outline, outlines)
         {
-            if (intersectedPolygonItem->strokesGroup()->parentItem())
+            UBGraphicsPolygonItem *polygonItem = new UBGraphicsPolygonItem(outline, model->parentItem());
+
+            model->copyItemParameters(polygonItem);
+            polygonItem->setNominalLine(false);
+            polygonItem->setFillRule(Qt::WindingFill);
+            polygonItem->setStroke(pieceStroke);
+            if (model->strokesGroup())
             {
-                bApplyTransform = true;
-                t = intersectedPolygonItem->sceneTransform();
+                polygonItem->setStrokesGroup(model->strokesGroup());
+                model->strokesGroup()->addToGroup(polygonItem);
             }
-            intersectedPolygonItem->strokesGroup()->removeFromGroup(intersectedPolygonItem);
+            mAddedItems << polygonItem;
         }
-        removeItem(intersectedPolygonItem);
-        if (bApplyTransform)
-            intersectedPolygonItem->setTransform(t);
     }
 
-    if (!intersectedItems.empty())
-        setModified(true);
+    foreach (UBGraphicsPolygonItem *polygonItem, strokePolygons)
+        removeErasedPolygon(polygonItem);
+
+    return true;
+}
+
+void UBGraphicsScene::removeErasedPolygon(UBGraphicsPolygonItem *polygonItem)
+{
+    mRemovedItems << polygonItem;
+
+    QTransform t;
+    bool bApplyTransform = false;
+    if (polygonItem->strokesGroup())
+    {
+        if (polygonItem->strokesGroup()->parentItem())
+        {
+            bApplyTransform = true;
+            t = polygonItem->sceneTransform();
+        }
+        polygonItem->strokesGroup()->removeFromGroup(polygonItem);
+    }
+    removeItem(polygonItem);
+    if (bApplyTransform)
+        polygonItem->setTransform(t);
 }
 
 void UBGraphicsScene::drawArcTo(const QPointF& pCenterPoint, qreal pSpanAngle)
@@ -2145,6 +2338,80 @@ QGraphicsItem *UBGraphicsScene::itemForUuid(QUuid uuid)
     return result;
 }
 
+void UBGraphicsScene::setModified(bool pModified)
+{
+    // a change of the whole scene may affect how any item is persisted
+    if (pModified)
+        mPersistedFragments.clear();
+
+    UBCoreGraphicsScene::setModified(pModified);
+}
+
+void UBGraphicsScene::setItemModified(QGraphicsItem* item)
+{
+    // children are persisted with their scene transform, so they change along with their parent
+    QList<QGraphicsItem*> changedItems;
+
+    if (item)
+        changedItems << item;
+
+    while (!changedItems.isEmpty())
+    {
+        QGraphicsItem* changedItem = changedItems.takeFirst();
+        mPersistedFragments.remove(getPersonalUuid(changedItem));
+        changedItems << changedItem->childItems();
+    }
+
+    UBCoreGraphicsScene::setModified(true);
+}
+
+QByteArray UBGraphicsScene::persistedFragment(QGraphicsItem* item, int context) const
+{
+    QHash<QUuid, PersistedFragment>::const_iterator it = mPersistedFragments.constFind(getPersonalUuid(item));
+
+    if (it == mPersistedFragments.constEnd())
+        return QByteArray();
+
+    // copies may share the uuid of their original, and some attributes are set without any notification
+    const PersistedFragment& fragment = it.value();
+
+    if (fragment.item != item
+            || fragment.context != context
+            || fragment.transform != item->sceneTransform()
+            || fragment.zValue != item->zValue()
+            || fragment.layer != item->data(UBGraphicsItemData::ItemLayerType)
+            || fragment.locked != item->data(UBGraphicsItemData::ItemLocked)
+            || fragment.editable != item->data(UBGraphicsItemData::ItemEditable)
+            || fragment.background != isBackgroundObject(item))
+    {
+        return QByteArray();
+    }
+
+    return fragment.data;
+}
+
+void UBGraphicsScene::setPersistedFragment(QGraphicsItem* item, int context, const QByteArray& fragment)
+{
+    QUuid uuid = getPersonalUuid(item);
+
+    // the stroke being drawn still changes
+    if (uuid.isNull() || fragment.isEmpty() || mInputDeviceIsPressed)
+        return;
+
+    PersistedFragment persistedFragment;
+    persistedFragment.item = item;
+    persistedFragment.context = context;
+    persistedFragment.transform = item->sceneTransform();
+    persistedFragment.zValue = item->zValue();
+    persistedFragment.layer = item->data(UBGraphicsItemData::ItemLayerType);
+    persistedFragment.locked = item->data(UBGraphicsItemData::ItemLocked);
+    persistedFragment.editable = item->data(UBGraphicsItemData::ItemEditable);
+    persistedFragment.background = isBackgroundObject(item);
+    persistedFragment.data = fragment;
+
+    mPersistedFragments.insert(uuid, persistedFragment);
+}
+
 void UBGraphicsScene::setDocument(UBDocumentProxy* pDocument)
 {
     if (pDocument != mDocument)
@@ -2672,60 +2939,8 @@ void UBGraphicsScene::drawBackground(QPainter *painter, const QRectF &rect)
         QGraphicsScene::drawBackground (painter, rect);
         return;
     }
-    bool darkBackground = isDarkBackground ();
-
-    if (darkBackground)
-    {
-      painter->fillRect (rect, QBrush (QColor (Qt::black)));
-    }
-    else
-    {
-      painter->fillRect (rect, QBrush (QColor (Qt::white)));
-    }
-
-    if (mZoomFactor > 0.5)
-    {
-        QColor bgCrossColor;
-
-        if (darkBackground)
-            bgCrossColor = QColor(UBSettings::settings()->boardCrossColorDarkBackground->get().toString());
-        else
-            bgCrossColor = QColor(UBSettings::settings()->boardCrossColorLightBackground->get().toString());
-        if (mZoomFactor < 0.7)
-        {
-            int alpha = 255 * mZoomFactor / 2;
-            bgCrossColor.setAlpha (alpha); // fade the crossing on small zooms
-        }
-
-        painter->setPen (bgCrossColor);
-
-        if (mPageBackground == UBPageBackground::crossed)
-        {
-            qreal firstY = ((int) (rect.y () / backgroundGridSize())) * backgroundGridSize();
-
-            for (qreal yPos = firstY; yPos < rect.y () + rect.height (); yPos += backgroundGridSize())
-            {
-                painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
-            }
-
-            qreal firstX = ((int) (rect.x () / backgroundGridSize())) * backgroundGridSize();
-
-            for (qreal xPos = firstX; xPos < rect.x () + rect.width (); xPos += backgroundGridSize())
-            {
-                painter->drawLine (xPos, rect.y (), xPos, rect.y () + rect.height ());
-            }
-        }
-
-        else if (mPageBackground == UBPageBackground::ruled)
-        {
-            qreal firstY = ((int) (rect.y () / backgroundGridSize())) * backgroundGridSize();
-
-            for (qreal yPos = firstY; yPos < rect.y () + rect.height (); yPos += backgroundGridSize())
-            {
-                painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
-            }
-        }
-    }
+    UBBackgroundGrid::backgroundGrid()->paint(painter, rect, mPageBackground, backgroundGridSize(), false,
+                                              isDarkBackground(), mZoomFactor);
 }
 
 void UBGraphicsScene::keyReleaseEvent(QKeyEvent * keyEvent)
@@ -2841,22 +3056,7 @@ void UBGraphicsScene::simplifyCurrentStroke()
     if (!mCurrentStroke)
         return;
 
-    UBGraphicsStroke* simplerStroke = mCurrentStroke->simplify();
-    if (!simplerStroke)
-        return;
-
-    foreach(UBGraphicsPolygonItem* poly, mCurrentStroke->polygons()){
-        mPreviousPolygonItems.removeAll(poly);
-        removeItem(poly);
-    }
-
-    mCurrentStroke = simplerStroke;
-
-    foreach(UBGraphicsPolygonItem* poly, mCurrentStroke->polygons()) {
-        addItem(poly);
-        mPreviousPolygonItems.append(poly);
-    }
-
+    mCurrentStroke->simplifyInBackground(UBSettings::settings()->boardSimplifyStrokesTolerance->get().toReal());
 }
 
 
@@ -35,6 +35,7 @@
 #include "core/UB.h"
 
 #include "UBItem.h"
+#include "UBStrokeSpatialIndex.h"
 #include "tools/UBGraphicsCurtainItem.h"
 #include "web/UBEmbedParser.h"
 
@@ -54,6 +55,7 @@ class UBGraphicsCompass;
 class UBDocumentProxy;
 class UBGraphicsCurtainItem;
 class UBGraphicsStroke;
+class UBGraphicsLiveStrokeItem;
 class UBMagnifierParams;
 class UBMagnifier;
 class UBGraphicsCache;
@@ -63,6 +65,14 @@ class UBBoardView;
 
 const double PI = 4.0 * atan(1.0);
 
+// A position of the input device, as reported by a tablet between two frames
+struct UBInputSample
+{
+    QPointF scenePos;
+    qreal pressure;
+    qint64 timestamp; // in ms, as given by the input event
+};
+
 class UBZLayerController : public QObject
 {
     Q_OBJECT
@@ -141,6 +151,7 @@ class UBGraphicsScene: public UBCoreGraphicsScene, public UBItem
 
         bool inputDevicePress(const QPointF& scenePos, const qreal& pressure = 1.0);
         bool inputDeviceMove(const QPointF& scenePos, const qreal& pressure = 1.0);
+        bool inputDeviceMove(const QVector<UBInputSample>& samples);
         bool inputDeviceRelease(int tool = -1);
 
         void leaveEvent (QEvent* event);
@@ -191,6 +202,18 @@ class UBGraphicsScene: public UBCoreGraphicsScene, public UBItem
 
         QGraphicsItem *itemForUuid(QUuid uuid);
 
+        virtual void setModified(bool pModified);
+        void setItemModified(QGraphicsItem* item);
+
+        // svg of an item as written by the last save, empty when the item changed since
+        QByteArray persistedFragment(QGraphicsItem* item, int context) const;
+        void setPersistedFragment(QGraphicsItem* item, int context, const QByteArray& fragment);
+
+        UBStrokeSpatialIndex* strokeIndex()
+        {
+            return &mStrokeIndex;
+        }
+
         void moveTo(const QPointF& pPoint);
         void drawLineTo(const QPointF& pEndPoint, const qreal& pWidth, bool bLineStyle);
         void drawLineTo(const QPointF& pEndPoint, const qreal& pStartWidth, const qreal& endWidth, bool bLineStyle);
@@ -398,6 +421,10 @@ public slots:
         UBGraphicsPolygonItem* curveToPolygonItem(const QList<QPair<QPointF, qreal> > &points);
         UBGraphicsPolygonItem* curveToPolygonItem(const QList<QPointF> &points, qreal startWidth, qreal endWidth);
         void addPolygonItemToCurrentStroke(UBGraphicsPolygonItem* polygonItem);
+        void addPolygonItemToLiveStroke(UBGraphicsPolygonItem* polygonItem);
+        void finishLiveStroke();
+        void addFreehandPoint(const QPointF& scenePos, qreal width, bool interpolate, qreal minDistance);
+        void updateFreehandTail(const QPointF& scenePos, qreal width);
 
         void initPolygonItem(UBGraphicsPolygonItem*);
 
@@ -435,6 +462,8 @@ public slots:
         void updatePenCircleColor();
         bool hasTextItemWithFocus(UBGraphicsGroupContainerItem* item);
         void simplifyCurrentStroke();
+        bool eraseStrokeCentreLine(UBGraphicsStroke* stroke, const QLineF& eraserLine, qreal eraserWidth);
+        void removeErasedPolygon(UBGraphicsPolygonItem* polygonItem);
 
         QGraphicsEllipseItem* mEraser;
         QGraphicsEllipseItem* mPointer; // "laser" pointer
@@ -476,6 +505,8 @@ public slots:
 
         UBGraphicsStroke* mCurrentStroke;
 
+        UBStrokeSpatialIndex mStrokeIndex;
+
         int mItemCount;
 
         QList<QGraphicsItem*> mFastAccessItems; // a local copy as QGraphicsScene::items() is very slow in Qt 4.6
@@ -492,9 +523,29 @@ public slots:
         UBGraphicsPolygonItem* mpLastPolygon;
         UBGraphicsPolygonItem* mTempPolygon;
 
+        // freehand strokes are drawn by a single item until the input device is released
+        bool mLiveStrokeEnabled;
+        UBGraphicsLiveStrokeItem* mLiveStroke;
+        QList<UBGraphicsPolygonItem*> mLivePolygons;
+
         bool mDrawWithCompass;
         UBGraphicsPolygonItem *mCurrentPolygon;
         UBSelectionFrame *mSelectionFrame;
+
+        struct PersistedFragment
+        {
+            QGraphicsItem* item;
+            int context;
+            QTransform transform;
+            qreal zValue;
+            QVariant layer;
+            QVariant locked;
+            QVariant editable;
+            bool background;
+            QByteArray data;
+        };
+
+        QHash<QUuid, PersistedFragment> mPersistedFragments;
 };
 
 
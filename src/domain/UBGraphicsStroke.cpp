@@ -29,20 +29,301 @@
 
 #include "UBGraphicsStroke.h"
 
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+
 #include "UBGraphicsPolygonItem.h"
 
 #include "board/UBBoardController.h"
 #include "core/UBApplication.h"
 #include "core/memcheck.h"
 #include "domain/UBGraphicsScene.h"
+#include "domain/UBGraphicsStrokesGroup.h"
 
 #include "frameworks/UBGeometryUtils.h"
 
 
 typedef QPair<QPointF, qreal> strokePoint;
 
+static qreal distanceToSegment(const QPointF& point, const QLineF& segment)
+{
+    QPointF direction = segment.p2() - segment.p1();
+    qreal lengthSquared = QPointF::dotProduct(direction, direction);
+    qreal t = 0;
+
+    if (lengthSquared > 0)
+        t = qBound(0.0, QPointF::dotProduct(point - segment.p1(), direction) / lengthSquared, 1.0);
+
+    return QLineF(point, segment.p1() + t * direction).length();
+}
+
+static strokePoint interpolatedPoint(const strokePoint& a, const strokePoint& b, qreal t)
+{
+    return strokePoint(a.first + t * (b.first - a.first), a.second + t * (b.second - a.second));
+}
+
+/**
+ * @brief Find the part of the segment [a, b] of a centre-line that is covered by the eraser
+ * @return false if the ink of the segment does not touch the eraser, otherwise the part is [tIn, tOut]
+ *
+ * The margin between the ink and the eraser is convex along the segment, so the erased part is a single interval
+ * around the point closest to the eraser.
+ */
+static bool erasedInterval(const strokePoint& a, const strokePoint& b, const QLineF& eraserLine, qreal eraserRadius, qreal* tIn, qreal* tOut)
+{
+    auto margin = [&](qreal t) {
+        strokePoint p = interpolatedPoint(a, b, t);
+        return distanceToSegment(p.first, eraserLine) - eraserRadius - p.second / 2;
+    };
+
+    qreal low = 0;
+    qreal high = 1;
+
+    for (int i = 0; i < 40; ++i) {
+        qreal third = (high - low) / 3;
+        if (margin(low + third) < margin(high - third))
+            high -= third;
+        else
+            low += third;
+    }
+
+    qreal closest = (low + high) / 2;
+    if (margin(closest) >= 0)
+        return false;
+
+    *tIn = 0;
+    if (margin(0) >= 0) {
+        low = 0;
+        high = closest;
+        for (int i = 0; i < 30; ++i) {
+            qreal middle = (low + high) / 2;
+            if (margin(middle) < 0)
+                high = middle;
+            else
+                low = middle;
+        }
+        *tIn = low;
+    }
+
+    *tOut = 1;
+    if (margin(1) >= 0) {
+        low = closest;
+        high = 1;
+        for (int i = 0; i < 30; ++i) {
+            qreal middle = (low + high) / 2;
+            if (margin(middle) < 0)
+                low = middle;
+            else
+                high = middle;
+        }
+        *tOut = high;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Keep the points that the centre-line needs to stay within the tolerance (Douglas-Peucker)
+ * @return The indexes of the points to keep, including the first and the last one
+ *
+ * The error of a point is its distance to the chord plus half the difference between its width and the width
+ * interpolated along the chord, which is how far the edge of the ink moves when the point is dropped.
+ */
+static QList<int> douglasPeucker(const QList<strokePoint>& points, qreal tolerance)
+{
+    QVector<bool> keep(points.size(), false);
+    keep[0] = true;
+    keep[points.size() - 1] = true;
+
+    QStack<QPair<int, int> > spans;
+    spans.push(qMakePair(0, points.size() - 1));
+
+    while (!spans.isEmpty()) {
+        QPair<int, int> span = spans.pop();
+        const strokePoint& a = points.at(span.first);
+        const strokePoint& b = points.at(span.second);
+
+        QPointF direction = b.first - a.first;
+        qreal lengthSquared = QPointF::dotProduct(direction, direction);
+
+        qreal maxError = 0;
+        int farthest = -1;
+
+        for (int i = span.first + 1; i < span.second; ++i) {
+            const strokePoint& p = points.at(i);
+            qreal t = 0;
+
+            if (lengthSquared > 0)
+                t = qBound(0.0, QPointF::dotProduct(p.first - a.first, direction) / lengthSquared, 1.0);
+
+            qreal error = QLineF(p.first, a.first + t * direction).length()
+                    + qAbs(p.second - (a.second + t * (b.second - a.second))) / 2;
+
+            if (error > maxError) {
+                maxError = error;
+                farthest = i;
+            }
+        }
+
+        if (farthest >= 0 && maxError > tolerance) {
+            keep[farthest] = true;
+            spans.push(qMakePair(span.first, farthest));
+            spans.push(qMakePair(farthest, span.second));
+        }
+    }
+
+    QList<int> kept;
+    for (int i = 0; i < keep.size(); ++i) {
+        if (keep.at(i))
+            kept << i;
+    }
+
+    return kept;
+}
+
+static QPointF bezierPoint(const QPointF* control, qreal t)
+{
+    qreal s = 1 - t;
+    return s * s * s * control[0] + 3 * s * s * t * control[1] + 3 * s * t * t * control[2] + t * t * t * control[3];
+}
+
+static QPointF normalized(const QPointF& vector)
+{
+    qreal length = qSqrt(QPointF::dotProduct(vector, vector));
+    return length > 0 ? vector / length : QPointF();
+}
+
+/**
+ * @brief Direction of the centre-line leaving the point at index towards index + step
+ *
+ * The curves on both sides of a point share their tangent, unless the centre-line has a sharp angle there.
+ */
+static QPointF tangent(const QList<strokePoint>& points, int index, int step)
+{
+    int previous = index - step;
+
+    if (previous >= 0 && previous < points.size()) {
+        qreal angle = qFabs(UBGeometryUtils::angle(points.at(previous).first, points.at(index).first, points.at(index + step).first));
+        if (angle >= 150) // same threshold as outlinePolygons()
+            return normalized(points.at(index + step).first - points.at(previous).first);
+    }
+
+    return normalized(points.at(index + step).first - points.at(index).first);
+}
+
+/// Position of the points of [first, last] along the chords, between 0 and 1
+static QVector<qreal> chordLengthParameters(const QList<strokePoint>& points, int first, int last)
+{
+    QVector<qreal> u(last - first + 1, 0);
+
+    for (int i = first + 1; i <= last; ++i)
+        u[i - first] = u[i - first - 1] + QLineF(points.at(i - 1).first, points.at(i).first).length();
+
+    if (u.last() > 0) {
+        for (int i = 1; i < u.size(); ++i)
+            u[i] /= u.last();
+    }
+
+    return u;
+}
+
+/**
+ * @brief Fit a cubic Bézier curve to the points of [first, last] by least squares, keeping their end points and tangents
+ * @return false if one of the points is further than tolerance from the curve
+ */
+static bool fitCubic(const QList<strokePoint>& points, int first, int last, qreal tolerance, QPointF* control)
+{
+    QVector<qreal> u = chordLengthParameters(points, first, last);
+
+    QPointF p0 = points.at(first).first;
+    QPointF p3 = points.at(last).first;
+    QPointF t1 = tangent(points, first, 1);
+    QPointF t2 = tangent(points, last, -1);
+
+    qreal c00 = 0, c01 = 0, c11 = 0, x0 = 0, x1 = 0;
+
+    for (int k = 0; k < u.size(); ++k) {
+        qreal t = u.at(k);
+        qreal s = 1 - t;
+        QPointF a1 = 3 * s * s * t * t1;
+        QPointF a2 = 3 * s * t * t * t2;
+        QPointF rest = points.at(first + k).first - ((s * s * s + 3 * s * s * t) * p0 + (3 * s * t * t + t * t * t) * p3);
+
+        c00 += QPointF::dotProduct(a1, a1);
+        c01 += QPointF::dotProduct(a1, a2);
+        c11 += QPointF::dotProduct(a2, a2);
+        x0 += QPointF::dotProduct(rest, a1);
+        x1 += QPointF::dotProduct(rest, a2);
+    }
+
+    qreal chord = QLineF(p0, p3).length();
+    qreal alpha1 = chord / 3;
+    qreal alpha2 = chord / 3;
+    qreal determinant = c00 * c11 - c01 * c01;
+
+    // A degenerate or backward solution falls back to the usual third of the chord
+    if (qAbs(determinant) > 1e-12) {
+        qreal a1 = (x0 * c11 - x1 * c01) / determinant;
+        qreal a2 = (c00 * x1 - c01 * x0) / determinant;
+
+        if (a1 > 1e-6 * chord && a2 > 1e-6 * chord) {
+            alpha1 = a1;
+            alpha2 = a2;
+        }
+    }
+
+    control[0] = p0;
+    control[1] = p0 + alpha1 * t1;
+    control[2] = p3 + alpha2 * t2;
+    control[3] = p3;
+
+    for (int k = 1; k < u.size() - 1; ++k) {
+        if (QLineF(points.at(first + k).first, bezierPoint(control, u.at(k))).length() > tolerance)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Add to params the parameters at which the curve [t0, t1] is cut into flat enough segments
+ *
+ * A segment is split until its control points are within tolerance of its chord and the width in its middle is
+ * within tolerance of the average of the widths at its ends.
+ */
+static void flattenCubic(const QPointF* control, qreal t0, qreal t1, const std::function<qreal(qreal)>& width,
+                         qreal tolerance, int depth, QList<qreal>* params)
+{
+    QLineF chord(control[0], control[3]);
+    qreal tMiddle = (t0 + t1) / 2;
+
+    bool flat = distanceToSegment(control[1], chord) <= tolerance && distanceToSegment(control[2], chord) <= tolerance
+            && qAbs(width(tMiddle) - (width(t0) + width(t1)) / 2) / 2 <= tolerance;
+
+    if (flat || depth >= 12) {
+        *params << t1;
+        return;
+    }
+
+    // de Casteljau
+    QPointF p01 = (control[0] + control[1]) / 2;
+    QPointF p12 = (control[1] + control[2]) / 2;
+    QPointF p23 = (control[2] + control[3]) / 2;
+    QPointF p012 = (p01 + p12) / 2;
+    QPointF p123 = (p12 + p23) / 2;
+    QPointF middle = (p012 + p123) / 2;
+
+    QPointF left[4] = { control[0], p01, p012, middle };
+    QPointF right[4] = { middle, p123, p23, control[3] };
+
+    flattenCubic(left, t0, tMiddle, width, tolerance, depth + 1, params);
+    flattenCubic(right, tMiddle, t1, width, tolerance, depth + 1, params);
+}
+
 UBGraphicsStroke::UBGraphicsStroke(UBGraphicsScene *scene)
     :mScene(scene)
+    , mSimplification(NULL)
 {
     mAntiScaleRatio = 1./(UBApplication::boardController->systemScaleFactor() * UBApplication::boardController->currentZoom());
 }
@@ -50,6 +331,8 @@ UBGraphicsStroke::UBGraphicsStroke(UBGraphicsScene *scene)
 
 UBGraphicsStroke::~UBGraphicsStroke()
 {
+    cancelSimplification();
+
     foreach(UBGraphicsPolygonItem* poly, mPolygons)
         poly->setStroke(NULL);
 
@@ -59,12 +342,16 @@ UBGraphicsStroke::~UBGraphicsStroke()
 
 void UBGraphicsStroke::addPolygon(UBGraphicsPolygonItem* pol)
 {
+    cancelSimplification();
+
     remove(pol);
     mPolygons << pol;
 }
 
 void UBGraphicsStroke::remove(UBGraphicsPolygonItem* polygonItem)
 {
+    cancelSimplification();
+
     int n = mPolygons.indexOf(polygonItem);
     if (n>=0)
         mPolygons.removeAt(n);
@@ -153,6 +440,136 @@ QList<QPair<QPointF, qreal> > UBGraphicsStroke::addPoint(const QPointF& point, q
     return QList<strokePoint>();
 }
 
+void UBGraphicsStroke::setCentreLine(const QList<QPair<QPointF, qreal> >& points)
+{
+    mReceivedPoints = points;
+    mDrawnPoints = points;
+}
+
+/**
+ * @brief Cut the parts of the centre-line that are under the eraser
+ * @param eraserLine The path of the eraser, in the coordinates of the polygons of the stroke
+ * @param eraserRadius Half the width of the eraser, in the same coordinates
+ * @param erased Set to true if the eraser touches the stroke
+ * @return The pieces of the centre-line that remain
+ *
+ * A point is erased when the ink around it touches the eraser, so that the round caps of the remaining pieces
+ * end at the edge of the eraser.
+ */
+QList<QList<QPair<QPointF, qreal> > > UBGraphicsStroke::erasedCentreLine(const QLineF& eraserLine, qreal eraserRadius, bool* erased) const
+{
+    QList<QList<strokePoint> > pieces;
+    QList<strokePoint> piece;
+
+    *erased = false;
+
+    const QRectF eraserRect = QRectF(eraserLine.p1(), eraserLine.p2()).normalized();
+
+    for (int i = 0; i < mDrawnPoints.size() - 1; ++i) {
+        const strokePoint& a = mDrawnPoints.at(i);
+        const strokePoint& b = mDrawnPoints.at(i + 1);
+
+        qreal reach = eraserRadius + qMax(a.second, b.second) / 2;
+        QRectF segmentRect = QRectF(a.first, b.first).normalized().adjusted(-reach, -reach, reach, reach);
+
+        // QRectF::intersects() ignores the empty rect of an eraser that did not move
+        bool nearEraser = segmentRect.left() <= eraserRect.right() && eraserRect.left() <= segmentRect.right()
+                && segmentRect.top() <= eraserRect.bottom() && eraserRect.top() <= segmentRect.bottom();
+
+        qreal tIn = 0;
+        qreal tOut = 0;
+
+        if (!nearEraser || !erasedInterval(a, b, eraserLine, eraserRadius, &tIn, &tOut)) {
+            if (piece.isEmpty())
+                piece << a;
+            piece << b;
+            continue;
+        }
+
+        *erased = true;
+
+        if (tIn > 0) {
+            if (piece.isEmpty())
+                piece << a;
+            piece << interpolatedPoint(a, b, tIn);
+        }
+
+        if (piece.size() > 1)
+            pieces << piece;
+        piece.clear();
+
+        if (tOut < 1)
+            piece << interpolatedPoint(a, b, tOut) << b;
+    }
+
+    if (piece.size() > 1)
+        pieces << piece;
+
+    return pieces;
+}
+
+/**
+ * @brief Build the polygons drawing a centre-line
+ *
+ * A new polygon is started at every sharp angle, and every 20 points when the stroke is translucent, in which case
+ * the overlapping parts are subtracted from the following polygons.
+ */
+QList<QPolygonF> UBGraphicsStroke::outlinePolygons(const QList<QPair<QPointF, qreal> >& points, bool translucent)
+{
+    QList<QPolygonF> polygons;
+    QList<strokePoint> newStrokePoints;
+
+    auto addOutline = [&]() {
+        QPolygonF polygon = UBGeometryUtils::curveToPolygon(newStrokePoints, true, true);
+
+        // Subtract overlapping polygons if the stroke is translucent
+        if (translucent) {
+            foreach(const QPolygonF& prev, polygons) {
+                if (polygon.boundingRect().intersects(prev.boundingRect()))
+                    polygon = polygon.subtracted(prev);
+            }
+        }
+
+        polygons << polygon;
+    };
+
+    int i(0);
+
+    while (i < points.size()) {
+        bool drawCurve = false;
+
+        newStrokePoints << points[i];
+
+        // Limiting the size of the polygons, and creating new ones when there is a sharp angle between
+        // consecutive point helps with two issues:
+        // 1. When a polygon is transparent and it overlaps with itself, it is *sometimes* filled incorrectly.
+        // 2. This way of simplifying strokes resuls in sharp, rather than rounded, corners when there is a sharp angle
+        //    in the stroke
+
+        if (newStrokePoints.size() > 1 && i < points.size() - 1) {
+            qreal angle = qFabs(UBGeometryUtils::angle(points[i-1].first, points[i].first, points[i+1].first));
+            if (angle < 150) // arbitrary threshold, change if necessary
+                drawCurve = true;
+        }
+
+        if (translucent && newStrokePoints.size() % 20 == 0)
+            drawCurve = true;
+
+        if (drawCurve) {
+            addOutline();
+            newStrokePoints.clear();
+            --i;
+        }
+
+        ++i;
+    }
+
+    if (newStrokePoints.size() > 0)
+        addOutline();
+
+    return polygons;
+}
+
 bool UBGraphicsStroke::hasPressure()
 {
     if (mPolygons.count() > 2)
@@ -198,128 +615,163 @@ void UBGraphicsStroke::clear()
 }
 
 /**
- * @brief Return a simplified version of the stroke, with less points and polygons.
+ * @brief Simplify a centre-line with Douglas-Peucker, then fit cubic curves to it
+ * @param tolerance How far the ink may move, in the coordinates of the points
+ * @return The points of the flattened curves, with the widths interpolated along the original centre-line
  *
+ * Each cubic spans as many segments of the Douglas-Peucker polyline as it can while staying within tolerance of the
+ * original points, and is flattened only as finely as the tolerance requires. A segment that no cubic fits is kept
+ * straight.
  */
-UBGraphicsStroke* UBGraphicsStroke::simplify()
+QList<QPair<QPointF, qreal> > UBGraphicsStroke::simplifiedCentreLine(const QList<QPair<QPointF, qreal> >& points, qreal tolerance)
 {
-    if (mDrawnPoints.size() < 3)
-        return NULL;
-
-    UBGraphicsStroke* newStroke = new UBGraphicsStroke();
-    newStroke->mDrawnPoints = QList<strokePoint>(mDrawnPoints);
-
-    QList<strokePoint>& points = newStroke->mDrawnPoints;
-    //qDebug() << "Simplifying. Before: " << points.size() << " points and " << polygons().size() << " polygons";
-
-    /* Basic simplifying algorithm: consider A, B and C the current point and the two following ones.
-     * If the angle between (AB) and (BC) is lower than a certain threshold,
-     * the three points are considered to be aligned and the middle one (B) is removed.
-     *
-     * We then consider the two following points as the new B and C while keeping the same A, and
-     * test these three points. As long as they are aligned, B is erased and we start over.
-     * If not, the current B becomes the new A, and so on.
-     *
-     * In case the stroke thickness varies a lot between A and B, then B is not removed even if it
-     * should be according to the previous criteria.
-     *
-     * TODO: more advanced algorithm that could also simplify curved sections of the stroke
-     */
-
-    // angle difference in degrees between AB and BC below which the segments are considered colinear
-    qreal thresholdAngle = UBSettings::settings()->boardSimplifyPenStrokesThresholdAngle->get().toReal();
-
-    // Relative difference in thickness between two consecutive points (A and B) below which they are considered equal
-    qreal thresholdWidthDifference = UBSettings::settings()->boardSimplifyPenStrokesThresholdWidthDifference->get().toReal();
-
-    QList<strokePoint>::iterator it = points.begin();
-    QList<QList<strokePoint>::iterator> toDelete;
-
-    while (it+2 != points.end()) {
-        // it, b_it and (b_it+1) correspond to A, B and C respectively
-        QList<strokePoint>::iterator b_it(it+1);
-
-        while (b_it+1 != points.end()) {
-            qreal angle = qFabs(180-(UBGeometryUtils::angle(it->first, b_it->first, (b_it+1)->first)));
-            qreal widthRatio = qMax(it->second, b_it->second)/qMin(it->second, b_it->second);
-
-            if (angle < thresholdAngle && widthRatio < thresholdWidthDifference)
-                b_it = points.erase(b_it);
-            else
-                break;
+    if (points.size() < 3)
+        return points;
+
+    QList<int> kept = douglasPeucker(points, tolerance);
+    QList<strokePoint> simplified;
+    simplified << points.first();
+
+    int i = 0;
+
+    while (i < kept.size() - 1) {
+        QPointF control[4];
+        QPointF candidate[4];
+        int j = i + 1;
+
+        while (j < kept.size() && fitCubic(points, kept.at(i), kept.at(j), tolerance, candidate)) {
+            std::copy(candidate, candidate + 4, control);
+            ++j;
         }
 
-        if (b_it+1 == points.end())
-            break;
-        else
-            it = b_it;
+        if (j == i + 1) {
+            simplified << points.at(kept.at(j));
+            i = j;
+            continue;
+        }
+
+        int first = kept.at(i);
+        int last = kept.at(j - 1);
+        QVector<qreal> u = chordLengthParameters(points, first, last);
+
+        auto width = [&](qreal t) {
+            int k = std::upper_bound(u.constBegin(), u.constEnd(), t) - u.constBegin();
+
+            if (k <= 0)
+                return points.at(first).second;
+            if (k >= u.size())
+                return points.at(last).second;
+
+            qreal span = u.at(k) - u.at(k - 1);
+            qreal f = span > 0 ? (t - u.at(k - 1)) / span : 0;
+            return points.at(first + k - 1).second + f * (points.at(first + k).second - points.at(first + k - 1).second);
+        };
+
+        QList<qreal> params;
+        flattenCubic(control, 0, 1, width, tolerance / 2, 0, &params);
+
+        foreach (qreal t, params)
+            simplified << strokePoint(bezierPoint(control, t), width(t));
+
+        i = j - 1;
     }
 
-    // Next, we iterate over the new points to build the polygons that make up the stroke.
-    // A new polygon is created every time drawCurve is true.
+    return simplified;
+}
 
-    QList<UBGraphicsPolygonItem*> newPolygons;
-    QList<strokePoint> newStrokePoints;
-    int i(0);
+/**
+ * @brief Replace the polygons of the stroke by simpler ones on a worker thread
+ * @param tolerance How far the ink may move, in pixels of the view in which the stroke was drawn
+ *
+ * The simplification is dropped if the stroke changes before it is done.
+ */
+void UBGraphicsStroke::simplifyInBackground(qreal tolerance)
+{
+    cancelSimplification();
 
-    while (i < points.size()) {
-        bool drawCurve = false;
+    if (mDrawnPoints.size() < 3 || mPolygons.isEmpty())
+        return;
 
-        newStrokePoints << points[i];
+    QList<strokePoint> points = mDrawnPoints;
+    qreal sceneTolerance = tolerance * mAntiScaleRatio;
+    bool translucent = hasAlpha();
 
-        // Limiting the size of the polygons, and creating new ones when there is a sharp angle between
-        // consecutive point helps with two issues:
-        // 1. When a polygon is transparent and it overlaps with itself, it is *sometimes* filled incorrectly.
-        // 2. This way of simplifying strokes resuls in sharp, rather than rounded, corners when there is a sharp angle
-        //    in the stroke
+    mSimplification = new QFutureWatcher<UBSimplifiedStroke>();
 
-        if (newStrokePoints.size() > 1 && i < points.size() - 1) {
-            qreal angle = qFabs(UBGeometryUtils::angle(points[i-1].first, points[i].first, points[i+1].first));
-            if (angle < 150) // arbitrary threshold, change if necessary
-                drawCurve = true;
-        }
+    QObject::connect(mSimplification, &QFutureWatcherBase::finished, mSimplification, [this]() {
+        UBSimplifiedStroke simplified = mSimplification->result();
 
-        if (hasAlpha() && newStrokePoints.size() % 20 == 0)
-            drawCurve = true;
+        mSimplification->deleteLater();
+        mSimplification = NULL;
 
-        if (drawCurve) {
-            UBGraphicsPolygonItem* poly = mScene->polygonToPolygonItem(UBGeometryUtils::curveToPolygon(newStrokePoints, true, true));
-            //poly->setColor(QColor(rand()%256, rand()%256, rand()%256, poly->brush().color().alpha())); // useful for debugging
+        replacePolygons(simplified);
+    });
 
-            // Subtract overlapping polygons if the stroke is translucent
-            if (!poly->brush().isOpaque()) {
-                foreach(UBGraphicsPolygonItem* prev, newPolygons)
-                    poly->subtract(prev);
-            }
+    mSimplification->setFuture(QtConcurrent::run([points, sceneTolerance, translucent]() {
+        UBSimplifiedStroke simplified;
+        simplified.points = simplifiedCentreLine(points, sceneTolerance);
+        simplified.outlines = outlinePolygons(simplified.points, translucent);
+        return simplified;
+    }));
+}
 
-            newPolygons << poly;
-            newStrokePoints.clear();
-            --i;
-        }
+void UBGraphicsStroke::cancelSimplification()
+{
+    // the worker runs to its end, its result goes away with the watcher
+    delete mSimplification;
+    mSimplification = NULL;
+}
 
-        ++i;
-    }
+/**
+ * @brief Swap the polygons of the stroke for the outline of its simplified centre-line
+ *
+ * All the polygons are replaced at once, so that the stroke is never drawn half simplified. Nothing is replaced
+ * if a polygon left the strokes group meanwhile, as it may belong to an undo command.
+ */
+void UBGraphicsStroke::replacePolygons(const UBSimplifiedStroke& simplified)
+{
+    if (mPolygons.isEmpty() || simplified.outlines.isEmpty())
+        return;
 
-    if (newStrokePoints.size() > 0) {
-        UBGraphicsPolygonItem* poly = mScene->polygonToPolygonItem(UBGeometryUtils::curveToPolygon(newStrokePoints, true, true));
+    QList<UBGraphicsPolygonItem*> oldPolygons = mPolygons;
+    UBGraphicsPolygonItem* model = oldPolygons.first();
+    UBGraphicsStrokesGroup* group = model->strokesGroup();
 
-        if (!poly->brush().isOpaque()) {
-            foreach(UBGraphicsPolygonItem* prev, newPolygons)
-                poly->subtract(prev);
-        }
+    if (!group)
+        return;
 
-        newPolygons << poly;
+    int verticesBefore = 0;
+    foreach (UBGraphicsPolygonItem* poly, oldPolygons) {
+        if (poly->strokesGroup() != group || poly->parentItem() != group)
+            return;
+
+        verticesBefore += poly->polygon().size();
     }
 
+    int verticesAfter = 0;
+    foreach (const QPolygonF& outline, simplified.outlines) {
+        UBGraphicsPolygonItem* polygonItem = new UBGraphicsPolygonItem(outline, group);
 
-    newStroke->mPolygons = QList<UBGraphicsPolygonItem*>(newPolygons);
+        model->copyItemParameters(polygonItem);
+        polygonItem->setNominalLine(false);
+        polygonItem->setFillRule(Qt::WindingFill);
+        polygonItem->setStroke(this);
+        polygonItem->setStrokesGroup(group);
+        group->addToGroup(polygonItem);
 
-    foreach(UBGraphicsPolygonItem* poly, newStroke->mPolygons) {
-        poly->setFillRule(Qt::WindingFill);
-        poly->setStroke(newStroke);
+        verticesAfter += outline.size();
     }
 
-    //qDebug() << "After: " << points.size() << " points and " << newStroke->polygons().size() << " polygons";
+    int pointsBefore = mDrawnPoints.size();
+    setCentreLine(simplified.points);
+
+    qDeleteAll(oldPolygons);
+
+    qDebug() << "Simplified stroke: points" << pointsBefore << "->" << simplified.points.size()
+             << ", polygons" << oldPolygons.size() << "->" << simplified.outlines.size()
+             << ", vertices" << verticesBefore << "->" << verticesAfter;
 
-    return newStroke;
+    // the group is saved again, with the simplified polygons
+    if (mScene)
+        mScene->setItemModified(group);
 }
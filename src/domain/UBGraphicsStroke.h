@@ -31,6 +31,7 @@
 #define UBGRAPHICSSTROKE_H_
 
 #include <QtGui>
+#include <QFutureWatcher>
 
 #include "core/UB.h"
 
@@ -39,6 +40,13 @@
 class UBGraphicsPolygonItem;
 class UBGraphicsScene;
 
+/// The result of the simplification of a stroke, computed on a worker thread
+struct UBSimplifiedStroke
+{
+    QList<QPair<QPointF, qreal> > points;
+    QList<QPolygonF> outlines;
+};
+
 class UBGraphicsStroke
 {
     friend class UBGraphicsPolygonItem;
@@ -63,7 +71,18 @@ class UBGraphicsStroke
 
         const QList<QPair<QPointF, qreal> >& points() { return mDrawnPoints; }
 
-        UBGraphicsStroke* simplify();
+        /// True when the polygons were built from the drawn points, so that the stroke can be cut along them
+        bool hasCentreLine() const { return mDrawnPoints.size() > 1; }
+        void setCentreLine(const QList<QPair<QPointF, qreal> >& points);
+
+        QList<QList<QPair<QPointF, qreal> > > erasedCentreLine(const QLineF& eraserLine, qreal eraserRadius, bool* erased) const;
+
+        static QList<QPolygonF> outlinePolygons(const QList<QPair<QPointF, qreal> >& points, bool translucent);
+
+        static QList<QPair<QPointF, qreal> > simplifiedCentreLine(const QList<QPair<QPointF, qreal> >& points, qreal tolerance);
+
+        void simplifyInBackground(qreal tolerance);
+        void cancelSimplification();
 
     protected:
         void addPolygon(UBGraphicsPolygonItem* pol);
@@ -81,6 +100,10 @@ class UBGraphicsStroke
         QList<QPair<QPointF, qreal> > mDrawnPoints;
 
         qreal mAntiScaleRatio;
+
+        QFutureWatcher<UBSimplifiedStroke>* mSimplification;
+
+        void replacePolygons(const UBSimplifiedStroke& simplified);
 };
 
 #endif /* UBGRAPHICSSTROKE_H_ */
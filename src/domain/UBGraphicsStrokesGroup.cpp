@@ -31,6 +31,7 @@
 #include "UBGraphicsStroke.h"
 
 #include "domain/UBGraphicsPolygonItem.h"
+#include "domain/UBGraphicsScene.h"
 
 #include "core/memcheck.h"
 
@@ -88,6 +89,10 @@ void UBGraphicsStrokesGroup::setColor(const QColor &color, colorType pColorType)
 
     if (mDebugText)
         mDebugText->setBrush(QBrush(color));
+
+    UBGraphicsScene* ubScene = dynamic_cast<UBGraphicsScene*>(scene());
+    if (ubScene)
+        ubScene->setItemModified(this);
 }
 
 QColor UBGraphicsStrokesGroup::color(colorType pColorType) const
@@ -439,7 +439,7 @@ void UBGraphicsTextItem::contentsChanged()
 {
     if (scene())
     {
-        scene()->setModified(true);
+        scene()->setItemModified(this);
     }
 
     if (toPlainText().isEmpty())
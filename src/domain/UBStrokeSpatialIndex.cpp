@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "UBStrokeSpatialIndex.h"
+
+#include "UBGraphicsPolygonItem.h"
+
+#include "core/memcheck.h"
+
+
+namespace UBStrokeSpatialIndexGrid
+{
+    // In scene units, about the width of the eraser at zoom 1.
+    const qreal cellSize = 128;
+
+    // Beyond that many cells, a polygon is kept out of the grid.
+    const int maxCellsPerItem = 1024;
+}
+
+UBStrokeSpatialIndex::UBStrokeSpatialIndex()
+{
+    // NOOP
+}
+
+void UBStrokeSpatialIndex::invalidate(UBGraphicsPolygonItem* polygonItem)
+{
+    mDirtyItems.insert(polygonItem);
+}
+
+void UBStrokeSpatialIndex::remove(UBGraphicsPolygonItem* polygonItem)
+{
+    mDirtyItems.remove(polygonItem);
+    take(polygonItem);
+}
+
+void UBStrokeSpatialIndex::clear()
+{
+    mCells.clear();
+    mItemCells.clear();
+    mOversizedItems.clear();
+    mDirtyItems.clear();
+}
+
+QList<UBGraphicsPolygonItem*> UBStrokeSpatialIndex::items(const QRectF& sceneRect)
+{
+    flush();
+
+    QSet<UBGraphicsPolygonItem*> candidates = mOversizedItems;
+
+    QRect range = cellRange(sceneRect);
+    for (int column = range.left(); column <= range.right(); column++)
+    {
+        for (int row = range.top(); row <= range.bottom(); row++)
+        {
+            QHash<quint64, QList<UBGraphicsPolygonItem*> >::const_iterator cell = mCells.constFind(cellKey(column, row));
+            if (cell != mCells.constEnd())
+            {
+                foreach (UBGraphicsPolygonItem* polygonItem, cell.value())
+                    candidates.insert(polygonItem);
+            }
+        }
+    }
+
+    QList<UBGraphicsPolygonItem*> result;
+    foreach (UBGraphicsPolygonItem* polygonItem, candidates)
+    {
+        if (polygonItem->sceneBoundingRect().intersects(sceneRect))
+            result << polygonItem;
+    }
+
+    return result;
+}
+
+void UBStrokeSpatialIndex::flush()
+{
+    foreach (UBGraphicsPolygonItem* polygonItem, mDirtyItems)
+    {
+        take(polygonItem);
+        insert(polygonItem);
+    }
+
+    mDirtyItems.clear();
+}
+
+void UBStrokeSpatialIndex::insert(UBGraphicsPolygonItem* polygonItem)
+{
+    QRect range = cellRange(polygonItem->sceneBoundingRect());
+
+    if (range.width() * range.height() > UBStrokeSpatialIndexGrid::maxCellsPerItem)
+    {
+        mOversizedItems.insert(polygonItem);
+        return;
+    }
+
+    for (int column = range.left(); column <= range.right(); column++)
+    {
+        for (int row = range.top(); row <= range.bottom(); row++)
+            mCells[cellKey(column, row)] << polygonItem;
+    }
+
+    mItemCells.insert(polygonItem, range);
+}
+
+void UBStrokeSpatialIndex::take(UBGraphicsPolygonItem* polygonItem)
+{
+    if (mOversizedItems.remove(polygonItem))
+        return;
+
+    QHash<UBGraphicsPolygonItem*, QRect>::iterator it = mItemCells.find(polygonItem);
+    if (it == mItemCells.end())
+        return;
+
+    QRect range = it.value();
+    mItemCells.erase(it);
+
+    for (int column = range.left(); column <= range.right(); column++)
+    {
+        for (int row = range.top(); row <= range.bottom(); row++)
+        {
+            QHash<quint64, QList<UBGraphicsPolygonItem*> >::iterator cell = mCells.find(cellKey(column, row));
+            if (cell != mCells.end())
+            {
+                cell.value().removeOne(polygonItem);
+                if (cell.value().isEmpty())
+                    mCells.erase(cell);
+            }
+        }
+    }
+}
+
+QRect UBStrokeSpatialIndex::cellRange(const QRectF& sceneRect) const
+{
+    const qreal cellSize = UBStrokeSpatialIndexGrid::cellSize;
+
+    return QRect(QPoint(qFloor(sceneRect.left() / cellSize), qFloor(sceneRect.top() / cellSize)),
+                 QPoint(qFloor(sceneRect.right() / cellSize), qFloor(sceneRect.bottom() / cellSize)));
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UBSTROKESPATIALINDEX_H_
+#define UBSTROKESPATIALINDEX_H_
+
+#include <QtGui>
+
+class UBGraphicsPolygonItem;
+
+/**
+ * Uniform grid over the scene bounding rects of the polygon items of a scene, so that the
+ * eraser finds the polygons under it without going through QGraphicsScene::items().
+ * Polygons report themselves as dirty when they enter the scene, move or change shape,
+ * and are re-bucketed on the next query.
+ */
+class UBStrokeSpatialIndex
+{
+    public:
+        UBStrokeSpatialIndex();
+
+        void invalidate(UBGraphicsPolygonItem* polygonItem);
+        void remove(UBGraphicsPolygonItem* polygonItem);
+        void clear();
+
+        QList<UBGraphicsPolygonItem*> items(const QRectF& sceneRect);
+
+    private:
+        void flush();
+        void insert(UBGraphicsPolygonItem* polygonItem);
+        void take(UBGraphicsPolygonItem* polygonItem);
+        QRect cellRange(const QRectF& sceneRect) const;
+
+        static quint64 cellKey(int column, int row)
+        {
+            return (quint64(quint32(column)) << 32) | quint32(row);
+        }
+
+        QHash<quint64, QList<UBGraphicsPolygonItem*> > mCells;
+        QHash<UBGraphicsPolygonItem*, QRect> mItemCells;
+
+        // Polygons covering too many cells, tested on every query.
+        QSet<UBGraphicsPolygonItem*> mOversizedItems;
+
+        QSet<UBGraphicsPolygonItem*> mDirtyItems;
+};
+
+#endif /* UBSTROKESPATIALINDEX_H_ */
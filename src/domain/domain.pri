@@ -13,6 +13,8 @@ HEADERS += src/domain/UBGraphicsScene.h \
     src/domain/UBGraphicsTextItem.h \
     src/domain/UBResizableGraphicsItem.h \
     src/domain/UBGraphicsStroke.h \
+    src/domain/UBGraphicsLiveStrokeItem.h \
+    src/domain/UBStrokeSpatialIndex.h \
     src/domain/UBGraphicsMediaItem.h \
     src/domain/UBGraphicsGroupContainerItem.h \
     src/domain/UBGraphicsGroupContainerItemDelegate.h \
@@ -42,6 +44,8 @@ SOURCES += src/domain/UBGraphicsScene.cpp \
     src/domain/UBGraphicsTextItem.cpp \
     src/domain/UBResizableGraphicsItem.cpp \
     src/domain/UBGraphicsStroke.cpp \
+    src/domain/UBGraphicsLiveStrokeItem.cpp \
+    src/domain/UBStrokeSpatialIndex.cpp \
     src/domain/UBGraphicsMediaItem.cpp \
     src/domain/UBGraphicsGroupContainerItem.cpp \
     src/domain/UBGraphicsGroupContainerItemDelegate.cpp \
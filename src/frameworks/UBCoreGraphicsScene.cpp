@@ -73,7 +73,8 @@ void UBCoreGraphicsScene::addItem(QGraphicsItem* item)
     if (item->scene() != this)
         QGraphicsScene::addItem(item);
 
-    setModified(true);
+    // adding an item does not change how the other items are persisted
+    UBCoreGraphicsScene::setModified(true);
 }
 
 
@@ -84,7 +85,7 @@ void UBCoreGraphicsScene::removeItem(QGraphicsItem* item, bool forceDelete)
     {
         deleteItem(item);
     }
-    setModified(true);
+    UBCoreGraphicsScene::setModified(true);
 }
 
 bool UBCoreGraphicsScene::deleteItem(QGraphicsItem* item)
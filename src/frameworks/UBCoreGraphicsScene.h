@@ -54,7 +54,7 @@ class UBCoreGraphicsScene : public QGraphicsScene
             return mIsModified;
         }
 
-        void setModified(bool pModified)
+        virtual void setModified(bool pModified)
         {
             mIsModified = pModified;
         }
@@ -42,6 +42,7 @@
 #include "adaptors/UBThumbnailAdaptor.h"
 #include "adaptors/UBSvgSubsetAdaptor.h"
 #include "document/UBDocumentController.h"
+#include "document/UBThumbnailService.h"
 #include "domain/UBGraphicsScene.h"
 #include "board/UBBoardPaletteManager.h"
 #include "core/UBApplicationController.h"
@@ -185,6 +186,35 @@ void UBBoardThumbnailsView::updateThumbnailsPos()
     scene()->setSceneRect(0, 0, scene()->itemsBoundingRect().size().width() - verticalScrollBar()->width(), scene()->itemsBoundingRect().size().height());
 
     update();
+
+    prioritizeVisibleThumbnails();
+}
+
+void UBBoardThumbnailsView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+
+    prioritizeVisibleThumbnails();
+}
+
+void UBBoardThumbnailsView::prioritizeVisibleThumbnails()
+{
+    // the pages shown here are loaded first by the document mode too
+    QList<int> pageIndexes;
+
+    foreach (QGraphicsItem* item, items(viewport()->rect()))
+    {
+        UBDraggableThumbnailView* thumbnail = dynamic_cast<UBDraggableThumbnailView*>(item);
+
+        if (thumbnail)
+            pageIndexes << thumbnail->sceneIndex();
+    }
+
+    if (!pageIndexes.isEmpty())
+    {
+        std::sort(pageIndexes.begin(), pageIndexes.end());
+        UBThumbnailService::thumbnailService()->prioritize(UBApplication::boardController->selectedDocument(), pageIndexes);
+    }
 }
 
 void UBBoardThumbnailsView::resizeEvent(QResizeEvent *event)
@@ -60,6 +60,7 @@ public slots:
 
 protected:
     virtual void resizeEvent(QResizeEvent *event);
+    virtual void scrollContentsBy(int dx, int dy);
 
     virtual void dragEnterEvent(QDragEnterEvent* event);
     virtual void dragMoveEvent(QDragMoveEvent* event);
@@ -76,6 +77,7 @@ signals:
 private:
     UBDraggableThumbnailView* createThumbnail(UBDocumentContainer* source, int i);
     void updateThumbnailsPos();
+    void prioritizeVisibleThumbnails();
 
     QList<UBDraggableThumbnailView*> mThumbnails;
 
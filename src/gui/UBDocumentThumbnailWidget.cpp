@@ -36,6 +36,7 @@
 #include "board/UBBoardController.h"
 
 #include "document/UBDocumentController.h"
+#include "document/UBThumbnailService.h"
 
 #include "core/memcheck.h"
 
@@ -98,6 +99,43 @@ void UBDocumentThumbnailWidget::mouseMoveEvent(QMouseEvent *event)
     UBThumbnailWidget::mouseMoveEvent(event);
 }
 
+void UBDocumentThumbnailWidget::resizeEvent(QResizeEvent *event)
+{
+    UBThumbnailWidget::resizeEvent(event);
+
+    prioritizeVisibleThumbnails();
+}
+
+void UBDocumentThumbnailWidget::scrollContentsBy(int dx, int dy)
+{
+    UBThumbnailWidget::scrollContentsBy(dx, dy);
+
+    prioritizeVisibleThumbnails();
+}
+
+void UBDocumentThumbnailWidget::prioritizeVisibleThumbnails()
+{
+    UBDocumentProxy* proxy = 0;
+    QList<int> pageIndexes;
+
+    foreach (QGraphicsItem* item, items(viewport()->rect()))
+    {
+        UBSceneThumbnailPixmap* thumbnail = dynamic_cast<UBSceneThumbnailPixmap*>(item);
+
+        if (thumbnail)
+        {
+            proxy = thumbnail->documentProxy();
+            pageIndexes << thumbnail->sceneIndex();
+        }
+    }
+
+    if (proxy)
+    {
+        std::sort(pageIndexes.begin(), pageIndexes.end());
+        UBThumbnailService::thumbnailService()->prioritize(proxy, pageIndexes);
+    }
+}
+
 void UBDocumentThumbnailWidget::dragEnterEvent(QDragEnterEvent *event)
 {
     if (!event->mimeData()->hasFormat(UBApplication::mimeTypeUniboardPage))
@@ -284,6 +322,8 @@ void UBDocumentThumbnailWidget::setGraphicsItems(const QList<QGraphicsItem*>& pG
     deleteDropCaret();
 
     UBThumbnailWidget::setGraphicsItems(pGraphicsItems, pItemPaths, pLabels, pMimeType);
+
+    prioritizeVisibleThumbnails();
 }
 
 void UBDocumentThumbnailWidget::setDragEnabled(bool enabled)
@@ -303,7 +343,12 @@ void UBDocumentThumbnailWidget::updateThumbnailPixmap(int index, const QPixmap&
         UBSceneThumbnailPixmap *thumbnail = dynamic_cast<UBSceneThumbnailPixmap*>(mGraphicItems.at(index));
         if (thumbnail)
         {
+            bool resized = thumbnail->pixmap().size() != newThumbnail.size();
+
             thumbnail->setPixmap(newThumbnail);
+
+            if (resized)
+                refreshScene();
         }
     }
 }
@@ -63,6 +63,8 @@ class UBDocumentThumbnailWidget: public UBThumbnailWidget
     protected:
 
         virtual void mouseMoveEvent(QMouseEvent *event);
+        virtual void resizeEvent(QResizeEvent *event);
+        virtual void scrollContentsBy(int dx, int dy);
 
         virtual void dragEnterEvent(QDragEnterEvent *event);
         virtual void dragLeaveEvent(QDragLeaveEvent *event);
@@ -71,6 +73,7 @@ class UBDocumentThumbnailWidget: public UBThumbnailWidget
 
     private:
         void deleteDropCaret();
+        void prioritizeVisibleThumbnails();
 
         QGraphicsRectItem *mDropCaretRectItem;
         UBThumbnailPixmap *mClosestDropItem;
@@ -39,6 +39,7 @@
 
 #include "adaptors/UBThumbnailAdaptor.h"
 #include "adaptors/UBSvgSubsetAdaptor.h"
+#include "adaptors/UBPageManifest.h"
 #include "frameworks/UBFileSystemUtils.h"
 
 #include "core/memcheck.h"
@@ -299,8 +300,8 @@ void UBDocumentTreeWidget::dropEvent(QDropEvent *event)
 
                             //due to incorrect generation of thumbnails of invisible scene I've used direct copying of thumbnail files
                             //it's not universal and good way but it's faster
-                            QString from = sourceItem.documentProxy()->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", sourceItem.sceneIndex());
-                            QString to  = targetDocProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetDocProxy->pageCount());
+                            QString from = UBPageManifest::pageThumbnailPath(sourceItem.documentProxy()->persistencePath(), sourceItem.sceneIndex());
+                            QString to  = UBPageManifest::pageThumbnailPath(targetDocProxy->persistencePath(), targetDocProxy->pageCount() - 1);
                             QFile::remove(to);
                             QFile::copy(from, to);
                           }
@@ -28,6 +28,8 @@
 
 #include "UBScreenMirror.h"
 
+#include <cstring>
+
 #include "core/UBSettings.h"
 #include "core/UBSetting.h"
 #include "core/UBApplication.h"
@@ -41,9 +43,40 @@
 #include "core/memcheck.h"
 
 
+/**
+ * @brief Find the tiles of current that differ from previous, both being RGB32 images of the same size
+ */
+static QRegion changedRegion(const QImage& previous, const QImage& current)
+{
+    const int tileSize = 64;
+    QRegion region;
+
+    for (int y = 0; y < current.height(); y += tileSize)
+    {
+        int rows = qMin(tileSize, current.height() - y);
+
+        for (int x = 0; x < current.width(); x += tileSize)
+        {
+            int columns = qMin(tileSize, current.width() - x);
+
+            for (int row = y; row < y + rows; ++row)
+            {
+                if (memcmp(previous.constScanLine(row) + x * 4, current.constScanLine(row) + x * 4, columns * 4) != 0)
+                {
+                    region += QRect(x, y, columns, rows);
+                    break;
+                }
+            }
+        }
+    }
+
+    return region;
+}
+
+
 UBScreenMirror::UBScreenMirror(QWidget* parent)
     : QWidget(parent)
-    , mSourceWidget(0)
+    , mGrabbing(false)
     , mTimerID(0)
 {
     // NOOP
@@ -52,24 +85,20 @@ UBScreenMirror::UBScreenMirror(QWidget* parent)
 
 UBScreenMirror::~UBScreenMirror()
 {
-    // NOOP
+    if (mSourceWidget)
+        unwatch(mSourceWidget);
 }
 
 
 void UBScreenMirror::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
-
     QPainter painter(this);
 
-    painter.fillRect(0, 0, width(), height(), QBrush(Qt::black));
+    painter.fillRect(event->rect(), QBrush(Qt::black));
 
-    if (!mLastPixmap.isNull())
+    if (!mBackBuffer.isNull())
     {
-        int x = (width() - mLastPixmap.width()) / 2;
-        int y = (height() - mLastPixmap.height()) / 2;
-
-        painter.drawPixmap(x, y, width(), height(), mLastPixmap);
+        painter.drawPixmap(backBufferOffset(), mBackBuffer);
     }
 }
 
@@ -78,34 +107,184 @@ void UBScreenMirror::timerEvent(QTimerEvent *event)
 {
     Q_UNUSED(event);
 
-    grabPixmap();
+    refresh();
+}
+
+
+bool UBScreenMirror::eventFilter(QObject *obj, QEvent *event)
+{
+    bool result = QWidget::eventFilter(obj, event);
+
+    QWidget* widget = qobject_cast<QWidget*>(obj);
+
+    if (!mSourceWidget || !widget)
+        return result;
+
+    if (event->type() == QEvent::Paint && !mGrabbing) // grab() paints the source as well
+    {
+        QRegion region = static_cast<QPaintEvent *>(event)->region();
+
+        if (widget != mSourceWidget)
+            region.translate(widget->mapTo(mSourceWidget, QPoint(0, 0)));
 
-    update();
+        mDirtyRegion += region;
+    }
+    else if (event->type() == QEvent::ChildPolished)
+    {
+        QWidget* child = qobject_cast<QWidget*>(static_cast<QChildEvent *>(event)->child());
+
+        if (child)
+            watch(child);
+    }
+
+    return result;
 }
 
-void UBScreenMirror::grabPixmap()
+
+/**
+ * @brief Grab again the dirty parts of the source and scale them into the back buffer
+ *
+ * Nothing is grabbed nor scaled when the source did not change since the last frame.
+ */
+void UBScreenMirror::refresh()
 {
+    QSize sourceSize;
+
     if (mSourceWidget)
     {
-        mLastPixmap = mSourceWidget->grab();
+        sourceSize = mSourceWidget->size();
     }
     else
     {
-        mLastPixmap = UBApplication::displayManager->grab(ScreenRole::Control);
+        QImage screen = UBApplication::displayManager->grab(ScreenRole::Control).toImage().convertToFormat(QImage::Format_RGB32);
+
+        if (!mLastScreen.isNull() && mLastScreen.size() == screen.size())
+            mDirtyRegion += changedRegion(mLastScreen, screen);
+
+        mLastScreen = screen;
+        sourceSize = screen.size();
     }
 
-    if (!mLastPixmap.isNull())
-        mLastPixmap = mLastPixmap.scaled(width(), height(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    if (sourceSize.isEmpty())
+        return;
+
+    QSize backBufferSize = sourceSize.scaled(size(), Qt::KeepAspectRatio);
+
+    if (backBufferSize.isEmpty())
+        return;
+
+    if (sourceSize != mSourceSize || backBufferSize != mBackBuffer.size())
+    {
+        mSourceSize = sourceSize;
+        mSourceToBackBuffer = QTransform::fromScale(qreal(backBufferSize.width()) / sourceSize.width(),
+                                                    qreal(backBufferSize.height()) / sourceSize.height());
+
+        mBackBuffer = QPixmap(backBufferSize);
+        mBackBuffer.fill(Qt::black);
+
+        mDirtyRegion = QRect(QPoint(0, 0), sourceSize);
+        update();
+    }
+
+    QRect sourceRect(QPoint(0, 0), mSourceSize);
+    QRegion dirtyRegion = mDirtyRegion & sourceRect;
+    mDirtyRegion = QRegion();
+
+    if (dirtyRegion.isEmpty())
+        return;
+
+    // many small rects cost more to grab one by one than together
+    if (dirtyRegion.rectCount() > 16)
+        dirtyRegion = dirtyRegion.boundingRect();
+
+    QTransform backBufferToSource = mSourceToBackBuffer.inverted();
+    QRegion updatedRegion;
+
+    QPainter painter(&mBackBuffer);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    for (const QRect& dirtyRect : dirtyRegion)
+    {
+        QRect target = mSourceToBackBuffer.mapRect(QRectF(dirtyRect)).toAlignedRect() & mBackBuffer.rect();
+
+        // a margin around the grabbed part keeps the smoothing continuous across the edges of the target
+        QRect source = backBufferToSource.mapRect(QRectF(target)).adjusted(-1, -1, 1, 1).toAlignedRect() & sourceRect;
+
+        QPixmap content = grabSource(source);
+
+        if (content.isNull())
+            continue;
+
+        painter.setClipRect(target);
+        painter.drawPixmap(mSourceToBackBuffer.mapRect(QRectF(source)), content, QRectF(content.rect()));
+
+        updatedRegion += target;
+    }
+
+    painter.end();
+
+    update(updatedRegion.translated(backBufferOffset()));
+}
+
+
+QPixmap UBScreenMirror::grabSource(const QRect& rect)
+{
+    if (!mSourceWidget)
+        return QPixmap::fromImage(mLastScreen.copy(rect));
+
+    mGrabbing = true;
+    QPixmap content = mSourceWidget->grab(rect);
+    mGrabbing = false;
+
+    return content;
+}
+
+
+QPoint UBScreenMirror::backBufferOffset() const
+{
+    return QPoint((width() - mBackBuffer.width()) / 2, (height() - mBackBuffer.height()) / 2);
+}
+
+
+/**
+ * @brief Listen to the repaints of a widget of the source and of its children, except the separate windows
+ */
+void UBScreenMirror::watch(QWidget* widget)
+{
+    if (widget != mSourceWidget && widget->isWindow())
+        return;
+
+    widget->installEventFilter(this);
+
+    foreach (QWidget* child, widget->findChildren<QWidget*>(QString(), Qt::FindDirectChildrenOnly))
+        watch(child);
+}
+
+
+void UBScreenMirror::unwatch(QWidget* widget)
+{
+    widget->removeEventFilter(this);
+
+    foreach (QWidget* child, widget->findChildren<QWidget*>())
+        child->removeEventFilter(this);
 }
 
 
 void UBScreenMirror::setSourceWidget(QWidget *sourceWidget)
 {
+    if (mSourceWidget)
+        unwatch(mSourceWidget);
+
     mSourceWidget = sourceWidget;
 
-    grabPixmap();
+    if (mSourceWidget)
+        watch(mSourceWidget);
 
-    update();
+    // the new source is grabbed entirely
+    mSourceSize = QSize();
+    mLastScreen = QImage();
+
+    refresh();
 }
 
 
@@ -115,6 +294,10 @@ void UBScreenMirror::start()
     UBApplication::boardController->freezeW3CWidgets(true);
     if (mTimerID == 0)
     {
+        // the source is grabbed entirely on the first frame
+        mSourceSize = QSize();
+        mLastScreen = QImage();
+
         int ms = 125;
 
         bool success;
@@ -32,6 +32,7 @@
 
 #include <QtGui>
 #include <QWidget>
+#include <QPointer>
 
 class UBScreenMirror : public QWidget
 {
@@ -52,13 +53,32 @@ class UBScreenMirror : public QWidget
 
         void stop();
 
+    protected:
+        bool eventFilter(QObject *obj, QEvent *event);
+
     private:
 
-        void grabPixmap();
+        void refresh();
+        QPixmap grabSource(const QRect& rect);
+        QPoint backBufferOffset() const;
+
+        void watch(QWidget* widget);
+        void unwatch(QWidget* widget);
+
+        QPointer<QWidget> mSourceWidget;
+
+        // the source scaled to the mirror, only the dirty parts of it are grabbed again
+        QPixmap mBackBuffer;
+        QSize mSourceSize;
+        QTransform mSourceToBackBuffer;
+
+        // repainted parts of the source since the last frame, in its coordinates
+        QRegion mDirtyRegion;
 
-        QWidget* mSourceWidget;
+        // the screen reports no repaints, its changes are found against the previous grab
+        QImage mLastScreen;
 
-        QPixmap mLastPixmap;
+        bool mGrabbing;
 
         long mTimerID;
 
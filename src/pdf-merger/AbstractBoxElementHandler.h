@@ -50,7 +50,7 @@ namespace merge_lib
 
       void _retrieveBoxFromParent()
       {                  
-         std::string content = _page->getObjectContent();
+         std::string_view content = _page->getObjectContentView();
          std::string mediaBox;
          Object * parent = _page;
          while(1)
@@ -63,7 +63,7 @@ namespace merge_lib
             if(parents.size() != 1)
                break;
             parent = parents[0];
-            std::string parentContent = parent->getObjectContent();
+            std::string_view parentContent = parent->getObjectContentView();
             unsigned int startOfMediaBox = parentContent.find(_handlerName);
             if((int)startOfMediaBox == -1)
             {
@@ -71,12 +71,12 @@ namespace merge_lib
                continue;
             }
             unsigned int endOfMediaBox = parentContent.find("]", startOfMediaBox);
-            mediaBox = parentContent.substr(startOfMediaBox, endOfMediaBox - startOfMediaBox + 1);
+            mediaBox.assign(parentContent.substr(startOfMediaBox, endOfMediaBox - startOfMediaBox + 1));
             break;
          }
          if(!mediaBox.empty())
          {
-            unsigned int startOfMediaBox = _page->getObjectContent().rfind(">>");
+            unsigned int startOfMediaBox = _page->getObjectContentView().rfind(">>");
             _page->insertToContent(startOfMediaBox, mediaBox);
             _changeObjectContent(startOfMediaBox);            
          }            
@@ -50,7 +50,7 @@ void AnnotsHandler::_processObjectContent(unsigned int startOfPageElement)
    if( _annotations.size() )
    {
       Object * child = _annotations[0];
-      std::string childContent = child->getObjectContent();
+      std::string_view childContent = child->getObjectContentView();
       if((int) Parser::findToken(childContent,"/Rect") == -1 &&
          (int)Parser::findToken(childContent,"/Subtype") == -1 )
       {
@@ -87,7 +87,7 @@ string ContentHandler::_getStreamFromReferencies(merge_lib::Object * objectWithA
    std::vector<Object *> referencies = objectWithArray->getSortedByPositionChildren(leftBound, rightBound);
    for(size_t i = 0; i < referencies.size(); ++i)
    {
-      result.append(_retrieveStreamContent(referencies[i], 0, referencies[i]->getObjectContent().size()));      
+      result.append(_retrieveStreamContent(referencies[i], 0, referencies[i]->getObjectContentView().size()));      
    }
    objectWithArray->forgetAboutChildren(leftBound,rightBound);
    return result;
@@ -51,7 +51,7 @@ namespace merge_lib
       //replace CropBox with BBox
       virtual void _changeObjectContent(unsigned int startOfPageElement)
       {
-         Rectangle mediaBox("/CropBox", _page->getObjectContent());
+         Rectangle mediaBox("/CropBox", _page->getObjectContentView());
 
          double shiftX = Utils::doubleEquals(mediaBox.x1,0)?0:-mediaBox.x1;
          double shiftY = Utils::doubleEquals(mediaBox.y1,0)?0:-mediaBox.y1;
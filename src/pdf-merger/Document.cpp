@@ -33,9 +33,12 @@
 #include "Utils.h"
 #include "Parser.h"
 #include "Exception.h"
+#include <QFile>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <set>
 
 #include "core/memcheck.h"
 
@@ -43,7 +46,7 @@ using namespace merge_lib;
 const std::string firstObj("%PDF-1.4\n1 0 obj\n<<\n/Title ()/Creator ()/Producer (Qt 4.5.0 (C) 1992-2009 Nokia Corporation and/or its subsidiary(-ies))/CreationDate (D:20090424120829)\n>>\nendobj\n");
 const std::string zeroStr("0000000000");
 Document::Document(const char * fileName):
-    _root(0), _pages(), _documentName(fileName), _maxObjectNumber(0)
+    _root(0), _pages(), _documentName(fileName), _maxObjectNumber(0), _startOfXref(0), _trailerSize(0), _trailerEntries()
 {
 
 }
@@ -127,6 +130,73 @@ void Document::saveAs(const char * newFileName)
 
 }
 
+void Document::saveAsUpdateOf(const char * newFileName, Document * updatedDocument)
+{
+   if(!updatedDocument || !updatedDocument->canBeUpdated())
+   {
+      throw Exception("Document cannot be saved as an update");
+   }
+
+   //the objects of the updated file keep their number, the new ones follow them
+   std::set<Object *> updatedFileObjects(updatedDocument->_allObjects.begin(), updatedDocument->_allObjects.end());
+   unsigned int fromObjNumber = updatedDocument->_trailerSize;
+   _root->recalculateObjectNumbers(fromObjNumber, updatedFileObjects);
+
+   QFile::remove(QFile::decodeName(newFileName));
+   if(!QFile::copy(QFile::decodeName(updatedDocument->_documentName.c_str()), QFile::decodeName(newFileName)))
+   {
+      std::string error("Access denied on file ");
+      error.append(newFileName);
+      throw Exception(error);
+   }
+
+   std::ofstream out;
+   out.open(newFileName, std::ios::binary | std::ios::in | std::ios::out);
+   if(!out.is_open())
+   {      
+      std::string error("Access denied on file ");
+      error.append(newFileName);
+      throw Exception(error);
+   }
+   out.seekp(0, std::ios::end);
+   //the updated file may not end with an end of line
+   out << "\n";
+
+   //key - object number
+   //value - offset and generation number of object
+   std::map< unsigned int, std::pair<unsigned long long, unsigned int > > offsetsAndGenerationNumbers;
+   std::set<Object *> passedObjects;
+   _root->serializeUpdate(out, updatedFileObjects, passedObjects, offsetsAndGenerationNumbers);
+
+   unsigned long long startOfXref = out.tellp();
+   unsigned int numberOfObjects = updatedDocument->_trailerSize;
+
+   //one xref subsection for each run of consecutive object numbers
+   out << "xref\n";
+   std::map< unsigned int, std::pair<unsigned long long, unsigned int > >::iterator sectionStart = offsetsAndGenerationNumbers.begin();
+   while(sectionStart != offsetsAndGenerationNumbers.end())
+   {
+      std::map< unsigned int, std::pair<unsigned long long, unsigned int > >::iterator sectionEnd = sectionStart;
+      unsigned int count = 0;
+      while(sectionEnd != offsetsAndGenerationNumbers.end() && (*sectionEnd).first == (*sectionStart).first + count)
+      {
+         ++sectionEnd;
+         ++count;
+      }
+      out << (*sectionStart).first << " " << count << "\n";
+      for(; sectionStart != sectionEnd; ++sectionStart)
+      {
+         out << std::setfill('0') << std::setw(10) << (*sectionStart).second.first << " " << std::setw(5) << (*sectionStart).second.second << " n \n";
+      }
+   }
+   if(!offsetsAndGenerationNumbers.empty())
+      numberOfObjects = std::max(numberOfObjects, (*offsetsAndGenerationNumbers.rbegin()).first + 1);
+
+   out << "trailer\n<<\n/Size " << numberOfObjects << "\n/Prev " << updatedDocument->_startOfXref << "\n"
+      << updatedDocument->_trailerEntries
+      << "/Root " << _root->getObjectNumber() << " " << _root->getgenerationNumber() << " R\n >>\nstartxref\n" << startOfXref << "\n%%EOF\n";
+}
+
 Object * Document::getDocumentObject()
 {
    return _root;
@@ -52,6 +52,27 @@ namespace merge_lib
       //save document with newFileName file name
       void     saveAs(const char * newFileName);   
 
+      //save document with newFileName file name as an incremental update of updatedDocument:
+      //the file of updatedDocument is copied as it is, then the objects which are not
+      //in it, or were modified, are appended with a new xref section
+      void     saveAsUpdateOf(const char * newFileName, Document * updatedDocument);
+
+      //the file of the document has a trailer which an incremental update can refer to
+      bool     canBeUpdated() const
+      {
+         return _startOfXref != 0;
+      }
+
+      const std::string & getDocumentName() const
+      {
+         return _documentName;
+      }
+
+      unsigned int getPageCount() const
+      {
+         return _pages.size();
+      }
+
       //get root of all document objects
       Object * getDocumentObject();
 
@@ -83,6 +104,13 @@ namespace merge_lib
       //max number of all document's objects
       unsigned int _maxObjectNumber;
 
+      //position of the last xref section and /Size of the last trailer, 0 if unknown
+      unsigned long _startOfXref;
+      unsigned int  _trailerSize;
+
+      //entries of the last trailer that an update repeats, as /Info or /ID
+      std::string   _trailerEntries;
+
    };
 }
 #endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#include "MappedFile.h"
+#include "Exception.h"
+
+#include "core/memcheck.h"
+
+using namespace merge_lib;
+
+MappedFile::MappedFile(const char * fileName): _file(QFile::decodeName(fileName)), _mappedData(0), _readContent(), _content()
+{
+   if (!_file.open(QIODevice::ReadOnly))
+   {
+      std::stringstream errorMessage("File ");
+      errorMessage << fileName << " is absent" << "\0";
+      throw Exception(errorMessage);
+   }
+
+   qint64 length = _file.size();
+   if (length > 0)
+   {
+      _mappedData = _file.map(0, length);
+   }
+
+   if (_mappedData)
+   {
+      _content = std::string_view(reinterpret_cast<const char *>(_mappedData), length);
+   }
+   else
+   {
+      //some file systems do not support mapping, fall back to reading the file
+      QByteArray data = _file.readAll();
+      _readContent.assign(data.constData(), data.size());
+      _content = _readContent;
+   }
+}
+
+MappedFile::~MappedFile()
+{
+   if (_mappedData)
+   {
+      _file.unmap(_mappedData);
+   }
+   _file.close();
+}
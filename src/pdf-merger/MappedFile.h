@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+
+
+#if !defined MappedFile_h
+#define MappedFile_h
+
+#include <QFile>
+
+#include <string>
+#include <string_view>
+
+namespace merge_lib
+{
+   //This class maps a pdf file into memory for reading.
+   //The parser and the objects refer to byte ranges of its content
+   //instead of copying them, so it lives as long as any of them.
+   class MappedFile
+   {
+   public:
+      MappedFile(const char * fileName); //throw Exception
+      ~MappedFile();
+
+      std::string_view getContent() const
+      {
+         return _content;
+      }
+
+   private:
+      MappedFile(const MappedFile & copy);
+      MappedFile & operator=(const MappedFile & copy);
+
+      //members
+      QFile            _file;
+      uchar *          _mappedData;
+      std::string      _readContent; //used when the file cannot be mapped
+      std::string_view _content;
+   };
+}
+#endif
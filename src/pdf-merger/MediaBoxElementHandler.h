@@ -74,7 +74,7 @@ namespace merge_lib
       }
       bool _wasCropBoxHandlerCalled()
       {
-         return ((int)_page->getObjectContent().find("/BBox") != -1) ? true : false;
+         return ((int)_page->getObjectContentView().find("/BBox") != -1) ? true : false;
       }
    };
 }
@@ -31,6 +31,7 @@
 #include "Parser.h"
 #include "OverlayDocumentParser.h"
 #include "Exception.h"
+#include "Utils.h"
 
 #include <map>
 #include <iostream>
@@ -39,9 +40,7 @@
 
 using namespace merge_lib;
 
-Parser Merger::_parser;
-
-Merger::Merger():_baseDocuments(),_overlayDocument(0)
+Merger::Merger():_baseDocuments(),_parser(),_overlayDocument(0)
 {
 
 }
@@ -126,6 +125,7 @@ void Merger::merge(const char * overlayDocName, const MergeDescription & pagesTo
                break;
          }
          isPageDuplicated = (2 == howManyTimesPageFound) ? true : false;
+         _mergedBasePages[(*pageIterator).baseDocumentName].insert((*pageIterator).basePageNumber);
       }
 
       destinationPage->merge(sourcePage, _overlayDocument, const_cast<MergePageDescription&>((*pageIterator)), isPageDuplicated);
@@ -138,3 +138,32 @@ void Merger::saveMergedDocumentsAs(const char * outDocumentName)
    _overlayDocument->saveAs(outDocumentName);
 }
 
+// Method performs saving of merged documents as an incremental update of the largest base document
+// whose pages are all merged, or saves them whole when no base document can be updated
+void Merger::saveMergedDocumentsAsUpdate(const char * outDocumentName)
+{
+   Document * updatedDocument = 0;
+   unsigned long updatedDocumentSize = 0;
+   std::map<std::string, Document *>::iterator docIterator = _baseDocuments.begin();
+   for(; docIterator != _baseDocuments.end(); ++docIterator)
+   {
+      Document * baseDocument = (*docIterator).second;
+      if(!baseDocument || !baseDocument->canBeUpdated())
+         continue;
+      //the update keeps the base file byte for byte, with the pages deleted from the exported document
+      std::map<std::string, std::set<unsigned int> >::const_iterator mergedPages = _mergedBasePages.find((*docIterator).first);
+      if(mergedPages == _mergedBasePages.end() || mergedPages->second.size() != baseDocument->getPageCount())
+         continue;
+      unsigned long size = Utils::getFileSize(baseDocument->getDocumentName().c_str());
+      if(size > updatedDocumentSize)
+      {
+         updatedDocument = baseDocument;
+         updatedDocumentSize = size;
+      }
+   }
+
+   if(updatedDocument)
+      _overlayDocument->saveAsUpdateOf(outDocumentName, updatedDocument);
+   else
+      _overlayDocument->saveAs(outDocumentName);
+}
@@ -33,6 +33,7 @@
 #include "Document.h"
 #include "Parser.h"
 #include <map>
+#include <set>
 
 // structure defines parameter of merge
 
@@ -54,11 +55,17 @@ namespace merge_lib
 
       void saveMergedDocumentsAs(const char *outDocumentName);
 
+      //the largest base document whose pages are all merged is copied as it is instead of being written
+      //object by object, a document with pages left out is never copied as their content would be shipped
+      void saveMergedDocumentsAsUpdate(const char *outDocumentName);
+
       void merge(const char *overlayDocName, const MergeDescription & pagesToMerge);
 
    private:
       std::map<std::string, Document * > _baseDocuments;
-      static Parser _parser;
+      //numbers of the pages of each base document that are merged into the overlay
+      std::map<std::string, std::set<unsigned int> > _mergedBasePages;
+      Parser _parser;
       Document * _overlayDocument;
    };
 }
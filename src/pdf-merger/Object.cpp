@@ -64,7 +64,11 @@ Object * Object::_getClone(std::map<unsigned int, Object *> & clones)
 {
    _isPassed = true;
    unsigned int objectNumber = this->getObjectNumber();   
-   Object * clone = new Object(objectNumber, this->_generationNumber, this->getObjectContent(), _fileName, _streamBounds, _hasStream);
+   //a clone shares the mapped content until one of them is modified
+   Object * clone = _isContentMapped ?
+      new Object(objectNumber, this->_generationNumber, _mappedContent, _source, _streamBounds, _hasStream) :
+      new Object(objectNumber, this->_generationNumber, _content, _fileName, _streamBounds, _hasStream);
+   clone->_source = _source;
    clone->_hasStreamInContent = _hasStreamInContent;
    clones.insert(std::pair<unsigned int, Object *>(objectNumber, clone));
    Children::iterator currentChild = _children.begin();
@@ -219,9 +223,25 @@ unsigned int Object::getgenerationNumber() const
 
 std::string & Object::getObjectContent()
 {
+   _detachContent();
    return _content;
 }
 
+std::string_view Object::getObjectContentView() const
+{
+   return _isContentMapped ? _mappedContent : std::string_view(_content);
+}
+
+void Object::_detachContent()
+{
+   if(_isContentMapped)
+   {
+      _content.assign(_mappedContent.data(), _mappedContent.size());
+      _mappedContent = std::string_view();
+      _isContentMapped = false;
+   }
+}
+
 void Object::_setObjectNumber(unsigned int objectNumber)
 {
    if(!isPassed())
@@ -234,16 +254,20 @@ void Object::_setObjectNumber(unsigned int objectNumber)
 
 void Object::setObjectContent(const std::string & objectContent)
 {
+   _mappedContent = std::string_view();
+   _isContentMapped = false;
    _content = objectContent;
 }
 
 void Object::appendContent(const std::string & addToContent)
 {
+   _detachContent();
    _content.append(addToContent);
 }
 
 void Object::eraseContent(unsigned int from, unsigned int size)
 {
+   _detachContent();
    int iSize = size;
    _recalculateReferencePositions(from + size, -iSize);
    _content.erase(from, size);
@@ -251,12 +275,14 @@ void Object::eraseContent(unsigned int from, unsigned int size)
 
 void Object::insertToContent(unsigned int position, const std::string & insertedStr)
 {
+   _detachContent();
    _recalculateReferencePositions(position, insertedStr.size());
    _content.insert(position, insertedStr);
 }
 
 void Object::insertToContent(unsigned int position, const char * insertedStr, unsigned int length)
 {    
+   _detachContent();
    _recalculateReferencePositions(position, length);
    _content.insert(position, insertedStr, length);    
 }
@@ -274,7 +300,7 @@ void Object::serialize(std::ofstream & out, std::map< unsigned int, std::pair<un
       stream.append("endstream\n");       
    }
    // xxxx + " " + "0" + " " + "obj" + "\n" + _content.size() + "endobj\n", where x - is a digit
-   unsigned long long objectSizeForXref = (static_cast<unsigned int>(std::log10(static_cast<double>(_number))) + 1) + 14 + _content.size() + stream.size();    
+   unsigned long long objectSizeForXref = (static_cast<unsigned int>(std::log10(static_cast<double>(_number))) + 1) + 14 + getObjectContentView().size() + stream.size();    
 
    sizesAndGenerationNumbers.insert(std::pair<unsigned int, std::pair<unsigned long long, unsigned int > >(_number, std::make_pair(objectSizeForXref, _generationNumber)));
 
@@ -290,22 +316,63 @@ void Object::serialize(std::ofstream & out, std::map< unsigned int, std::pair<un
       currentChild->serialize(out, sizesAndGenerationNumbers);
    }
 }
+void Object::serializeUpdate(std::ofstream & out, const std::set<Object *> & updatedFileObjects, std::set<Object *> & passedObjects,
+                             std::map< unsigned int, std::pair<unsigned long long, unsigned int > > & offsetsAndGenerationNumbers)
+{
+   if(!passedObjects.insert(this).second) return;
+
+   //an unmodified object of the updated file is already written, but its children may not be
+   if(!(isUnmodified() && updatedFileObjects.count(this)))
+   {
+      std::string stream;
+      if(_hasStream && !_hasStreamInContent)
+      {       
+         getStream(stream);
+         stream.append("endstream\n");       
+      }
+      offsetsAndGenerationNumbers[_number] = std::make_pair((unsigned long long)out.tellp(), _generationNumber);
+      serialize(out, stream);
+   }
+
+   Children::iterator it;
+   for ( it=_children.begin() ; it != _children.end(); it++ )
+   {
+      (*it).second.first->serializeUpdate(out, updatedFileObjects, passedObjects, offsetsAndGenerationNumbers);
+   }
+}
+
 void Object::recalculateObjectNumbers(unsigned int & newNumber)
 {    
    _recalculateObjectNumbers(newNumber);
    resetIsPassed();
 }
 
-void Object::_recalculateObjectNumbers(unsigned int & newNumber)
+void Object::recalculateObjectNumbers(unsigned int & newNumber, const std::set<Object *> & keptNumbers)
 {    
-   _setObjectNumber(newNumber);
+   _recalculateObjectNumbers(newNumber, &keptNumbers);
+   resetIsPassed();
+}
+
+void Object::_recalculateObjectNumbers(unsigned int & newNumber, const std::set<Object *> * keptNumbers)
+{    
+   if(keptNumbers && keptNumbers->count(this))
+   {
+      _isPassed = true;
+      _oldNumber = _number;
+   }
+   else
+      _setObjectNumber(newNumber);
 
    Children::iterator childIterator;
    for ( childIterator = _children.begin() ; childIterator != _children.end(); ++childIterator )
    {
       Object * currentChild = (*childIterator).second.first;
       if(currentChild->isPassed()) continue;                
-      currentChild->_recalculateObjectNumbers(++newNumber);        
+      //a kept number does not use up newNumber
+      if(keptNumbers && keptNumbers->count(currentChild))
+         currentChild->_recalculateObjectNumbers(newNumber, keptNumbers);
+      else
+         currentChild->_recalculateObjectNumbers(++newNumber, keptNumbers);
    }
 
    //recalculate referencies in content
@@ -316,6 +383,10 @@ void Object::_recalculateObjectNumbers(unsigned int & newNumber)
       const ReferencePositionsInContent & refPositionForcurrentChild = (*childIterator).second.second;
       const std::string & oldNumberStr = Utils::uIntToStr(currentChild->getOldNumber());
       const std::string & newNumber = Utils::uIntToStr(currentChild->getObjectNumber());
+      //the content stays in the mapped file when no reference changes
+      if(newNumber == oldNumberStr)
+         continue;
+      _detachContent();
       const unsigned int newNumberStringSize = newNumber.size();
       const unsigned int oldNumberStringSize = oldNumberStr.size();
       unsigned int diff = newNumberStringSize;
@@ -383,7 +454,7 @@ void Object::_retrieveMaxObjectNumber(unsigned int & maxNumber)
 bool Object::_findObject(const std::string & token, Object* & foundObject, unsigned int & tokenPositionInContent)
 {
    _isPassed = true;
-   tokenPositionInContent = Parser::findToken(_content,token);
+   tokenPositionInContent = Parser::findToken(getObjectContentView(),token);
    if((int)tokenPositionInContent != -1)
    {
       foundObject = this;
@@ -431,7 +502,7 @@ void Object::_addParent(Object * child)
 }
 void Object::serialize(std::ofstream  & out, const std::string & stream)
 {
-    out << _number << " " << _generationNumber << " obj\n" << _content << stream << "endobj\n";
+    out << _number << " " << _generationNumber << " obj\n" << getObjectContentView() << stream << "endobj\n";
    out.flush();
 }
 
@@ -451,6 +522,17 @@ bool Object::getStream(std::string & stream)
          return false;
    }
 
+   if(_source)
+   {
+      std::string_view fileContent = _source->getContent();
+      if(_streamBounds.first > _streamBounds.second || _streamBounds.second > fileContent.size())
+      {
+         throw Exception("Stream of object is out of file bounds");
+      }
+      stream.assign(fileContent.data() + _streamBounds.first, _streamBounds.second - _streamBounds.first);
+      return true;
+   }
+
    std::ifstream pdfFile;
    pdfFile.open (_fileName.c_str(), std::ios::binary );
    if (pdfFile.fail())
@@ -470,28 +552,29 @@ bool Object::getStream(std::string & stream)
 
 bool Object::_getStreamFromContent(std::string & stream)
 {
-   size_t stream_begin = _content.find("stream");
+   std::string_view content = getObjectContentView();
+   size_t stream_begin = content.find("stream");
    if((int) stream_begin == -1 )
    {
       return false;
    }
-   size_t stream_end = _content.find("endstream",stream_begin);
+   size_t stream_end = content.find("endstream",stream_begin);
    if((int) stream_end == -1 )
    {
       return false;
    }
    stream_begin += strlen("stream");
    // need to skip trailing \r
-   while(_content[stream_begin] == '\r')
+   while(content[stream_begin] == '\r')
    {
       stream_begin ++;
    }
-   if( _content[stream_begin] == '\n')
+   if( content[stream_begin] == '\n')
    {
       stream_begin ++;
    }
 
-   stream = _content.substr(stream_begin, stream_end - stream_begin);
+   stream.assign(content.substr(stream_begin, stream_end - stream_begin));
    return true;
 }
 
@@ -502,13 +585,14 @@ bool Object::_getStreamFromContent(std::string & stream)
 */
 bool Object::getHeader(std::string &content)
 {
+   std::string_view objectContent = getObjectContentView();
    if( !hasStream() )
    {
-      content = _content;
+      content.assign(objectContent);
       return true;
    }
-   size_t stream_begin = _content.find("stream");
-   content = _content.substr(0,stream_begin);
+   size_t stream_begin = objectContent.find("stream");
+   content.assign(objectContent.substr(0,stream_begin));
    return true;
 }
 
@@ -548,7 +632,7 @@ std::string Object::getNameSimpleValue(const std::string &content, const std::st
                Object *child = getChild(number);
                if( child )
                {
-                  value = child->getObjectContent();
+                  value.assign(child->getObjectContentView());
                   Parser::trim(value);                  
                }
                else
@@ -572,7 +656,7 @@ std::string Object::getNameSimpleValue(const std::string &content, const std::st
 
 Object* Object::findPatternInObjOrParents(const std::string &pattern)
 {
-   std::string content=getObjectContent();
+   std::string content(getObjectContentView());
    if((int) Parser::findToken(content,pattern,0) != -1 )
    {
       return this;
@@ -594,7 +678,7 @@ Object* Object::findPatternInObjOrParents(const std::string &pattern)
          break;
       }
       parent = parents[0];
-      std::string parentContent = parent->getObjectContent();
+      std::string parentContent(parent->getObjectContentView());
       unsigned int startOfPattern = parentContent.find(pattern);
       if((int)startOfPattern == -1)
       {
@@ -31,9 +31,12 @@
 #define Object_h
 
 #include "Utils.h"
+#include "MappedFile.h"
 
 #include <cmath>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <map>
 #include <set>
@@ -52,6 +55,8 @@ namespace merge_lib
     //Each reference (child object) should be kept with it position(s) in object's content.
     //After each content modification, all references should be changed too.
     //This convention lighten the recalculation object numbers work.
+    //Objects read from a file refer to their content in the mapped file,
+    //it is copied the first time the content is modified.
     class Object
     {
     public:
@@ -63,7 +68,15 @@ namespace merge_lib
            std::string fileName = "", std::pair<unsigned int, unsigned int> streamBounds = std::make_pair ((unsigned int)0,(unsigned int)0), bool hasStream = false
                   ):
        _number(objectNumber), _generationNumber(generationNumber), _oldNumber(objectNumber), _content(objectContent),_parents(),_children(),_isPassed(false),
-           _streamBounds(streamBounds), _fileName(fileName), _hasStream(hasStream), _hasStreamInContent(false)
+           _streamBounds(streamBounds), _fileName(fileName), _hasStream(hasStream), _hasStreamInContent(false), _source(), _mappedContent(), _isContentMapped(false)
+       {
+       }
+       //objectContent is a range of the source content
+       Object(unsigned int objectNumber, unsigned int generationNumber, std::string_view objectContent, 
+           const std::shared_ptr<MappedFile> & source, std::pair<unsigned int, unsigned int> streamBounds, bool hasStream
+                  ):
+       _number(objectNumber), _generationNumber(generationNumber), _oldNumber(objectNumber), _content(),_parents(),_children(),_isPassed(false),
+           _streamBounds(streamBounds), _fileName(), _hasStream(hasStream), _hasStreamInContent(false), _source(source), _mappedContent(objectContent), _isContentMapped(true)
        {
        }
        virtual ~Object();
@@ -85,7 +98,10 @@ namespace merge_lib
        unsigned int                getgenerationNumber() const;
 
 
+       //the content is copied out of the mapped file before it is returned
        std::string &               getObjectContent();
+       //read only access, it stays valid until the content is modified
+       std::string_view            getObjectContentView() const;
 
        void                        setObjectContent(const std::string & objectContent);
        void                        appendContent(const std::string & addToContent);
@@ -97,6 +113,19 @@ namespace merge_lib
        void serialize(std::ofstream & out, std::map< unsigned int, std::pair<unsigned long long, unsigned int > > & sizesAndGenerationNumbers);
 
        void recalculateObjectNumbers(unsigned int & newNumber);
+       //objects of keptNumbers keep their number, the others are numbered after newNumber
+       void recalculateObjectNumbers(unsigned int & newNumber, const std::set<Object *> & keptNumbers);
+
+       //writes the objects which are not already in the updated file, an incremental update of it
+       //the offset and generation number of each written object is returned
+       void serializeUpdate(std::ofstream & out, const std::set<Object *> & updatedFileObjects, std::set<Object *> & passedObjects,
+                            std::map< unsigned int, std::pair<unsigned long long, unsigned int > > & offsetsAndGenerationNumbers);
+
+       //true while the object is as it was read from its file
+       bool isUnmodified() const
+       {
+          return _isContentMapped && !_hasStreamInContent;
+       }
 
        bool isPassed()
        {
@@ -153,11 +182,12 @@ namespace merge_lib
        void _addParent(Object * child);
        bool _findObject(const std::string & token, Object* & foundObject, unsigned int & tokenPositionInContent);
        void serialize(std::ofstream  & out, const std::string & stream);
-       void _recalculateObjectNumbers(unsigned int & maxNumber);
+       void _recalculateObjectNumbers(unsigned int & maxNumber, const std::set<Object *> * keptNumbers = 0);
        void _recalculateReferencePositions(unsigned int changedReference, int displacement);
        void _retrieveMaxObjectNumber(unsigned int & maxNumber);
        void serialize(std::ofstream & out, std::map<unsigned int, unsigned long long> & sizes);
        bool _getStreamFromContent(std::string & stream);
+       void _detachContent();
 
        //members
        unsigned int                          _number;
@@ -171,6 +201,9 @@ namespace merge_lib
        std::string                           _fileName;
        bool                                  _hasStream;
        bool                                  _hasStreamInContent;
+       std::shared_ptr<MappedFile>           _source;
+       std::string_view                      _mappedContent;
+       bool                                  _isContentMapped;
 
     };
 }
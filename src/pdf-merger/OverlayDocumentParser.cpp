@@ -56,7 +56,7 @@ void OverlayDocumentParser::_readXRefAndCreateObjects()
    std::map<unsigned int, unsigned long> objectsAndSizes;
    std::map<unsigned int, unsigned long>::iterator objAndSIter;
    std::map<unsigned int, unsigned long>::iterator objAndPIter;
-   unsigned long fileSize = Utils::getFileSize(_fileName.c_str());
+   unsigned long fileSize = _source->getContent().size();
 
    for(objAndSIter = objectsAndPositions.begin(); objAndSIter != objectsAndPositions.end(); ++objAndSIter)
    {
@@ -98,10 +98,10 @@ void OverlayDocumentParser::_readXRefAndCreateObjects()
             unsigned int objectNumber;
             unsigned int generationNumber;
             bool hasObjectStream;
-            const std::string content = _getObjectContent(objIter->second - partStart, objectNumber, generationNumber, streamBounds, hasObjectStream);
+            std::string_view content = _getObjectContent(objIter->second - partStart, objectNumber, generationNumber, streamBounds, hasObjectStream);
             streamBounds.first += partStart;
             streamBounds.second += partStart;
-            Object * newObject = new Object(objectNumber, generationNumber, content, _document->_documentName ,streamBounds, hasObjectStream);
+            Object * newObject = new Object(objectNumber, generationNumber, content, _source, streamBounds, hasObjectStream);
             _objects[objectNumber] = newObject;
             std::map<unsigned int, unsigned long>::iterator temp = objIter;                   
             ++objIter;
@@ -117,28 +117,21 @@ void OverlayDocumentParser::_readXRefAndCreateObjects()
 
 void OverlayDocumentParser::_getFileContent(const char * fileName)
 {
-    Q_UNUSED(fileName);
+   // the file is only mapped here, the parts are selected by _getPartOfFileContent
+   _source = std::make_shared<MappedFile>(fileName);
 }
 
 void OverlayDocumentParser::_getPartOfFileContent(long startOfPart, unsigned int length)
 {
-   ifstream pdfFile;
-   pdfFile.open (_fileName.c_str(), ios::binary );
-   if (pdfFile.fail())
+   if(!_source)
    {
-      stringstream errorMessage("File ");
-      errorMessage << _fileName << " is absent" << "\0";
-      throw Exception(errorMessage);
-   }   
-   ios_base::seekdir dir;
-   if(startOfPart >= 0)
-      dir = ios_base::beg;
-   else 
-      dir = ios_base::end;
-   pdfFile.seekg (startOfPart, dir);
-   _fileContent.resize(length);
-   pdfFile.read(&_fileContent[0], length);
-   pdfFile.close();
+      _getFileContent(_fileName.c_str());
+   }
+   std::string_view fileContent = _source->getContent();
+   // a negative start is counted from the end of file
+   if(startOfPart < 0)
+      startOfPart = qMax<long>(0, fileContent.size() + startOfPart);
+   _fileContent = fileContent.substr(qMin<size_t>(startOfPart, fileContent.size()), length);
 }
 
 void OverlayDocumentParser::_readXref(std::map<unsigned int, unsigned long> & objectsAndSizes)
@@ -147,21 +140,21 @@ void OverlayDocumentParser::_readXref(std::map<unsigned int, unsigned long> & ob
    unsigned int startOfStartxref = _fileContent.find("startxref");
    unsigned int startOfNumber = _fileContent.find_first_of(Parser::NUMBERS, startOfStartxref);
    unsigned int endOfNumber = _fileContent.find_first_not_of(Parser::NUMBERS, startOfNumber + 1);
-   std::string startXref = _fileContent.substr(startOfNumber, endOfNumber - startOfNumber);
+   std::string startXref(_fileContent.substr(startOfNumber, endOfNumber - startOfNumber));
    unsigned int strtXref = Utils::stringToInt(startXref);
 
-   unsigned int sizeOfXref = Utils::getFileSize(_fileName.c_str()) - strtXref;
+   unsigned int sizeOfXref = _source->getContent().size() - strtXref;
    _getPartOfFileContent(strtXref, sizeOfXref);
    unsigned int leftBoundOfObjectNumber = _fileContent.find("0 ") + strlen("0 ");
    unsigned int rightBoundOfObjectNumber = _fileContent.find_first_not_of(Parser::NUMBERS, leftBoundOfObjectNumber);
-   std::string objectNuberStr = _fileContent.substr(leftBoundOfObjectNumber, rightBoundOfObjectNumber - leftBoundOfObjectNumber);
+   std::string objectNuberStr(_fileContent.substr(leftBoundOfObjectNumber, rightBoundOfObjectNumber - leftBoundOfObjectNumber));
    unsigned long objectNumber = Utils::stringToInt(objectNuberStr);
    unsigned int startOfObjectPosition = _fileContent.find("0000000000 65535 f ") + strlen("0000000000 65535 f ");
    for(unsigned long i = 1; i < objectNumber; ++i)
    {
       startOfObjectPosition = _fileContent.find_first_of(Parser::NUMBERS, startOfObjectPosition);
       unsigned int endOfObjectPostion = _fileContent.find(" 00000 n", startOfObjectPosition);
-      std::string objectPostionStr = _fileContent.substr(startOfObjectPosition, endOfObjectPostion - startOfObjectPosition);
+      std::string objectPostionStr(_fileContent.substr(startOfObjectPosition, endOfObjectPostion - startOfObjectPosition));
       objectsAndSizes[i] = Utils::stringToInt(objectPostionStr);
       startOfObjectPosition = endOfObjectPostion + strlen(" 00000 n");
    }
@@ -178,3 +171,8 @@ unsigned int OverlayDocumentParser::_getStartOfXrefWithRoot()
    return 0;
 }
 
+void OverlayDocumentParser::_readUpdateInformation()
+{
+   // the overlay document is never updated, it is saved whole
+}
+
@@ -58,6 +58,7 @@ namespace merge_lib
       void         _readXref(std::map<unsigned int, unsigned long> & objectsAndSizes);
       void         _getPartOfFileContent(long startOfPart, unsigned int length);
       unsigned int _getStartOfXrefWithRoot();
+      void         _readUpdateInformation();
       //constants
       static int DOC_PART_WITH_START_OF_XREF;
 
@@ -187,9 +187,7 @@ void _recalculateAnnotsCoordinates(Object * annotation,
    Object * objectWithRectangle;
    unsigned int fake;
    annotation->findObject(annotsRectangleName, objectWithRectangle, fake);
-   std::string annotContent = objectWithRectangle->getObjectContent();
-
-   Rectangle annotsRectangle(annotsRectangleName.c_str(), annotContent);
+   Rectangle annotsRectangle(annotsRectangleName.c_str(), objectWithRectangle->getObjectContentView());
 
    //we move annotation from base page to output page
    //that's way annotation should be scaled before all transformations.
@@ -339,7 +337,7 @@ static void processBasePageResources(Object *basePage)
       return;
    }
    std::string resourceToken = "/Resources";
-   if((int) Parser::findTokenName(basePage->getObjectContent(),resourceToken) == -1 )
+   if((int) Parser::findTokenName(basePage->getObjectContentView(),resourceToken) == -1 )
    {
       // it seems base page does not have resources, they can be located in parent!
       Object *resource = basePage->findPatternInObjOrParents(resourceToken);
@@ -359,7 +357,7 @@ static void processBasePageResources(Object *basePage)
          }
          std::string resourceContent = resContStr.substr(startOfRes,endOfRes-startOfRes);
 
-         size_t positionToInsert = basePage->getObjectContent().find("<<");
+         size_t positionToInsert = basePage->getObjectContentView().find("<<");
          if((int) positionToInsert == -1 )
          {
             positionToInsert = 0;
@@ -449,7 +447,7 @@ std::string Page::_getMergedPageContent(  unsigned int & contentPosition,
    content.append("/Annots [ ");
    if(!description.skipBasePage)
    {
-      Rectangle basePageRectangle("/BBox", basePage->getObjectContent());
+      Rectangle basePageRectangle("/BBox", basePage->getObjectContentView());
       for(size_t i = 0; i < annots.size(); ++i)
       {
          _updateAnnotFormColor(annots[i]);
@@ -479,7 +477,7 @@ void Page::merge(Page * sourcePage, Document * parentDocument, MergePageDescript
    {
       // Lets recalculate final transformation of overlay page
       // before it will be places into XObject
-      Rectangle mediaBox("/MediaBox",_root->getObjectContent());
+      Rectangle mediaBox("/MediaBox",_root->getObjectContentView());
       description.overlayPageTransformation.recalculateTranslation(mediaBox.getWidth(),mediaBox.getHeight());
 
       std::vector<Object *> fake;
@@ -495,14 +493,14 @@ void Page::merge(Page * sourcePage, Document * parentDocument, MergePageDescript
       rotationHandler.processObjectContent();
       description.basePageTransformation.addRotation(_rotation);
 
-      if((int) sourcePage->_root->getObjectContent().find("/Annots") != -1 )
+      if((int) sourcePage->_root->getObjectContentView().find("/Annots") != -1 )
       {
          Object *crop = sourcePage->_root->findPatternInObjOrParents("/CropBox");
          if( crop )
          {
             // we need to calculate special compensational shifting
             // for annotations if cropbox is starting not from 0,0
-            Rectangle mediaBox("/CropBox", crop->getObjectContent());
+            Rectangle mediaBox("/CropBox", crop->getObjectContentView());
             if( !Utils::doubleEquals(mediaBox.x1,0) || !Utils::doubleEquals(mediaBox.y1,0) )
             {
                double shiftX = Utils::doubleEquals(mediaBox.x1,0)?0:-mediaBox.x1;
@@ -514,7 +512,7 @@ void Page::merge(Page * sourcePage, Document * parentDocument, MergePageDescript
       }
       processBasePageResources(sourcePage->_root);
       sourcePageToXObject = sourcePage->pageToXObject(toAllObjects, annotations, isPageDuplicated);
-      Rectangle mediaBox("/BBox", sourcePageToXObject->getObjectContent());
+      Rectangle mediaBox("/BBox", sourcePageToXObject->getObjectContentView());
       description.basePageTransformation.recalculateTranslation(mediaBox.getWidth(),mediaBox.getHeight());      
    }
 
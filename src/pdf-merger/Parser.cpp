@@ -69,7 +69,7 @@ Document * Parser::parseDocument(const char * fileName)
 
 void Parser::_retrieveAllPages(Object * objectWithKids)
 {
-   std::string & objectContent = objectWithKids->getObjectContent();
+   std::string_view objectContent = objectWithKids->getObjectContentView();
    unsigned int startOfKids = objectContent.find("/Kids");
    unsigned int endOfKids = objectContent.find("]", startOfKids);
    if(
@@ -95,7 +95,7 @@ void Parser::_createDocument(const char * docName)
 {
     Q_UNUSED(docName);
    _document->_root = _root;
-   std::string & rootContent = _root->getObjectContent();
+   std::string_view rootContent = _root->getObjectContentView();
    unsigned int startOfPages = rootContent.find("/Pages");
    if((int)startOfPages == -1)
       throw Exception("Some document is wrong");
@@ -112,28 +112,17 @@ void Parser::_createDocument(const char * docName)
 void Parser::_clearParser()
 {
    _root = 0;
-   _fileContent.clear();
-   _fileContent.reserve();
+   _fileContent = std::string_view();
+   _source.reset();
    _objects.clear();
+   _references.clear();
 }
 
 
 void Parser::_getFileContent(const char * fileName)
 {
-   ifstream pdfFile;
-   pdfFile.open (fileName, ios::binary );
-   if (pdfFile.fail())
-   {
-      stringstream errorMessage("File ");
-      errorMessage << fileName << " is absent" << "\0";
-      throw Exception(errorMessage);
-   }
-   // get length of file:
-   pdfFile.seekg (0, ios::end);
-   int length = pdfFile.tellg();
-   pdfFile.seekg (0, ios::beg);
-   _fileContent.resize(length);
-   pdfFile.read(&_fileContent[0], length);
+   _source = std::make_shared<MappedFile>(fileName);
+   _fileContent = _source->getContent();
 
    // check version
    const char *header = "%PDF-1.";
@@ -160,7 +149,6 @@ void Parser::_getFileContent(const char * fileName)
    {
       throw Exception("Unrecognized header of PDF file");
    }
-   pdfFile.close();
 }
 
 
@@ -172,6 +160,7 @@ void Parser::_createObjectTree(const char * fileName)
       _getFileContent(fileName);
       _readXRefAndCreateObjects();
       rootObjectNumber = _readTrailerAndReturnRoot();
+      _readUpdateInformation();
    }
    catch (std::exception &)
    {
@@ -192,7 +181,7 @@ void Parser::_createObjectTree(const char * fileName)
       _document->_allObjects.push_back(currentObject);
       //key - object number :  value - positions in object content of this reference
       const std::map<unsigned int, Object::ReferencePositionsInContent> & refs = 
-         _getReferences(currentObject->getObjectContent());      
+         _getReferences(currentObject->getObjectContentView());      
       std::map<unsigned int, Object::ReferencePositionsInContent>::const_iterator refsIterator = refs.begin();
       for(; refsIterator !=  refs.end(); ++refsIterator)
       {        
@@ -204,10 +193,10 @@ void Parser::_createObjectTree(const char * fileName)
 
 }
 
-const std::map<unsigned int, Object::ReferencePositionsInContent> & Parser::_getReferences(const std::string & objectContent)
+const std::map<unsigned int, Object::ReferencePositionsInContent> & Parser::_getReferences(std::string_view objectContent)
 {
    unsigned int currentPosition(0), startOfNextSearch(0);
-   static std::map<unsigned int, std::vector<unsigned int> >  searchResult;
+   std::map<unsigned int, Object::ReferencePositionsInContent> & searchResult = _references;
    searchResult.clear();
    unsigned int streamStart = objectContent.find("stream");
    if((int)streamStart == -1)
@@ -221,8 +210,9 @@ const std::map<unsigned int, Object::ReferencePositionsInContent> & Parser::_get
       {         
          //check that next character of " R" is WHITESPACE. 
 
-         if(((int)WHITESPACES.find(objectContent[currentPosition + 2]) == -1) &&
-            ((int)DELIMETERS.find(objectContent[currentPosition + 2]) == -1)
+         if((currentPosition + 2 >= objectContent.size()) ||
+            (((int)WHITESPACES.find(objectContent[currentPosition + 2]) == -1) &&
+            ((int)DELIMETERS.find(objectContent[currentPosition + 2]) == -1))
             )
          {
             //this is not reference. this is something looks like "0 0 0 RG"
@@ -263,7 +253,7 @@ const std::map<unsigned int, Object::ReferencePositionsInContent> & Parser::_get
             ++startOfNextSearch;
             continue;
          }
-         unsigned int objectNumber = Utils::stringToInt(objectContent.substr(numberSearchCounter + 1, currentPosition - numberSearchCounter));
+         unsigned int objectNumber = Utils::stringToInt(std::string(objectContent.substr(numberSearchCounter + 1, currentPosition - numberSearchCounter)));
 
          searchResult[objectNumber].push_back(numberSearchCounter + 1);
 
@@ -277,7 +267,7 @@ const std::map<unsigned int, Object::ReferencePositionsInContent> & Parser::_get
    return searchResult;
 }
 
-unsigned int Parser::_skipNumber(const std::string & str, unsigned int currentPosition)
+unsigned int Parser::_skipNumber(std::string_view str, unsigned int currentPosition)
 {
    unsigned int numberSearchCounter = currentPosition;    
    while(((int)NUMBERS.find(str[numberSearchCounter]) != -1) && --numberSearchCounter)
@@ -324,10 +314,10 @@ void Parser::_readXRefAndCreateObjects()
                      std::pair<unsigned int, unsigned int> streamBounds;
                      bool hasObjectStream;
                      unsigned int generationNumber;
-                     const std::string content = _getObjectContent(first, objectNumber, generationNumber, streamBounds, hasObjectStream);
+                     std::string_view content = _getObjectContent(first, objectNumber, generationNumber, streamBounds, hasObjectStream);
                      if(!_objects.count(objectNumber))
                      {
-                        Object * newObject = new Object(objectNumber, generationNumber, content, _document->_documentName ,streamBounds, hasObjectStream);
+                        Object * newObject = new Object(objectNumber, generationNumber, content, _source, streamBounds, hasObjectStream);
                         _objects[objectNumber] = newObject;
                      }
                   }
@@ -371,11 +361,55 @@ unsigned int Parser::_getStartOfXrefWithRoot()
 
    unsigned int rightBoundOfStartOfXref = _fileContent.find_first_not_of(NUMBERS, leftBoundOfStartOfXref + 1);
 
-   std::string  startOfXref = _fileContent.substr(leftBoundOfStartOfXref, rightBoundOfStartOfXref - leftBoundOfStartOfXref);
+   std::string  startOfXref(_fileContent.substr(leftBoundOfStartOfXref, rightBoundOfStartOfXref - leftBoundOfStartOfXref));
    int integerStartOfXref = Utils::stringToInt(startOfXref);
    return integerStartOfXref;
 }
 
+// Reads what an incremental update of the document needs from its last trailer.
+// The document stays not updatable when the trailer cannot be read.
+void Parser::_readUpdateInformation()
+{
+   unsigned int startOfXref = _getStartOfXrefWithRoot();
+   size_t startOfTrailer = Parser::findToken(_fileContent,"trailer", startOfXref);
+   size_t endOfTrailer = _fileContent.find("startxref", startOfTrailer);
+   if((int) startOfTrailer == -1 || (int) endOfTrailer == -1)
+      return;
+   std::string_view trailer = _fileContent.substr(startOfTrailer, endOfTrailer - startOfTrailer);
+
+   size_t startOfSize = Parser::findToken(trailer,"/Size");
+   if((int) startOfSize == -1)
+      return;
+   startOfSize = trailer.find_first_of(NUMBERS, startOfSize);
+   size_t endOfSize = trailer.find_first_not_of(NUMBERS, startOfSize);
+   if((int) startOfSize == -1 || (int) endOfSize == -1)
+      return;
+
+   std::string entries;
+   size_t startOfInfo = Parser::findToken(trailer,"/Info");
+   size_t endOfInfo = trailer.find("R", startOfInfo);
+   if((int) startOfInfo != -1 && (int) endOfInfo != -1)
+   {
+      entries.append(trailer.substr(startOfInfo, endOfInfo + 1 - startOfInfo));
+      entries.append("\n");
+   }
+   size_t startOfID = Parser::findToken(trailer,"/ID");
+   size_t endOfID = trailer.find("]", startOfID);
+   if((int) startOfID != -1 && (int) endOfID != -1)
+   {
+      entries.append(trailer.substr(startOfID, endOfID + 1 - startOfID));
+      entries.append("\n");
+   }
+
+   unsigned int trailerSize = Utils::stringToInt(std::string(trailer.substr(startOfSize, endOfSize - startOfSize)));
+   if(trailerSize == 0)
+      return;
+
+   _document->_startOfXref = startOfXref;
+   _document->_trailerSize = trailerSize;
+   _document->_trailerEntries = entries;
+}
+
 unsigned int Parser::_getEndOfLineFromContent(unsigned int fromPosition)
 {
    fromPosition = _skipWhiteSpacesFromContent(fromPosition);
@@ -385,9 +419,9 @@ unsigned int Parser::_getEndOfLineFromContent(unsigned int fromPosition)
 
 }
 
-const std::pair<unsigned int, unsigned int> & Parser::_getLineBounds(const std::string & str, unsigned int fromPosition)
+std::pair<unsigned int, unsigned int> Parser::_getLineBounds(const std::string & str, unsigned int fromPosition)
 {
-   static std::pair<unsigned int, unsigned int> bounds;
+   std::pair<unsigned int, unsigned int> bounds;
    bounds.first = str.rfind('\n', fromPosition);
    if((int)bounds.first == -1)
       bounds.first = 0;
@@ -397,17 +431,16 @@ const std::pair<unsigned int, unsigned int> & Parser::_getLineBounds(const std::
    return bounds;
 }
 
-const std::string & Parser::_getNextToken(unsigned int & fromPosition)
+std::string Parser::_getNextToken(unsigned int & fromPosition)
 {
    fromPosition = _skipWhiteSpacesFromContent(fromPosition);
    unsigned int position = _fileContent.find_first_of(WHITESPACES, fromPosition);
 
-   static std::string token;
+   std::string token;
    if(position > fromPosition)
    {        
       unsigned int tokenSize = position - fromPosition;
-      token.resize(tokenSize);
-      memcpy(&token[0], &_fileContent[fromPosition], tokenSize);
+      token.assign(_fileContent.substr(fromPosition, tokenSize));
       fromPosition = position;
       return token;
    }
@@ -415,7 +448,6 @@ const std::string & Parser::_getNextToken(unsigned int & fromPosition)
    {
       //TODO throw exception
    }
-   token = "";
    return token;
 }
 
@@ -446,13 +478,13 @@ unsigned int Parser::_skipWhiteSpaces(const std::string & str, unsigned int from
 unsigned int Parser::_skipWhiteSpacesFromContent(unsigned int fromPosition)
 {
    unsigned int position = fromPosition;
-   if((int)WHITESPACES.find(_fileContent[position]) != -1)
+   if(position < _fileContent.size() && (int)WHITESPACES.find(_fileContent[position]) != -1)
       position = _fileContent.find_first_not_of(WHITESPACES, position);// + 1;
 
    return position;
 }
 
-const std::string & Parser::_getObjectContent(unsigned int objectPosition, unsigned int & objectNumber, unsigned int & generationNumber, std::pair<unsigned int, unsigned int> & streamBounds, bool & hasObjectStream)
+std::string_view Parser::_getObjectContent(unsigned int objectPosition, unsigned int & objectNumber, unsigned int & generationNumber, std::pair<unsigned int, unsigned int> & streamBounds, bool & hasObjectStream)
 {
    hasObjectStream = false;
    unsigned int currentPosition = objectPosition;
@@ -472,8 +504,6 @@ const std::string & Parser::_getObjectContent(unsigned int objectPosition, unsig
       throw Exception(strOut.str());
    }
 
-   static std::string objectContent;
-
    size_t contentStart = _fileContent.find_first_not_of(Parser::WHITESPACES,currentPosition);
    if((int) contentStart == -1 )
    {
@@ -547,9 +577,7 @@ const std::string & Parser::_getObjectContent(unsigned int objectPosition, unsig
    }
    unsigned int contentSize = endOfContent - currentPosition;
 
-   objectContent.resize(contentSize);
-   memcpy(&objectContent[0], &_fileContent[currentPosition], contentSize);
-   return objectContent;
+   return _fileContent.substr(currentPosition, contentSize);
 
 }
 
@@ -573,7 +601,7 @@ unsigned int Parser::_readTrailerAndReturnRoot()
    while((int)NUMBERS.find(_fileContent[endOfRoot++]) != -1)
    {}
    --endOfRoot;
-   return Utils::stringToInt(_fileContent.substr(startOfRoot, endOfRoot - startOfRoot));   
+   return Utils::stringToInt(std::string(_fileContent.substr(startOfRoot, endOfRoot - startOfRoot)));   
 }
 
 unsigned int Parser::_readTrailerAndRterievePrev(const unsigned int startPositionForSearch, unsigned int & previosXref)
@@ -596,14 +624,14 @@ unsigned int Parser::_readTrailerAndRterievePrev(const unsigned int startPositio
    while((int)NUMBERS.find(_fileContent[endOfPrev++]) != -1)
    {}
    --endOfPrev;
-   previosXref = Utils::stringToInt(_fileContent.substr(startOfPrev, endOfPrev - startOfPrev));   
+   previosXref = Utils::stringToInt(std::string(_fileContent.substr(startOfPrev, endOfPrev - startOfPrev)));   
    return true;
 }
 
 //Method finds the token from current position from string
 // It uses PDF whitespaces and delimeters to recognize
 // Returned string without begin/end spaces
-std::string Parser::getNextToken(const std::string &str, unsigned int  &position)
+std::string Parser::getNextToken(std::string_view str, unsigned int  &position)
 {
    if( position >= str.size() )
    {
@@ -623,7 +651,7 @@ std::string Parser::getNextToken(const std::string &str, unsigned int  &position
    }
    position = end_pos;
 
-   std::string out = str.substr(beg_pos,end_pos - beg_pos);
+   std::string out(str.substr(beg_pos,end_pos - beg_pos));
    Parser::trim(out);
    return out;
 }
@@ -632,7 +660,7 @@ std::string Parser::getNextToken(const std::string &str, unsigned int  &position
 * method finds and returns next word from the string
 * For example: " 1 0 R \n" will return "1" , then "0" then "R"
 */
-bool Parser::getNextWord(std::string &out, const std::string &str, size_t &nextPosition, size_t  *found)
+bool Parser::getNextWord(std::string &out, std::string_view str, size_t &nextPosition, size_t  *found)
 {
    if( found )
    {
@@ -661,7 +689,7 @@ bool Parser::getNextWord(std::string &out, const std::string &str, size_t &nextP
       end_pos = str.size();
    }
    nextPosition = end_pos;
-   out = str.substr(beg_pos,end_pos - beg_pos);
+   out.assign(str.substr(beg_pos,end_pos - beg_pos));
    Parser::trim(out);
    if( out.empty() )
    {
@@ -710,7 +738,7 @@ std::string Parser::findTokenStr(const std::string &content, const std::string &
 // contains token but not euqal to it
 // Example: content "/Transparency/ ..." pattern "/Trans
 //          will return npos.
-size_t Parser::findToken(const std::string &content, const std::string &keyword,size_t start)
+size_t Parser::findToken(std::string_view content, const std::string &keyword,size_t start)
 {
    size_t cur_pos  = start;
    // lets find pattern first
@@ -749,7 +777,7 @@ size_t Parser::findToken(const std::string &content, const std::string &keyword,
 // /H /P /P 12 0 R
 // the tag /P can be a name (and a value also), while 12 cannot
 // start defines the position of token content
-bool Parser::tokenIsAName(const std::string &content, size_t start )
+bool Parser::tokenIsAName(std::string_view content, size_t start )
 {
    std::string openBraces = "<[({";
    bool found = false;
@@ -796,7 +824,7 @@ bool Parser::tokenIsAName(const std::string &content, size_t start )
 // For example, the string contains /H /P /P 12 0 R.
 // If search for /P then it will return position of /P 12 0 R, not value of 
 // /H /P
-size_t Parser::findTokenName(const std::string &content, const std::string &keyword,size_t start)
+size_t Parser::findTokenName(std::string_view content, const std::string &keyword,size_t start)
 {
    size_t cur_pos  = start;
    // lets find pattern first
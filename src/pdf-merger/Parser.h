@@ -33,8 +33,12 @@
 #include "Object.h"
 #include "Document.h"
 #include "Page.h"
+#include "MappedFile.h"
 
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -44,10 +48,12 @@ namespace merge_lib
 
    //This class parsed the pdf document and creates
    //an Document object
+   //The file is mapped into memory, the objects refer to it until they are modified.
+   //A parser keeps no static state, so separate parsers can run concurrently.
    class Parser
    {
    public:   
-      Parser(): _root(0), _fileContent(), _objects(), _document(0)  {};
+      Parser(): _root(0), _source(), _fileContent(), _objects(), _document(0), _references()  {};
       Document * parseDocument(const char * fileName);
 
       static const std::string WHITESPACES;
@@ -55,17 +61,17 @@ namespace merge_lib
       static const std::string NUMBERS;
       static const std::string WHITESPACES_AND_DELIMETERS;
 
-      static bool getNextWord(std::string & out, const std::string &in, size_t &nextPosition,size_t *found = NULL);
-      static std::string getNextToken( const std::string &in, unsigned &position);
+      static bool getNextWord(std::string & out, std::string_view in, size_t &nextPosition,size_t *found = NULL);
+      static std::string getNextToken( std::string_view in, unsigned &position);
       static void trim(std::string &str);
       static std::string findTokenStr(const std::string &content, const std::string &pattern, size_t start,size_t &foundStart, size_t &foundEnd); 
 
-      static size_t findToken(const std::string &content, const std::string &keyword,size_t start = 0);
-      static size_t findTokenName(const std::string &content, const std::string &keyword,size_t start = 0);
+      static size_t findToken(std::string_view content, const std::string &keyword,size_t start = 0);
+      static size_t findTokenName(std::string_view content, const std::string &keyword,size_t start = 0);
       static unsigned int findEndOfElementContent(const std::string &content, unsigned int startOfPageElement);
-      static bool tokenIsAName(const std::string &content, size_t start );
+      static bool tokenIsAName(std::string_view content, size_t start );
    protected:
-      const std::string &                           _getObjectContent(unsigned int objectPosition, unsigned int & objectNumber, unsigned int & generationNumber, std::pair<unsigned int, unsigned int> &, bool &);
+      std::string_view                              _getObjectContent(unsigned int objectPosition, unsigned int & objectNumber, unsigned int & generationNumber, std::pair<unsigned int, unsigned int> &, bool &);
       virtual unsigned int                          _readTrailerAndReturnRoot();
    private:
       //methods
@@ -77,16 +83,17 @@ namespace merge_lib
       void                                          _fillOutObjects();
       virtual void                                  _readXRefAndCreateObjects();
       unsigned int                                  _getEndOfLineFromContent(unsigned int fromPosition);
-      const std::pair<unsigned int, unsigned int> & _getLineBounds(const std::string & str, unsigned int fromPosition);
-      const std::string &                           _getNextToken(unsigned int & fromPosition);
+      std::pair<unsigned int, unsigned int>         _getLineBounds(const std::string & str, unsigned int fromPosition);
+      std::string                                   _getNextToken(unsigned int & fromPosition);
       unsigned int                                  _countTokens(unsigned int leftBound, unsigned int rightBount);
       unsigned int                                  _skipWhiteSpaces(const std::string & str);
       unsigned int                                  _skipWhiteSpacesFromContent(unsigned int fromPosition);
-      const std::map<unsigned int, Object::ReferencePositionsInContent> & _getReferences(const std::string & objectContent);
-      unsigned int                                  _skipNumber(const std::string & str, unsigned int currentPosition);      
+      const std::map<unsigned int, Object::ReferencePositionsInContent> & _getReferences(std::string_view objectContent);
+      unsigned int                                  _skipNumber(std::string_view str, unsigned int currentPosition);      
       unsigned int                                  _skipWhiteSpaces(const std::string & str, unsigned int fromPosition);
       void                                          _createDocument(const char * docName);      
       virtual unsigned int                          _getStartOfXrefWithRoot();
+      virtual void                                  _readUpdateInformation();
       unsigned int                                  _readTrailerAndRterievePrev(const unsigned int startPositionForSearch, unsigned int & previosXref);
       void                                          _clearParser();      
       
@@ -95,9 +102,13 @@ namespace merge_lib
 
       //members
       Object *                         _root;
-      std::string                      _fileContent;
+      std::shared_ptr<MappedFile>      _source;
+      //the part of the mapped file being parsed
+      std::string_view                 _fileContent;
       std::map<unsigned int, Object *> _objects;
       Document *                       _document;
+      //key - object number :  value - positions in object content of this reference
+      std::map<unsigned int, Object::ReferencePositionsInContent> _references;
       
    };
 }
@@ -48,7 +48,7 @@ _tm()
 
 {}
 
-Rectangle::Rectangle(const char * rectangleName, const std::string content): 
+Rectangle::Rectangle(const char * rectangleName, std::string_view content): 
 x1(0),
 y1(0),
 x2(0),
@@ -66,7 +66,7 @@ _rectangleName(rectangleName)
 
    if((int) beg != -1 && (int) end != -1 )
    {
-      std::string arr = content.substr(beg+1,end-beg-1);
+      std::string arr(content.substr(beg+1,end-beg-1));
       std::stringstream in;
       in<<arr;
       in>>x1>>y1>>x2>>y2;
@@ -115,14 +115,14 @@ void Rectangle::updateRectangle(Object * objectWithRectangle, const char * delim
    Object * foundObjectWithRectangle;
    unsigned int fake;
    objectWithRectangle->findObject(std::string(_rectangleName), foundObjectWithRectangle, fake);
-   std::string objectContent = foundObjectWithRectangle->getObjectContent();
+   std::string_view objectContent = foundObjectWithRectangle->getObjectContentView();
    unsigned int rectanglePosition = objectContent.find(_rectangleName);
    unsigned int endOfRectangle = objectContent.find("]", rectanglePosition) + 1;
    foundObjectWithRectangle->eraseContent(rectanglePosition, endOfRectangle - rectanglePosition);
    foundObjectWithRectangle->insertToContent(rectanglePosition, _getRectangleAsString(delimeter));
 
    // reread the objectContent, since it was changed just above;
-   objectContent = foundObjectWithRectangle->getObjectContent();
+   objectContent = foundObjectWithRectangle->getObjectContentView();
 
    //update matrix
    unsigned int startOfAP = Parser::findToken(objectContent,"/AP");
@@ -132,7 +132,7 @@ void Rectangle::updateRectangle(Object * objectWithRectangle, const char * delim
    {
       Object * objectWithMatrix = aps[i];
 
-      std::string objectContent = objectWithMatrix->getObjectContent();      
+      std::string_view objectContent = objectWithMatrix->getObjectContentView();      
       unsigned int matrixPosition = Parser::findToken(objectContent,"/Matrix");
       if((int)matrixPosition == -1)
          continue;
@@ -32,6 +32,7 @@
 
 #include "Transformation.h"
 
+#include <string_view>
 #include <vector>
 #include <map>
 
@@ -45,7 +46,7 @@ namespace merge_lib
    public:
       Rectangle(const char * rectangleName);
 
-      Rectangle(const char * rectangleName, const std::string content);
+      Rectangle(const char * rectangleName, std::string_view content);
       void appendRectangleToString(std::string & content, const char * delimeter);
       void updateRectangle(Object * objectWithRectangle, const char * delimeter);
       void setNewRectangleName(const char * newName);
@@ -55,7 +55,7 @@ namespace merge_lib
       virtual void _processObjectContent(unsigned int startOfPageElement)
       {
          unsigned int endOfElement = _findEndOfElementContent(startOfPageElement);
-         std::string rotationField = _page->getObjectContent().substr(startOfPageElement, endOfElement - startOfPageElement);
+         std::string rotationField(_page->getObjectContentView().substr(startOfPageElement, endOfElement - startOfPageElement));
          std::string numbers("1234567890");
          unsigned int startOfNumber = rotationField.find_first_of(numbers);
          if( startOfNumber > 0 )
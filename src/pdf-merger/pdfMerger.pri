@@ -15,6 +15,7 @@ HEADERS += \
 	src/pdf-merger/FlateDecode.h \
 	src/pdf-merger/JBIG2Decode.h \
 	src/pdf-merger/LZWDecode.h \
+	src/pdf-merger/MappedFile.h \
 	src/pdf-merger/MediaBoxElementHandler.h \
 	src/pdf-merger/MergePageDescription.h \
 	src/pdf-merger/Merger.h \
@@ -44,6 +45,7 @@ SOURCES += \
 	src/pdf-merger/FilterPredictor.cpp \
 	src/pdf-merger/FlateDecode.cpp \
 	src/pdf-merger/LZWDecode.cpp \
+	src/pdf-merger/MappedFile.cpp \
 	src/pdf-merger/Merger.cpp \
 	src/pdf-merger/Object.cpp \
 	src/pdf-merger/Page.cpp \
@@ -42,6 +42,8 @@ GraphicsPDFItem::GraphicsPDFItem(PDFRenderer *renderer, int pageNumber, QGraphic
     , mIsCacheAllowed(true)
 {
     setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    // exposedRect is only filled in with this flag, the renderer requests the tiles it covers
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
     mRenderer->attach();
     connect(mRenderer, SIGNAL(signalUpdateParent()), this, SLOT(OnRequireUpdate()));
 }
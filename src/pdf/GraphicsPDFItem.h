@@ -51,6 +51,7 @@ class GraphicsPDFItem : public QObject, public QGraphicsItem
         int pageNumber() const { return mPageNumber; }
         QUuid fileUuid() const { return mRenderer->fileUuid(); }
         QByteArray fileData() const { return mRenderer->fileData(); }
+        qint64 cachedBytes() const { return mRenderer->cachedBytes(mPageNumber); }
         void setCacheAllowed(bool const value) { mIsCacheAllowed = value; }
         virtual void updateChild() = 0;
     protected:
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "PDFRasterCache.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QDebug>
+
+#include <algorithm>
+
+#include "core/memcheck.h"
+
+
+qint64 PDFRasterCache::sTotalBytes = -1;
+QMutex PDFRasterCache::sMutex;
+
+namespace PDFRasterCacheFiles
+{
+    const QString checksumFileName = "checksum";
+    const QString imageSuffix = ".png";
+}
+
+PDFRasterCache::PDFRasterCache(const QString &rootDirectory, qint64 budget, const QUuid &fileUuid, const QByteArray &fileData)
+    : mRootDirectory(rootDirectory)
+    , mBudget(budget)
+{
+    if (fileUuid.isNull() || fileData.isEmpty() || budget <= 0)
+        return;
+
+    QString directory = rootDirectory + "/" + fileUuid.toString();
+    QByteArray checksum = QCryptographicHash::hash(fileData, QCryptographicHash::Sha1).toHex();
+
+    QFile checksumFile(directory + "/" + PDFRasterCacheFiles::checksumFileName);
+    if (!checksumFile.open(QIODevice::ReadOnly) || checksumFile.readAll().trimmed() != checksum)
+    {
+        checksumFile.close();
+
+        // The rasters come from another content stored under the same uuid.
+        if (QDir(directory).exists())
+        {
+            QMutexLocker lock(&sMutex);
+            QDir(directory).removeRecursively();
+            sTotalBytes = -1;
+        }
+
+        if (!QDir().mkpath(directory) || !checksumFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            qWarning() << "cannot create the PDF raster cache in" << directory;
+            return;
+        }
+
+        checksumFile.write(checksum);
+        checksumFile.close();
+    }
+
+    mDirectory = directory;
+}
+
+QString PDFRasterCache::tileKey(int pageNumber, double dpi, int column, int row)
+{
+    return QString("%1-%2-%3-%4").arg(pageNumber).arg(qRound(dpi * 100)).arg(column).arg(row);
+}
+
+QString PDFRasterCache::filePath(const QString &key) const
+{
+    return mDirectory + "/" + key + PDFRasterCacheFiles::imageSuffix;
+}
+
+QImage PDFRasterCache::image(const QString &key) const
+{
+    QImage image;
+
+    if (!isValid())
+        return image;
+
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadWrite))
+        return image;
+
+    uchar *data = file.map(0, file.size());
+    if (data)
+    {
+        image.loadFromData(data, static_cast<int>(file.size()), "PNG");
+        file.unmap(data);
+    }
+
+    if (image.isNull())
+    {
+        // Truncated by a crash or a full disk.
+        file.remove();
+        return image;
+    }
+
+    // The modification time orders the files when trimming.
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    return image;
+}
+
+void PDFRasterCache::insert(const QString &key, const QImage &image)
+{
+    if (!isValid())
+        return;
+
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly) || !image.save(&file, "PNG") || !file.commit())
+        return;
+
+    addBytes(QFileInfo(filePath(key)).size());
+}
+
+void PDFRasterCache::addBytes(qint64 bytes) const
+{
+    QMutexLocker lock(&sMutex);
+
+    if (sTotalBytes < 0)
+    {
+        sTotalBytes = 0;
+
+        QDirIterator it(mRootDirectory, QStringList() << "*" + PDFRasterCacheFiles::imageSuffix, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+        {
+            it.next();
+            sTotalBytes += it.fileInfo().size();
+        }
+    }
+    else
+    {
+        sTotalBytes += bytes;
+    }
+
+    // Trimming scans the whole cache, leave some room before the next one.
+    if (sTotalBytes > mBudget)
+        trim(mBudget * 3 / 4);
+}
+
+void PDFRasterCache::trim(qint64 target) const
+{
+    QFileInfoList files;
+
+    QDirIterator it(mRootDirectory, QStringList() << "*" + PDFRasterCacheFiles::imageSuffix, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        files << it.fileInfo();
+    }
+
+    std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+
+    sTotalBytes = 0;
+    foreach (const QFileInfo &file, files)
+        sTotalBytes += file.size();
+
+    for (int i = 0; i < files.size() && sTotalBytes > target; i++)
+    {
+        if (QFile::remove(files.at(i).absoluteFilePath()))
+            sTotalBytes -= files.at(i).size();
+    }
+}
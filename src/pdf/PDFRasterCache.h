@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2015-2022 Département de l'Instruction Publique (DIP-SEM)
+ *
+ * Copyright (C) 2013 Open Education Foundation
+ *
+ * Copyright (C) 2010-2013 Groupement d'Intérêt Public pour
+ * l'Education Numérique en Afrique (GIP ENA)
+ *
+ * This file is part of OpenBoard.
+ *
+ * OpenBoard is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License,
+ * with a specific linking exception for the OpenSSL project's
+ * "OpenSSL" library (or with modified versions of it that use the
+ * same license as the "OpenSSL" library).
+ *
+ * OpenBoard is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenBoard. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef PDFRASTERCACHE_H
+#define PDFRASTERCACHE_H
+
+#include <QString>
+#include <QUuid>
+#include <QImage>
+#include <QMutex>
+
+/**
+ * On-disk cache of rendered PDF rasters, one folder per PDF file uuid in the user data directory.
+ * The folder holds the checksum of the PDF it was filled from and is emptied when it changes.
+ * Rasters are PNG files read through a memory mapping; the least recently used ones are removed
+ * when the cache grows over 'PDF/RasterCacheDiskBudgetInMB'. The methods may be called from any thread.
+ */
+class PDFRasterCache
+{
+    public:
+        //! 'rootDirectory' and 'budget' (in bytes) are read from the settings on the GUI thread by the caller.
+        PDFRasterCache(const QString &rootDirectory, qint64 budget, const QUuid &fileUuid, const QByteArray &fileData);
+
+        bool isValid() const { return !mDirectory.isEmpty(); }
+
+        QImage image(const QString &key) const;
+        void insert(const QString &key, const QImage &image);
+
+        static QString tileKey(int pageNumber, double dpi, int column, int row);
+
+    private:
+        QString filePath(const QString &key) const;
+
+        void addBytes(qint64 bytes) const;
+        void trim(qint64 target) const;
+
+        QString mRootDirectory;
+        qint64 mBudget;
+        QString mDirectory;
+
+        // Size of the whole cache, -1 until it has been measured.
+        static qint64 sTotalBytes;
+        static QMutex sMutex;
+};
+
+#endif // PDFRASTERCACHE_H
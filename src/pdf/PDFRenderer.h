@@ -68,6 +68,9 @@ class PDFRenderer : public QObject
 
         virtual void render(QPainter *p, int pageNumber, bool const cacheAllowed, const QRectF &bounds = QRectF()) = 0;
 
+        //! Approximate number of bytes held in memory for the rendered images of the given page.
+        virtual qint64 cachedBytes(int pageNumber) const { Q_UNUSED(pageNumber); return 0; }
+
     private:
         QAtomicInt mRefCount;
         QByteArray mFileData;
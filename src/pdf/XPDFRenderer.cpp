@@ -41,6 +41,9 @@
 
 
 QAtomicInt XPDFRenderer::sInstancesCount = 0;
+QCache<XPDFRenderer::TileKey, QImage> XPDFRenderer::sTileCache;
+QCache<XPDFRenderer::TileKey, QImage> XPDFRenderer::sSpeculativeTileCache;
+QMutex XPDFRenderer::sTileCacheMutex;
 
 namespace constants{
     SplashColor paperColor = {0xFF, 0xFF, 0xFF}; // white
@@ -51,6 +54,7 @@ XPDFRenderer::XPDFRenderer(const QString &filename, bool importingFile)
     , mpSplashBitmapHistorical(nullptr)
     , mSplashHistorical(nullptr)
     , mDocument(nullptr)
+    , m_lastTiledPage(0)
 {
     Q_UNUSED(importingFile);
     if (!globalParams)
@@ -64,13 +68,7 @@ XPDFRenderer::XPDFRenderer(const QString &filename, bool importingFile)
 #endif
         globalParams->setupBaseFonts(QFile::encodeName(UBPlatformUtils::applicationResourcesDirectory() + "/" + "fonts").data());
     }
-#ifdef USE_XPDF
-    mDocument = new PDFDoc(new GString(filename.toLocal8Bit()), 0, 0, 0); // the filename GString is deleted on PDFDoc desctruction
-#elif POPPLER_VERSION_MAJOR > 22 || (POPPLER_VERSION_MAJOR == 22 && POPPLER_VERSION_MINOR >= 3)
-    mDocument = new PDFDoc(std::make_unique<GooString>(filename.toLocal8Bit()));
-#else
-    mDocument = new PDFDoc(new GooString(filename.toLocal8Bit()), 0, 0, 0); // the filename GString is deleted on PDFDoc desctruction
-#endif
+    mDocument = openDocument(filename);
 
     if (isValid())
     {
@@ -78,6 +76,20 @@ XPDFRenderer::XPDFRenderer(const QString &filename, bool importingFile)
 
         sInstancesCount.ref();
         connect(&m_cacheThread, SIGNAL(finished()), this, SLOT(OnThreadFinished()));
+
+        if (m_pdfZoomMode == 4)
+        {
+            // The pool threads render with their own documents, a PDFDoc cannot be shared between threads.
+            // Tiles are also kept on disk, so that reopening a document does not render them again.
+            m_tileQueue = QSharedPointer<TileQueue>(new TileQueue(this, filename, UBSettings::userDataDirectory() + "/pdf-cache",
+                                                                  UBSettings::settings()->pdfRasterCacheDiskBudget->get().toLongLong() * 1024 * 1024));
+
+            int const budget = UBSettings::settings()->pdfTileCacheMemoryBudget->get().toInt() * 1024;
+
+            QMutexLocker lock(&sTileCacheMutex);
+            sTileCache.setMaxCost(budget - budget / 4);
+            sSpeculativeTileCache.setMaxCost(budget / 4);
+        }
     }
     else
     {
@@ -87,6 +99,25 @@ XPDFRenderer::XPDFRenderer(const QString &filename, bool importingFile)
 
 XPDFRenderer::~XPDFRenderer()
 {
+    if (m_tileQueue)
+    {
+        m_tileQueue->close();
+
+        // Another renderer may be allocated at the same address later on.
+        QMutexLocker lock(&sTileCacheMutex);
+        foreach (const TileKey &key, sTileCache.keys())
+        {
+            if (key.renderer == this)
+                sTileCache.remove(key);
+        }
+
+        foreach (const TileKey &key, sSpeculativeTileCache.keys())
+        {
+            if (key.renderer == this)
+                sSpeculativeTileCache.remove(key);
+        }
+    }
+
     disconnect(&m_cacheThread, SIGNAL(finished()), this, SLOT(OnThreadFinished()));
     m_cacheThread.cancelPending();
     m_cacheThread.wait(XPDFThreadMaxTimeoutOnExit::timeout_ms);
@@ -126,6 +157,17 @@ XPDFRenderer::~XPDFRenderer()
     }
 }
 
+PDFDoc* XPDFRenderer::openDocument(const QString &filename)
+{
+#ifdef USE_XPDF
+    return new PDFDoc(new GString(filename.toLocal8Bit()), 0, 0, 0); // the filename GString is deleted on PDFDoc desctruction
+#elif POPPLER_VERSION_MAJOR > 22 || (POPPLER_VERSION_MAJOR == 22 && POPPLER_VERSION_MINOR >= 3)
+    return new PDFDoc(std::make_unique<GooString>(filename.toLocal8Bit()));
+#else
+    return new PDFDoc(new GooString(filename.toLocal8Bit()), 0, 0, 0); // the filename GString is deleted on PDFDoc desctruction
+#endif
+}
+
 void XPDFRenderer::initPDFZoomData()
 {
     for (int i=1; i <= mDocument->getNumPages(); i++)
@@ -281,7 +323,11 @@ void XPDFRenderer::render(QPainter *p, int pageNumber, bool const cacheAllowed,
     Q_UNUSED(bounds);
     if (isValid())
     {
-        if (m_perPagepdfZoomCache.contains(pageNumber) && m_perPagepdfZoomCache[pageNumber].size() > 0 && cacheAllowed)
+        if (m_tileQueue && cacheAllowed)
+        {
+            renderTiles(p, pageNumber, bounds);
+        }
+        else if (m_perPagepdfZoomCache.contains(pageNumber) && m_perPagepdfZoomCache[pageNumber].size() > 0 && cacheAllowed)
         {
             qreal xscale = p->worldTransform().m11();
             qreal yscale = p->worldTransform().m22();
@@ -401,6 +447,25 @@ void XPDFRenderer::render(QPainter *p, int pageNumber, bool const cacheAllowed,
     //qDebug() << "render leave";
 }
 
+qint64 XPDFRenderer::cachedBytes(int pageNumber) const
+{
+    // Tiles are budgeted by the shared tile cache.
+    if (m_tileQueue)
+        return 0;
+
+    qint64 bytes = 0;
+
+    const QVector<PdfZoomCacheData> zoomCache = m_perPagepdfZoomCache.value(pageNumber);
+    for (int i = 0; i < zoomCache.size(); i++)
+    {
+        // Images being processed are owned by the cache thread, their size is not known yet.
+        if (!zoomCache[i].hasToBeProcessed && zoomCache[i].cachedPageNumber == pageNumber)
+            bytes += zoomCache[i].cachedImage.byteCount();
+    }
+
+    return bytes;
+}
+
 QImage& XPDFRenderer::createPDFImageCached(int pageNumber, PdfZoomCacheData &cacheData)
 {
     if (isValid())
@@ -478,3 +543,404 @@ void XPDFRenderer::CacheThread::run()
     jobData.cacheData->hasToBeProcessed = false;
     m_jobMutex.unlock();
 }
+
+double XPDFRenderer::tileZoomRatio(int zoomIndex)
+{
+    return XPDFRendererZoomFactor::mode4_zoomFactorStart + XPDFRendererZoomFactor::mode4_zoomFactorStepSquare * static_cast<double>(zoomIndex * zoomIndex);
+}
+
+QThreadPool* XPDFRenderer::tileThreadPool()
+{
+    // Shared by all the renderers, allocated once and never deleted.
+    static QThreadPool *pool = nullptr;
+
+    if (!pool)
+    {
+        pool = new QThreadPool();
+        // Leave a core to the GUI thread.
+        pool->setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    }
+
+    return pool;
+}
+
+void XPDFRenderer::renderTiles(QPainter *p, int pageNumber, const QRectF &bounds)
+{
+    qreal zoomRequested = p->worldTransform().m11();
+    Q_ASSERT(zoomRequested > 0.0);
+
+    // Choose a zoom which is superior or equivalent than the user choice (= no loss, upscaling).
+    int zoomIndex = 0;
+    while (zoomIndex < XPDFRendererZoomFactor::mode4_zoomFactorIterations - 1 && zoomRequested > tileZoomRatio(zoomIndex) + 0.1)
+        zoomIndex++;
+
+    QRectF pageRect(QPointF(0, 0), pageSizeF(pageNumber));
+    QRectF visibleRect = bounds.isNull() ? pageRect : bounds & pageRect;
+
+    if (visibleRect.isEmpty())
+        return;
+
+    QList<QPair<QPoint, QImage> > tiles;
+    QList<TileQueue::Job> missingTiles;
+    findTiles(pageNumber, zoomIndex, visibleRect, &tiles, &missingTiles);
+
+    // Replacing the jobs of the previous page also cancels the pre-rendering around it.
+    int const taskCount = m_tileQueue->setJobs(zoomIndex, missingTiles, neighbourTiles(pageNumber, zoomIndex, visibleRect));
+    for (int i = 0; i < taskCount; i++)
+        tileThreadPool()->start(new TileTask(m_tileQueue));
+
+    m_lastTiledPage = pageNumber;
+
+    // Until all the tiles are there, they are drawn over a coarse preview which is quick to render.
+    // Its jobs are queued under their own requester, ahead of the tiles of the page.
+    QList<TileQueue::Job> missingPreviewTiles;
+    int const previewIndex = qMin(zoomIndex, 1);
+
+    if (!missingTiles.isEmpty())
+    {
+        p->fillRect(visibleRect, Qt::white);
+
+        if (previewIndex != zoomIndex)
+        {
+            QList<QPair<QPoint, QImage> > previewTiles;
+            findTiles(pageNumber, previewIndex, visibleRect, &previewTiles, &missingPreviewTiles);
+
+            drawTiles(p, tileZoomRatio(previewIndex), previewTiles);
+        }
+    }
+
+    int const previewTaskCount = m_tileQueue->setJobs(-1 - zoomIndex, missingPreviewTiles, QList<TileQueue::Job>());
+    for (int i = 0; i < previewTaskCount; i++)
+        tileThreadPool()->start(new TileTask(m_tileQueue));
+
+    drawTiles(p, tileZoomRatio(zoomIndex), tiles);
+}
+
+void XPDFRenderer::findTiles(int pageNumber, int zoomIndex, const QRectF &bounds, QList<QPair<QPoint, QImage> > *tiles, QList<TileQueue::Job> *missingTiles, bool speculative)
+{
+    double const ratio = tileZoomRatio(zoomIndex);
+    int const tileSize = XPDFRendererTiles::tileSize;
+
+    QSizeF pageSize = pageSizeF(pageNumber);
+    QRect imageRect(0, 0, qCeil(pageSize.width() * ratio), qCeil(pageSize.height() * ratio));
+
+    // In pixels of the page image at that zoom.
+    QRect exposedRect = QRectF(bounds.topLeft() * ratio, bounds.bottomRight() * ratio).toAlignedRect() & imageRect;
+
+    if (exposedRect.isEmpty())
+        return;
+
+    QPointF center = QRectF(exposedRect).center();
+
+    QList<QPair<qreal, TileQueue::Job> > missing;
+
+    for (int row = exposedRect.top() / tileSize; row <= exposedRect.bottom() / tileSize; row++)
+    {
+        for (int column = exposedRect.left() / tileSize; column <= exposedRect.right() / tileSize; column++)
+        {
+            TileKey key = {this, pageNumber, zoomIndex, column, row};
+            QRect slice = QRect(column * tileSize, row * tileSize, tileSize, tileSize) & imageRect;
+
+            QImage tile;
+            {
+                QMutexLocker lock(&sTileCacheMutex);
+                QImage *cachedTile = sTileCache.object(key);
+                if (cachedTile)
+                {
+                    tile = *cachedTile;
+                }
+                else if (speculative)
+                {
+                    cachedTile = sSpeculativeTileCache.object(key);
+                    if (cachedTile)
+                        tile = *cachedTile;
+                }
+                else
+                {
+                    // A pre-rendered tile that is now visible.
+                    cachedTile = sSpeculativeTileCache.take(key);
+                    if (cachedTile)
+                    {
+                        tile = *cachedTile;
+                        sTileCache.insert(key, cachedTile, qMax(1, cachedTile->byteCount() / 1024));
+                    }
+                }
+            }
+
+            if (tile.isNull())
+            {
+                TileQueue::Job job = {key, static_cast<double>(this->dpiForRendering), ratio, slice, zoomIndex, speculative};
+                QPointF offset = QRectF(slice).center() - center;
+                missing << qMakePair(offset.x() * offset.x() + offset.y() * offset.y(), job);
+            }
+            else
+            {
+                tiles->append(qMakePair(slice.topLeft(), tile));
+            }
+        }
+    }
+
+    // The tiles in the middle of the view first.
+    std::sort(missing.begin(), missing.end(), [](const QPair<qreal, TileQueue::Job> &a, const QPair<qreal, TileQueue::Job> &b) {
+        return a.first < b.first;
+    });
+
+    for (int i = 0; i < missing.size(); i++)
+        missingTiles->append(missing.at(i).second);
+}
+
+QList<XPDFRenderer::TileQueue::Job> XPDFRenderer::neighbourTiles(int pageNumber, int zoomIndex, const QRectF &bounds)
+{
+    QList<TileQueue::Job> jobs;
+
+    // The page in the direction of travel first.
+    QList<int> neighbours;
+    if (pageNumber < m_lastTiledPage)
+        neighbours << pageNumber - 1 << pageNumber + 1;
+    else
+        neighbours << pageNumber + 1 << pageNumber - 1;
+
+    // No more than their cache can hold.
+    qint64 budget = 0;
+    {
+        QMutexLocker lock(&sTileCacheMutex);
+        budget = sSpeculativeTileCache.maxCost();
+    }
+
+    qint64 cost = 0;
+
+    foreach (int neighbour, neighbours)
+    {
+        if (neighbour < 1 || neighbour > pageCount())
+            continue;
+
+        // Same place on the neighbour page, slides of a deck usually share the page size.
+        QList<QPair<QPoint, QImage> > tiles;
+        QList<TileQueue::Job> missingTiles;
+        findTiles(neighbour, zoomIndex, bounds & QRectF(QPointF(0, 0), pageSizeF(neighbour)), &tiles, &missingTiles, true);
+
+        foreach (const TileQueue::Job &job, missingTiles)
+        {
+            cost += qMax(1, job.slice.width() * job.slice.height() * 3 / 1024);
+            if (cost > budget)
+                return jobs;
+
+            jobs << job;
+        }
+    }
+
+    return jobs;
+}
+
+void XPDFRenderer::drawTiles(QPainter *p, double ratio, const QList<QPair<QPoint, QImage> > &tiles)
+{
+    QTransform savedTransform = p->worldTransform();
+
+    // The tiles are in pixels of the page image at that zoom.
+    p->setWorldTransform(QTransform(savedTransform).scale(1.0 / ratio, 1.0 / ratio));
+
+    for (int i = 0; i < tiles.size(); i++)
+        p->drawImage(tiles.at(i).first, tiles.at(i).second);
+
+    p->setWorldTransform(savedTransform);
+}
+
+void XPDFRenderer::tileRendered()
+{
+    // One refresh for all the tiles rendered until the GUI thread gets to it.
+    if (m_tileUpdatePending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "OnTilesRendered", Qt::QueuedConnection);
+}
+
+void XPDFRenderer::OnTilesRendered()
+{
+    m_tileUpdatePending.storeRelease(0);
+    emit signalUpdateParent();
+}
+
+XPDFRenderer::TileQueue::TileQueue(XPDFRenderer *renderer, const QString &filename, const QString &rasterCacheDirectory, qint64 rasterCacheBudget)
+    : m_renderer(renderer)
+    , m_filename(filename)
+    , m_pendingTasks(0)
+    , m_closed(false)
+    , m_rasterCacheDirectory(rasterCacheDirectory)
+    , m_rasterCacheBudget(rasterCacheBudget)
+{
+}
+
+XPDFRenderer::TileQueue::~TileQueue()
+{
+    close();
+}
+
+int XPDFRenderer::TileQueue::setJobs(int requester, const QList<Job> &jobs, const QList<Job> &speculativeJobs)
+{
+    QMutexLocker lock(&m_mutex);
+
+    QList<Job> queuedJobs = m_jobs;
+    QSet<TileKey> queuedTiles = m_runningTiles;
+
+    // Tiles that went out of view are dropped, the ones already queued or being rendered are not queued again.
+    m_jobs.clear();
+
+    foreach (Job job, jobs)
+    {
+        if (!queuedTiles.contains(job.key))
+        {
+            job.requester = requester;
+            job.speculative = false;
+            m_jobs << job;
+            queuedTiles.insert(job.key);
+        }
+    }
+
+    foreach (const Job &job, queuedJobs)
+    {
+        if (job.requester != requester && !job.speculative && !queuedTiles.contains(job.key))
+        {
+            m_jobs << job;
+            queuedTiles.insert(job.key);
+        }
+    }
+
+    foreach (Job job, speculativeJobs)
+    {
+        if (!queuedTiles.contains(job.key))
+        {
+            job.requester = requester;
+            job.speculative = true;
+            m_jobs << job;
+            queuedTiles.insert(job.key);
+        }
+    }
+
+    foreach (const Job &job, queuedJobs)
+    {
+        if (job.requester != requester && job.speculative && !queuedTiles.contains(job.key))
+        {
+            m_jobs << job;
+            queuedTiles.insert(job.key);
+        }
+    }
+
+    int taskCount = qMax(0, m_jobs.size() - m_pendingTasks);
+    m_pendingTasks += taskCount;
+
+    return taskCount;
+}
+
+void XPDFRenderer::TileQueue::close()
+{
+    QMutexLocker lock(&m_mutex);
+
+    m_closed = true;
+    m_jobs.clear();
+
+    while (!m_runningTiles.isEmpty())
+        m_idle.wait(&m_mutex);
+
+    foreach (const Output &output, m_idleOutputs)
+    {
+        delete output.splash;
+        delete output.document;
+    }
+    m_idleOutputs.clear();
+}
+
+PDFRasterCache *XPDFRenderer::TileQueue::rasterCache()
+{
+    QMutexLocker lock(&m_rasterCacheMutex);
+
+    // Opened by the first job rather than the constructor: hashing the file must not hold up the GUI thread,
+    // and the renderer only gets its file uuid after being constructed.
+    if (!m_rasterCache)
+        m_rasterCache.reset(new PDFRasterCache(m_rasterCacheDirectory, m_rasterCacheBudget, m_renderer->fileUuid(), m_renderer->fileData()));
+
+    return m_rasterCache->isValid() ? m_rasterCache.data() : nullptr;
+}
+
+void XPDFRenderer::TileQueue::runNextJob()
+{
+    m_mutex.lock();
+    m_pendingTasks--;
+
+    if (m_closed || m_jobs.isEmpty())
+    {
+        m_mutex.unlock();
+        return;
+    }
+
+    Job job = m_jobs.takeFirst();
+    m_runningTiles.insert(job.key);
+
+    m_mutex.unlock();
+
+    PDFRasterCache *diskCache = rasterCache();
+    QString const rasterKey = PDFRasterCache::tileKey(job.key.pageNumber, job.dpi * job.ratio, job.key.column, job.key.row);
+
+    QImage *tile = nullptr;
+    Output output = {nullptr, nullptr};
+
+    if (diskCache)
+    {
+        QImage image = diskCache->image(rasterKey);
+        if (!image.isNull())
+            tile = new QImage(image);
+    }
+
+    if (!tile)
+    {
+        m_mutex.lock();
+        if (!m_idleOutputs.isEmpty())
+            output = m_idleOutputs.takeLast();
+        m_mutex.unlock();
+
+        if (!output.document)
+        {
+            output.document = openDocument(m_filename);
+            output.splash = new SplashOutputDev(splashModeRGB8, 1, false, constants::paperColor);
+#ifdef USE_XPDF
+            output.splash->startDoc(output.document->getXRef());
+#else
+            output.splash->startDoc(output.document);
+#endif
+        }
+
+        int rotation = 0; // in degrees (get it from the worldTransform if we want to support rotation)
+        bool useMediaBox = false;
+        bool crop = true;
+        bool printing = false;
+
+        output.document->displayPageSlice(output.splash, job.key.pageNumber, job.dpi * job.ratio, job.dpi * job.ratio,
+                                          rotation, useMediaBox, crop, printing,
+                                          job.slice.x(), job.slice.y(), job.slice.width(), job.slice.height());
+
+        SplashBitmap *bitmap = output.splash->getBitmap();
+        // The bitmap buffer is reused by the next slice, the tile keeps its own copy.
+        tile = new QImage(QImage(bitmap->getDataPtr(), bitmap->getWidth(), bitmap->getHeight(),
+                                 bitmap->getWidth() * 3 /* bytesPerLine, 24 bits for RGB888, = 3 bytes */,
+                                 QImage::Format_RGB888).copy());
+
+        if (diskCache)
+            diskCache->insert(rasterKey, *tile);
+    }
+
+    {
+        QMutexLocker lock(&sTileCacheMutex);
+        if (job.speculative)
+            sSpeculativeTileCache.insert(job.key, tile, qMax(1, tile->byteCount() / 1024));
+        else
+            sTileCache.insert(job.key, tile, qMax(1, tile->byteCount() / 1024));
+    }
+
+    m_mutex.lock();
+    if (output.document)
+        m_idleOutputs << output;
+    m_runningTiles.remove(job.key);
+
+    if (!m_closed)
+        m_renderer->tileRendered();
+
+    m_idle.wakeAll();
+    m_mutex.unlock();
+}
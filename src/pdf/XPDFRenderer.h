@@ -32,7 +32,14 @@
 #include <QImage>
 #include <QThread>
 #include <QMutexLocker>
+#include <QWaitCondition>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QScopedPointer>
+#include <QCache>
 #include "PDFRenderer.h"
+#include "PDFRasterCache.h"
 #include <splash/SplashBitmap.h>
 
 #include "globals/UBGlobals.h"
@@ -72,6 +79,12 @@ namespace XPDFThreadMaxTimeoutOnExit
     const double timeout_ms = 3000;
 }
 
+namespace XPDFRendererTiles
+{
+    // Used when 'ZoomBehavior == 4', size in pixels of the square tiles the pages are rendered in.
+    const int tileSize = 512;
+}
+
 class XPDFRenderer : public PDFRenderer
 {
     Q_OBJECT
@@ -87,6 +100,7 @@ class XPDFRenderer : public PDFRenderer
         virtual int pageRotation(int pageNumber) const override;
         virtual QString title() const override;
         virtual void render(QPainter *p, int pageNumber, const bool cacheAllowed, const QRectF &bounds = QRectF()) override;
+        virtual qint64 cachedBytes(int pageNumber) const override;
 
     signals:
         void signalUpdateParent();
@@ -94,6 +108,8 @@ class XPDFRenderer : public PDFRenderer
     private:
         void init();
 
+        static PDFDoc* openDocument(const QString &filename);
+
         struct PdfZoomCacheData {
             PdfZoomCacheData() : splashBitmap(nullptr), cachedPageNumber(-1), splash(nullptr), ratio(1.0), hasToBeProcessed(false) {};
             PdfZoomCacheData(double const a_ratio) : splashBitmap(nullptr), cachedPageNumber(-1), splash(nullptr), ratio(a_ratio), hasToBeProcessed(false) {};
@@ -160,6 +176,99 @@ class XPDFRenderer : public PDFRenderer
 
         CacheThread m_cacheThread;
 
+        //! Identifies a tile of a page rendered at one of the 'mode4' zoom levels.
+        struct TileKey {
+            const XPDFRenderer* renderer;
+            int pageNumber;
+            int zoomIndex;
+            int column;
+            int row;
+
+            bool operator==(const TileKey &other) const {
+                return renderer == other.renderer && pageNumber == other.pageNumber && zoomIndex == other.zoomIndex
+                        && column == other.column && row == other.row;
+            }
+
+            friend uint qHash(const TileKey &key, uint seed = 0) {
+                return qHash(key.renderer, seed) ^ qHash(key.pageNumber, seed) ^ qHash((key.zoomIndex << 24) ^ (key.column << 12) ^ key.row, seed);
+            }
+        };
+
+        //! Tiles waiting to be rendered by the pool threads, in priority order. The queue is shared with the
+        //! pool tasks, so it outlives the renderer until the last of them has run.
+        class TileQueue
+        {
+        public:
+            struct Job {
+                TileKey key;
+                double dpi;
+                double ratio;
+                QRect slice;
+                int requester;
+                bool speculative;
+            };
+
+            TileQueue(XPDFRenderer *renderer, const QString &filename, const QString &rasterCacheDirectory, qint64 rasterCacheBudget);
+            ~TileQueue();
+
+            //! Replaces the jobs queued by the same requester (a view painting at a zoom level), the
+            //! visible tiles go before the ones of the other requesters, the speculative ones after them.
+            //! Returns the number of pool tasks to start.
+            int setJobs(int requester, const QList<Job> &jobs, const QList<Job> &speculativeJobs);
+            void runNextJob();
+            void close();
+
+        private:
+            struct Output {
+                PDFDoc *document;
+                SplashOutputDev *splash;
+            };
+
+            PDFRasterCache *rasterCache();
+
+            XPDFRenderer *m_renderer;
+            QString m_filename;
+            QMutex m_mutex;
+            QWaitCondition m_idle;
+            QList<Job> m_jobs;
+            QSet<TileKey> m_runningTiles;
+            QList<Output> m_idleOutputs;
+            int m_pendingTasks;
+            bool m_closed;
+            QString m_rasterCacheDirectory;
+            qint64 m_rasterCacheBudget;
+            QScopedPointer<PDFRasterCache> m_rasterCache;
+            QMutex m_rasterCacheMutex;
+        };
+
+        class TileTask : public QRunnable
+        {
+        public:
+            TileTask(const QSharedPointer<TileQueue> &queue) : m_queue(queue) {}
+            virtual void run() override { m_queue->runNextJob(); }
+        private:
+            QSharedPointer<TileQueue> m_queue;
+        };
+
+        void renderTiles(QPainter *p, int pageNumber, const QRectF &bounds);
+        QList<TileQueue::Job> neighbourTiles(int pageNumber, int zoomIndex, const QRectF &bounds);
+        void findTiles(int pageNumber, int zoomIndex, const QRectF &bounds, QList<QPair<QPoint, QImage> > *tiles, QList<TileQueue::Job> *missingTiles, bool speculative = false);
+        void drawTiles(QPainter *p, double ratio, const QList<QPair<QPoint, QImage> > &tiles);
+        static double tileZoomRatio(int zoomIndex);
+        static QThreadPool *tileThreadPool();
+        void tileRendered();
+
+        QSharedPointer<TileQueue> m_tileQueue;
+        QAtomicInt m_tileUpdatePending;
+        int m_lastTiledPage;
+
+        // Tiles of all the renderers, budgeted in KB by 'TileCacheMemoryBudgetInMB'. The pre-rendered tiles of
+        // the neighbour pages get a quarter of it in a cache of their own, so that they never evict a visible
+        // tile; they move to the main cache once painted.
+        static QCache<TileKey, QImage> sTileCache;
+        static QCache<TileKey, QImage> sSpeculativeTileCache;
+        static QMutex sTileCacheMutex;
+
         QImage &createPDFImageCached(int pageNumber, PdfZoomCacheData &cacheData);
         QImage* createPDFImageHistorical(int pageNumber, qreal xscale, qreal yscale, const QRectF &bounds);
 
@@ -167,7 +276,7 @@ class XPDFRenderer : public PDFRenderer
         // =1 has only x3 zoom in cache (= loss if user zoom > 3.0).
         // =2, has 2.5, 5 and 10 (= no loss, but a bit slower).
         // =3, has 1.0, 2.5, 5 and 10, but downsampled instead of upsampled (= minor quality loss, a bit faster).
-        // =4, multithreaded, multiple level of zoom.
+        // =4, multithreaded, multiple level of zoom, rendered in tiles (see renderTiles).
         QMap<int, QVector<PdfZoomCacheData>> m_perPagepdfZoomCache;
         int const m_pdfZoomMode;
 
@@ -183,6 +292,7 @@ class XPDFRenderer : public PDFRenderer
 
 private slots:
         void OnThreadFinished();
+        void OnTilesRendered();
 };
 
 #endif // XPDFRENDERER_H
@@ -1,8 +1,10 @@
 HEADERS      += src/pdf/GraphicsPDFItem.h \
+                src/pdf/PDFRasterCache.h \
                 src/pdf/PDFRenderer.h \
                 src/pdf/XPDFRenderer.h
                 
 SOURCES      += src/pdf/GraphicsPDFItem.cpp \
+                src/pdf/PDFRasterCache.cpp \
                 src/pdf/PDFRenderer.cpp \
                 src/pdf/XPDFRenderer.cpp
                           
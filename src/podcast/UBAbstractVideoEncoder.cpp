@@ -34,6 +34,7 @@
 UBAbstractVideoEncoder::UBAbstractVideoEncoder(QObject *pParent)
     : QObject(pParent)
     , mFramesPerSecond(10)
+    , mKeyframeInterval(1000)
     , mVideoSize(640, 480)
     , mVideoBitsPerSecond(1700000) // 1.7 Mbps
 {
@@ -64,6 +64,17 @@ class UBAbstractVideoEncoder : public QObject
             return mFramesPerSecond;
         }
 
+        /// Longest time in ms between two key frames; frames may arrive irregularly
+        void setKeyframeInterval(int pIntervalMs)
+        {
+            mKeyframeInterval = pIntervalMs;
+        }
+
+        int keyframeInterval() const
+        {
+            return mKeyframeInterval;
+        }
+
         virtual QString videoFileExtension() const = 0;
 
         virtual void setVideoFileName(const QString& pFileName)
@@ -122,6 +133,8 @@ class UBAbstractVideoEncoder : public QObject
 
         int mFramesPerSecond;
 
+        int mKeyframeInterval;
+
         QString mVideoFileName;
 
         QSize mVideoSize;
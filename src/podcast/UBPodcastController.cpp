@@ -81,6 +81,9 @@ UBPodcastController::UBPodcastController(QObject* pParent)
     , mVideoEncoder(0)
     , mInitialized(false)
     , mEmptyChapter(true)
+    , mVariableFrameRate(false)
+    , mKeyframeIntervalMs(5000)
+    , mLastFrameTimestamp(0)
     , mVideoFramesPerSecondAtStart(10)
     , mVideoFrameSizeAtStart(1024, 768)
     , mVideoBitsPerSecondAtStart(1700000)
@@ -348,7 +351,12 @@ void UBPodcastController::start()
 
             mVideoEncoder->setAudioRecordingDevice(recordingDevice);
 
+            mVariableFrameRate = UBSettings::settings()->podcastVariableFrameRate->get().toBool();
+            mKeyframeIntervalMs = qMax(1, UBSettings::settings()->podcastKeyframeIntervalInSeconds->get().toInt()) * 1000;
+            mLastGrab = QImage();
+
             mVideoEncoder->setFramesPerSecond(mVideoFramesPerSecondAtStart);
+            mVideoEncoder->setKeyframeInterval(mKeyframeIntervalMs);
             mVideoEncoder->setVideoSize(mVideoFrameSizeAtStart);
             mVideoEncoder->setVideoBitsPerSecond(mVideoBitsPerSecondAtStart);
 
@@ -568,6 +576,7 @@ void UBPodcastController::processScenePaintEvent()
         return;
 
     QRectF repaintRect;
+    bool fullRepaint = !mInitialized;
 
     if (!mInitialized)
     {
@@ -593,6 +602,17 @@ void UBPodcastController::processScenePaintEvent()
     {
         UBGraphicsScene *scene = bv->scene();
 
+        repaintRect.adjust(-1, -1, 1, 1);
+
+        // keep the area about to be repainted, to find out if anything really changed
+        QTransform sceneToVideo = bv->viewportTransform() * mViewToVideoTransform;
+        QRect videoRect = sceneToVideo.mapRect(repaintRect).toAlignedRect().intersected(mLatestCapture.rect());
+
+        QImage previousContent;
+
+        if (mVariableFrameRate && !fullRepaint)
+            previousContent = mLatestCapture.copy(videoRect);
+
         QPainter p(&mLatestCapture);
 
         p.setTransform(mViewToVideoTransform);
@@ -601,8 +621,6 @@ void UBPodcastController::processScenePaintEvent()
         p.setRenderHints(QPainter::Antialiasing);
         p.setRenderHints(QPainter::SmoothPixmapTransform);
 
-        repaintRect.adjust(-1, -1, 1, 1);
-
         p.setClipRect(repaintRect);
 
         if (scene->isDarkBackground())
@@ -616,6 +634,11 @@ void UBPodcastController::processScenePaintEvent()
 
         scene->setRenderingContext(UBGraphicsScene::Screen);
 
+        p.end();
+
+        if (!previousContent.isNull() && previousContent == mLatestCapture.copy(videoRect))
+            return;
+
         sendLatestPixmapToEncoder();
     }
 }
@@ -715,8 +738,10 @@ void UBPodcastController::encodingFinished(bool ok)
 
 void UBPodcastController::sendLatestPixmapToEncoder()
 {
+    mLastFrameTimestamp = elapsedRecordingMs();
+
     if (mVideoEncoder)
-        mVideoEncoder->newPixmap(mLatestCapture, elapsedRecordingMs());
+        mVideoEncoder->newPixmap(mLatestCapture, mLastFrameTimestamp);
 
     mEmptyChapter = false;
 }
@@ -731,7 +756,14 @@ void UBPodcastController::timerEvent(QTimerEvent *event)
         }
         else if (event->timerId() == mRecordingProgressTimerEventID)
         {
-            emit recordingProgressChanged(elapsedRecordingMs());
+            long elapsed = elapsedRecordingMs();
+
+            // a static board sends no frames, repeat the last one now and then
+            // so that players can seek and the last picture lasts until the end
+            if (mVariableFrameRate && elapsed - mLastFrameTimestamp >= mKeyframeIntervalMs)
+                sendLatestPixmapToEncoder();
+
+            emit recordingProgressChanged(elapsed);
         }
     }
 }
@@ -752,6 +784,17 @@ void UBPodcastController::processScreenGrabingTimerEvent()
         mSourceWidget->render(&p);
     }
 
+    if (mVariableFrameRate)
+    {
+        // comparing is much cheaper than scaling and encoding an identical frame
+        QImage grab = widgetContent.toImage();
+
+        if (mInitialized && grab == mLastGrab)
+            return;
+
+        mLastGrab = grab;
+    }
+
     QPainter p(&mLatestCapture);
 
     if (!mInitialized)
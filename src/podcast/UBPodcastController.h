@@ -141,6 +141,13 @@ class UBPodcastController : public QObject
 
         QImage mLatestCapture;
 
+        /// Only frames whose content changed are sent, with their own timestamps
+        bool mVariableFrameRate;
+        /// Longest gap between two frames sent in variable frame rate mode
+        int mKeyframeIntervalMs;
+        long mLastFrameTimestamp;
+        QImage mLastGrab;
+
         int mVideoFramesPerSecondAtStart;
         QSize mVideoFrameSizeAtStart;
         long mVideoBitsPerSecondAtStart;
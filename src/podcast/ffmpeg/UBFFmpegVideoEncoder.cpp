@@ -21,6 +21,8 @@
 
 #include "UBFFmpegVideoEncoder.h"
 
+#include <QtConcurrent>
+
 // Due to the whole FFmpeg / libAV silliness, we have to support libavresample instead
 // of libswresapmle on some platforms, as well as now-obsolete function names
 #if LIBAVFORMAT_VERSION_MICRO < 100
@@ -214,7 +216,6 @@ void flushStream(AVPacket *packet, AVStream *stream, AVFormatContext *outputForm
 UBFFmpegVideoEncoder::UBFFmpegVideoEncoder(QObject* parent)
     : UBAbstractVideoEncoder(parent)
     , mOutputFormatContext(NULL)
-    , mSwsContext(NULL)
     , mShouldRecordAudio(true)
     , mAudioInput(NULL)
     , mSwrContext(NULL)
@@ -322,7 +323,9 @@ bool UBFFmpegVideoEncoder::init()
     c->width = videoSize().width();
     c->height = videoSize().height();
     c->time_base = {1, mVideoTimebase};
-    c->gop_size = 10;
+    // Frames are only sent when the picture changes, so the encoder's own
+    // GOP is a fallback; key frames are forced by time in writeVideoFrame
+    c->gop_size = qMax(1, framesPerSecond() * keyframeInterval() / 1000);
     c->max_b_frames = 0;
     c->pix_fmt = AV_PIX_FMT_YUV420P;
 
@@ -349,11 +352,7 @@ bool UBFFmpegVideoEncoder::init()
 
     mVideoStream->codec = c;
 
-    // Source images are RGB32, and should be converted to YUV for h264 video
-    mSwsContext = sws_getCachedContext(mSwsContext,
-                                       c->width, c->height, AV_PIX_FMT_RGB32,
-                                       c->width, c->height, c->pix_fmt,
-                                       SWS_BICUBIC, 0, 0, 0);
+    // Source images are RGB32, the worker converts them to YUV for h264 video
 
     // Audio codec and context
     // -------------------------------------
@@ -468,70 +467,31 @@ bool UBFFmpegVideoEncoder::init()
 
 /**
  * This function should be called every time a new "screenshot" is ready.
- * The image is converted to the right format and sent to the encoder.
+ * The image is sent to the worker, which converts it to the right format and encodes it.
  */
 void UBFFmpegVideoEncoder::newPixmap(const QImage &pImage, long timestamp)
 {
-    if (!mVideoWorker->isRunning()) {
-        qDebug() << "Encoder worker thread not running. Queuing frame.";
-        mPendingFrames.enqueue({pImage, timestamp});
-    }
-
-    else {
-        // First send any queued frames, then the latest one
-        while (!mPendingFrames.isEmpty()) {
-            AVFrame* avFrame = convertImageFrame(mPendingFrames.dequeue());
-            if (avFrame)
-                mVideoWorker->queueVideoFrame(avFrame);
-        }
-
-        // note: if converting the frame turns out to be too slow to do here, it
-        // can always be done from the worker thread (in that case,
-        // the worker's queue would contain ImageFrames rather than AVFrames)
-
-        AVFrame* avFrame = convertImageFrame({pImage, timestamp});
-        if (avFrame)
-            mVideoWorker->queueVideoFrame(avFrame);
-
-        // signal the worker that frames are available
-        mVideoWorker->mWaitCondition.wakeAll();
-    }
+    mVideoWorker->queueVideoFrame({pImage, timestamp});
 }
 
-/**
- * Convert a frame consisting of a QImage and timestamp to an AVFrame
- * with the right pixel format and PTS
- */
-AVFrame* UBFFmpegVideoEncoder::convertImageFrame(ImageFrame frame)
+/// Number of images waiting to be converted and encoded
+int UBFFmpegVideoEncoder::videoQueueDepth() const
 {
-    AVFrame* avFrame = av_frame_alloc();
-
-    avFrame->format = mVideoStream->codec->pix_fmt;
-    avFrame->width = mVideoStream->codec->width;
-    avFrame->height = mVideoStream->codec->height;
-    avFrame->pts = mVideoTimebase * frame.timestamp / 1000;
-
-    const uchar * rgbImage = frame.image.bits();
-
-    const int in_linesize[1] = { frame.image.bytesPerLine() };
+    return mVideoWorker->mVideoQueueDepth;
+}
 
-    // Allocate the output image
-    if (av_image_alloc(avFrame->data, avFrame->linesize, mVideoStream->codec->width,
-                       mVideoStream->codec->height, mVideoStream->codec->pix_fmt, 32) < 0)
-    {
-        qWarning() << "Couldn't allocate image";
-        return NULL;
-    }
+/// Number of images that were not encoded because the encoder could not keep up
+int UBFFmpegVideoEncoder::droppedVideoFrames() const
+{
+    return mVideoWorker->mDroppedVideoFrames;
+}
 
-    sws_scale(mSwsContext,
-              (const uint8_t* const*)&rgbImage,
-              in_linesize,
-              0,
-              mVideoStream->codec->height,
-              avFrame->data,
-              avFrame->linesize);
+/// Average time to convert and encode an image, in ms
+qreal UBFFmpegVideoEncoder::videoEncodeTimePerFrame() const
+{
+    int frames = mVideoWorker->mEncodedVideoFrames;
 
-    return avFrame;
+    return frames > 0 ? mVideoWorker->mVideoEncodeTimeNs / 1000000.0 / frames : 0;
 }
 
 void UBFFmpegVideoEncoder::onAudioAvailable(QByteArray data)
@@ -654,7 +614,6 @@ void UBFFmpegVideoEncoder::finishEncoding()
     avio_close(mOutputFormatContext->pb);
 
     avcodec_close(mVideoStream->codec);
-    sws_freeContext(mSwsContext);
 
     if (mShouldRecordAudio) {
         avcodec_close(mAudioStream->codec);
@@ -663,6 +622,9 @@ void UBFFmpegVideoEncoder::finishEncoding()
 
     avformat_free_context(mOutputFormatContext);
 
+    qDebug() << "Video encoder:" << mVideoWorker->mEncodedVideoFrames << "frames encoded in"
+             << videoEncodeTimePerFrame() << "ms each," << droppedVideoFrames() << "dropped";
+
     emit encodingFinished(true);
 }
 
@@ -673,11 +635,21 @@ void UBFFmpegVideoEncoder::finishEncoding()
 
 UBFFmpegVideoEncoderWorker::UBFFmpegVideoEncoderWorker(UBFFmpegVideoEncoder* controller)
     : mController(controller)
+    , mLastVideoPts(AV_NOPTS_VALUE)
+    , mLastKeyframePts(AV_NOPTS_VALUE)
 {
     mStopRequested = false;
     mIsRunning = false;
     mVideoPacket = new AVPacket();
     mAudioPacket = new AVPacket();
+
+    // set once encoding starts, the frame rate is only known then
+    mMaxQueuedImages = 0;
+
+    mVideoQueueDepth = 0;
+    mDroppedVideoFrames = 0;
+    mEncodedVideoFrames = 0;
+    mVideoEncodeTimeNs = 0;
 }
 
 UBFFmpegVideoEncoderWorker::~UBFFmpegVideoEncoderWorker()
@@ -692,17 +664,26 @@ UBFFmpegVideoEncoderWorker::~UBFFmpegVideoEncoderWorker()
 void UBFFmpegVideoEncoderWorker::stopEncoding()
 {
     qDebug() << "Video worker: stop requested";
+
+    QMutexLocker locker(&mFrameQueueMutex);
     mStopRequested = true;
     mWaitCondition.wakeAll();
 }
 
-void UBFFmpegVideoEncoderWorker::queueVideoFrame(AVFrame* frame)
+void UBFFmpegVideoEncoderWorker::queueVideoFrame(const UBFFmpegVideoEncoder::ImageFrame& frame)
 {
-    if (frame) {
-        mFrameQueueMutex.lock();
-        mImageQueue.enqueue(frame);
-        mFrameQueueMutex.unlock();
+    QMutexLocker locker(&mFrameQueueMutex);
+
+    // When the encoder cannot keep up, the oldest images are dropped so that the video stays current
+    while (mMaxQueuedImages > 0 && mImageQueue.size() >= mMaxQueuedImages) {
+        mImageQueue.dequeue();
+        ++mDroppedVideoFrames;
     }
+
+    mImageQueue.enqueue(frame);
+    mVideoQueueDepth = mImageQueue.size();
+
+    mWaitCondition.wakeAll();
 }
 
 void UBFFmpegVideoEncoderWorker::queueAudioFrame(AVFrame* frame)
@@ -717,40 +698,196 @@ void UBFFmpegVideoEncoderWorker::queueAudioFrame(AVFrame* frame)
 /**
  * The main encoding function. Takes the queued frames and
  * writes them to the video and audio streams
+ *
+ * The queues are only locked while frames are taken from them, so that the
+ * GUI thread never waits for the encoder.
  */
 void UBFFmpegVideoEncoderWorker::runEncoding()
 {
+    mFrameQueueMutex.lock();
+    // half a second of images at most
+    mMaxQueuedImages = qMax(2, mController->framesPerSecond() / 2);
+    mFrameQueueMutex.unlock();
+
+    initVideoConversion();
+
     mIsRunning = true;
 
-    while (!mStopRequested) {
+    forever {
         mFrameQueueMutex.lock();
-        mWaitCondition.wait(&mFrameQueueMutex);
 
-        while (!mImageQueue.isEmpty()) {
-            writeLatestVideoFrame();
-        }
+        if (mImageQueue.isEmpty() && mAudioQueue.isEmpty() && !mStopRequested)
+            mWaitCondition.wait(&mFrameQueueMutex);
+
+        bool hasImage = !mImageQueue.isEmpty();
+        UBFFmpegVideoEncoder::ImageFrame image;
 
-        while (!mAudioQueue.isEmpty()) {
-            writeLatestAudioFrame();
+        if (hasImage) {
+            image = mImageQueue.dequeue();
+            mVideoQueueDepth = mImageQueue.size();
         }
 
+        QQueue<AVFrame*> audioFrames;
+        audioFrames.swap(mAudioQueue);
+
+        // the queues are emptied before stopping
+        bool finished = mStopRequested && mImageQueue.isEmpty();
+
         mFrameQueueMutex.unlock();
+
+        if (hasImage)
+            writeVideoFrame(image);
+
+        while (!audioFrames.isEmpty())
+            writeAudioFrame(audioFrames.dequeue());
+
+        if (finished)
+            break;
     }
 
+    releaseVideoConversion();
+
     emit encodingFinished();
 }
 
-void UBFFmpegVideoEncoderWorker::writeLatestVideoFrame()
+/**
+ * Create one scaler per band of the image, so that the bands can be converted in parallel.
+ * The bands start on even rows, which keeps the subsampled chroma rows whole.
+ */
+void UBFFmpegVideoEncoderWorker::initVideoConversion()
 {
-    AVFrame* frame = mImageQueue.dequeue();
-    writeFrame(frame, mVideoPacket, mController->mVideoStream, mController->mOutputFormatContext);
-    av_freep(&frame->data[0]);
-    av_frame_free(&frame);
+    AVCodecContext* c = mController->mVideoStream->codec;
+
+    int sliceCount = qBound(1, QThread::idealThreadCount(), 4);
+    int sliceHeight = (c->height / sliceCount + 1) & ~1;
+
+    for (int top = 0; top < c->height; top += sliceHeight) {
+        ConversionSlice slice;
+        slice.top = top;
+        slice.height = qMin(sliceHeight, c->height - top);
+        slice.context = sws_getContext(c->width, slice.height, AV_PIX_FMT_RGB32,
+                                       c->width, slice.height, c->pix_fmt,
+                                       SWS_BICUBIC, 0, 0, 0);
+
+        mConversionSlices << slice;
+    }
+}
+
+void UBFFmpegVideoEncoderWorker::releaseVideoConversion()
+{
+    foreach (const ConversionSlice& slice, mConversionSlices)
+        sws_freeContext(slice.context);
+
+    mConversionSlices.clear();
+
+    foreach (AVFrame* frame, mFramePool) {
+        av_freep(&frame->data[0]);
+        av_frame_free(&frame);
+    }
+
+    mFramePool.clear();
+}
+
+/**
+ * Convert a frame consisting of a QImage and timestamp to an AVFrame
+ * with the right pixel format and PTS. The AVFrame is taken from the pool
+ * if one is available.
+ */
+AVFrame* UBFFmpegVideoEncoderWorker::convertImageFrame(const UBFFmpegVideoEncoder::ImageFrame& frame)
+{
+    AVCodecContext* c = mController->mVideoStream->codec;
+
+    if (frame.image.width() != c->width || frame.image.height() < c->height) {
+        qWarning() << "Image size" << frame.image.size() << "doesn't match the video size";
+        return NULL;
+    }
+
+    AVFrame* avFrame = NULL;
+
+    if (!mFramePool.isEmpty()) {
+        avFrame = mFramePool.takeLast();
+    }
+    else {
+        avFrame = av_frame_alloc();
+
+        avFrame->format = c->pix_fmt;
+        avFrame->width = c->width;
+        avFrame->height = c->height;
+
+        // Allocate the output image
+        if (av_image_alloc(avFrame->data, avFrame->linesize, c->width, c->height, c->pix_fmt, 32) < 0)
+        {
+            qWarning() << "Couldn't allocate image";
+            av_frame_free(&avFrame);
+            return NULL;
+        }
+    }
+
+    avFrame->pts = mController->mVideoTimebase * frame.timestamp / 1000;
+
+    const QImage& image = frame.image;
+
+    QtConcurrent::blockingMap(mConversionSlices, [&image, avFrame](ConversionSlice& slice) {
+        const uchar* rgbImage = image.constScanLine(slice.top);
+        const int in_linesize[1] = { image.bytesPerLine() };
+
+        // the chroma planes of YUV420P have half as many rows
+        uint8_t* data[4] = {
+            avFrame->data[0] + slice.top * avFrame->linesize[0],
+            avFrame->data[1] + slice.top / 2 * avFrame->linesize[1],
+            avFrame->data[2] + slice.top / 2 * avFrame->linesize[2],
+            NULL
+        };
+
+        sws_scale(slice.context,
+                  (const uint8_t* const*)&rgbImage,
+                  in_linesize,
+                  0,
+                  slice.height,
+                  data,
+                  avFrame->linesize);
+    });
+
+    return avFrame;
+}
+
+void UBFFmpegVideoEncoderWorker::writeVideoFrame(const UBFFmpegVideoEncoder::ImageFrame& frame)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    AVFrame* avFrame = convertImageFrame(frame);
+
+    if (!avFrame)
+        return;
+
+    // The encoder needs increasing timestamps
+    if (mLastVideoPts != AV_NOPTS_VALUE && avFrame->pts <= mLastVideoPts) {
+        ++mDroppedVideoFrames;
+    }
+    else {
+        // Pooled frames keep their picture type, so it is reset every time
+        int64_t keyframeInterval = (int64_t)mController->mVideoTimebase * mController->keyframeInterval() / 1000;
+
+        if (mLastKeyframePts == AV_NOPTS_VALUE || avFrame->pts - mLastKeyframePts >= keyframeInterval) {
+            avFrame->pict_type = AV_PICTURE_TYPE_I;
+            mLastKeyframePts = avFrame->pts;
+        }
+        else
+            avFrame->pict_type = AV_PICTURE_TYPE_NONE;
+
+        writeFrame(avFrame, mVideoPacket, mController->mVideoStream, mController->mOutputFormatContext);
+        mLastVideoPts = avFrame->pts;
+
+        ++mEncodedVideoFrames;
+        mVideoEncodeTimeNs += timer.nsecsElapsed();
+    }
+
+    mFramePool << avFrame;
 }
 
-void UBFFmpegVideoEncoderWorker::writeLatestAudioFrame()
+void UBFFmpegVideoEncoderWorker::writeAudioFrame(AVFrame* frame)
 {
-    AVFrame *frame = mAudioQueue.dequeue();
     writeFrame(frame, mAudioPacket, mController->mAudioStream, mController->mOutputFormatContext);
     av_frame_free(&frame);
 
@@ -66,7 +66,7 @@ class UBPodcastController;
  * video streams and encoders, etc) from inputs consisting of raw PCM audio and raw RGBA
  * images.
  *
- * A worker thread is used to encode and write the audio and video on-the-fly.
+ * A worker thread is used to convert, encode and write the audio and video on-the-fly.
  */
 
 class UBFFmpegVideoEncoder : public UBAbstractVideoEncoder
@@ -91,6 +91,10 @@ public:
 
     void setRecordAudio(bool pRecordAudio) { mShouldRecordAudio = pRecordAudio; }
 
+    int videoQueueDepth() const;
+    int droppedVideoFrames() const;
+    qreal videoEncodeTimePerFrame() const;
+
 private slots:
 
     void setLastErrorMessage(const QString& pMessage);
@@ -105,7 +109,6 @@ private:
         long timestamp; // unit: ms
     };
 
-    AVFrame* convertImageFrame(ImageFrame frame);
     AVFrame* convertAudio(QByteArray data);
     void processAudio(QByteArray& data);
     bool init();
@@ -123,9 +126,6 @@ private:
 
     // Video
     // ------------------------------------------
-    QQueue<ImageFrame> mPendingFrames;
-    struct SwsContext * mSwsContext;
-
     int mVideoTimebase;
 
     // Audio
@@ -156,7 +156,7 @@ public:
 
     bool isRunning() { return mIsRunning; }
 
-    void queueVideoFrame(AVFrame* frame);
+    void queueVideoFrame(const UBFFmpegVideoEncoder::ImageFrame& frame);
     void queueAudioFrame(AVFrame* frame);
 
 public slots:
@@ -168,8 +168,20 @@ signals:
     void error(QString message);
 
 private:
-    void writeLatestVideoFrame();
-    void writeLatestAudioFrame();
+    /// A band of the image, converted by its own scaler on the thread pool
+    struct ConversionSlice
+    {
+        struct SwsContext* context;
+        int top;
+        int height;
+    };
+
+    void initVideoConversion();
+    void releaseVideoConversion();
+    AVFrame* convertImageFrame(const UBFFmpegVideoEncoder::ImageFrame& frame);
+
+    void writeVideoFrame(const UBFFmpegVideoEncoder::ImageFrame& frame);
+    void writeAudioFrame(AVFrame* frame);
 
     UBFFmpegVideoEncoder* mController;
 
@@ -178,12 +190,26 @@ private:
     std::atomic<bool> mStopRequested;
     std::atomic<bool> mIsRunning;
 
-    QQueue<AVFrame*> mImageQueue;
+    QQueue<UBFFmpegVideoEncoder::ImageFrame> mImageQueue;
     QQueue<AVFrame*> mAudioQueue;
 
     QMutex mFrameQueueMutex;
     QWaitCondition mWaitCondition;
 
+    /// Images waiting beyond this are dropped, the oldest first; no limit before encoding starts
+    int mMaxQueuedImages;
+
+    QVector<ConversionSlice> mConversionSlices;
+    /// Converted frames are given back to the pool once encoded
+    QList<AVFrame*> mFramePool;
+    int64_t mLastVideoPts;
+    int64_t mLastKeyframePts;
+
+    std::atomic<int> mVideoQueueDepth;
+    std::atomic<int> mDroppedVideoFrames;
+    std::atomic<int> mEncodedVideoFrames;
+    std::atomic<qint64> mVideoEncodeTimeNs;
+
     AVPacket* mVideoPacket;
     AVPacket* mAudioPacket;
 };